@@ -616,3 +616,8 @@ typedef volatile nglAtomic64 nglAtomic;
 typedef volatile nglAtomic32 nglAtomic;
 #endif
 
+
+// Size of the data cache lines. Use it to keep the variables written by different threads apart (false sharing).
+#ifndef NGL_CACHE_LINE_SIZE
+#define NGL_CACHE_LINE_SIZE 64
+#endif
@@ -42,6 +42,7 @@ public:
   static bool   HasMMX();      ///< return true if MMX extensions are available
   static bool   HasSSE();      ///< return true if SSE extensions are available
   static bool   HasSSE2();     ///< return true if SSE2 extensions are available
+  static bool   HasAVX2();     ///< return true if AVX2 extensions are available (and enabled by the OS)
   static bool   Has3DNow();    ///< return true if 3DNow extensions are available
   static bool   HasAltivec();  ///< return true if Altivec extensions are available
 
@@ -54,6 +55,7 @@ private:
   static bool mMMX;
   static bool mSSE;
   static bool mSSE2;
+  static bool mAVX2;
   static bool m3DNow;
   static bool mAltivec;
 
@@ -61,4 +63,21 @@ private:
   static void FillCPUInfo();
 };
 
+/*
+NGL_TARGET_BEGIN / NGL_TARGET_END compile the functions between them for an instruction set the rest of the
+library may not be built with (\a ISA is a string such as "sse2" or "avx2"). This is meant for whole kernel files
+which are only called after checking the matching nglCPUInfo::HasXXX().
+*/
+#if defined(__clang__)
+#define NGL_TARGET_BEGIN(ISA) _Pragma(NGL_TARGET_STR(clang attribute push (__attribute__((target(ISA))), apply_to = function)))
+#define NGL_TARGET_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define NGL_TARGET_BEGIN(ISA) _Pragma("GCC push_options") _Pragma(NGL_TARGET_STR(GCC target(ISA)))
+#define NGL_TARGET_END _Pragma("GCC pop_options")
+#else
+#define NGL_TARGET_BEGIN(ISA)
+#define NGL_TARGET_END
+#endif
+#define NGL_TARGET_STR(X) #X
+
 #endif // __nglCPUInfo_h__
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "nuiNonCopyable.h"
+#include "nglSPSCRing.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //		LockFreeFifo
@@ -15,63 +16,40 @@
 template<class T> class nglLockFreeFifo : nuiNonCopyable
   {
   public:
-    nglLockFreeFifo (uint32 bufsz) : mReadIdx(0), mWriteIdx(0), mBuffer(bufsz)
+    /// Single producer / single consumer fifo. Kept for compatibility, see nglSPSCRing for bulk transfers.
+    /// bufsz is rounded up to the next power of two.
+    nglLockFreeFifo (uint32 bufsz) : mRing(bufsz)
     {
     }
     
     T Get(void)
     {
-      NGL_ASSERT(mReadIdx != mWriteIdx);
+      T result = T();
+      bool res = mRing.Pop(result);
+      NGL_ASSERT(res);
       //	throw runtime_error ("lock free fifo underrun");
-      
-      T result = mBuffer[mReadIdx];
-      
-      if ((mReadIdx + 1) >= mBuffer.size())
-        mReadIdx = 0;
-      else
-        mReadIdx = mReadIdx + 1;
-      
       return result;
     }
     
     void Put(T element)
     {
-      uint32 newIdx;
-      
-      if ((mWriteIdx + 1) >= mBuffer.size())
-        newIdx = 0;
-      else
-        newIdx = mWriteIdx + 1;
-      
-      NGL_ASSERT(newIdx != mReadIdx);
+      bool res = mRing.Push(element);
+      NGL_ASSERT(res);
       //throw runtime_error ("lock free fifo overrun");
-      
-      mBuffer[mWriteIdx] = element;
-      
-      mWriteIdx = newIdx;
     }
     
     bool CanRead() const 
     {
-      return mReadIdx != mWriteIdx;
+      return mRing.CanRead();
     }
     
     bool CanWrite() const 
     {
-      uint32 newIdx;
-      
-      if ((mWriteIdx + 1) >= mBuffer.size())
-        newIdx = 0;
-      else
-        newIdx = mWriteIdx + 1;
-      
-      return newIdx != mReadIdx;
+      return mRing.CanWrite();
     }
     
   private:
     
-    nglAtomic mReadIdx;
-    nglAtomic mWriteIdx;
-    std::vector<T> mBuffer;
+    nglSPSCRing<T> mRing;
   };
 
@@ -0,0 +1,156 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiNonCopyable.h"
+
+/// Wait-free ring buffer between exactly one producer thread and one consumer thread.
+/*!
+ The capacity is rounded up to a power of two so that wrapping is a mask. The indices run freely and are published with
+ release/acquire ordering. The producer and consumer indices live on their own cache lines, each side also keeps a private
+ copy of the other side's index so that it only reads the shared one when its copy says the ring looks full (or empty).
+ Nothing here locks or allocates after construction, which makes it usable from an audio callback.
+ */
+template <class T>
+class nglSPSCRing : nuiNonCopyable
+{
+public:
+  nglSPSCRing(uint32 MinCapacity)
+  : mMask(RoundCapacity(MinCapacity) - 1), mBuffer(mMask + 1), mWriteIdx(0), mReadCache(0), mReadIdx(0), mWriteCache(0)
+  {
+  }
+
+  uint32 GetCapacity() const
+  {
+    return mMask + 1;
+  }
+
+  // Producer side:
+  bool Push(const T& rElement)
+  {
+    const uint32 w = mWriteIdx.load(std::memory_order_relaxed);
+    if (w - mReadCache > mMask)
+    {
+      mReadCache = mReadIdx.load(std::memory_order_acquire);
+      if (w - mReadCache > mMask)
+        return false;
+    }
+    mBuffer[w & mMask] = rElement;
+    mWriteIdx.store(w + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint32 Push(const T* pElements, uint32 Count) ///< Push up to Count elements, returns the number of elements actually written.
+  {
+    const uint32 w = mWriteIdx.load(std::memory_order_relaxed);
+    uint32 writable = GetCapacity() - (w - mReadCache);
+    if (writable < Count)
+    {
+      mReadCache = mReadIdx.load(std::memory_order_acquire);
+      writable = GetCapacity() - (w - mReadCache);
+    }
+    Count = MIN(Count, writable);
+
+    const uint32 start = w & mMask;
+    const uint32 first = MIN(Count, GetCapacity() - start);
+    std::copy(pElements, pElements + first, mBuffer.begin() + start);
+    std::copy(pElements + first, pElements + Count, mBuffer.begin());
+
+    mWriteIdx.store(w + Count, std::memory_order_release);
+    return Count;
+  }
+
+  uint32 GetWritable() const
+  {
+    return GetCapacity() - (mWriteIdx.load(std::memory_order_relaxed) - mReadIdx.load(std::memory_order_acquire));
+  }
+
+  bool CanWrite() const
+  {
+    return GetWritable() != 0;
+  }
+
+  // Consumer side:
+  bool Pop(T& rElement)
+  {
+    const uint32 r = mReadIdx.load(std::memory_order_relaxed);
+    if (r == mWriteCache)
+    {
+      mWriteCache = mWriteIdx.load(std::memory_order_acquire);
+      if (r == mWriteCache)
+        return false;
+    }
+    rElement = mBuffer[r & mMask];
+    mReadIdx.store(r + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint32 Pop(T* pElements, uint32 Count) ///< Pop up to Count elements, returns the number of elements actually read.
+  {
+    const uint32 r = mReadIdx.load(std::memory_order_relaxed);
+    uint32 readable = mWriteCache - r;
+    if (readable < Count)
+    {
+      mWriteCache = mWriteIdx.load(std::memory_order_acquire);
+      readable = mWriteCache - r;
+    }
+    Count = MIN(Count, readable);
+
+    const uint32 start = r & mMask;
+    const uint32 first = MIN(Count, GetCapacity() - start);
+    std::copy(mBuffer.begin() + start, mBuffer.begin() + start + first, pElements);
+    std::copy(mBuffer.begin(), mBuffer.begin() + (Count - first), pElements + first);
+
+    mReadIdx.store(r + Count, std::memory_order_release);
+    return Count;
+  }
+
+  uint32 Discard(uint32 Count) ///< Drop up to Count elements without reading them, returns the number of elements dropped.
+  {
+    const uint32 r = mReadIdx.load(std::memory_order_relaxed);
+    mWriteCache = mWriteIdx.load(std::memory_order_acquire);
+    Count = MIN(Count, mWriteCache - r);
+    mReadIdx.store(r + Count, std::memory_order_release);
+    return Count;
+  }
+
+  uint32 GetReadable() const
+  {
+    return mWriteIdx.load(std::memory_order_acquire) - mReadIdx.load(std::memory_order_relaxed);
+  }
+
+  bool CanRead() const
+  {
+    return GetReadable() != 0;
+  }
+
+private:
+  static uint32 RoundCapacity(uint32 MinCapacity)
+  {
+    uint32 capacity = 2;
+    while (capacity < MinCapacity)
+      capacity <<= 1;
+    return capacity;
+  }
+
+  // Shared, read only:
+  const uint32 mMask;
+  std::vector<T> mBuffer;
+  char mPad0[NGL_CACHE_LINE_SIZE];
+
+  // Producer:
+  std::atomic<uint32> mWriteIdx;
+  uint32 mReadCache;
+  char mPad1[NGL_CACHE_LINE_SIZE - sizeof(uint32) * 2];
+
+  // Consumer:
+  std::atomic<uint32> mReadIdx;
+  uint32 mWriteCache;
+  char mPad2[NGL_CACHE_LINE_SIZE - sizeof(uint32) * 2];
+};
+
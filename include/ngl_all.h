@@ -41,7 +41,9 @@ extern "C"
 }// extern "C"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <deque>
 #include <iostream>
 #include <limits>
 #include <list>
@@ -135,6 +137,7 @@ extern "C"
 #include "nglSyncEvent.h"
 #include "nglReaderWriterLock.h"
 #include "nglRingBuffer.h"
+#include "nglSPSCRing.h"
 #include "nglPath.h"
 
 #include "nglLog.h"
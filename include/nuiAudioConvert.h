@@ -9,6 +9,32 @@
 
 #include "nui.h"
 
+/// Instruction sets the buffer conversions can use. The best one available on the running CPU is picked on first use.
+enum nuiAudioConvertImplementation
+{
+  eAudioConvertScalar = 0,
+  eAudioConvertSSE2,
+  eAudioConvertAVX2
+};
+
+bool nuiAudioConvert_SetImplementation(nuiAudioConvertImplementation Implementation); ///< Force an implementation (mostly for benchmarks and tests). Returns false if the CPU doesn't support it.
+bool nuiAudioConvert_IsImplementationAvailable(nuiAudioConvertImplementation Implementation);
+nuiAudioConvertImplementation nuiAudioConvert_GetImplementation();
+void nuiAudioConvert_ResetImplementation(); ///< Go back to the best implementation for this CPU.
+const char* nuiAudioConvert_GetImplementationName(nuiAudioConvertImplementation Implementation);
+
+// Buffer conversions. Integer to float maps the negative range with 1/2^(n-1) and the positive range with 1/(2^(n-1)-1) so that both full scales map to +/-1.0,
+// float to integer clamps to [-1, 1] and truncates toward zero. The buffers are processed forward, each block is read before it is written.
+void nuiAudioConvert_Int16ToFloat(const int16* pIn, float* pOut, int64 count);
+void nuiAudioConvert_FloatToInt16(const float* pIn, int16* pOut, int64 count);
+void nuiAudioConvert_FloatToInt16Dither(const float* pIn, int16* pOut, int64 count, uint32& rDitherState); ///< TPDF dither (+/- 1 LSB) and round half up. rDitherState is the generator state, keep it from one buffer to the next (any value to start).
+void nuiAudioConvert_Int24LEToFloat(const uint8* pIn, float* pOut, int64 count); ///< Packed 24 bits little endian samples.
+void nuiAudioConvert_FloatToInt24LE(const float* pIn, uint8* pOut, int64 count);
+void nuiAudioConvert_Int32ToFloat(const int32* pIn, float* pOut, int64 count);
+void nuiAudioConvert_FloatToInt32(const float* pIn, int32* pOut, int64 count);
+void nuiAudioConvert_Interleave(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames); ///< pIn holds one buffer per channel.
+void nuiAudioConvert_Deinterleave(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames); ///< pOut holds one buffer per channel.
+
 void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames); // interlaced int16 to de-interlaced float
 
 void nuiAudioConvert_DEfloatToINint16(const float* input, int16* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames); // de-interlaced float to interlaced int16
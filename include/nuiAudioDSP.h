@@ -0,0 +1,38 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nui.h"
+
+// Small mixing kernels used by the voices and the audio engine. They use SSE when the CPU has it and never allocate,
+// so they can be called from the audio thread. The buffers don't need any particular alignment.
+
+enum nuiAudioPanLaw
+{
+  eAudioPanBalance = 0, ///< Center is 0 dB on both sides, the opposite side is attenuated linearly. Best suited to stereo sources.
+  eAudioPanConstantPower ///< sin/cos law: the power stays the same across the field (-3 dB on both sides at the center). Best suited to mono sources.
+};
+
+void nuiAudioDSP_PanGains(float Pan, nuiAudioPanLaw Law, float& rLeft, float& rRight); ///< Pan goes from -1 (left) to 1 (right).
+
+void nuiAudioDSP_Clear(float* pBuffer, int32 SampleFrames);
+void nuiAudioDSP_Copy(const float* pSrc, float* pDst, int32 SampleFrames);
+void nuiAudioDSP_Scale(float* pBuffer, int32 SampleFrames, float Gain);
+void nuiAudioDSP_Ramp(float* pBuffer, int32 SampleFrames, float StartGain, float EndGain); ///< Multiply by a linear ramp. EndGain is the gain of the frame that follows the buffer, so that consecutive ramps join seamlessly.
+
+void nuiAudioDSP_MixAdd(const float* pSrc, float* pDst, int32 SampleFrames, float Gain); ///< pDst += pSrc * Gain
+void nuiAudioDSP_MixAddRamp(const float* pSrc, float* pDst, int32 SampleFrames, float StartGain, float EndGain); ///< pDst += pSrc * linear ramp (see nuiAudioDSP_Ramp)
+void nuiAudioDSP_MixAddStereo(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float GainLeft, float GainRight); ///< Mono to stereo, the source is read once.
+void nuiAudioDSP_MixAddStereoRamp(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float StartLeft, float EndLeft, float StartRight, float EndRight);
+
+float nuiAudioDSP_Peak(const float* pBuffer, int32 SampleFrames); ///< Biggest absolute value.
+float nuiAudioDSP_RMS(const float* pBuffer, int32 SampleFrames);
+
+void nuiAudioDSP_EnableSIMD(bool Enable); ///< SIMD is used by default if available, disable it to compare with the scalar code.
+bool nuiAudioDSP_IsSIMDEnabled();
+
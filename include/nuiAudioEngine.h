@@ -12,14 +12,18 @@
 #include "nuiAudioDevice.h"
 #include "nuiAudioDecoder.h"
 #include "nglRingBuffer.h"
+#include "nglSPSCRing.h"
 
 #include "nuiSound.h"
+#include "nuiSampleWriter.h"
 
 
 
 class nuiVoice;
 class nuiAudioDevice;
 
+#define NUI_AUDIOENGINE_CHANNELS 2
+
 class nuiAudioEngine : public nuiObject
 {
 public:
@@ -33,7 +37,7 @@ public:
     eStereo
   };
   
-  nuiAudioEngine(double SampleRate, int32 BufferSize, ChannelConfig inputConfig = eNone);
+  nuiAudioEngine(double SampleRate, int32 BufferSize, ChannelConfig inputConfig = eNone, uint32 MaxVoices = 1024, bool Offline = false); ///< An offline engine doesn't open any audio device: it only produces samples when Render is called.
   virtual ~nuiAudioEngine();
   
   double GetSampleRate() const;
@@ -56,6 +60,13 @@ public:
   nuiVoice* PlaySound(nuiSound* pSound);
   void StopSound(nuiVoice* pnuiVoice);
   
+  uint32 GetMaxVoices() const; ///< Maximum number of voices that can play at the same time. Voices started above that limit are dropped.
+  uint32 GetDroppedVoices() const; ///< Number of voices that were dropped because the voice table or the command fifo was full.
+  uint32 GetVoiceCount() const; ///< Number of voices in the voice table of the audio thread (only exact from that thread or when rendering offline).
+  float GetOutputPeak(int32 Channel) const; ///< Peak level of the last buffer sent to the output device.
+  float GetOutputRMS(int32 Channel) const; ///< RMS level of the last buffer sent to the output device.
+  void ReleaseStoppedVoices(); ///< Release the voices the audio thread is done with. This is done by PlaySound and StopSound, call it if you don't start or stop sounds for a long time.
+  
   float GetGain();
   void SetGain(float gain);
   float GetGainDb();
@@ -71,6 +82,15 @@ public:
   void Play();
   void Pause();
   
+  // Offline rendering: pull the voices as fast as the CPU allows instead of waiting for an output device. Only valid on an offline engine.
+  bool IsOffline() const;
+  void SetRenderThreads(uint32 Threads); ///< Split the voices across this many threads of nuiTaskPool::GetDefault() and sum the results (0 = one per worker). The summing order is fixed so a given thread count always renders the same samples. Defaults to 1.
+  uint32 GetRenderThreads() const;
+  void Render(const std::vector<float*>& rOutput, int32 SampleFrames); ///< Render the next SampleFrames frames to de-interleaved stereo buffers, exactly like an output device callback would.
+  int64 Render(nuiSampleWriter& rWriter, int64 SampleFrames); ///< Render SampleFrames frames (or until no voice is left if SampleFrames < 0) to rWriter as interleaved floats. WriteInfo must have been called, Finalize is left to the caller. Returns the number of frames written.
+  int64 RenderToFile(const nglPath& rPath, int64 SampleFrames, int32 BitsPerSample = 24); ///< Render to a stereo wave file (16, 24 or 32 bits float). Returns the number of frames written, -1 on error.
+  int64 GetRenderedFrames() const;
+  
     
 protected:
   void ProcessAudioOutput(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, int32 SampleFrames);
@@ -81,6 +101,33 @@ protected:
 
   void InitAttributes();
   
+  class VoiceCommand
+  {
+  public:
+    enum Type
+    {
+      eAdd,
+      eRemove
+    };
+    
+    VoiceCommand(Type type = eAdd, nuiVoice* pVoice = NULL)
+    : mType(type), mpVoice(pVoice)
+    {
+    }
+    
+    Type mType;
+    nuiVoice* mpVoice;
+  };
+  
+  bool PostVoiceCommand(VoiceCommand::Type type, nuiVoice* pVoice);
+  
+  // Audio thread only:
+  void ProcessVoiceCommands();
+  void AddVoice(nuiVoice* pVoice);
+  bool RemoveVoice(nuiVoice* pVoice);
+  void Mix(const std::vector<float*>& rOutput, int32 Offset, int32 SampleFrames);
+  void MixVoices(uint32 Group, uint32 Groups, int32 SampleFrames);
+  
   double mSampleRate;
   int32 mBufferSize;
 
@@ -98,9 +145,22 @@ protected:
   nuiAudioEngine::InputDelegate mInputDelegate;
   nuiAudioEngine::OutputDelegate mOutputDelegate;
   
-  nglCriticalSection mCs;
+  nglCriticalSection mCs; ///< Serializes the threads that post voice commands. Never taken by the audio thread.
 
-  std::vector<nuiVoice*> mVoices;
-  std::vector<nuiVoice*> mAddVoicesQueue;
-  std::vector<nuiVoice*> mRemoveVoicesQueue;
+  nglSPSCRing<VoiceCommand> mVoiceCommands; ///< Voices to add or remove, consumed by the audio thread.
+  nglSPSCRing<nuiVoice*> mReleasedVoices; ///< Voices the audio thread is done with, released by ReleaseStoppedVoices.
+  std::vector<nuiVoice*> mVoices; ///< Dense table of the playing voices, preallocated to MaxVoices. Each voice knows its slot (nuiVoice::mEngineSlot).
+  uint32 mVoiceCount;
+  std::atomic<uint32> mDroppedVoices;
+  
+  std::vector<float> mMixData; ///< Preallocated mix buffers, mBufferSize frames per output channel.
+  std::vector<float*> mMixBuffers;
+  std::atomic<float> mOutputPeak[NUI_AUDIOENGINE_CHANNELS];
+  std::atomic<float> mOutputRMS[NUI_AUDIOENGINE_CHANNELS];
+  
+  bool mOffline;
+  uint32 mRenderThreads;
+  int64 mRenderedFrames;
+  std::vector<float> mGroupData; ///< Buses of the render threads but the first one, see SetRenderThreads.
+  std::vector<std::vector<float*> > mGroupBus;
 };
@@ -0,0 +1,90 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#ifndef __nuiBatchPainter_h__
+#define __nuiBatchPainter_h__
+
+#include "nuiPainter.h"
+
+/// Sits in front of another painter (nuiGLPainter, nuiGL2Painter, nuiSoftwarePainter...) and merges the consecutive
+/// render arrays that share the same render state, clip rect and vertex format into one array that is sent with a single
+/// DrawArray. The vertices are transformed by their matrix when they are merged, so the batch is drawn with the identity.
+/// Strips, fans and quads become triangles, line strips and loops become lines.
+///
+/// Indexed, 3D, custom stream and debug arrays as well as arrays drawn with a shader state are always forwarded
+/// as they are. A batch of one array is also sent untouched.
+///
+/// GetRenderOperations() counts the arrays received, GetBatches() the draws sent to the target.
+class nuiBatchPainter : public nuiPainter
+{
+public:
+  nuiBatchPainter(nuiPainter* pTarget, nglContext* pContext = NULL); ///< The target painter is deleted with the batch painter.
+  virtual ~nuiBatchPainter();
+
+  nuiPainter* GetTarget() const;
+
+  void SetBatching(bool Set); ///< When false every array is forwarded as soon as it is received. True by default.
+  bool GetBatching() const;
+  void SetMaxBatchSize(uint32 Vertices); ///< A batch is sent when it reaches this many vertices (4096 by default). Bigger arrays are forwarded as they are.
+  uint32 GetMaxBatchSize() const;
+
+  void Flush(); ///< Send the pending batch to the target.
+
+  virtual void SetSize(uint32 sizex, uint32 sizey);
+  virtual void StartRendering();
+  virtual void BeginSession();
+  virtual void EndSession();
+
+  virtual void SetState(const nuiRenderState& rState, bool ForceApply = false);
+  virtual void DrawArray(nuiRenderArray* pArray);
+  virtual bool DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality);
+  virtual void Clear(bool color, bool depth, bool stencil);
+
+  virtual void LoadProjectionMatrix(const nuiRect& rViewport, const nuiMatrix& rMatrix);
+  virtual void MultProjectionMatrix(const nuiMatrix& rMatrix);
+  virtual void PushProjectionMatrix();
+  virtual void PopProjectionMatrix();
+
+  virtual uint32 GetRectangleTextureSupport() const;
+  virtual void AddBreakPoint();
+
+  virtual void SetSurface(nuiSurface* pSurface);
+  virtual nuiSurface* GetSurface() const;
+
+  virtual void DestroySurface(nuiSurface* pSurface);
+  virtual void DestroyRenderArray(nuiRenderArray* pArray);
+
+protected:
+  virtual void DestroyTexture(nuiTexture* pTexture);
+
+  bool CanBatch(const nuiRenderArray* pArray, GLenum& rMode) const;
+  bool IsCompatible(const nuiRenderArray* pArray, GLenum Mode) const;
+  void AddToBatch(const nuiRenderArray* pArray, const nuiMatrix& rMatrix);
+  void Forward(nuiRenderArray* pArray, const nuiRenderState& rState, const nuiMatrix& rMatrix, const nuiClipper& rClip);
+  void SyncTarget(const nuiRenderState& rState, const nuiMatrix& rMatrix, const nuiClipper& rClip);
+
+  nuiPainter* mpTarget;
+  bool mBatching;
+  uint32 mMaxBatchSize;
+
+  // The pending batch:
+  nuiRenderArray* mpFirstArray; ///< Kept as is until a second array can be merged with it.
+  nuiMatrix mFirstMatrix;
+  nuiRenderArray* mpBatch; ///< Transformed vertices of all the arrays of the batch, NULL while there is only mpFirstArray.
+  nuiRenderState mBatchState;
+  nuiClipper mBatchClip;
+  GLenum mBatchMode; ///< GL_TRIANGLES, GL_LINES or GL_POINTS.
+  bool mBatchColors;
+  bool mBatchTexCoords;
+  bool mBatchShape;
+  nuiRenderArray::VertexFormat mBatchFormat;
+  uint32 mBatchSize;
+
+  std::vector<nuiRenderArray::Vertex> mScratchVertices; ///< Transformed vertices of the array being merged, see AddToBatch.
+};
+
+#endif // __nuiBatchPainter_h__
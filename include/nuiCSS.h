@@ -76,6 +76,7 @@ public:
   virtual void ApplyAction(nuiObject* pObject);
 
   uint32 GetMatchersTag() const;
+  nuiWidgetMatcher* GetIndexMatcher() const; ///< The right-most class or name matcher that tests the widget itself (a name matcher if there are both), NULL if there is none.
 private:
   std::vector<nuiWidgetMatcher*> mMatchers;
 
@@ -169,8 +170,17 @@ public:
   uint32 GetRulesCount() const;
   const std::vector<nuiCSSRule*> GetRules() const;
 private:
+  const std::vector<nuiCSSRule*>& GetCandidateRules(nuiWidget* pWidget); ///< The rules that can match pWidget according to its class and name, in declaration order.
 
   std::vector<nuiCSSRule*> mRules;
   nglString mErrorString;
 
+  // Rule index: a rule can only match the widgets that pass its index matcher (see nuiCSSRule::GetIndexMatcher), so only
+  // the buckets of the widget's name and classes and the joker bucket (rules without an index matcher) need to be tried.
+  std::map<int32, std::vector<uint32> > mClassRules;
+  std::map<nglString, std::vector<uint32> > mNameRules;
+  std::vector<uint32> mJokerRules;
+  std::map<std::pair<int32, nglString>, std::vector<nuiCSSRule*> > mCandidates; ///< Candidate rules per class and indexed name, the widgets keep a pointer to their list.
+  uint32 mGeneration; ///< Changes whenever the rules change so that the widgets drop their cached candidates.
+
 };
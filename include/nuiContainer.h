@@ -115,6 +115,7 @@ public:
   //@{
   virtual void InvalidateChildren(bool Recurse);
   virtual void SilentInvalidateChildren(bool Recurse);
+  virtual uint32 DumpRenderCacheMemory(uint32 Depth = 0);
   virtual bool Draw(nuiDrawContext* pContext);
   virtual nuiRect CalcIdealSize();
   virtual bool SetRect(const nuiRect& rRect);
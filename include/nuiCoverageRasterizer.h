@@ -0,0 +1,85 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nui.h"
+#include "nuiShape.h"
+
+class nuiPath;
+
+/// Anti-aliased polygon scan converter: each edge adds its exact signed area to the pixel cells it crosses, then a sweep
+/// of each row turns the accumulated winding into coverage with the even-odd or non-zero rule. Only the cells touched by
+/// an edge are stored, the pixels between them are output as runs, so the cost follows the outline and not the area.
+/// The coverage is exact except in the pixels where edges cross each other, where it is approximated.
+///
+/// Usage: Reset with the clip rect, add the edges in pixel coordinates, Sweep, then read the spans row by row.
+class nuiCoverageRasterizer
+{
+public:
+  nuiCoverageRasterizer();
+  virtual ~nuiCoverageRasterizer();
+
+  void Reset(int32 X0, int32 Y0, int32 X1, int32 Y1); ///< Forget the previous edges and spans and clip to this rect (in pixels).
+  void AddLine(float X0, float Y0, float X1, float Y1);
+  void AddPath(const nuiPath& rPath, const nuiMatrix& rMatrix); ///< Add the contours of rPath (separated by nuiPointTypeStop points), each one is closed.
+  bool Sweep(nuiShape::Winding Rule); ///< Compute the spans. Only eOdd and eNonZero are supported, returns false for the other rules.
+
+  /// A run of pixels of a row: fully covered if mOffset is -1, else mCount coverage values start at GetCoverage()[mOffset].
+  class Span
+  {
+  public:
+    Span(int32 X, int32 Count, int32 Offset)
+    : mX(X), mCount(Count), mOffset(Offset)
+    {
+    }
+
+    int32 mX;
+    int32 mCount;
+    int32 mOffset;
+  };
+
+  bool IsEmpty() const;
+  void GetBounds(int32& rX0, int32& rY0, int32& rX1, int32& rY1) const; ///< Pixels covered by the spans.
+  const Span* GetSpans(int32 Y, int32& rCount) const; ///< Spans of row Y, sorted from left to right.
+  const uint8* GetCoverage() const;
+
+protected:
+  class Cell
+  {
+  public:
+    Cell(int32 X, float Cover, float Area)
+    : mX(X), mCover(Cover), mArea(Area)
+    {
+    }
+
+    bool operator<(const Cell& rCell) const
+    {
+      return mX < rCell.mX;
+    }
+
+    int32 mX;
+    float mCover; ///< Signed height of the edges crossing this cell, carried to all the pixels on its right.
+    float mArea; ///< Signed part of this pixel on the right of the edges.
+  };
+
+  void AddClippedLine(float X0, float Y0, float X1, float Y1);
+  void AddRowSegment(int32 Row, float X0, float Y0, float X1, float Y1, float Direction);
+  void AddCell(int32 Row, int32 X, float Cover, float Area);
+  uint8 GetCoverage(float Winding, nuiShape::Winding Rule) const;
+  void AddPixel(int32 X, uint8 Coverage);
+  void AddRun(int32 X0, int32 X1, uint8 Coverage);
+
+  int32 mClipX0, mClipY0, mClipX1, mClipY1;
+  int32 mMinRow, mMaxRow; ///< Rows of mCells that contain cells.
+  std::vector<std::vector<Cell> > mCells; ///< One list per row of the clip rect.
+
+  std::vector<Span> mSpans;
+  std::vector<int32> mRows; ///< Index of the first span of each row in mSpans, plus the end of the last row.
+  std::vector<uint8> mCoverage;
+  int32 mX0, mY0, mX1, mY1;
+};
@@ -67,6 +67,7 @@ public:
   void BeginSession();
   void EndSession();
   void StopRendering();
+  static uint32 GetFrame(); ///< Counts the StartRendering calls of all the draw contexts
   //@}
 
   void EnableColorBuffer(bool set);
@@ -187,7 +188,8 @@ public:
   void DrawGradient(const nuiGradient& rGradient, const nuiRect& rEnclosingRect, const nuiVector2& rP1, const nuiVector2& rP2);
   void DrawGradient(const nuiGradient& rGradient, const nuiRect& rEnclosingRect, nuiSize x1, nuiSize y1, nuiSize x2, nuiSize y2);
   void DrawArray(nuiRenderArray* pArray);
-  void DrawObject(const nuiRenderObject& rObject);
+  void DrawObject(const nuiRenderObject& rObject); ///< Each array gives one of its references to the painter, like with DrawArray.
+  void DrawSharedObject(const nuiRenderObject& rObject); ///< The arrays are acquired for the painter, rObject can be drawn again.
   //@}
 
   int GetWidth() const;
@@ -223,6 +225,7 @@ protected:
   
   nuiSize mWidth,mHeight;
   bool mDebug : 1;
+  static uint32 mFrame;
 
 #ifndef CALLBACK 
   #define CALLBACK 
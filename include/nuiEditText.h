@@ -240,8 +240,11 @@ protected:
 
     void Layout();
     void InvalidateLayout();
+    static void Layout(const std::vector<TextBlock*>& rpBlocks); ///< Lay out the blocks whose layout is invalid, their paragraphs are shaped together on the default task pool
 
   protected:
+    void UpdateIdealRect();
+
     uint mBegin;
     uint mEnd;
     nuiTextLayout* mpLayout;
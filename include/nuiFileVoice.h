@@ -9,12 +9,15 @@
 #include "nui.h"
 #include "nuiSampleReader.h"
 #include "nuiFileSound.h"
+#include "nglSPSCRing.h"
 
+class nuiFileVoiceLoader;
 
 class nuiFileVoice : public nuiVoice
 {
 public:
   friend class nuiFileSound;
+  friend class nuiFileVoiceLoader;
   
   nuiFileVoice(const nuiFileVoice& rVoice);
   nuiFileVoice& operator=(const nuiFileVoice& rVoice);
@@ -23,6 +26,19 @@ public:
   virtual int32 GetChannels() const;
   
   int32 GetSampleFrames() const;
+  virtual double GetSampleRate() const;
+  
+  /// In streaming mode the file is decoded ahead of the play position by a shared loader thread, the audio thread only reads from a per voice ring buffer.
+  /// The settings apply to the voices created afterwards. Streaming is on by default with 32768 frames of prefetch.
+  static void SetStreaming(bool Enable, int32 PrefetchFrames = 32768);
+  static bool IsStreaming();
+  static int32 GetPrefetchFrames();
+  static void ReleaseLoader(); ///< Stop the loader thread (called by nuiUninit).
+  
+  bool IsStreamingVoice() const; ///< Return true if this voice reads through the loader thread.
+  virtual void SetOffline(bool Offline); ///< An offline voice decodes in ReadSamples, the loader can't keep up with an offline render.
+  uint32 GetUnderruns() const; ///< Number of times the audio thread didn't find the decoded data it needed.
+  uint32 GetSeeks() const; ///< Number of times the play position jumped. The silence played while the loader catches up with a seek is not counted as underruns.
   
 protected:
   virtual int32 ReadSamples(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames);
@@ -32,10 +48,34 @@ private:
   virtual ~nuiFileVoice();
   
   bool Init();
+  void Clear();
+  
+  // Streaming:
+  void InitStreaming(int32 PrefetchFrames);
+  void ClearStreaming();
+  int32 ReadStream(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames); ///< Audio thread side.
+  void RequestSeek(int64 position); ///< Audio thread side.
+  bool FillStream(); ///< Loader side. Returns true if some data was decoded.
+  uint32 GetStreamReadable() const;
   
   nuiFileSound* mpFileSound;
+  bool mOffline;
   
   nglIStream* mpStream;
   nuiSampleReader* mpReader;
   nuiSampleInfo mInfo;
+  std::vector<void*> mReadPointers;
+  
+  std::vector<nglSPSCRing<float>*> mStreamRings; ///< One ring per channel, empty if the voice is not streaming.
+  int64 mStreamPosition; ///< Audio thread: file position of the next frame in the rings.
+  int64 mLoaderPosition; ///< Loader: file position of the next frame to decode.
+  std::atomic<int64> mSeekPosition;
+  std::atomic<uint32> mSeekGeneration; ///< Bumped by the audio thread each time it needs the loader to restart from mSeekPosition.
+  std::atomic<uint32> mSeekAck; ///< Last generation handled by the loader. The rings only contain valid data when it equals mSeekGeneration.
+  int64 mPlayPosition; ///< Audio thread: position of the next frame if the voice plays on.
+  bool mSeeking; ///< Audio thread: the loader has not caught up with the last seek yet.
+  std::atomic<uint32> mUnderruns;
+  std::atomic<uint32> mSeeks;
+  std::vector<float> mDecodeData;
+  std::vector<void*> mDecodePointers;
 };
\ No newline at end of file
@@ -19,6 +19,7 @@ class nuiFont;
 class nuiTextLayout;
 class nuiTextLine;
 #include "nuiTextRun.h"
+#include "nuiTaskPool.h"
 class nuiRenderArray;
 
 //! Font units
@@ -45,6 +46,7 @@ public:
   
   const nglPath& GetPath() const;
   bool CheckPath();
+  double GetLastMod() const; ///< Modification time of the font file when it was scanned.
   const nglString& GetName() const;
   const nglString& GetStyle() const;
   
@@ -63,6 +65,9 @@ public:
   
   const nuiFontPanoseBytes& GetPanoseBytes() const; 
   
+  typedef std::pair<nglUChar, nglUChar> GlyphRange;
+  const std::vector<GlyphRange>& GetGlyphRanges() const; ///< Sorted, disjoint ranges of the code points covered by the font.
+  
   bool IsValid() const;
   
   bool Save(nglOStream& rStream);
@@ -74,13 +79,13 @@ private:
   nglString mName;
   nglString mStyle;
   int32     mFace;
+  double    mLastMod;
   
   bool mBold;
   bool mItalic;
   bool mMonospace;
   bool mScalable;
   std::set<nglTextEncoding> mEncodings;
-  typedef std::pair<nglUChar, nglUChar> GlyphRange;
   std::vector<GlyphRange> mGlyphs;
   std::set<int32> mSizes;
   
@@ -171,8 +176,10 @@ public:
   
   static const RenderMode AntiAliasing;  ///< Use anti-aliasing. See SetRenderMode()
   static const RenderMode Hinting;       ///< Interpret font hints. See SetRenderMode()
+  static const RenderMode DistanceField; ///< Draw the glyphs from a signed distance field shared by all the sizes of the face. See SetRenderMode()
   
   static float DefaultPixelSize;  ///< Default size (in pixels) for scalable fonts
+  static RenderMode DefaultRenderMode;  ///< Render mode of the scalable fonts when they are loaded (AntiAliasing | Hinting by default)
   
   /** @name Life cycle */
   //@{
@@ -394,6 +401,13 @@ public:
    the renderer keep some font features consistant, such as stem width or spacing,
    serif control, and so on. These hints are especially important (and well tuned)
    for small sizes like 10-20 pixels. \e Hinting is turned on as a default.
+   
+   \a DistanceField doesn't render a bitmap per glyph and size: all the fonts of a face
+   share one atlas of signed distance fields generated from the outlines at a single size,
+   and the painters turn the distances into coverage at the scale the text is drawn
+   (nuiGL2Painter with a shader, nuiSoftwarePainter on the CPU). Use it for text that is
+   zoomed or drawn at many sizes. Small text looks sharper with regular bitmaps, and the
+   glyphs of the atlas are never hinted.
    */
   //@}
   
@@ -440,6 +454,32 @@ public:
   void Print(nuiDrawContext *pContext, float X, float Y, const nglString& rText, bool AlignGlyphPixels = true);
   
   bool PrepareGlyph(float X, float Y, nuiTextGlyph& rGlyph);
+  void RasterizeGlyphs(const std::vector<int>& rIndices, nuiTaskPool& rPool = nuiTaskPool::GetDefault());
+  /*!< Render the glyphs of rIndices that are not in the font textures yet
+   \param rIndices glyph indices, they can appear several times
+   \param rPool the glyphs are rendered on the workers of this pool
+   
+   PrepareGlyph renders the missing glyphs one at a time on the calling thread. This method renders
+   a whole set in parallel, each worker with its own FreeType face, and then packs them in the
+   textures in one go. Small sets are left to PrepareGlyph.
+   */
+  void TrimTextures();
+  /*!< Drop the glyph textures that no glyph used since the last frame that printed with this font
+   
+   Only the first call of each frame (see nuiDrawContext::GetFrame) does something, and only when
+   there are more than NUI_FONT_MAX_TEXTURES textures: the textures of the current and last frames
+   are kept however many they are. The glyphs that were in the dropped textures are rendered again
+   the next time they are needed. The texture objects are only released, so the draws that still
+   use them stay valid. nuiTextLayout::Print calls this for the fonts of its runs before it collects
+   their glyphs.
+   */
+  void UpdateGlyphTextures(nuiTextRun* pRun);
+  /*!< Point the glyphs of pRun, placed by PrepareGlyph, to their current place in the glyph textures
+   
+   Does nothing (but mark their textures as used) if no texture was dropped by TrimTextures since
+   the glyphs were placed.
+   */
+  uint32 GetTextureGeneration() const; ///< Changes each time TrimTextures drops textures
   
   void Shape(nuiTextRun* pRun);
 protected:
@@ -462,33 +502,84 @@ private:
   {
   public:
     GlyphLocation();
-    GlyphLocation(int OffsetX, int OffsetY, int Width, int Height, int OffsetTexture);
+    GlyphLocation(int OffsetX, int OffsetY, int Width, int Height, int OffsetTexture, int Left, int Top);
     ~GlyphLocation();
 
   public:
     int mOffsetX, mOffsetY, mWidth, mHeight, mOffsetTexture;
+    int mLeft, mTop; ///< Bitmap bearings (see GlyphBitmap)
   };
 
-  typedef std::map<int, GlyphLocation> GlyphLocationLookupTable;
-  typedef std::map<int, GlyphLocation>::iterator GlyphLocationLookupTableIterator;
+  /// Glyph index to GlyphLocation map with open addressing (linear probing): PrepareGlyph looks up each glyph of each laid out text.
+  class GlyphLocationTable
+  {
+  public:
+    GlyphLocationTable();
+
+    const GlyphLocation* Find(int Index) const;
+    void Insert(int Index, const GlyphLocation& rLocation);
+    void RemapTextures(const std::vector<int>& rTextures); ///< rTextures gives the new index of each texture, the glyphs of the textures mapped to -1 are removed
+    void Clear();
+    uint32 GetSize() const;
+
+  private:
+    void Grow();
+
+    std::vector<int> mKeys; ///< -1 for the free slots
+    std::vector<GlyphLocation> mLocations;
+    uint32 mCount;
+  };
+
+  /// A row of glyphs in a texture. Glyphs go to the lowest shelf that can hold them so that the big ones don't leave holes above the small ones.
+  class Shelf
+  {
+  public:
+    Shelf(int Y, int Height);
+
+    int mY, mHeight;
+    int mX; ///< Start of the free space
+  };
+
+  class TextureShelves
+  {
+  public:
+    TextureShelves();
+
+    std::vector<Shelf> mShelves;
+    int mBottom; ///< Start of the space below the shelves
+    uint32 mLastUse; ///< Frame in which a glyph of this texture was last used
+  };
+
+  class RasterizedGlyph;
+
+  nuiFontBase(const nuiFontBase& rFont, float Size); ///< Create the distance field atlas of the face of rFont
+  nuiFontBase* AcquireDistanceFieldAtlas();
+  bool GetDistanceFieldBitmap(int Index, GlyphBitmap& rBitmap, std::vector<uint8>& rPixels);
+
+  nuiFontBase* mpDistanceFieldAtlas; ///< Holds the glyphs of this font in DistanceField mode
+  bool mIsDistanceFieldAtlas; ///< This font only renders the distance fields of the others
+
   typedef std::vector<nuiTexture *> Textures;
 
-  GlyphLocationLookupTable mGlyphLocationLookupTable;
+  GlyphLocationTable mGlyphLocationLookupTable;
   Textures mTextures;
-
-  int mCurrentX;
-  int mRowMaxWidth;
-  int mCurrentY;
-  int mCurrentTexture;
+  std::vector<TextureShelves> mTextureShelves;
+  uint32 mTrimFrame; ///< Frame of the last TrimTextures call
+  uint32 mTextureGeneration;
 
   nuiTexture *AllocateTexture(int size);
+  void AddTexture(int size);
   bool CopyBitmapToTexture(const GlyphBitmap &rBitmap, nuiTexture *pTexture, unsigned int OffsetX, unsigned int OffsetY);
 
   void Blit8BitsBitmapToTexture(const GlyphBitmap &rBitmap, nuiTexture *pTexture, unsigned int OffsetX, unsigned int OffsetY);
 
-  void GetCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation);
-  void AddCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation);
-  bool FindNextGlyphLocation(int Width, int Height, int &rOffsetX, int &rOffsetY);
+  bool GetCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation);
+  bool AddCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation);
+  void AddCacheGlyph(int Index, const GlyphBitmap& rBitmap, nuiFontBase::GlyphLocation &rGlyphLocation);
+  void FindGlyphLocation(int Width, int Height, int &rTexture, int &rOffsetX, int &rOffsetY);
+  bool FindGlyphLocation(int Texture, int Width, int Height, bool BestFit, int &rOffsetX, int &rOffsetY);
+  void SetGlyphSource(const nuiFontBase* pCache, const GlyphLocation& rLocation, nuiTextGlyph& rGlyph) const;
+  void RasterizeGlyphRange(std::vector<RasterizedGlyph>* pGlyphs, uint32 First, uint32 Last);
   void Defaults();
    
   static const int TEXTURE_SIZE;
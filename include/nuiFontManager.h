@@ -170,19 +170,46 @@ public:
   static void ExitManager();
   static nuiFontManager& LoadManager(nglIStream& rStream, double lastscantime = 0);
   
+  /// The database keeps the modification time of each file of the font folders: Load and ScanFolders only open the files
+  /// that were added or changed since it was saved. lastscantime is not used anymore.
   bool Save(nglOStream& rStream);
   bool Load(nglIStream& rStream, double lastscantime = 0);
   
   void Clear();
 private:
+  /// The faces found in a file the last time it was scanned, none if it is not a font file.
+  class ScannedFile
+  {
+  public:
+    ScannedFile();
+    
+    double mLastMod;
+    std::vector<nuiFontDesc*> mpFonts;
+  };
+  typedef std::map<nglPath, ScannedFile> ScannedFileMap;
+  
   std::map<nglString, nglPath> mFontFolders;
   std::vector<nuiFontDesc*> mpFonts;
   std::set<nglPath> mScanedFolders;
+  std::map<nglPath, double> mSkippedFiles; ///< Files of the font folders that are not fonts, with their modification time.
+  
+  // Lookup tables rebuilt by BuildIndex each time mpFonts changes, so that RequestFont doesn't have to go through all the fonts:
+  std::vector<nglString> mFamilies; ///< Lower case family names.
+  std::map<nglString, uint32> mFamilyIds;
+  std::vector<std::vector<uint32> > mFamilyFonts; ///< Fonts of each family.
+  std::vector<uint32> mFontFamilies; ///< Family of each font.
+  std::vector<std::vector<uint32> > mBlockFonts; ///< Fonts that have glyphs in each block of 256 code points.
   
   static nuiFontManager gManager;
   
   nglPath mSavePath;
-  bool ScanSubFolder(const nglPath& rPath);
+  bool ReadIndex(nglIStream& rStream, ScannedFileMap& rFiles) const;
+  uint32 ScanSubFolder(const nglPath& rPath, ScannedFileMap& rPrevious);
+  bool ScanFile(const nglPath& rPath, ScannedFileMap& rPrevious);
+  uint32 AddUnchangedFiles(ScannedFileMap& rPrevious);
+  void BuildIndex();
+  void ClearIndex();
+  bool ScoreFonts(const nuiFontRequest& rRequest, const std::vector<uint32>& rCandidates, const std::vector<bool>& rCovering, std::list<nuiFontRequestResult>& rFoundFonts) const; ///< Add the candidates that match rRequest to rFoundFonts, returns true if one of them has some of the requested glyphs
   void UpdateFonts();
 };
 
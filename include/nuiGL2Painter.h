@@ -52,6 +52,8 @@ protected:
   nuiShaderProgram* mpShader_TextureAlphaVertexColor;
   nuiShaderProgram* mpShader_TextureDifuseColor;
   nuiShaderProgram* mpShader_TextureAlphaDifuseColor;
+  nuiShaderProgram* mpShader_TextureDistanceFieldVertexColor;
+  nuiShaderProgram* mpShader_TextureDistanceFieldDifuseColor;
   nuiShaderProgram* mpShader_DifuseColor;
   nuiShaderProgram* mpShader_VertexColor;
 
@@ -24,9 +24,10 @@ public:
 
   void InitProperties();
 
-  virtual bool Draw(nuiDrawContext* pContext);
+  virtual bool Draw(nuiDrawContext* pContext); ///< Only visits the items that cross the clip rect (see GetVisibleItems).
   virtual nuiRect CalcIdealSize();
   virtual bool SetRect(const nuiRect& rRect);
+  virtual void ChildMoved(nuiWidgetPtr pChild);
 
   void SetOrientation(nuiOrientation orientation); /// Set the widget orientation.
   nuiOrientation GetOrientation(); ///< Get the widget orientation.
@@ -117,6 +118,13 @@ protected:
   
   void OnChildAdded(const nuiEvent& rEvent);
   void OnChildDeleted(const nuiEvent& rEvent);
+
+  void GetVisibleItems(nuiDrawContext* pContext, uint32& rFirst, uint32& rLast); ///< The items that can cross the clip rect of pContext are in [rFirst, rLast[
+  void UpdateItemIndex();
+  std::vector<float> mItemStarts; ///< Start of the overdraw rect of each item along the orientation of the list
+  std::vector<float> mItemEnds; ///< Farthest end of the overdraw rects of the items up to each one
+  bool mItemIndexValid; ///< Cleared each time an item is added, removed or moved
+  bool mItemIndexSorted; ///< The items are in order along the list, so the index can be searched
   
   float mMoveAnimDuration;
   nuiEasingMethod mMoveAnimEasing;
@@ -0,0 +1,105 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiNonCopyable.h"
+
+/// Intrusive link used by nuiMPSCQueue. An object can only wait in one queue at a time.
+class nuiQueueLink
+{
+public:
+  nuiQueueLink()
+  : mpNextInQueue(NULL)
+  {
+  }
+
+  nuiQueueLink(const nuiQueueLink& rLink)
+  : mpNextInQueue(NULL)
+  {
+  }
+
+  nuiQueueLink& operator=(const nuiQueueLink& rLink)
+  {
+    return *this; // The link belongs to the queue the object is in, never copy it.
+  }
+
+  std::atomic<nuiQueueLink*> mpNextInQueue;
+};
+
+/// Lock-free intrusive FIFO with many producers and one consumer (D. Vyukov's algorithm).
+/*!
+ Push is wait-free and never allocates: the link is embedded in the pushed object (T must derive from nuiQueueLink).
+ Pop must only be called by one thread at a time. It may return NULL while a producer is in the middle of a Push,
+ in which case the item becomes visible as soon as that producer returns.
+ */
+template <class T>
+class nuiMPSCQueue : nuiNonCopyable
+{
+public:
+  nuiMPSCQueue()
+  : mpHead(&mStub), mpTail(&mStub)
+  {
+  }
+
+  void Push(T* pItem)
+  {
+    PushLink(pItem);
+  }
+
+  T* Pop()
+  {
+    nuiQueueLink* pTail = mpTail;
+    nuiQueueLink* pNext = pTail->mpNextInQueue.load(std::memory_order_acquire);
+    if (pTail == &mStub)
+    {
+      if (!pNext)
+        return NULL;
+      mpTail = pNext;
+      pTail = pNext;
+      pNext = pNext->mpNextInQueue.load(std::memory_order_acquire);
+    }
+
+    if (pNext)
+    {
+      mpTail = pNext;
+      return static_cast<T*>(pTail);
+    }
+
+    if (pTail != mpHead.load(std::memory_order_seq_cst))
+      return NULL; // A producer has swapped the head but not linked its item yet.
+
+    // pTail is the last item: push the stub behind it so that it can be detached.
+    PushLink(&mStub);
+    pNext = pTail->mpNextInQueue.load(std::memory_order_acquire);
+    if (pNext)
+    {
+      mpTail = pNext;
+      return static_cast<T*>(pTail);
+    }
+    return NULL;
+  }
+
+  bool IsEmpty() const ///< Only meaningful from the consumer thread.
+  {
+    return mpTail == &mStub && mStub.mpNextInQueue.load(std::memory_order_acquire) == NULL;
+  }
+
+private:
+  void PushLink(nuiQueueLink* pLink)
+  {
+    pLink->mpNextInQueue.store(NULL, std::memory_order_relaxed);
+    nuiQueueLink* pPrev = mpHead.exchange(pLink, std::memory_order_seq_cst);
+    pPrev->mpNextInQueue.store(pLink, std::memory_order_seq_cst);
+  }
+
+  std::atomic<nuiQueueLink*> mpHead; ///< Written by the producers.
+  char mPad[NGL_CACHE_LINE_SIZE - sizeof(std::atomic<nuiQueueLink*>)];
+  nuiQueueLink* mpTail; ///< Only touched by the consumer.
+  nuiQueueLink mStub;
+};
+
@@ -152,6 +152,7 @@ public:
 
   NUI_GETSETDO(bool, DrawDirtyRects, Invalidate());
   NUI_GETSETDO(bool, DrawToSurface, Invalidate());
+  NUI_GETSETDO(bool, BatchDrawCalls, Invalidate()); ///< Merge the consecutive draws that share a render state, see nuiBatchPainter.
 
 private:
   void Register();
@@ -289,6 +290,7 @@ private:
 
   bool mDrawDirtyRects = false;
   bool mDrawToSurface = false;
+  bool mBatchDrawCalls = false;
 
   CreateDragFeedbackDelegate mCreateDragFeedbackDelegate;
 };
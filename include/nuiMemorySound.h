@@ -15,8 +15,10 @@ public:
   
   int32 GetSampleFrames() const;
   int32 GetChannels()const;
+  double GetSampleRate() const; ///< Rate of the decoded file, 0 if it couldn't be loaded.
   
   int32 ReadSamples(const std::vector<float*>& rBuffers, int64 position, int32 SampleFrames);
+  const float* GetSamples(int32 Channel) const; ///< The whole decoded channel, GetSampleFrames() frames long.
   
 protected:
   nuiMemorySound(const nglPath& rPath);
@@ -28,5 +30,6 @@ protected:
   bool LoadSamples(nglIStream* pStream = NULL);
   std::vector<float*> mSamples;
   int64 mLength;
+  double mSampleRate;
   nglPath mPath;
 };
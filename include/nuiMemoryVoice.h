@@ -20,9 +20,12 @@ public:
   virtual bool IsValid() const;
   virtual int32 GetChannels() const;
   int32 GetSampleFrames() const;
+  virtual double GetSampleRate() const;
   
 protected:
   virtual int32 ReadSamples(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames);
+  virtual bool HasDirectSamples() const;
+  virtual int32 GetDirectSamples(std::vector<const float*>& rChannels, int64 position, int32 SampleFrames);
   
 private:
   nuiMemoryVoice(nuiMemorySound* pSound = NULL);
@@ -11,19 +11,22 @@
 #include "nui.h"
 #include "nglCriticalSection.h"
 #include "nglSyncEvent.h"
+#include "nuiMPSCQueue.h"
 
 class nuiNotification;
 class nuiTask;
 
 /// implements a message queue for multi-threaded communication
 /// see nuiTest, MessageQueueWindow, for an application example
+/// Posting is lock-free (see nuiMPSCQueue) and Message must derive from nuiQueueLink, which means that a message can only be posted to one queue at a time.
+/// The consumer side is serialized so several threads may still Get from the same queue.
 template <class Message>
 class nuiProtectedQueue
 {
 public : 
 
   nuiProtectedQueue(const char* queue_name = "basic queue")
-  : mQueueCS(queue_name)
+  : mQueueCS(queue_name), mParked(0)
   {
   }
 
@@ -34,43 +37,51 @@ public :
 
   bool Post(Message* message)
   {
-    nglCriticalSectionGuard guard(mQueueCS);
     message->Acquire();
-    mQueue.push(message);
+    mQueue.Push(message);
 
-    // unlock thread waiting to read the message
-    mSyncEvent.Set ();
+    // unlock the threads waiting to read the message. Only pay for the system call if a reader is actually parked.
+    if (mParked.load(std::memory_order_seq_cst) > 0)
+      mSyncEvent.Set();
     return true;
   }
 
   // Don't forget to ->Release the message you get from this method!
   Message* Get(uint32 time)
   {
-    // wait for an incoming message
-    if (time > 0)
-      mSyncEvent.Wait(time);
-
-    mQueueCS.Lock();
-    if (mQueue.empty())
+    Message* message = Pop();
+    if (message || !time)
+      return message;
+
+    // Announce that we are going to sleep, then look again so that a message posted in between can't be missed:
+    mParked.fetch_add(1, std::memory_order_seq_cst);
+    mSyncEvent.Reset();
+    message = Pop();
+    if (!message)
     {
-      mQueueCS.Unlock();
-      return NULL;
+      // wait for an incoming message
+      mSyncEvent.Wait(time);
+      message = Pop();
     }
-    Message* message = mQueue.front();
-    mQueue.pop();
-
-    // no more messages. next call to Get will block 'til another message is posted.
-    if (mQueue.empty())
-      mSyncEvent.Reset();
-    mQueueCS.Unlock();
-    
+
+    // Our Reset may have cleared the Set of a message that is still waiting for another parked reader, wake them up again:
+    if (mParked.fetch_sub(1, std::memory_order_seq_cst) > 1 && message)
+      mSyncEvent.Set();
+
     return message;
   }
 
 private : 
 
-  nglCriticalSection mQueueCS;
-  std::queue<Message*> mQueue;
+  Message* Pop()
+  {
+    nglCriticalSectionGuard guard(mQueueCS);
+    return mQueue.Pop();
+  }
+
+  nglCriticalSection mQueueCS; ///< Only serializes the readers, writers never take it.
+  nuiMPSCQueue<Message> mQueue;
+  std::atomic<int32> mParked; ///< Number of readers waiting in Get
   nglSyncEvent mSyncEvent;
 };
 
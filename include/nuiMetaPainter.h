@@ -17,7 +17,13 @@ class nuiDrawContext;
 
 typedef std::vector<uint8> nuiRenderCache;
 
-// 
+/// Records the rendering operations of a widget so that they can be replayed without calling its Draw method again.
+/*!
+ The operations are stored in a byte stream: a one byte opcode followed by its parameters. Pure translations are stored as three
+ floats instead of a whole matrix. Render states are kept aside and identical states are stored only once. The children of the
+ recorded widget are stored as references (see DrawChild) and are drawn at their current position on replay, so moving a child
+ doesn't require recording its parent again (see nuiWidget::EnablePartialRenderCache).
+ */
 class nuiMetaPainter : public nuiPainter
 {
 public:
@@ -47,7 +53,7 @@ public:
   virtual void EnableClipping(bool set);
 //  virtual bool GetClipRect(nuiRect& rRect, bool LocalRect);
   
-  void DrawChild(nuiDrawContext* pContext, nuiWidget* pChild);
+  void DrawChild(nuiDrawContext* pContext, nuiWidget* pChild); ///< Store a reference to pChild. Unless the children are drawn immediately, the caller must not have translated the context to the position of the child.
 
   /** @name Render operation storage management */
   //@{
@@ -75,6 +81,10 @@ public:
   void SetDrawChildrenImmediat(bool set);
   bool GetDrawChildrenImmediat() const;
 
+  uint32 GetMemoryUsage(bool IncludeArrays = false) const; ///< Bytes used by the recorded operations. If IncludeArrays is true the vertices of the recorded render arrays are counted too, even if they are shared with other caches.
+  int32 GetNbRenderStates() const; ///< Number of distinct render states stored.
+  int32 GetNbSharedRenderStates() const; ///< Number of SetState operations that reused a render state that was already stored.
+
   virtual void DestroySurface(nuiSurface* pSurface);
   virtual void DestroyRenderArray(nuiRenderArray* pArray);
 
@@ -108,6 +118,7 @@ protected:
     eEnableClipping,
 
     eDrawChild,
+    eTranslate,
     
     eBreak
   };
@@ -136,14 +147,15 @@ protected:
   bool mLastStateValid;
 
   int32 mNbDrawChild;
+  int32 mNbSharedStates;
   int32 mNbDrawArray;
   int32 mNbClearColor;
-  mutable int32 mOperationPos;
+  mutable size_t mOperationPos;
   int32 mNbOperations;
     
   nglString mName;
   mutable std::vector<int32> mOperationIndices;
-  mutable int32 mLastSize;
+  mutable size_t mLastSize; ///< Size of mOperations when mOperationIndices was built, (size_t)-1 when it has to be rebuilt.
   void UpdateIndices() const;
   bool mDrawChildrenImmediat;
   
@@ -13,7 +13,7 @@
 
 class nuiNotificationManager;
 
-class nuiNotification : public nuiObject
+class nuiNotification : public nuiObject, public nuiQueueLink
 {
 public:
   nuiNotification(const nglString& rName);
@@ -61,6 +61,7 @@ public:
   static int32 GetClassNameIndex(const nglString& rName);
   static const nglString& GetClassNameFromIndex(int32 index);
   static int32 GetClassCount();
+  static int32 GetParentClassIndex(int32 ClassIndex); ///< -1 if the class has no parent.
   //@}
   
   /** @name Properties system */
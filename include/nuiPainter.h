@@ -77,6 +77,7 @@ public:
 
   virtual void SetState(const nuiRenderState& rState, bool ForceApply = false) = 0;
   virtual void DrawArray(nuiRenderArray* pArray) = 0;
+  virtual bool DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality); ///< Draw the shape without tessellating it with the current state. Returns false if the painter can't, which is the default.
   virtual void Clear(bool color, bool depth, bool stencil) = 0;
 
   virtual void LoadMatrix(const nuiMatrix& rMatrix);
@@ -8,6 +8,34 @@
 #pragma once
 
 #include "nui.h"
+#include "nuiSpanKernels.h"
+
+// Each blender combines one pixel (Blend) or a whole span (FillSpan with one color, BlendSpan with a color per pixel).
+// The spans of the common blenders go to the nuiSpanKernels picked for this CPU.
+// BlendCoverage draws one color with a coverage per pixel (0 to 255), for the edges of anti-aliased shapes.
+
+// Map a coverage in [0, 255] to a weight in [0, 256].
+static inline uint32 nuiCoverageWeight(uint32 coverage)
+{
+  return coverage + (coverage >> 7);
+}
+
+// Multiply the alpha of color by coverage.
+static inline uint32 nuiCoverageAlpha(uint32 color, uint32 coverage)
+{
+  uint8& a(((uint8*)&color)[NUI_RGBA_ENDIANSAFE_A]);
+  a = (uint8)((a * nuiCoverageWeight(coverage)) >> 8);
+  return color;
+}
+
+// Per channel (d * (256 - ti) + s * ti) >> 8, two channels at a time. ti is in [0, 256], the products can't carry into the next channel.
+static inline uint32 lerpRGBA(const uint32 d, const uint32 s, uint32 ti)
+{
+  const uint32 di = 256 - ti;
+  const uint32 ga = ((((d & 0xFF00FF) * di) + ((s & 0xFF00FF) * ti)) >> 8) & 0x00FF00FF;
+  const uint32 rb = ((((d >> 8) & 0xFF00FF) * di) + (((s >> 8) & 0xFF00FF) * ti)) & 0xFF00FF00;
+  return ga | rb;
+}
 
 class nuiPixelBlender_Copy
 {
@@ -21,6 +49,23 @@ public:
   {
     return true;
   }
+
+  static void FillSpan(uint32* pDest, uint32 src_color, int32 count)
+  {
+    nuiSpan_GetKernels().Fill(pDest, src_color, count);
+  }
+
+  static void BlendSpan(uint32* pDest, const uint32* pSrc, int32 count)
+  {
+    memcpy(pDest, pSrc, count * sizeof(uint32));
+  }
+
+  // There is no blending: the partially covered pixels are a mix of the destination and the color, alpha included.
+  static void BlendCoverage(uint32* pDest, uint32 src_color, const uint8* pCoverage, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      pDest[i] = lerpRGBA(pDest[i], src_color, nuiCoverageWeight(pCoverage[i]));
+  }
 };
 
 class nuiPixelBlender_Add32
@@ -35,45 +80,25 @@ public:
   {
     return false;
   }
-};
 
-#if 0
-static uint32 lerpRGBA(const uint32 d, const uint32 s, uint32 ti)
-{
-  uint32 dstga = d      & 0xFF00FF;
-  uint32 dstrb = d >> 8 & 0xFF00FF;
-  
-  uint32 srcga = s      & 0xFF00FF;
-  uint32 srcrb = s >> 8 & 0xFF00FF;
-  
-  uint32 dga = srcga - dstga;
-  uint32 drb = srcrb - dstrb;
-  
-  dga = (dga * ti) >> 8;  
-  drb = (drb * ti) >> 8;  
-  
-  const uint32 ga  = (dga + dstga)      & 0x00FF00FF;
-  const uint32 rb  = (drb + dstrb) << 8 & 0xFF00FF00;
-  return ga | rb;
-}
-#else
-static uint32 lerpRGBA(const uint32 d, const uint32 s, uint32 ti)
-{
-  ti--;
-  uint32 dstga = d      & 0xFF00FF;
-  uint32 dstrb = d >> 8 & 0xFF00FF;
-  
-  uint32 srcga = s      & 0xFF00FF;
-  uint32 srcrb = s >> 8 & 0xFF00FF;
-  
-  uint32 dga = (dstga * ti) >> 8;  
-  uint32 drb = (dstrb * ti) >> 8;  
-  
-  const uint32 ga  = (dga + srcga)      & 0x00FF00FF;
-  const uint32 rb  = (drb + srcrb) << 8 & 0xFF00FF00;
-  return ga | rb;
-}
-#endif
+  static void FillSpan(uint32* pDest, uint32 src_color, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], src_color);
+  }
+
+  static void BlendSpan(uint32* pDest, const uint32* pSrc, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], pSrc[i]);
+  }
+
+  static void BlendCoverage(uint32* pDest, uint32 src_color, const uint8* pCoverage, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], lerpRGBA(0, src_color, nuiCoverageWeight(pCoverage[i])));
+  }
+};
 
 class nuiPixelBlender_Transp
 {
@@ -81,18 +106,18 @@ public:
 
   static void Blend(uint32& dest_color, const uint32 src_color)
   {
-    const uint8 Sa = 255 - ((const uint8*)&src_color)[NUI_RGBA_ENDIANSAFE_A];
-    if (Sa == 0)
+    const uint8 Sa = ((const uint8*)&src_color)[NUI_RGBA_ENDIANSAFE_A];
+    if (Sa == 255)
     {
       dest_color = src_color;
       return;
     }
-    if (Sa == 255)
+    if (Sa == 0)
     {
       return;
     }
     
-    dest_color = lerpRGBA(src_color, dest_color, Sa + 1);
+    dest_color = lerpRGBA(dest_color, src_color, Sa + 1);
   }
 
   
@@ -100,6 +125,21 @@ public:
   {
     return false;
   }
+
+  static void FillSpan(uint32* pDest, uint32 src_color, int32 count)
+  {
+    nuiSpan_GetKernels().FillTransp(pDest, src_color, count);
+  }
+
+  static void BlendSpan(uint32* pDest, const uint32* pSrc, int32 count)
+  {
+    nuiSpan_GetKernels().BlendTransp(pDest, pSrc, count);
+  }
+  static void BlendCoverage(uint32* pDest, uint32 src_color, const uint8* pCoverage, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], nuiCoverageAlpha(src_color, pCoverage[i]));
+  }
 };
 
 class nuiPixelBlender_TranspAdd
@@ -139,6 +179,21 @@ public:
   {
     return false;
   }
+
+  static void FillSpan(uint32* pDest, uint32 src_color, int32 count)
+  {
+    nuiSpan_GetKernels().FillTranspAdd(pDest, src_color, count);
+  }
+
+  static void BlendSpan(uint32* pDest, const uint32* pSrc, int32 count)
+  {
+    nuiSpan_GetKernels().BlendTranspAdd(pDest, pSrc, count);
+  }
+  static void BlendCoverage(uint32* pDest, uint32 src_color, const uint8* pCoverage, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], nuiCoverageAlpha(src_color, pCoverage[i]));
+  }
 };
 
 class nuiPixelBlender_Add
@@ -168,5 +223,23 @@ public:
   {
     return false;
   }
+
+  static void FillSpan(uint32* pDest, uint32 src_color, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], src_color);
+  }
+
+  static void BlendSpan(uint32* pDest, const uint32* pSrc, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], pSrc[i]);
+  }
+
+  static void BlendCoverage(uint32* pDest, uint32 src_color, const uint8* pCoverage, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+      Blend(pDest[i], lerpRGBA(0, src_color, nuiCoverageWeight(pCoverage[i])));
+  }
 };
 
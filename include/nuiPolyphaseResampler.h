@@ -0,0 +1,68 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nui.h"
+
+class nuiPolyphaseFilter;
+
+/// Band-limited sample rate converter for streams of de-interleaved float channels: a Kaiser windowed sinc stored as a
+/// table of polyphase branches, interpolated linearly between branches so any ratio works. When downsampling, the cutoff
+/// follows the output Nyquist frequency. The tables are shared by all the resamplers that use the same settings.
+///
+/// Usage (pull model): ask GetInputFramesNeeded how much input is required to produce N output frames, Push that input
+/// (in as many chunks as needed) then Pull the N frames. After Prepare, Push and Pull never allocate.
+class nuiPolyphaseResampler
+{
+public:
+  enum Quality
+  {
+    eFast = 0, ///< 8 taps, ~50 dB of stop band attenuation. For many voices or previews.
+    eNormal,   ///< 24 taps, ~80 dB.
+    eBest      ///< 64 taps, ~110 dB. For offline rendering.
+  };
+
+  nuiPolyphaseResampler(int32 Channels, double InputRate, double OutputRate, Quality quality = eNormal);
+  virtual ~nuiPolyphaseResampler();
+
+  int32 GetChannels() const;
+  double GetInputRate() const;
+  double GetOutputRate() const;
+  Quality GetQuality() const;
+  void SetRates(double InputRate, double OutputRate); ///< Change the ratio. The stream continues without a click (the filter is replaced if the cutoff changes). May allocate.
+  void SetQuality(Quality quality); ///< May allocate, resets the stream.
+
+  void Prepare(int32 MaxOutputFrames); ///< Size the history for blocks of up to MaxOutputFrames output frames.
+  void Reset(); ///< Forget the past input, for example after a seek.
+  int32 GetLatency() const; ///< Number of input frames the filter needs ahead of the current position.
+
+  int32 GetInputFramesNeeded(int32 OutputFrames) const; ///< Input frames to push before OutputFrames frames can be pulled.
+  void Push(const std::vector<const float*>& rInput, int32 Frames);
+  void PushSilence(int32 Frames);
+  int32 Pull(const std::vector<float*>& rOutput, int32 Frames); ///< Returns the number of frames produced, less than Frames if not enough input was pushed.
+
+  static const char* GetQualityName(Quality quality);
+
+protected:
+  void SetFilter();
+  void Compact();
+  void Reserve(int32 Frames);
+
+  int32 mChannels;
+  double mInputRate;
+  double mOutputRate;
+  Quality mQuality;
+  const nuiPolyphaseFilter* mpFilter;
+
+  uint64 mStep; ///< Input frames per output frame, 32.32 fixed point so that the position never drifts.
+  int64 mPosition; ///< Integer part of the position of the next output frame in mHistory.
+  uint32 mFraction; ///< Fractional part of the position.
+
+  std::vector<std::vector<float> > mHistory; ///< Input frames per channel, the filter window starts at mPosition - GetLatency() + 1.
+  int32 mFrames; ///< Number of valid frames in mHistory.
+};
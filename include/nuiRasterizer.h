@@ -9,6 +9,7 @@
 #pragma once
 
 #include "nui.h"
+#include "nuiCoverageRasterizer.h"
 
 class nuiRasterizer
 {
@@ -171,6 +172,8 @@ private:
     ClipSegmentX(v0, v1, incr);
     
     int32 y = v0.CeiledY();
+    if (y < ToBelow(mClipY0) || y >= ToBelow(mClipY1)) // Line sections can end one row past the clip rect
+      return;
     int32 x = ToAbove(v0.X());
     int32 end = ToAbove(v1.X());
 
@@ -180,7 +183,7 @@ private:
     
     uint32* pBuffer = mpBuffer + (y * mWidth + x);
 
-    incr.DrawHLine<PixelBlender>(pBuffer, v0, width);
+    incr.template DrawHLine<PixelBlender>(pBuffer, v0, width);
   }
   
 public:
@@ -245,6 +248,10 @@ public:
   
   void ClearStencil(uint8 value)
   {
+    // The stencil is only allocated when used so that rasterizers working on a part of a shared buffer stay cheap:
+    if (mStencilBuffer.size() != (size_t)(mWidth * mHeight))
+      mStencilBuffer.resize(mWidth * mHeight);
+
     if (
         (mClipX0 == 0) &&
         (mClipY0 == 0) &&
@@ -374,7 +381,11 @@ public:
     clipped |= !SetupSegment<VertexType, false>(Left0, Left1, LeftIncr);
     clipped |= !SetupSegment<VertexType, false>(Right0, Right1, RightIncr);
 
-    if (!((Left0.X() <= Right0.X()) && (Left1.X() <= Right1.X())))
+    // Tell which edge is on the left from the unclipped triangle: the edges may start at the same point or be clipped away.
+    const int64 cross = (int64)(Triangle[1].X() - Triangle[0].X()) * (int64)(Triangle[2].Y() - Triangle[0].Y())
+                      - (int64)(Triangle[2].X() - Triangle[0].X()) * (int64)(Triangle[1].Y() - Triangle[0].Y());
+    const bool flatbottom = fillbottom ? false : (Triangle[1].Y() == Triangle[2].Y() && Triangle[0].Y() != Triangle[1].Y());
+    if (flatbottom ? (cross > 0) : (cross < 0))
     {
       std::swap(Left0, Right0);
       std::swap(Left1, Right1);
@@ -449,6 +460,39 @@ public:
       DrawSection<PixelBlender>(Left0, Left1, LeftIncr, Right0, Right1, RightIncr);
   }
   
+  /// Blend Color with the anti-aliased spans of rCoverage, inside the clip rect.
+  template <class PixelBlender>
+  void DrawCoverage(const nuiCoverageRasterizer& rCoverage, uint32 Color)
+  {
+    int32 x0, y0, x1, y1;
+    rCoverage.GetBounds(x0, y0, x1, y1);
+    x0 = MAX(x0, ToBelow(mClipX0));
+    y0 = MAX(y0, ToBelow(mClipY0));
+    x1 = MIN(x1, ToBelow(mClipX1));
+    y1 = MIN(y1, ToBelow(mClipY1));
+
+    const uint8* pCoverage = rCoverage.GetCoverage();
+    for (int32 y = y0; y < y1; y++)
+    {
+      int32 count;
+      const nuiCoverageRasterizer::Span* pSpans = rCoverage.GetSpans(y, count);
+      uint32* pLine = mpBuffer + y * mWidth;
+      for (int32 i = 0; i < count; i++)
+      {
+        const nuiCoverageRasterizer::Span& rSpan(pSpans[i]);
+        const int32 start = MAX(rSpan.mX, x0);
+        const int32 end = MIN(rSpan.mX + rSpan.mCount, x1);
+        if (start >= end)
+          continue;
+
+        if (rSpan.mOffset < 0)
+          PixelBlender::FillSpan(pLine + start, Color, end - start);
+        else
+          PixelBlender::BlendCoverage(pLine + start, Color, pCoverage + rSpan.mOffset + start - rSpan.mX, end - start);
+      }
+    }
+  }
+
   void Resize(int32 width, int32 height, uint32* pBuffer = NULL)
   {
     mWidth = width;
@@ -469,7 +513,7 @@ public:
       mpBufferVector = NULL;
     }
     
-    mStencilBuffer.resize(width * height);
+    mStencilBuffer.clear();
   }
   
   uint32* GetBuffer() const
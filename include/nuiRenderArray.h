@@ -42,6 +42,50 @@ public:
     GLubyte mA;
   };
 
+  struct Vertex2DTexColor
+  {
+    GLfloat mX;
+    GLfloat mY;
+
+    GLfloat mTX;
+    GLfloat mTY;
+
+    GLubyte mR;
+    GLubyte mG;
+    GLubyte mB;
+    GLubyte mA;
+  };
+
+  struct Vertex2DColor
+  {
+    GLfloat mX;
+    GLfloat mY;
+
+    GLubyte mR;
+    GLubyte mG;
+    GLubyte mB;
+    GLubyte mA;
+  };
+
+  enum VertexFormat
+  {
+    eFormatFull = 0, ///< Vertex: XYZW, texture coordinates, normal and color (44 bytes). The default, needed by 3D meshes.
+    eFormat2DTexColor, ///< Vertex2DTexColor: XY, texture coordinates and color (20 bytes).
+    eFormat2DColor ///< Vertex2DColor: XY and color (12 bytes).
+  };
+
+  /// Where the painters find each component of a vertex in GetVertexData(). The offset of a component the format doesn't store is -1.
+  class VertexLayout
+  {
+  public:
+    uint32 mStride;
+    int32 mPositionCount; ///< Number of floats of the position (2 or 3).
+    int32 mPosition;
+    int32 mTexCoord;
+    int32 mColor;
+    int32 mNormal;
+  };
+
   enum StreamType
   {
     eFloat = GL_FLOAT,
@@ -92,6 +136,7 @@ public:
 #endif
   };
   
+  // The next accessors give direct access to the vertices of an eFormatFull array. Use GetVertex(index, rVertex) to read any format.
   std::vector<Vertex>& GetVertices()
   { 
     return mVertices; 
@@ -122,13 +167,21 @@ public:
     return mVertices[index];
   }
 
+  void GetVertex(uint32 index, Vertex& rVertex) const; ///< Read a vertex of any format. The components the format doesn't store get their default value.
+
+  void SetFormat(VertexFormat Format); ///< The vertices already in the array are converted.
+  VertexFormat GetFormat() const;
+  const VertexLayout& GetLayout() const;
+  static const VertexLayout& GetLayout(VertexFormat Format);
+  const void* GetVertexData() const; ///< The vertices with the layout of GetFormat(), NULL if the array is empty.
+
   int32 AddStream(const StreamDesc& rDesc);
     
   void SetMode(GLenum mode); ///< GL_POINTS, GL_LINE_STRIP, GL_LINE_LOOP, GL_LINES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES
   GLenum GetMode() const; ///< GL_POINTS, GL_LINE_STRIP, GL_LINE_LOOP, GL_LINES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES
 
   void EnableArray(DataType tpe, bool Set = true);
-  bool IsArrayEnabled(DataType tpe) const;
+  bool IsArrayEnabled(DataType tpe) const; ///< Always false for the components the format doesn't store.
   
   bool Is3DMesh() const;
   void Set3DMesh(bool set);
@@ -173,6 +226,7 @@ public:
   void SetNormal(uint32 index, const nuiVector3& rV3f);
 
   void PushVertex();
+  void PushVertex(const Vertex& rVertex);
   
   IndexArray& GetIndexArray(uint32 ArrayIndex);
   void AddIndicesArray(uint32 mode, uint32 reserve_count = 0, bool resize_reserve = false);
@@ -207,8 +261,11 @@ private:
   bool mShape : 1;
   bool mDebug : 1;
 
+  VertexFormat mFormat;
   Vertex mCurrentVertex;
   std::vector<Vertex> mVertices;
+  std::vector<Vertex2DTexColor> mVertices2DTexColor;
+  std::vector<Vertex2DColor> mVertices2DColor;
   std::vector<StreamDesc*> mStreams;
   
   nuiRect mBounds;
@@ -216,6 +273,7 @@ private:
   std::vector<IndexArray*> mIndexedArrays;
 
   void UpdateBounds(float x, float y, float z);
+  void StoreVertex(uint32 index, const Vertex& rVertex);
   float mMinX;
   float mMinY;
   float mMinZ;
@@ -83,7 +83,9 @@ public:
   Winding GetWinding() const; ///< Set the Winding rule of this shape. The default winding rule is set to eNone (it will use the active winding rule of the draw context).
   void SetWinding(Winding Rule); ///< Get the Winding rule of this shape. 
 
-  void EmptyCaches();
+  void EmptyCaches(); ///< Forget the tessellations of this shape kept in nuiTessellationCache.
+  void Changed(); ///< The shape methods call it for you. Call it yourself after changing one of its contours or path generators directly.
+  uint64 GetRevision() const; ///< Changes every time the shape is modified. Two different shapes never share a revision.
 
   float GetDistanceFromPoint(float X, float Y, float Quality = 0.5f) const;
   
@@ -93,6 +95,8 @@ private:
   nuiShape& operator=(const nuiShape& rShape);
 
   Winding mWinding;
+  mutable uint64 mRevision;
+  mutable bool mRevisionUsed; ///< Only give the shape a new revision if the current one was handed out.
 };
 
 
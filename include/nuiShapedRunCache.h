@@ -0,0 +1,97 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiTextRun.h"
+
+class nuiFontBase;
+
+/// Keeps the glyphs produced by nuiFontBase::Shape so that shaping the same text again with the same font doesn't go through
+/// HarfBuzz. The entries are keyed by the font, its size, the script and the text of the run (the direction of the run is
+/// derived from its script by the shaper). The least recently used entries are dropped when the cache holds more than
+/// GetMaxEntries() runs or GetMaxGlyphs() glyphs. Runs longer than GetMaxLength() chars are never cached.
+///
+/// The glyphs are stored as nuiFontBase::Shape leaves them, it sets their color from the style of each run it finds here.
+class nuiShapedRunCache
+{
+public:
+  nuiShapedRunCache(uint32 MaxEntries = 8192, uint32 MaxGlyphs = 256 * 1024, uint32 MaxLength = 256);
+  virtual ~nuiShapedRunCache();
+
+  static nuiShapedRunCache& Get();
+  static void Forget(nuiFontBase* pFont); ///< Drop the entries of this font from the global cache (the font is deleted or its rendering changed).
+
+  /// Copy the shaped glyphs of this text in rGlyphs and its advance in rAdvanceX. Returns false if the run is not in the cache.
+  bool Find(nuiFontBase* pFont, nuiUnicodeScript Script, const nglUChar* pText, int32 Length, std::vector<nuiTextGlyph>& rGlyphs, float& rAdvanceX);
+  void Store(nuiFontBase* pFont, nuiUnicodeScript Script, const nglUChar* pText, int32 Length, const std::vector<nuiTextGlyph>& rGlyphs, float AdvanceX);
+
+  void SetEnabled(bool Set); ///< When disabled the runs are shaped each time and nothing is kept. True by default.
+  bool GetEnabled() const;
+  void SetMaxEntries(uint32 MaxEntries);
+  uint32 GetMaxEntries() const;
+  void SetMaxGlyphs(uint32 MaxGlyphs);
+  uint32 GetMaxGlyphs() const;
+  void SetMaxLength(uint32 MaxLength);
+  uint32 GetMaxLength() const;
+
+  void Clear();
+  uint32 GetEntryCount() const;
+  uint32 GetGlyphCount() const; ///< Glyphs in all the cached runs.
+
+  uint64 GetHits() const;
+  uint64 GetMisses() const;
+  uint64 GetEvictions() const;
+  float GetHitRate() const; ///< Hits / (hits + misses), 0 if nothing was looked up since the last ResetStats.
+  void ResetStats();
+
+private:
+  class Key
+  {
+  public:
+    Key(nuiFontBase* pFont, float Size, nuiUnicodeScript Script, const nglUChar* pText, int32 Length);
+
+    bool operator<(const Key& rKey) const;
+
+    nuiFontBase* mpFont;
+    float mSize;
+    nuiUnicodeScript mScript;
+    std::vector<nglUChar> mText;
+  };
+
+  class Entry
+  {
+  public:
+    Entry(const Key& rKey, const std::vector<nuiTextGlyph>& rGlyphs, float AdvanceX);
+
+    Key mKey;
+    std::vector<nuiTextGlyph> mGlyphs;
+    float mAdvanceX;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::map<Key, EntryList::iterator> EntryMap;
+
+  void ForgetFont(nuiFontBase* pFont);
+  void Remove(EntryMap::iterator it);
+  void Trim();
+
+  bool mEnabled;
+  uint32 mMaxEntries;
+  uint32 mMaxGlyphs;
+  uint32 mMaxLength;
+  uint32 mGlyphs;
+  EntryList mEntries; ///< Most recently used first.
+  EntryMap mIndex;
+
+  uint64 mHits;
+  uint64 mMisses;
+  uint64 mEvictions;
+
+  mutable nglCriticalSection mCS;
+};
+
@@ -10,9 +10,16 @@
 
 #include "nuiDrawContext.h"
 #include "nglImage.h"
+#include <atomic>
 
 class nuiRasterizer;
+class nuiCoverageRasterizer;
 
+/// Renders to a 32 bits buffer with nuiRasterizer.
+/// By default the draw calls of a session are not rasterized right away: each primitive is transformed and binned into
+/// the screen tiles it covers, then EndSession rasterizes the tiles in parallel on nuiTaskPool::GetDefault(). Each tile
+/// replays its primitives in submission order, so the result is the same as drawing them one by one.
+/// Shapes are not tessellated: their outline goes to a nuiCoverageRasterizer that anti-aliases the edges.
 class nuiSoftwarePainter : public nuiPainter
 {
 public:
@@ -23,11 +30,16 @@ public:
   virtual void StartRendering();
   virtual void SetState(const nuiRenderState& rState, bool ForceApply = false);
   virtual void DrawArray(nuiRenderArray* pArray);
+  virtual bool DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality);
+  virtual void Clear(bool color, bool depth, bool stencil);
   virtual void ClearColor();
   virtual void BeginSession();
   virtual void EndSession();
   virtual uint32 GetRectangleTextureSupport() const { return 1; }
 
+  virtual void DestroySurface(nuiSurface* pSurface);
+  virtual void DestroyRenderArray(nuiRenderArray* pArray);
+
   void Display(nglWindow* pWindow, const nuiRect& rRect);
 
   nuiRasterizer* GetRasterizer() const
@@ -35,22 +47,117 @@ public:
     return mpRasterizer;
   }
 
+  void SetRenderThreads(uint32 Threads); ///< Rasterize the tiles on this many threads of nuiTaskPool::GetDefault() (0 = one per worker, the default). 1 draws every array immediately, without binning.
+  uint32 GetRenderThreads() const;
+  void SetTileSize(int32 TileSize); ///< Size of the square screen tiles in pixels. Defaults to 64.
+  int32 GetTileSize() const;
+  void SetShapeAntialiasing(bool Set); ///< Draw the shapes with analytic anti-aliasing (true by default). Untextured shapes with the even-odd or non-zero rule only, the others are always tessellated.
+  bool GetShapeAntialiasing() const;
+
+  void Flush(); ///< Rasterize the binned primitives now. Called by EndSession, SetSize and Display.
+
 protected:
+  virtual void DestroyTexture(nuiTexture* pTexture);
 
   class nuiRasterizer* mpRasterizer;
 
-  void DrawLines(const nuiRenderArray* pArray);
-  void DrawLineStrip(const nuiRenderArray* pArray);
-  void DrawLineLoop(const nuiRenderArray* pArray);
-  void DrawTriangles(const nuiRenderArray* pArray);
-  void DrawTrianglesFan(const nuiRenderArray* pArray);
-  void DrawTrianglesStrip(const nuiRenderArray* pArray);
-  void DrawQuads(const nuiRenderArray* pArray);
-  void DrawQuadStrip(const nuiRenderArray* pArray);
-
-  void DrawLine(const nuiRenderArray* pArray, int p1, int p2);
-  void DrawTriangle(const nuiRenderArray* pArray, int p1, int p2, int p3);
-  void DrawRectangle(const nuiRenderArray* pArray, int p1, int p2, int p3, int p4);
+  /// A line (2 vertices), triangle (3) or axis aligned rectangle (4) of a render array.
+  class Primitive
+  {
+  public:
+    Primitive(int32 p1, int32 p2)
+    : mCount(2)
+    {
+      mIndices[0] = p1; mIndices[1] = p2; mIndices[2] = mIndices[3] = 0;
+    }
+
+    Primitive(int32 p1, int32 p2, int32 p3)
+    : mCount(3)
+    {
+      mIndices[0] = p1; mIndices[1] = p2; mIndices[2] = p3; mIndices[3] = 0;
+    }
+
+    Primitive(int32 p1, int32 p2, int32 p3, int32 p4)
+    : mCount(4)
+    {
+      mIndices[0] = p1; mIndices[1] = p2; mIndices[2] = p3; mIndices[3] = p4;
+    }
+
+    int32 mCount;
+    int32 mIndices[4];
+  };
+
+  /// A binned DrawArray, DrawShape or ClearColor call.
+  class Command
+  {
+  public:
+    nuiRenderArray* mpArray; ///< Acquired until the next Flush, NULL for a clear or a shape.
+    nuiCoverageRasterizer* mpCoverage; ///< Spans of a shape, taken from mCoverages.
+    int32 mState; ///< Index in mStates.
+    nuiMatrix mMatrix;
+    int32 mClipX0, mClipY0, mClipX1, mClipY1; ///< Screen clip rect in pixels.
+    uint32 mColor; ///< Of the clear or the shape.
+    nuiBlendFunc mBlendFunc; ///< Of the shape.
+    std::vector<Primitive> mPrimitives;
+  };
+
+  class TileEntry
+  {
+  public:
+    TileEntry(int32 command, int32 primitive)
+    : mCommand(command), mPrimitive(primitive)
+    {
+    }
+
+    int32 mCommand;
+    int32 mPrimitive; ///< -1 for a clear or a shape.
+  };
+
+  class Tile
+  {
+  public:
+    int32 mX0, mY0, mX1, mY1;
+    std::vector<TileEntry> mEntries;
+  };
+
+  bool IsBinning() const;
+  void GetClipRect(int32& rX0, int32& rY0, int32& rX1, int32& rY1) const;
+  void ResizeTiles();
+  void BinPrimitive(int32 command, int32 primitive);
+  void BinRect(int32 command, int32 primitive, int32 X0, int32 Y0, int32 X1, int32 Y1);
+  void RenderTiles();
+  void RenderTile(Tile& rTile);
+
+  void GetPrimitives(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetLines(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetLineStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetLineLoop(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetTriangles(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetTrianglesFan(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetTrianglesStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetQuads(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+  void GetQuadStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const;
+
+  void FillPath(const nuiPath& rPath, nuiShape::Winding Rule, const nuiColor& rColor, nuiBlendFunc BlendFunc);
+  void DrawCoverage(nuiRasterizer* pRasterizer, const nuiCoverageRasterizer& rCoverage, uint32 Color, nuiBlendFunc BlendFunc);
+
+  void DrawPrimitive(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, const Primitive& rPrimitive);
+  void DrawLine(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2);
+  void DrawTriangle(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2, int p3);
+  void DrawRectangle(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2, int p3, int p4);
+
+  uint32 mRenderThreads;
+  int32 mTileSize;
+  int32 mTilesX;
+  int32 mTilesY;
+  std::vector<Tile> mTiles;
+  std::vector<Command> mCommands;
+  std::vector<nuiRenderState*> mStates; ///< Copies of the states used by mCommands, a new one is only made when the state changes.
+  std::vector<Primitive> mPrimitives; ///< Scratch buffer of the immediate mode.
+  bool mShapeAntialiasing;
+  std::vector<nuiCoverageRasterizer*> mCoverages; ///< The first mCoverageCount ones are used by mCommands, the others are kept for their buffers.
+  uint32 mCoverageCount;
+  std::atomic<int32> mNextTile;
 };
 
 #endif //__nuiSoftwarePainter_h__
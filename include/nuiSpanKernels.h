@@ -0,0 +1,42 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nui.h"
+
+/// Instruction sets the nuiRasterizer span kernels can use. The best one available on the running CPU is picked on first use.
+enum nuiSpanImplementation
+{
+  eSpanScalar = 0,
+  eSpanSSE2,
+  eSpanAVX2
+};
+
+bool nuiSpan_SetImplementation(nuiSpanImplementation Implementation); ///< Force an implementation (mostly for benchmarks and tests). Returns false if the CPU doesn't support it.
+bool nuiSpan_IsImplementationAvailable(nuiSpanImplementation Implementation);
+nuiSpanImplementation nuiSpan_GetImplementation();
+void nuiSpan_ResetImplementation(); ///< Go back to the best implementation for this CPU.
+const char* nuiSpan_GetImplementationName(nuiSpanImplementation Implementation);
+
+/// Horizontal span kernels used by nuiVertex::DrawHLine and the nuiPixelBlender classes. Pixels are 32 bits NUI_RGBA values (alpha in the top byte).
+/// All the implementations produce exactly the same pixels.
+class nuiSpanKernels
+{
+public:
+  void (*Fill)(uint32* pDst, uint32 Color, int32 Count);
+  void (*FillTransp)(uint32* pDst, uint32 Color, int32 Count); ///< Alpha blend one color, see nuiPixelBlender_Transp.
+  void (*FillTranspAdd)(uint32* pDst, uint32 Color, int32 Count); ///< See nuiPixelBlender_TranspAdd.
+  void (*BlendTransp)(uint32* pDst, const uint32* pSrc, int32 Count);
+  void (*BlendTranspAdd)(uint32* pDst, const uint32* pSrc, int32 Count);
+  void (*Modulate)(uint32* pDst, const uint32* pSrc, int32 Count); ///< Per channel pDst = (pDst * pSrc) >> 8, see nuiModulatedColor.
+  void (*Gouraud)(uint32* pDst, int32* pColor, const int32* pIncr, int32 Count); ///< pColor and pIncr are R, G, B, A 16.16 fixed point values. pColor is advanced by Count steps.
+  void (*FetchRGB24)(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count); ///< Nearest texels with clamped 16.16 coordinates, see nuiTexelAccessor_RGB24.
+  void (*FetchRGBA32)(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count);
+};
+
+const nuiSpanKernels& nuiSpan_GetKernels();
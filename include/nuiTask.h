@@ -9,6 +9,7 @@
 
 #include "nuiFastDelegate.h"
 #include "nuiRefCount.h"
+#include "nuiMPSCQueue.h"
 
 
 template <class Param>
@@ -43,7 +44,7 @@ public:
 
 
 
-class nuiTask : public nuiRefCount
+class nuiTask : public nuiRefCount, public nuiQueueLink
 {
 public:
   nuiTask()
@@ -0,0 +1,98 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiTask.h"
+
+class nuiTaskPool;
+
+/// A nuiTaskGroup counts the tasks posted to a nuiTaskPool with it so that one can wait for all of them to complete (see nuiTaskPool::Wait).
+class nuiTaskGroup : nuiNonCopyable
+{
+  friend class nuiTaskPool;
+public:
+  nuiTaskGroup();
+  virtual ~nuiTaskGroup();
+
+  bool IsDone() const; ///< Returns true if all the tasks posted with this group have been executed (or canceled).
+  uint32 GetPending() const; ///< Returns the number of tasks of this group that are still waiting or running.
+
+private:
+  void Add();
+  void Done();
+
+  std::atomic<int32> mPending;
+  nglSyncEvent mDone;
+};
+
+/// A pool of worker threads that execute nuiTasks.
+/*!
+ Each worker owns one deque per priority. Tasks posted from a worker go to its own deques, tasks posted from any other thread are
+ dispatched round robin. A worker pops its own most recent task first and, when it runs dry, steals the oldest task of another
+ worker, so that the threads only touch each other's locks when there is an imbalance.
+
+ Like nuiTaskQueue, the pool acquires the task when it is posted and releases it once it has run.
+ */
+class nuiTaskPool : nuiNonCopyable
+{
+public:
+  enum Priority
+  {
+    eLow = 0,
+    eNormal,
+    eHigh,
+    ePriorityCount
+  };
+
+  nuiTaskPool(uint32 ThreadCount = 0, const nglString& rName = nglString("nuiTaskPool"), nglThread::Priority ThreadPriority = nglThread::Normal); ///< Creates ThreadCount workers. If ThreadCount is 0 there will be one worker per CPU (see nglCPUInfo::GetCount).
+  virtual ~nuiTaskPool(); ///< Stops the workers. Tasks that didn't get a chance to run are released without being executed.
+
+  void Post(nuiTask* pTask, Priority priority = eNormal, nuiTaskGroup* pGroup = NULL); ///< Schedule pTask for execution. If pGroup is given it will track the completion of pTask.
+  void Wait(nuiTaskGroup& rGroup); ///< Blocks until all the tasks of rGroup have been executed. When called from a worker of this pool, the calling thread keeps executing tasks while it waits.
+  bool RunOne(); ///< Execute one pending task on the calling thread, if there is one. Returns false if there was nothing to do.
+
+  uint32 GetThreadCount() const;
+  bool IsWorkerThread() const; ///< Returns true if the calling thread is one of the workers of this pool.
+
+  uint64 GetExecutedCount() const; ///< Number of tasks executed since the creation of the pool.
+  uint64 GetStolenCount() const; ///< Number of tasks that were executed by another worker than the one they were posted to.
+
+  static nuiTaskPool& GetDefault(); ///< Returns the application wide pool, creating it with one worker per CPU on first use.
+  static void ReleaseDefault(); ///< Destroy the application wide pool (called by nuiUninit).
+
+private:
+  class Worker;
+  friend class Worker;
+
+  class Job
+  {
+  public:
+    Job(nuiTask* pTask = NULL, nuiTaskGroup* pGroup = NULL)
+    : mpTask(pTask), mpGroup(pGroup)
+    {
+    }
+
+    nuiTask* mpTask;
+    nuiTaskGroup* mpGroup;
+  };
+
+  Worker* GetCurrentWorker() const;
+  bool FindJob(uint32 WorkerIndex, Job& rJob);
+  void Execute(const Job& rJob);
+  void Discard(const Job& rJob);
+  void WakeUp(uint32 Preferred);
+
+  std::vector<Worker*> mWorkers;
+  std::atomic<uint32> mNextWorker;
+  std::atomic<bool> mStop;
+  std::atomic<uint64> mExecuted;
+  std::atomic<uint64> mStolen;
+
+  static nuiTaskPool* mpDefault;
+};
+
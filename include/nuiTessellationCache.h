@@ -0,0 +1,99 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#ifndef __nuiTessellationCache_h__
+#define __nuiTessellationCache_h__
+
+#include "nuiShape.h"
+
+class nuiRenderObject;
+
+/// Keeps the render objects generated by nuiShape::Fill and nuiShape::Outline so that drawing the same shape again with the
+/// same parameters doesn't tessellate it again. The entries are keyed by nuiShape::GetRevision(), the quality, the mode and
+/// the stroke parameters. The least recently used entries are dropped when the cache holds more than GetMaxEntries() objects
+/// or GetMaxVertices() vertices. nuiDrawContext::DrawShape uses the cache returned by Get().
+///
+/// The cached arrays are shared: they must not be modified by the code that draws them.
+class nuiTessellationCache
+{
+public:
+  nuiTessellationCache(uint32 MaxEntries = 512, uint32 MaxVertices = 256 * 1024);
+  virtual ~nuiTessellationCache();
+
+  static nuiTessellationCache& Get();
+  static void Forget(uint64 ShapeRevision); ///< Drop the entries of this shape revision from the global cache (see nuiShape::EmptyCaches).
+
+  /// Add the arrays of the tessellated shape to rObject (which acquires them). Returns false if the shape is empty.
+  bool Fill(nuiShape* pShape, float Quality, nuiRenderObject& rObject);
+  bool Outline(nuiShape* pShape, float Quality, float LineWidth, nuiLineJoin LineJoin, nuiLineCap LineCap, float MiterLimit, nuiRenderObject& rObject);
+
+  void SetEnabled(bool Set); ///< When disabled the shapes are tessellated each time and nothing is kept. True by default.
+  bool GetEnabled() const;
+  void SetMaxEntries(uint32 MaxEntries);
+  uint32 GetMaxEntries() const;
+  void SetMaxVertices(uint32 MaxVertices);
+  uint32 GetMaxVertices() const;
+
+  void Clear();
+  uint32 GetEntryCount() const;
+  uint32 GetVertexCount() const; ///< Vertices in all the cached render objects.
+
+  uint64 GetHits() const;
+  uint64 GetMisses() const;
+  uint64 GetEvictions() const;
+  void ResetStats();
+
+private:
+  class Key
+  {
+  public:
+    Key(uint64 Revision, nuiShapeMode Mode, float Quality, float LineWidth, nuiLineJoin LineJoin, nuiLineCap LineCap, float MiterLimit);
+
+    bool operator<(const Key& rKey) const;
+
+    uint64 mRevision;
+    nuiShapeMode mMode;
+    float mQuality;
+    float mLineWidth;
+    nuiLineJoin mLineJoin;
+    nuiLineCap mLineCap;
+    float mMiterLimit;
+  };
+
+  class Entry
+  {
+  public:
+    Entry(const Key& rKey, nuiRenderObject* pObject, uint32 Vertices);
+
+    Key mKey;
+    nuiRenderObject* mpObject;
+    uint32 mVertices;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef std::map<Key, EntryList::iterator> EntryMap;
+
+  bool GetObject(nuiShape* pShape, const Key& rKey, nuiRenderObject& rObject);
+  void ForgetRevision(uint64 ShapeRevision);
+  void Remove(EntryMap::iterator it);
+  void Trim();
+
+  bool mEnabled;
+  uint32 mMaxEntries;
+  uint32 mMaxVertices;
+  uint32 mVertices;
+  EntryList mEntries; ///< Most recently used first.
+  EntryMap mIndex;
+
+  uint64 mHits;
+  uint64 mMisses;
+  uint64 mEvictions;
+
+  mutable nglCriticalSection mCS;
+};
+
+#endif // __nuiTessellationCache_h__
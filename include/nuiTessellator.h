@@ -10,10 +10,22 @@
 #ifndef __nuiTessellator_h__
 #define __nuiTessellator_h__
 
+#include "nuiTaskPool.h"
+
 class nuiRenderObject;
 class nuiShape;
 class nuiPathGenerator;
+class nuiTessellationFuture;
+
+/// Turns a nuiShape or a nuiPathGenerator into a nuiRenderObject.
+/*!
+ Each call to Generate borrows a GLU tessellator from a shared pool and gives it back when done, so different nuiTessellator
+ instances can run on different threads at the same time. A single instance must not be used by two threads at once.
 
+ Fills made of a single simple contour (rectangles, rounded rectangles, ellipses...) don't go through libtess: convex contours
+ are turned into a fan of triangles and the other ones are ear clipped, both in one GL_TRIANGLES array. Everything else, outlines
+ included, is handled by libtess.
+ */
 class nuiTessellator
 {
 public:
@@ -23,6 +35,14 @@ public:
 
   nuiRenderObject* Generate(float Quality = 0.5f);
 
+  /// Run Generate on rPool. The path generator or shape must stay alive and unchanged until the returned future is done.
+  /// The caller owns the future.
+  nuiTessellationFuture* GenerateAsync(float Quality = 0.5f, nuiTaskPool& rPool = nuiTaskPool::GetDefault(), nuiTaskPool::Priority Priority = nuiTaskPool::eNormal) const;
+
+  static void ReleaseTessellators(); ///< Delete the pooled GLU tessellators (called by nuiUninit).
+  static void SetFastPath(bool Set); ///< Set to false to send every contour to libtess. True by default.
+  static bool GetFastPath();
+
   void SetFill(bool Set) { mOutline = !Set; }
   void SetOutline(bool Set) { mOutline = Set; }
   bool GetFill() const { return !mOutline; }
@@ -35,9 +55,14 @@ private:
 
   nuiRenderObject* GenerateFromPath(float Quality);
   nuiRenderObject* GenerateFromShape(float Quality);
+  nuiRenderObject* GenerateSimple(const nuiPath& rPoints); ///< Returns NULL if rPoints is not a single simple contour.
+
+  static bool mFastPath;
 
-  static class GLUtesselator* mpTess;
-  static uint32 mRefs;
+  static class GLUtesselator* AcquireTessellator();
+  static void ReleaseTessellator(GLUtesselator* pTess);
+
+  GLUtesselator* mpTess;
 
 #ifndef CALLBACK
 #define CALLBACK
@@ -62,4 +87,30 @@ private:
   bool mEdgeFlag;
 };
 
+/// The pending result of nuiTessellator::GenerateAsync.
+class nuiTessellationFuture : nuiNonCopyable
+{
+public:
+  virtual ~nuiTessellationFuture(); ///< Cancels the tessellation if it hasn't started yet or waits for it to finish. Deletes the render object unless it was taken.
+
+  bool IsDone() const;
+  void Wait(); ///< Blocks until the tessellation is done. When called from a worker of the pool it keeps executing other tasks meanwhile.
+
+  nuiRenderObject* GetObject(); ///< Waits and returns the result, which still belongs to the future. May be NULL if there was nothing to tessellate.
+  nuiRenderObject* TakeObject(); ///< Waits and hands the result over to the caller, exactly as nuiTessellator::Generate would have returned it.
+
+private:
+  friend class nuiTessellator;
+  nuiTessellationFuture(nuiTessellator* pTessellator, float Quality, nuiTaskPool& rPool, nuiTaskPool::Priority Priority);
+
+  void Run();
+
+  nuiTessellator* mpTessellator;
+  float mQuality;
+  nuiRenderObject* mpObject;
+  nuiTaskPool& mrPool;
+  nuiTaskGroup mGroup;
+  nuiTask* mpTask;
+};
+
 #endif // nuiTessellator
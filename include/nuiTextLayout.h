@@ -15,6 +15,8 @@
 #include "nuiTextRun.h"
 #include "nuiTextLine.h"
 
+class nuiTaskPool;
+
 class nuiTextLayout : public nuiRefCount
 {
 public:
@@ -22,7 +24,8 @@ public:
   nuiTextLayout(nuiFontBase* pFont, nuiOrientation Orientation = nuiHorizontal);
   virtual ~nuiTextLayout();
 
-  bool Layout(const nglString& rString);
+  bool Layout(const nglString& rString); ///< Lay rString out. The paragraphs of the previous call whose text didn't change are reused as they are if the style, the style changes and the wrapping width didn't change either.
+  static void Layout(const std::vector<nuiTextLayout*>& rLayouts, const std::vector<nglString>& rStrings, nuiTaskPool& rPool); ///< Lay each string of rStrings out in the layout of rLayouts at the same index. The paragraphs of all the layouts are shaped together on the workers of rPool, which pays off for many small texts that would each be too short to be split.
   void Print(nuiDrawContext* pContext, float X, float Y, bool AlignGlyphPixels) const;
   
   int32 GetParagraphCount() const;
@@ -83,14 +86,49 @@ public:
   void DelStyleChanges(int32 StringPosition);
   const std::map<int32, nuiTextStyle>& GetStyleChanges() const;
   void ClearStyleChanges();
-  
+
+  void SetTaskPool(nuiTaskPool* pPool); ///< Shape the paragraphs of big texts on the workers of pPool. NULL by default: everything is done on the calling thread.
+  nuiTaskPool* GetTaskPool() const;
+  int32 GetReusedParagraphCount() const; ///< Number of paragraphs the last call to Layout took from the previous one instead of laying them out again.
+
 private:
+  typedef std::map<nuiFontBase*, std::map<nuiUnicodeScript, std::set<nglUChar> > > Charsets;
+  typedef std::map<std::pair<nuiFontBase*, nuiUnicodeScript>, nuiFontBase*> FontSet;
+
+  class Paragraph : public std::vector<nuiTextLine*>
+  {
+  public:
+    Paragraph(int32 Start, int32 Length, uint32 Hash);
+    ~Paragraph();
+
+    void Clear(); ///< Delete the lines
+
+    int32 mStart; ///< Position of the first char in mUnicode
+    int32 mLength;
+    uint32 mHash; ///< Hash of the text
+    Charsets mCharsets; ///< Chars used by each font and script
+    FontSet mFonts; ///< Fonts the runs were shaped with
+    float mWidth; ///< Width of the widest line
+  };
+
   bool PrintGlyphs(nuiDrawContext *pContext, float X, float Y, const std::map<nuiTexture*, std::vector<nuiTextGlyph*> >& rGlyphs, bool AlignGlyphPixels) const;
-  void SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const nuiTextStyle& style, int32& pos, int32 len);
+  void SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const nuiTextStyle& style, Charsets& rCharsets, int32& pos, int32 len);
+  Paragraph* ReuseParagraph(int32 Start, int32 Length, uint32 Hash, const std::vector<nglUChar>& rOldUnicode, std::multimap<uint32, Paragraph*>& rOldParagraphs);
+  typedef std::vector<std::pair<nuiTextLayout*, Paragraph*> > LayoutParagraphs;
+
+  void BeginLayout(const nglString& rString, std::vector<Paragraph*>& rToShape); ///< Split rString in paragraphs and choose their fonts, rToShape gets the ones that must be shaped
+  void EndLayout(); ///< Place the lines once the paragraphs are shaped
+  void SetParagraphFonts(Paragraph* pParagraph);
+  static void ShapeParagraphs(LayoutParagraphs& rParagraphs, nuiTaskPool* pPool);
+  static void ShapeParagraphRange(LayoutParagraphs* pParagraphs, uint32 First, uint32 Last);
+  void ShapeParagraph(Paragraph* pParagraph);
+  static void RasterizeGlyphs(const LayoutParagraphs& rParagraphs, nuiTaskPool& rPool);
+  void InvalidateParagraphs();
 
   nuiTextStyle mStyle;
   std::map<int32, nuiTextStyle> mStyleChanges;
-  std::map<nuiFontBase*, std::map<nuiUnicodeScript, std::set<nglUChar> > > mCharsets;
+  FontSet mFontSet;
+  std::map<nuiFontBase*, float> mFontHeights;
   
   nuiOrientation mOrientation;
   
@@ -100,9 +138,8 @@ private:
   float mXMin, mXMax;
   float mYMin, mYMax;
   
-  bool LayoutParagraph(int32 start, int32 length);
+  bool LayoutParagraph(Paragraph* pParagraph);
   
-  typedef std::vector<nuiTextLine*> Paragraph;
   std::vector<Paragraph*> mpParagraphs;
   
   std::vector<nglUChar> mUnicode;
@@ -113,5 +150,9 @@ private:
   float mTabWidth = 0;
   float mWrapX = 0;
 
+  nuiTaskPool* mpTaskPool = NULL;
+  bool mReuseParagraphs = false;
+  int32 mReusedParagraphs = 0;
+
 };
 
@@ -110,5 +110,6 @@ private:
   float mY;
   float mAdvanceX;
   float mAdvanceY;
+  uint32 mTextureGeneration; ///< Texture generation of the font when the glyphs were placed (see nuiFontBase::UpdateGlyphTextures)
 };
 
@@ -41,6 +41,8 @@ public:
   static void ForceReloadAll(bool Rebind = false);
 
   void ForceReload(bool Rebind = false); ///< This method deletes the texture assiciated with the nuiTexture thus forcing its recreation at the next rendertime. If Rebind == false then we consider that the native (GL) texture was lost because the context/window have been destroyed and we have to completely recreate the texture.
+  void ForceReloadRect(const nuiRect& rRect); ///< Only the pixels of rRect (in image coordinates) changed since the last upload: the painter can update this part of the texture only. Several calls accumulate until the texture is uploaded.
+  const nuiRect& GetReloadRect() const; ///< The part of the texture that ForceReloadRect reported as changed. Empty if the whole texture has to be uploaded.
   void ResetForceReload();
   void ImageToTextureCoord(nuiSize& x, nuiSize& y) const; ///< Transform the x,y point in the coordinates of the image to the coordinates of the texture. 
   void TextureToImageCoord(nuiSize& x, nuiSize& y) const; ///< Transform the x,y point in the coordinates of the texture to the coordinates of the image. 
@@ -79,6 +81,8 @@ public:
   bool GetAutoMipMap() const;
   
   void SetRetainBuffer(bool Retain); ///< Set the nglImage destroying switch upon uploading to OpenGL
+  void SetDistanceFieldSpread(float Spread); ///< The alpha channel holds a signed distance to the edge of a shape instead of a coverage: 0.5 on the edge, 0 and 1 at Spread texels outside and inside. The painters then turn it into a coverage at the scale they draw it. 0 (the default) for regular textures.
+  float GetDistanceFieldSpread() const;
 
   bool SetSource(const nglString& rName); ///< Set the image source. Permits to set a global name for an image source instead of the automatically assigned one.
   nglString GetSource() const; ///< Retreive the source name of this texture.
@@ -140,7 +144,9 @@ protected:
   nuiSize mRealWidthPOT;
   nuiSize mRealHeightPOT;
   bool mForceReload;
+  nuiRect mReloadRect;
   bool mRetainBuffer;
+  float mDistanceFieldSpread;
 
   GLuint mMinFilter;
   GLuint mMagFilter;
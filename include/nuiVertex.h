@@ -9,6 +9,7 @@
 
 #include "nui.h"
 #include "nuiFixedPoint.h"
+#include "nuiSpanKernels.h"
 
 #ifdef _WIN32_
 #define NUI_RGBA_ENDIANSAFE_R 2
@@ -129,6 +130,11 @@ public:
   {
     return true;
   }
+
+  void GetSpan(uint32* pColors, const nuiSolidColor& rIncr, int32 count)
+  {
+    nuiSpan_GetKernels().Fill(pColors, mColor, count);
+  }
 };
 
 template <class Source0, class Source1>
@@ -208,6 +214,14 @@ public:
   {
     return mSrc0.IsStable() && mSrc1.IsStable();
   }
+
+  void GetSpan(uint32* pColors, const nuiModulatedColor& rIncr, int32 count)
+  {
+    uint32* pColors1 = (uint32*)alloca(count * sizeof(uint32));
+    mSrc0.GetSpan(pColors, rIncr.mSrc0, count);
+    mSrc1.GetSpan(pColors1, rIncr.mSrc1, count);
+    nuiSpan_GetKernels().Modulate(pColors, pColors1, count);
+  }
 };
 
 
@@ -304,6 +318,17 @@ public:
   {
     return (mR == 0) && (mG == 0) && (mB == 0) && (mA == 0);
   }
+
+  void GetSpan(uint32* pColors, const nuiGouraudColor& rIncr, int32 count)
+  {
+    int32 color[4] = { mR, mG, mB, mA };
+    const int32 incr[4] = { rIncr.mR, rIncr.mG, rIncr.mB, rIncr.mA };
+    nuiSpan_GetKernels().Gouraud(pColors, color, incr, count);
+    mR = color[0];
+    mG = color[1];
+    mB = color[2];
+    mA = color[3];
+  }
 };
 
 class nuiTexelAccessor_Lum
@@ -317,6 +342,16 @@ public:
     const uint8 lum = pBuffer[index];
     return NUI_RGBA(lum, lum, lum, 255);
   }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+    {
+      pColors[i] = GetTexelColor(mpTexture, pBuffer, width, height, U, V);
+      U += IncrU;
+      V += IncrV;
+    }
+  }
 };
 
 class nuiTexelAccessor_Alpha
@@ -330,6 +365,69 @@ public:
     const uint8 alpha = pBuffer[index];
     return NUI_RGBA(255, 255, 255, alpha);
   }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+    {
+      pColors[i] = GetTexelColor(mpTexture, pBuffer, width, height, U, V);
+      U += IncrU;
+      V += IncrV;
+    }
+  }
+};
+
+/// Evaluates the signed distance field of an alpha texture (see nuiTexture::SetDistanceFieldSpread) as a coverage. The distance is
+/// interpolated between the texels and the edge is smoothed over one destination pixel, whatever the scale of the texture.
+class nuiTexelAccessor_DistanceField
+{
+public:
+  static uint32 GetTexelColor(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V)
+  {
+    return GetCoverage(GetDistance(mpTexture, pBuffer, width, height, U, V), 1.0f);
+  }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    // Texels per destination pixel:
+    float scale = (float)MAX(abs(IncrU), abs(IncrV)) / (float)NUI_FP_ONE;
+    if (scale <= 0)
+      scale = 1.0f;
+
+    for (int32 i = 0; i < count; i++)
+    {
+      pColors[i] = GetCoverage(GetDistance(mpTexture, pBuffer, width, height, U, V), scale);
+      U += IncrU;
+      V += IncrV;
+    }
+  }
+
+private:
+  static float GetDistance(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V)
+  {
+    // The texels are sampled at their centers:
+    U -= NUI_FP_HALF;
+    V -= NUI_FP_HALF;
+    const float fu = (float)Frac(U) / (float)NUI_FP_ONE;
+    const float fv = (float)Frac(V) / (float)NUI_FP_ONE;
+    const int32 x0 = MAX(0, MIN(width - 1, ToBelow(U)));
+    const int32 y0 = MAX(0, MIN(height - 1, ToBelow(V)));
+    const int32 x1 = MIN(width - 1, x0 + 1);
+    const int32 y1 = MIN(height - 1, y0 + 1);
+
+    const float top = pBuffer[x0 + width * y0] * (1 - fu) + pBuffer[x1 + width * y0] * fu;
+    const float bottom = pBuffer[x0 + width * y1] * (1 - fu) + pBuffer[x1 + width * y1] * fu;
+    const float value = top * (1 - fv) + bottom * fv;
+
+    // In texels, positive inside:
+    return (value / 255.0f - 0.5f) * 2.0f * mpTexture->GetDistanceFieldSpread();
+  }
+
+  static uint32 GetCoverage(float Distance, float Scale)
+  {
+    const float coverage = MAX(0.0f, MIN(1.0f, Distance / Scale + 0.5f));
+    return NUI_RGBA(255, 255, 255, ToNearest(coverage * 255.0f));
+  }
 };
 
 class nuiTexelAccessor_LumA
@@ -344,6 +442,16 @@ public:
     const uint8 alpha = pBuffer[index + 1];
     return NUI_RGBA(lum, lum, lum, alpha);
   }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    for (int32 i = 0; i < count; i++)
+    {
+      pColors[i] = GetTexelColor(mpTexture, pBuffer, width, height, U, V);
+      U += IncrU;
+      V += IncrV;
+    }
+  }
 };
 
 class nuiTexelAccessor_RGB24
@@ -368,6 +476,11 @@ public:
     const uint8 b = pBuffer[index + 2];
     return NUI_RGBA(r, g, b, 255);
   }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    nuiSpan_GetKernels().FetchRGB24(pColors, pBuffer, width, height, U, V, IncrU, IncrV, count);
+  }
 };
 
 class nuiTexelAccessor_RGBA32
@@ -392,6 +505,11 @@ public:
     const uint8 a = pBuffer[index + 3];
     return NUI_RGBA(r, g, b, a);
   }
+
+  static void GetTexelSpan(nuiTexture* mpTexture, uint8* pBuffer, int32 width, int32 height, ifp32 U, ifp32 V, ifp32 IncrU, ifp32 IncrV, uint32* pColors, int32 count)
+  {
+    nuiSpan_GetKernels().FetchRGBA32(pColors, pBuffer, width, height, U, V, IncrU, IncrV, count);
+  }
 };
 
 
@@ -469,6 +587,13 @@ public:
   {
     return (mU == 0) && (mV == 0);
   }
+
+  void GetSpan(uint32* pColors, const nuiTexelColor& rIncr, int32 count)
+  {
+    TexelAccessor::GetTexelSpan(mpTexture, mpBuffer, mWidth, mHeight, mU, mV, rIncr.mU, rIncr.mV, pColors, count);
+    mU += rIncr.mU * count;
+    mV += rIncr.mV * count;
+  }
 };
 
 
@@ -671,70 +796,29 @@ public:
     return mValue.IsStable();
   }
   
+  void GetSpan(uint32* pColors, const nuiVertex<InterpolatedType>& rIncr, int32 count)
+  {
+    mValue.GetSpan(pColors, rIncr.mValue, count);
+  }
+  
   template <class PixelBlender>
   void DrawHLine(uint32* pBuffer, nuiVertex<InterpolatedType>& v0, int32 width)
   {
     NGL_ASSERT(width > 0);
     
-    if (PixelBlender::CanOptimize())
+    if (IsStable())
+    {
+      PixelBlender::FillSpan(pBuffer, v0.GetColor(), width);
+    }
+    else if (PixelBlender::CanOptimize())
     {
-      if (IsStable())
-      {
-        uint32 color = v0.GetColor();
-        for (int32 i = 0; i < width; i++)
-          pBuffer[i] = color;
-      }
-      else
-      {
-        while (width > 0)
-        {
-          *pBuffer = v0.GetColor();
-          pBuffer++;
-          v0.AddValue(*this);
-          width--;
-        }
-      }
+      v0.GetSpan(pBuffer, *this, width);
     }
     else
     {
-      if (IsStable())
-      {
-        uint32 color = v0.GetColor();
-        while (width > 0)
-        {
-          PixelBlender::Blend(*pBuffer, color);
-          pBuffer++;
-          width--;
-        }
-      }
-      else
-      {
-        if (1)
-        {
-          uint32* local = (uint32*)alloca(width*sizeof(uint32));
-          for (int32 i = 0; i < width; i++)
-          {
-            local[i] = v0.GetColor();
-            v0.AddValue(*this);
-          }
-          
-          for (int32 i = 0; i < width; i++)
-          {
-            PixelBlender::Blend(*pBuffer, local[i]);
-            pBuffer++;
-          }
-        }
-        else
-        {
-          while (width > 0)
-          {
-            PixelBlender::Blend(*pBuffer, v0.GetColor());
-            pBuffer++;
-            v0.AddValue(*this);
-            width--;
-          }
-        }
-      }
+      uint32* local = (uint32*)alloca(width * sizeof(uint32));
+      v0.GetSpan(local, *this, width);
+      PixelBlender::BlendSpan(pBuffer, local, width);
     }
   }
   
@@ -27,6 +27,7 @@ public:
 
 class nuiVoice : public nuiObject
 {
+  friend class nuiAudioEngine;
 public:   
   nuiVoice(const nuiVoice& rVoice);
   nuiVoice& operator=(const nuiVoice& rVoice);
@@ -62,11 +63,27 @@ public:
   
   float GetPan() const;
   void SetPan(float pan);
+  nuiAudioPanLaw GetPanLaw() const;
+  void SetPanLaw(nuiAudioPanLaw Law); ///< eAudioPanBalance by default.
+  
+  void Prepare(int32 MaxSampleFrames, double SampleRate = 0); ///< Allocate the work buffers for blocks of up to MaxSampleFrames at SampleRate (0 keeps the previous rate). nuiAudioEngine does it before the voice reaches the audio thread.
+  virtual void SetOffline(bool Offline); ///< An offline nuiAudioEngine renders faster than real time: the voice must not depend on background work to produce its samples. The engine sets it before playing the voice.
+  
+  /// Rate of the voice's samples, 0 if they are produced at the output rate. When it differs from the rate given to Prepare, the voice is played through a nuiPolyphaseResampler and the position is counted in source frames.
+  virtual double GetSampleRate() const;
+  nuiPolyphaseResampler::Quality GetResamplingQuality() const;
+  void SetResamplingQuality(nuiPolyphaseResampler::Quality quality); ///< eNormal by default. May allocate, call it before playing the voice.
+  bool IsResampling() const;
   
   void PostEvent(const nuiVoiceEvent& rEvent);
 protected:
   virtual int32 ReadSamples(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames) = 0;
-  void ProcessInternal(const std::vector<float*>& rOutput, int32 SampleFrames);
+  virtual bool HasDirectSamples() const; ///< Return true if the samples are in memory and GetDirectSamples can be used instead of ReadSamples.
+  virtual int32 GetDirectSamples(std::vector<const float*>& rChannels, int64 position, int32 SampleFrames); ///< Point rChannels to the samples at position instead of copying them. Returns the number of frames available there.
+  void ProcessInternal(const std::vector<float*>& rOutput, int32 Offset, int32 SampleFrames);
+  int32 ReadSource(int32 SampleFrames); ///< Point mSources to the next samples at the source rate, handles looping and the end of the voice.
+  int32 ReadResampled(int32 SampleFrames); ///< Point mSources to the next samples at the output rate.
+  void MixSamples(const std::vector<float*>& rOutput, int32 SourceOffset, int32 Offset, int32 SampleFrames, float GainLeft, float GainRight, float StartLevel, float EndLevel);
 
   nuiVoice(nuiSound* pSound = NULL);  
   virtual ~nuiVoice();
@@ -87,6 +104,7 @@ protected:
   bool mMute;
   float mGain;
   float mPan;
+  nuiAudioPanLaw mPanLaw;
   int64 mPosition;
   
   bool mFadingIn;
@@ -99,9 +117,24 @@ protected:
   
   nglCriticalSection mCs;
   
+  std::vector<float> mScratchData; ///< ReadSamples destination, see Prepare.
+  std::vector<float*> mScratch;
+  int32 mScratchFrames;
+  std::vector<const float*> mSources; ///< Samples being mixed: mScratch or the voice's own memory.
+  
+  double mOutputSampleRate;
+  nuiPolyphaseResampler::Quality mResamplingQuality;
+  nuiPolyphaseResampler* mpResampler; ///< NULL if the voice plays at the output rate.
+  std::vector<float> mResampleData; ///< ReadSamples destination when resampling.
+  std::vector<float*> mResampleInput;
+  std::vector<const float*> mResampleSources;
+  int32 mResampleFrames;
+  int32 mResampleTail; ///< Frames of silence pushed to the resampler since the end of the source, -1 while the source plays.
+  
   std::vector<nuiVoiceEvent> mEvents;
   nglCriticalSection mEventCs;
   
+  int32 mEngineSlot; ///< Index of this voice in the voice table of the nuiAudioEngine playing it, -1 if it is not playing.
 };
 
 
@@ -37,6 +37,8 @@ class nuiPainter;
  
 class nuiTheme;
 class nuiRectAttributeAnimation;
+class nuiCSS;
+class nuiCSSRule;
 
 class nuiMatrixNode;
 class nuiEventActionHolder;
@@ -462,6 +464,10 @@ public:
   void EnableRenderCache(bool set); ///< Enable or disable the rendering cache that speeds up Widget rendering. Disable the cache if you need to use OpenGL directly in this widget.
   bool IsRenderCacheEnabled(); ///< See EnableRenderCache.
   const nuiMetaPainter* GetRenderCache() const;
+  void EnablePartialRenderCache(bool set); ///< When enabled, moving a child of this widget only redraws it: the render cache is kept since it places the children at their current position. Only enable it if the Draw method doesn't depend on the position of the children. Disabled by default.
+  bool IsPartialRenderCacheEnabled() const; ///< See EnablePartialRenderCache.
+  virtual void ChildMoved(nuiWidgetPtr pChild); ///< Called when the position of pChild changed. Invalidates this widget unless the partial render cache is enabled.
+  virtual uint32 DumpRenderCacheMemory(uint32 Depth = 0); ///< Log the memory used by the render cache of each widget of this branch, indented by depth. Returns the total.
   //@}
 
   /** @name Rendering the widget in a surface */
@@ -592,6 +598,8 @@ public:
   void IncrementCSSPass();
   void ResetCSSPass();
   uint32 GetCSSPass() const;
+  const std::vector<nuiCSSRule*>* GetCSSRules(const nuiCSS* pCSS, uint32 Generation) const; ///< The rules of pCSS that can match this widget as cached by SetCSSRules, NULL if the cache is not valid anymore.
+  void SetCSSRules(const nuiCSS* pCSS, uint32 Generation, const std::vector<nuiCSSRule*>* pRules);
   //@}
 
   NUI_GETSETDO(bool, ReverseRender, Invalidate());
@@ -600,6 +608,10 @@ public:
 
   static void SetGlobalUseRenderCache(bool set);
   static bool GetGlobalUseRenderCache();
+  static void SetGlobalUseCulling(bool set); ///< Skip drawing the branches that have nothing to update and lie outside of the clip rect. True by default.
+  static bool GetGlobalUseCulling();
+  static uint32 GetCulledCount(); ///< Number of widgets skipped by the culling since the last call to ResetCulledCount.
+  static void ResetCulledCount();
 
 protected:
   std::map<nglString, nuiEventSource*, nglString::LessFunctor> mEventMap;
@@ -678,6 +690,11 @@ protected:
 
   static bool mShowFocusDefault;
   static bool mGlobalUseRenderCache;
+  static bool mGlobalUseCulling;
+  static uint32 mCulledCount;
+
+  bool IsClippedOut(nuiDrawContext* pContext, float X = 0, float Y = 0) const; ///< Returns true if this widget, placed with the current matrix of pContext moved by X, Y, doesn't intersect its clip rect.
+  bool CanCull(nuiDrawContext* pContext, float X = 0, float Y = 0) const; ///< Returns true if drawing this branch at X, Y in the current matrix of pContext can be skipped (see SetGlobalUseCulling).
 
 
   bool mAnimateLayout : 1;
@@ -686,6 +703,7 @@ protected:
   bool mInheritAlpha : 1;
   bool mVisible : 1;
   bool mUseRenderCache : 1;
+  bool mPartialRenderCache : 1;
   bool mDrawingInCache : 1;
   bool mNeedInvalidateOnSetRect : 1;
   bool mInteractiveOD : 1;
@@ -785,6 +803,9 @@ protected:
   nuiRectAttributeAnimation* mpLayoutAnimation;
   
   uint32 mCSSPasses;
+  const nuiCSS* mpCSSRulesOwner; ///< See SetCSSRules. The cache is dropped when the class or the name of the widget changes.
+  uint32 mCSSRulesGeneration;
+  const std::vector<nuiCSSRule*>* mpCSSRules;
   virtual void InternalResetCSSPass();
   
   std::vector<nuiRect> mDirtyRects;
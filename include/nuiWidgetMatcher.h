@@ -161,6 +161,11 @@ public:
     return pWidget->IsOfClass(mClassIndex);
   }
   
+  uint32 GetClassIndex() const
+  {
+    return mClassIndex;
+  }
+  
 protected:
   nglString mClass;
   uint32 mClassIndex;
@@ -180,6 +185,11 @@ public:
     return pWidget->GetObjectName() == mName;
   }
   
+  const nglString& GetName() const
+  {
+    return mName;
+  }
+  
 protected:
   nglString mName;
 };
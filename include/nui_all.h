@@ -61,6 +61,8 @@ typedef double nuiSize;
 #include "nuiWaveWriter.h"
 #include "nuiSample.h"
 #include "nuiAudioConvert.h"
+#include "nuiAudioDSP.h"
+#include "nuiPolyphaseResampler.h"
 #include "nuiAiffWriter.h"
 
 
@@ -78,6 +80,7 @@ typedef double nuiSize;
 #include "nuiPathOptimizer.h"
 #include "nuiPolyLine.h"
 #include "nuiTessellator.h"
+#include "nuiTessellationCache.h"
 #include "nuiSpline.h"
 #include "nuiShape.h"
 #include "nuiPoint.h"
@@ -120,6 +123,7 @@ typedef double nuiSize;
 
 #include "nuiTask.h"
 #include "nuiTaskThread.h"
+#include "nuiTaskPool.h"
 #include "nuiAttributeAnimation.h"
 #include "nuiLocale.h"
 #include "nuiMessageQueue.h"
@@ -156,6 +160,7 @@ typedef double nuiSize;
   #include "nuiFontBase.h"
   #include "nuiFont.h"
   #include "nuiFontManager.h"
+  #include "nuiShapedRunCache.h"
 
   #include "nuiGradient.h"
   #include "nuiDrawContext.h"
@@ -164,6 +169,7 @@ typedef double nuiSize;
   #include "nuiGLPainter.h"
   #include "nuiGL2Painter.h"
   #include "nuiMetaPainter.h"
+  #include "nuiBatchPainter.h"
   #include "nuiSoftwarePainter.h"
 
 
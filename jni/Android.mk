@@ -88,6 +88,10 @@ NUI_LOCAL_SRC_FILES_ATTRIBUTES := ../src/Attributes/nuiAttribute.cpp \
                                   ../src/Attributes/nuiPopupValueAttributeEditor.cpp \
 
 NUI_LOCAL_SRC_FILES_AUDIO := ../src/Audio/nuiAudioConvert.cpp \
+                             ../src/Audio/nuiAudioConvert_SSE2.cpp \
+                             ../src/Audio/nuiAudioDSP.cpp \
+                             ../src/Audio/nuiPolyphaseResampler.cpp \
+                             ../src/Audio/nuiAudioConvert_AVX2.cpp \
                              ../src/Audio/nuiAudioFifo.cpp \
                              ../src/Audio/nuiAudioDevice.cpp \
                              ../src/Audio/Android/nuiAudioDevice_Android.cpp \
@@ -144,6 +148,7 @@ NUI_LOCAL_SRC_FILES_BASE := ../src/Base/nuiBindingManager.cpp \
                             ../src/Base/nuiXML.cpp \
                             ../src/Base/nuiApplication.cpp \
                             ../src/Base/nuiTask.cpp \
+                            ../src/Base/nuiTaskPool.cpp \
                             ../src/Base/nuiHTML.cpp \
 
 
@@ -177,6 +182,7 @@ NUI_LOCAL_SRC_FILES_FILE := ../src/File/nglFile.cpp \
 
 NUI_LOCAL_SRC_FILES_FONT := ../src/Font/nuiFont.cpp \
                             ../src/Font/nuiFontBase.cpp \
+                            ../src/Font/nuiShapedRunCache.cpp \
                             ../src/Font/nuiFontManager.cpp \
                             ../src/Font/hb_nui.cpp \
                             ../src/Font/nuiTextLayout.cpp \
@@ -277,6 +283,12 @@ NUI_LOCAL_SRC_FILES_RENDERERS_SHAPES_CONTOURS := ../src/Renderers/nuiArc.cpp \
                                                  ../src/Renderers/nuiUniformDesc.cpp \
                                                  ../src/Renderers/nuiVertexAttribDesc.cpp \
                                                  ../src/Renderers/nuiTessellator.cpp \
+                                                 ../src/Renderers/nuiSpanKernels.cpp \
+                                                 ../src/Renderers/nuiSpanKernels_SSE2.cpp \
+                                                 ../src/Renderers/nuiSpanKernels_AVX2.cpp \
+                                                 ../src/Renderers/nuiCoverageRasterizer.cpp \
+                                                 ../src/Renderers/nuiBatchPainter.cpp \
+                                                 ../src/Renderers/nuiTessellationCache.cpp \
 
 NUI_LOCAL_SRC_FILES_RENDERERS := ../src/Renderers/nuiDrawContext.cpp \
                                  ../src/Renderers/nuiRenderArray.cpp \
@@ -119,6 +119,10 @@ solution "minui3"
             -- "src/Application/nuiLocale.cpp",
 
             "src/Audio/nuiAudioConvert.cpp",
+            "src/Audio/nuiAudioConvert_AVX2.cpp",
+            "src/Audio/nuiAudioConvert_SSE2.cpp",
+            "src/Audio/nuiAudioDSP.cpp",
+            "src/Audio/nuiPolyphaseResampler.cpp",
             "src/AudioSamples/*.cpp",
             "src/AudioSamples/Unix/*.cpp",
 
@@ -162,6 +166,7 @@ solution "minui3"
             "src/Base/nuiNotification.cpp",
             "src/Base/nuiSignalsSlots.cpp",
             "src/Base/nuiTask.cpp",
+            "src/Base/nuiTaskPool.cpp",
             "src/Base/nuiTimer.cpp",
             "src/Base/nuiToken.cpp",
             "src/Base/nuiTree.cpp",
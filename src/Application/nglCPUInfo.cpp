@@ -28,6 +28,7 @@ uint nglCPUInfo::mCount   = 0; // 0 CPU means we do not have any info on the cur
 bool nglCPUInfo::mMMX     = false;
 bool nglCPUInfo::mSSE     = false;
 bool nglCPUInfo::mSSE2    = false;
+bool nglCPUInfo::mAVX2    = false;
 bool nglCPUInfo::m3DNow   = false;
 bool nglCPUInfo::mAltivec = false;
 
@@ -62,6 +63,12 @@ bool nglCPUInfo::HasSSE2()
   return mSSE2;
 }
 
+bool nglCPUInfo::HasAVX2()
+{
+  FillCPUInfo();
+  return mAVX2;
+}
+
 bool nglCPUInfo::Has3DNow()
 {
   FillCPUInfo();
@@ -101,10 +108,11 @@ nglString nglCPUInfo::Dump()
     text += _T(" x %d");
   }
 
-  buffer.Format(_T("%s%s%s%s%s"),
+  buffer.Format(_T("%s%s%s%s%s%s"),
     HasMMX()     ? _T(" MMX") : _T(""),
     HasSSE()     ? _T(" SSE") : _T(""),
     HasSSE2()    ? _T(" SSE2") : _T(""),
+    HasAVX2()    ? _T(" AVX2") : _T(""),
     Has3DNow()   ? _T(" 3DNow") : _T(""),
     HasAltivec() ? _T(" Altivec") : _T(""));
   if (buffer.GetLength())
@@ -119,5 +127,18 @@ nglString nglCPUInfo::Dump()
 #ifndef _WIN32_
 void nglCPUInfo::FillCPUInfo()
 {
+  if (mCount)
+    return;
+
+#if (defined _NGL_X86_ || defined _NGL_X64_) && (defined __GNUC__)
+  __builtin_cpu_init();
+  mMMX  = __builtin_cpu_supports("mmx") != 0;
+  mSSE  = __builtin_cpu_supports("sse") != 0;
+  mSSE2 = __builtin_cpu_supports("sse2") != 0;
+  mAVX2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  mCount = (count > 0) ? (uint)count : 1;
 }
 #endif // _WIN32_
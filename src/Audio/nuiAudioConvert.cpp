@@ -8,14 +8,121 @@
 #include "nui.h"
 
 
-void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames)
+#include "nuiAudioConvert_SIMD.h"
+
+// Scalar kernels, used as is when the CPU has no usable vector unit and by the vector kernels to process the remaining samples.
+static void Int16ToFloat_Scalar(const int16* pIn, float* pOut, int64 count)
+{
+  static const float mult1 = 1.0 / NUI_AUDIOCONVERT_INT16_NEG;
+  static const float mult2 = 1.0 / NUI_AUDIOCONVERT_INT16_POS;
+
+  for (int64 i = 0; i < count; i++)
+  {
+    float in = pIn[i];
+    if (in < 0)
+      pOut[i] = in * mult1;
+    else
+      pOut[i] = in * mult2;
+  }
+}
+
+static void FloatToInt16_Scalar(const float* pIn, int16* pOut, int64 count)
+{
+  for (int64 i = 0; i < count; i++)
+  {
+    float in = nuiClamp(pIn[i], -1.0f, 1.0f);
+    if (in < 0)
+      pOut[i] = ToZero(in * NUI_AUDIOCONVERT_INT16_NEG);
+    else
+      pOut[i] = ToZero(in * NUI_AUDIOCONVERT_INT16_POS);
+  }
+}
+
+static void FloatToInt16Dither_Scalar(const float* pIn, int16* pOut, int64 count, uint32& rSeed)
+{
+  uint32 states[NUI_AUDIOCONVERT_DITHER_LANES];
+  nuiAudioConvert_DitherBegin(rSeed, states);
+  nuiAudioConvert_DitherSamples(pIn, pOut, count, states);
+}
+
+static void Int24LEToFloat_Scalar(const uint8* pIn, float* pOut, int64 count)
+{
+  for (int64 i = 0; i < count; i++)
+    pOut[i] = nuiAudioConvert_24bitsToFloatFromLittleEndian(const_cast<uint8*>(pIn + 3 * i));
+}
+
+static void FloatToInt24LE_Scalar(const float* pIn, uint8* pOut, int64 count)
 {
-  static const float mult1 = 1.0 / 32768.0f;
-  static const float mult2 = 1.0 / 32767.0f;
-  int32 j;
+  for (int64 i = 0; i < count; i++)
+  {
+    float value = nuiClamp(pIn[i], -1.0f, 1.0f);
+    int32 TempInt32;
+    if (value < 0)
+      TempInt32 = ToZero(value * NUI_AUDIOCONVERT_INT24_NEG);
+    else
+      TempInt32 = ToZero(value * NUI_AUDIOCONVERT_INT24_POS);
+
+    pOut[3 * i] = (uint8)(TempInt32);
+    pOut[3 * i + 1] = (uint8)(TempInt32 >> 8);
+    pOut[3 * i + 2] = (uint8)(TempInt32 >> 16);
+  }
+}
+
+static void Int32ToFloat_Scalar(const int32* pIn, float* pOut, int64 count)
+{
+  static const float mult1 = 1.0 / NUI_AUDIOCONVERT_INT32_NEG;
+  static const float mult2 = 1.0 / NUI_AUDIOCONVERT_INT32_POS;
+
+  for (int64 i = 0; i < count; i++)
+  {
+    if (pIn[i] < 0)
+      pOut[i] = pIn[i] * mult1;
+    else
+      pOut[i] = pIn[i] * mult2;
+  }
+}
+
+static void FloatToInt32_Scalar(const float* pIn, int32* pOut, int64 count)
+{
+  for (int64 i = 0; i < count; i++)
+  {
+    float value = nuiClamp(pIn[i], -1.0f, 1.0f);
+    if (value < 0)
+      pOut[i] = ToZero(value * NUI_AUDIOCONVERT_INT32_NEG);
+    else
+      pOut[i] = ToZero(MIN(value * NUI_AUDIOCONVERT_INT32_POS, NUI_AUDIOCONVERT_INT32_MAXFLOAT));
+  }
+}
+
+static void Interleave_Scalar(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  for (int32 c = 0; c < nbChannels; c++)
+  {
+    const float* pChannel = pIn[c];
+    float* pDest = pOut + c;
+    for (int64 i = 0; i < nbSampleFrames; i++, pDest += nbChannels)
+      *pDest = pChannel[i];
+  }
+}
+
+static void Deinterleave_Scalar(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  for (int32 c = 0; c < nbChannels; c++)
+  {
+    float* pChannel = pOut[c];
+    const float* pSrc = pIn + c;
+    for (int64 i = 0; i < nbSampleFrames; i++, pSrc += nbChannels)
+      pChannel[i] = *pSrc;
+  }
+}
+
+static void INint16ToDEfloat_Scalar(const int16* input, float* output, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
+{
+  static const float mult1 = 1.0 / NUI_AUDIOCONVERT_INT16_NEG;
+  static const float mult2 = 1.0 / NUI_AUDIOCONVERT_INT16_POS;
 
   input += curChannel;
-  for (j = 0; j < nbSampleFrames; j++)
+  for (int64 j = 0; j < nbSampleFrames; j++)
   {
     int16 in = *input;
 
@@ -28,26 +135,177 @@ void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, int32 c
   }
 }
 
-
-
-void nuiAudioConvert_DEfloatToINint16(const float* input, int16* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames) // de-interlaced float to interlaced int16
+static void DEfloatToINint16_Scalar(const float* input, int16* output, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
 {
-  static const float mult1 = 32768.0f ;
-  static const float mult2 = 32767.0f ;
-  int32 j;
-
   output += curChannel;
-  for (j=0; j < nbSampleFrames; j++)
+  for (int64 j = 0; j < nbSampleFrames; j++)
   {
     float in = *input++;
     in = nuiClamp(in, -1.0f, 1.0f);
     if (in < 0)
-      *output = ToZero(in * mult1);
+      *output = ToZero(in * NUI_AUDIOCONVERT_INT16_NEG);
     else
-      *output = ToZero(in * mult2);
+      *output = ToZero(in * NUI_AUDIOCONVERT_INT16_POS);
 
     output += nbChannels;
-  } 
+  }
+}
+
+const nuiAudioConvertKernels gAudioConvertKernels_Scalar =
+{
+  Int16ToFloat_Scalar,
+  FloatToInt16_Scalar,
+  FloatToInt16Dither_Scalar,
+  Int24LEToFloat_Scalar,
+  FloatToInt24LE_Scalar,
+  Int32ToFloat_Scalar,
+  FloatToInt32_Scalar,
+  Interleave_Scalar,
+  Deinterleave_Scalar,
+  INint16ToDEfloat_Scalar,
+  DEfloatToINint16_Scalar
+};
+
+
+// Runtime dispatch:
+static const nuiAudioConvertKernels* GetKernels(nuiAudioConvertImplementation Implementation)
+{
+  switch (Implementation)
+  {
+#ifdef NUI_AUDIOCONVERT_X86
+    case eAudioConvertSSE2:
+      return nglCPUInfo::HasSSE2() ? &gAudioConvertKernels_SSE2 : NULL;
+    case eAudioConvertAVX2:
+      return nglCPUInfo::HasAVX2() ? &gAudioConvertKernels_AVX2 : NULL;
+#endif
+    case eAudioConvertScalar:
+      return &gAudioConvertKernels_Scalar;
+    default:
+      return NULL;
+  }
+}
+
+static nuiAudioConvertImplementation GetBestImplementation()
+{
+  if (GetKernels(eAudioConvertAVX2))
+    return eAudioConvertAVX2;
+  if (GetKernels(eAudioConvertSSE2))
+    return eAudioConvertSSE2;
+  return eAudioConvertScalar;
+}
+
+// The pointer is only ever swapped between static tables, a reader racing with nuiAudioConvert_SetImplementation uses either one.
+static std::atomic<const nuiAudioConvertKernels*> gpAudioConvertKernels(NULL);
+static std::atomic<nuiAudioConvertImplementation> gAudioConvertImplementation(eAudioConvertScalar);
+
+static inline const nuiAudioConvertKernels& Kernels()
+{
+  const nuiAudioConvertKernels* pKernels = gpAudioConvertKernels.load(std::memory_order_acquire);
+  if (pKernels)
+    return *pKernels;
+
+  nuiAudioConvertImplementation implementation = GetBestImplementation();
+  pKernels = GetKernels(implementation);
+  gAudioConvertImplementation.store(implementation, std::memory_order_relaxed);
+  gpAudioConvertKernels.store(pKernels, std::memory_order_release);
+  return *pKernels;
+}
+
+bool nuiAudioConvert_SetImplementation(nuiAudioConvertImplementation Implementation)
+{
+  const nuiAudioConvertKernels* pKernels = GetKernels(Implementation);
+  if (!pKernels)
+    return false;
+  gAudioConvertImplementation.store(Implementation, std::memory_order_relaxed);
+  gpAudioConvertKernels.store(pKernels, std::memory_order_release);
+  return true;
+}
+
+bool nuiAudioConvert_IsImplementationAvailable(nuiAudioConvertImplementation Implementation)
+{
+  return GetKernels(Implementation) != NULL;
+}
+
+nuiAudioConvertImplementation nuiAudioConvert_GetImplementation()
+{
+  Kernels();
+  return gAudioConvertImplementation.load(std::memory_order_relaxed);
+}
+
+void nuiAudioConvert_ResetImplementation()
+{
+  nuiAudioConvert_SetImplementation(GetBestImplementation());
+}
+
+const char* nuiAudioConvert_GetImplementationName(nuiAudioConvertImplementation Implementation)
+{
+  switch (Implementation)
+  {
+    case eAudioConvertScalar: return "Scalar";
+    case eAudioConvertSSE2: return "SSE2";
+    case eAudioConvertAVX2: return "AVX2";
+    default: return "Unknown";
+  }
+}
+
+
+// Buffer conversions:
+void nuiAudioConvert_Int16ToFloat(const int16* pIn, float* pOut, int64 count)
+{
+  Kernels().Int16ToFloat(pIn, pOut, count);
+}
+
+void nuiAudioConvert_FloatToInt16(const float* pIn, int16* pOut, int64 count)
+{
+  Kernels().FloatToInt16(pIn, pOut, count);
+}
+
+void nuiAudioConvert_FloatToInt16Dither(const float* pIn, int16* pOut, int64 count, uint32& rDitherState)
+{
+  Kernels().FloatToInt16Dither(pIn, pOut, count, rDitherState);
+}
+
+void nuiAudioConvert_Int24LEToFloat(const uint8* pIn, float* pOut, int64 count)
+{
+  Kernels().Int24LEToFloat(pIn, pOut, count);
+}
+
+void nuiAudioConvert_FloatToInt24LE(const float* pIn, uint8* pOut, int64 count)
+{
+  Kernels().FloatToInt24LE(pIn, pOut, count);
+}
+
+void nuiAudioConvert_Int32ToFloat(const int32* pIn, float* pOut, int64 count)
+{
+  Kernels().Int32ToFloat(pIn, pOut, count);
+}
+
+void nuiAudioConvert_FloatToInt32(const float* pIn, int32* pOut, int64 count)
+{
+  Kernels().FloatToInt32(pIn, pOut, count);
+}
+
+void nuiAudioConvert_Interleave(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  Kernels().Interleave(pIn, pOut, nbChannels, nbSampleFrames);
+}
+
+void nuiAudioConvert_Deinterleave(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  Kernels().Deinterleave(pIn, pOut, nbChannels, nbSampleFrames);
+}
+
+
+void nuiAudioConvert_INint16ToDEfloat(const int16* input, float* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames)
+{
+  Kernels().INint16ToDEfloat(input, output, curChannel, nbChannels, nbSampleFrames);
+}
+
+
+
+void nuiAudioConvert_DEfloatToINint16(const float* input, int16* output, int32 curChannel, int32 nbChannels, int32 nbSampleFrames) // de-interlaced float to interlaced int16
+{
+  Kernels().DEfloatToINint16(input, output, curChannel, nbChannels, nbSampleFrames);
 }
 
 /*
@@ -142,36 +400,13 @@ void nuiAudioConvert_Signed8bitsBufferToFloat(float* pBuffer, int64 SizeToRead)
 //////////////////////////////////////
 void nuiAudioConvert_16bitsBufferToFloat(float* pBuffer, int64 SizeToRead)
 {
-  static const float mult1 = 1.0 / 32768.0f;
-  static const float mult2 = 1.0 / 32767.0f;
-  
-  float Temp;
-  
-  int64 i;
-  for (i = 0; i< SizeToRead; i++)
-  {
-    Temp = ((int16*)pBuffer)[ SizeToRead + i ];
-    if (Temp < 0)
-      pBuffer[i] = Temp * mult1;
-    else
-      pBuffer[i] = Temp * mult2;
-  }
+  // The int16 samples sit in the second half of the buffer, the kernels work forward and read each block before writing it:
+  Kernels().Int16ToFloat(((int16*)pBuffer) + SizeToRead, pBuffer, SizeToRead);
 }
 
 void nuiAudioConvert_FloatBufferTo16bits(float* pFloatBuffer, int16* pInt16Buffer, int64 SizeToRead)
 {
-  static const float mult1 = 32768.0f;
-  static const float mult2 = 32767.0f;
-  float Temp;
-  for (int64 i = 0; i< SizeToRead; i++)
-  {
-    Temp = pFloatBuffer[i];
-    Temp = nuiClamp(Temp, -1.0f, 1.0f);
-    if (Temp < 0)
-      pInt16Buffer[i] = ToZero(Temp * mult1);
-    else
-      pInt16Buffer[i] = ToZero(Temp * mult2);
-  }
+  Kernels().FloatToInt16(pFloatBuffer, pInt16Buffer, SizeToRead);
 }
 
 
@@ -211,34 +446,7 @@ float nuiAudioConvert_24bitsToFloatFromBigEndian(uint8* pBytesBuf)
 //
 void nuiAudioConvert_FloatTo24bitsLittleEndian(float* pInBuffer, uint8* pOutBuffer, int64 SizeToRead)
 {
-  static const float mult1 = 8388608.0f ;
-  static const float mult2 = 8388607.0f ;
-  
-  int32 TempInt32;
-  
-  int64 i;
-  for ( i = 0; i < SizeToRead; i++)
-  {
-    float value = pInBuffer[i];
-    value = nuiClamp(value, -1.0f, 1.0f);
-    if ( pInBuffer[i] < 0 )
-    {
-      TempInt32 = ToZero( value * mult1 );
-      NGL_ASSERT(TempInt32 <= 0);
-      NGL_ASSERT(TempInt32 >= -8388608);
-    }
-    else
-    {
-      TempInt32 = ToZero( value * mult2 );
-      NGL_ASSERT(TempInt32 >= 0);
-      NGL_ASSERT(TempInt32 <= 8388607);
-    }
-      
-    
-    pOutBuffer[ 3 * i] = (uint8)(TempInt32);
-    pOutBuffer[ 3 * i + 1] = (uint8)(TempInt32>>8);
-    pOutBuffer[ 3 * i + 2] = (uint8)(TempInt32>>16);
-  }
+  Kernels().FloatToInt24LE(pInBuffer, pOutBuffer, SizeToRead);
 }
 
 void nuiAudioConvert_FloatTo24bitsBigEndian(float* pInBuffer, uint8* pOutBuffer, int64 SizeToRead)
@@ -274,33 +482,12 @@ void nuiAudioConvert_FloatTo24bitsBigEndian(float* pInBuffer, uint8* pOutBuffer,
 
 void nuiAudioConvert_FloatTo32bits(float* pInBuffer, int32* pOutBuffer, int64 SizeToRead)
 {
-  static const float mult1 = 2147483648.0f ;
-  static const float mult2 = 2147483647.0f ;
-  
-  int64 i;
-  for ( i = 0; i < SizeToRead; i++)
-  {
-    float value = nuiClamp(pInBuffer[i], -1.0f, 1.0f);
-    if (value < 0 )
-      pOutBuffer[i] = ToZero(value * mult1);
-    else
-      pOutBuffer[i] = ToZero(value * mult2);
-  }  
+  Kernels().FloatToInt32(pInBuffer, pOutBuffer, SizeToRead);
 }
 
 
 void nuiAudioConvert_32bitsToFloat(int32* pInBuffer, float* pOutBuffer, int64 SizeToRead)
 {
-  static const float mult1 =  1.0 / 2147483648.0f ;
-  static const float mult2 = 1.0 / 2147483647.0f ;
-  
-  int64 i;
-  for ( i = 0; i < SizeToRead; i++)
-  {
-    if (pInBuffer[i] < 0)
-      pOutBuffer[i] = pInBuffer[i] * mult1;
-    else
-      pOutBuffer[i] = pInBuffer[i] * mult2;
-  }
+  Kernels().Int32ToFloat(pInBuffer, pOutBuffer, SizeToRead);
 }
 
@@ -0,0 +1,287 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiAudioConvert_SIMD.h"
+
+#ifdef NUI_AUDIOCONVERT_X86
+
+#include <immintrin.h>
+
+NGL_TARGET_BEGIN("avx2")
+
+// Integer to float with the asymmetric scaling, branchless:
+static inline __m256 ScaleToFloat(__m256i in, __m256 neg, __m256 pos)
+{
+  __m256 f = _mm256_cvtepi32_ps(in);
+  return _mm256_mul_ps(f, _mm256_blendv_ps(pos, neg, _mm256_cmp_ps(f, _mm256_setzero_ps(), _CMP_LT_OQ)));
+}
+
+// Clamp, scale and truncate:
+static inline __m256i ScaleToInt(__m256 in, __m256 neg, __m256 pos)
+{
+  in = _mm256_min_ps(_mm256_max_ps(in, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+  return _mm256_cvttps_epi32(_mm256_mul_ps(in, _mm256_blendv_ps(pos, neg, _mm256_cmp_ps(in, _mm256_setzero_ps(), _CMP_LT_OQ))));
+}
+
+// packs works inside each 128 bits lane, put the 64 bits quarters back in order:
+static inline __m256i PackInt16(__m256i a, __m256i b)
+{
+  return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static void Int16ToFloat_AVX2(const int16* pIn, float* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_NEG));
+  const __m256 pos = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_POS));
+
+  int64 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pIn + i)));
+    __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pIn + i + 8)));
+    _mm256_storeu_ps(pOut + i, ScaleToFloat(lo, neg, pos));
+    _mm256_storeu_ps(pOut + i + 8, ScaleToFloat(hi, neg, pos));
+  }
+  gAudioConvertKernels_SSE2.Int16ToFloat(pIn + i, pOut + i, count - i);
+}
+
+static void FloatToInt16_AVX2(const float* pIn, int16* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps(NUI_AUDIOCONVERT_INT16_NEG);
+  const __m256 pos = _mm256_set1_ps(NUI_AUDIOCONVERT_INT16_POS);
+
+  int64 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = ScaleToInt(_mm256_loadu_ps(pIn + i), neg, pos);
+    __m256i hi = ScaleToInt(_mm256_loadu_ps(pIn + i + 8), neg, pos);
+    _mm256_storeu_si256((__m256i*)(pOut + i), PackInt16(lo, hi));
+  }
+  gAudioConvertKernels_SSE2.FloatToInt16(pIn + i, pOut + i, count - i);
+}
+
+// Eight xorshift32 generators in parallel, returns floats in [0, 1):
+static inline __m256 DitherRandom(__m256i& rState)
+{
+  rState = _mm256_xor_si256(rState, _mm256_slli_epi32(rState, 13));
+  rState = _mm256_xor_si256(rState, _mm256_srli_epi32(rState, 17));
+  rState = _mm256_xor_si256(rState, _mm256_slli_epi32(rState, 5));
+  __m256i bits = _mm256_or_si256(_mm256_srli_epi32(rState, 9), _mm256_set1_epi32(0x3f800000));
+  return _mm256_sub_ps(_mm256_castsi256_ps(bits), _mm256_set1_ps(1.0f));
+}
+
+// Clamp, scale, add the noise and round half up like floorf(x + 0.5f):
+static inline __m256i DitherToInt(__m256 in, __m256i& rState)
+{
+  const __m256 r0 = DitherRandom(rState);
+  const __m256 r1 = DitherRandom(rState);
+  __m256 value = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(in, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f)), _mm256_set1_ps(NUI_AUDIOCONVERT_INT16_POS));
+  value = _mm256_add_ps(_mm256_add_ps(value, _mm256_sub_ps(r0, r1)), _mm256_set1_ps(0.5f));
+  return _mm256_cvttps_epi32(_mm256_floor_ps(value));
+}
+
+static void FloatToInt16Dither_AVX2(const float* pIn, int16* pOut, int64 count, uint32& rSeed)
+{
+  uint32 states[NUI_AUDIOCONVERT_DITHER_LANES];
+  nuiAudioConvert_DitherBegin(rSeed, states);
+  __m256i state = _mm256_loadu_si256((const __m256i*)states);
+
+  int64 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = DitherToInt(_mm256_loadu_ps(pIn + i), state);
+    __m256i hi = DitherToInt(_mm256_loadu_ps(pIn + i + 8), state);
+    _mm256_storeu_si256((__m256i*)(pOut + i), PackInt16(lo, hi)); // Saturates to the int16 range
+  }
+
+  _mm256_storeu_si256((__m256i*)states, state);
+  nuiAudioConvert_DitherSamples(pIn + i, pOut + i, count - i, states);
+}
+
+static void Int24LEToFloat_AVX2(const uint8* pIn, float* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT24_NEG));
+  const __m256 pos = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT24_POS));
+  // Move each 3 bytes sample to the top of a 32 bits word (0x80 clears the byte), the arithmetic shift then sign extends it:
+  const __m256i spread = _mm256_setr_epi8(
+    (char)0x80, 0, 1, 2, (char)0x80, 3, 4, 5, (char)0x80, 6, 7, 8, (char)0x80, 9, 10, 11,
+    (char)0x80, 0, 1, 2, (char)0x80, 3, 4, 5, (char)0x80, 6, 7, 8, (char)0x80, 9, 10, 11);
+
+  // Each 16 bytes load only uses 12 bytes: keep 4 bytes of slack after the last block.
+  int64 i = 0;
+  for (; i + 8 + 2 <= count; i += 8)
+  {
+    const uint8* p = pIn + 3 * i;
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)), _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+    __m256i samples = _mm256_srai_epi32(_mm256_shuffle_epi8(in, spread), 8);
+    _mm256_storeu_ps(pOut + i, ScaleToFloat(samples, neg, pos));
+  }
+  gAudioConvertKernels_SSE2.Int24LEToFloat(pIn + 3 * i, pOut + i, count - i);
+}
+
+static void FloatToInt24LE_AVX2(const float* pIn, uint8* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps(NUI_AUDIOCONVERT_INT24_NEG);
+  const __m256 pos = _mm256_set1_ps(NUI_AUDIOCONVERT_INT24_POS);
+  // Pack the 3 low bytes of each 32 bits word at the start of the lane:
+  const __m256i pack = _mm256_setr_epi8(
+    0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, (char)0x80, (char)0x80, (char)0x80, (char)0x80,
+    0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, (char)0x80, (char)0x80, (char)0x80, (char)0x80);
+
+  // Each lane is stored with a 16 bytes write of which only 12 bytes are valid: keep 4 bytes of slack after the last block,
+  // they are overwritten by the next block or by the tail.
+  int64 i = 0;
+  for (; i + 8 + 2 <= count; i += 8)
+  {
+    __m256i packed = _mm256_shuffle_epi8(ScaleToInt(_mm256_loadu_ps(pIn + i), neg, pos), pack);
+    uint8* p = pOut + 3 * i;
+    _mm_storeu_si128((__m128i*)p, _mm256_castsi256_si128(packed));
+    _mm_storeu_si128((__m128i*)(p + 12), _mm256_extracti128_si256(packed, 1));
+  }
+  gAudioConvertKernels_SSE2.FloatToInt24LE(pIn + i, pOut + 3 * i, count - i);
+}
+
+static void Int32ToFloat_AVX2(const int32* pIn, float* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT32_NEG));
+  const __m256 pos = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT32_POS));
+
+  int64 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i in0 = _mm256_loadu_si256((const __m256i*)(pIn + i));
+    __m256i in1 = _mm256_loadu_si256((const __m256i*)(pIn + i + 8));
+    _mm256_storeu_ps(pOut + i, ScaleToFloat(in0, neg, pos));
+    _mm256_storeu_ps(pOut + i + 8, ScaleToFloat(in1, neg, pos));
+  }
+  gAudioConvertKernels_SSE2.Int32ToFloat(pIn + i, pOut + i, count - i);
+}
+
+static void FloatToInt32_AVX2(const float* pIn, int32* pOut, int64 count)
+{
+  const __m256 neg = _mm256_set1_ps(NUI_AUDIOCONVERT_INT32_NEG);
+  const __m256 pos = _mm256_set1_ps(NUI_AUDIOCONVERT_INT32_POS);
+  const __m256 minus1 = _mm256_set1_ps(-1.0f);
+  const __m256 plus1 = _mm256_set1_ps(1.0f);
+  const __m256 top = _mm256_set1_ps(NUI_AUDIOCONVERT_INT32_MAXFLOAT);
+
+  int64 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 in = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i), minus1), plus1);
+    __m256 scaled = _mm256_mul_ps(in, _mm256_blendv_ps(pos, neg, _mm256_cmp_ps(in, _mm256_setzero_ps(), _CMP_LT_OQ)));
+    _mm256_storeu_si256((__m256i*)(pOut + i), _mm256_cvttps_epi32(_mm256_min_ps(scaled, top)));
+  }
+  gAudioConvertKernels_SSE2.FloatToInt32(pIn + i, pOut + i, count - i);
+}
+
+static void Interleave_AVX2(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.Interleave(pIn, pOut, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  const float* pLeft = pIn[0];
+  const float* pRight = pIn[1];
+  int64 i = 0;
+  for (; i + 8 <= nbSampleFrames; i += 8)
+  {
+    __m256 l = _mm256_loadu_ps(pLeft + i);
+    __m256 r = _mm256_loadu_ps(pRight + i);
+    __m256 lo = _mm256_unpacklo_ps(l, r); // L0 R0 L1 R1 | L4 R4 L5 R5
+    __m256 hi = _mm256_unpackhi_ps(l, r); // L2 R2 L3 R3 | L6 R6 L7 R7
+    _mm256_storeu_ps(pOut + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(pOut + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+  const float* pTail[2] = { pLeft + i, pRight + i };
+  gAudioConvertKernels_SSE2.Interleave(pTail, pOut + 2 * i, 2, nbSampleFrames - i);
+}
+
+static void Deinterleave_AVX2(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.Deinterleave(pIn, pOut, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  float* pLeft = pOut[0];
+  float* pRight = pOut[1];
+  int64 i = 0;
+  for (; i + 8 <= nbSampleFrames; i += 8)
+  {
+    __m256 a = _mm256_loadu_ps(pIn + 2 * i);
+    __m256 b = _mm256_loadu_ps(pIn + 2 * i + 8);
+    __m256 t0 = _mm256_permute2f128_ps(a, b, 0x20); // L0 R0 L1 R1 | L4 R4 L5 R5
+    __m256 t1 = _mm256_permute2f128_ps(a, b, 0x31); // L2 R2 L3 R3 | L6 R6 L7 R7
+    _mm256_storeu_ps(pLeft + i, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm256_storeu_ps(pRight + i, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  float* pTail[2] = { pLeft + i, pRight + i };
+  gAudioConvertKernels_SSE2.Deinterleave(pIn + 2 * i, pTail, 2, nbSampleFrames - i);
+}
+
+static void INint16ToDEfloat_AVX2(const int16* pIn, float* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels == 1)
+  {
+    Int16ToFloat_AVX2(pIn, pOut, nbSampleFrames);
+    return;
+  }
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.INint16ToDEfloat(pIn, pOut, curChannel, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  // Stereo: each 32 bits word holds one frame, the arithmetic shifts pick the channel and sign extend it.
+  const __m256 neg = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_NEG));
+  const __m256 pos = _mm256_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_POS));
+  const __m128i shift = _mm_cvtsi32_si128(curChannel ? 0 : 16);
+
+  int64 i = 0;
+  for (; i + 8 <= nbSampleFrames; i += 8)
+  {
+    __m256i in = _mm256_loadu_si256((const __m256i*)(pIn + 2 * i));
+    __m256i samples = _mm256_srai_epi32(_mm256_sll_epi32(in, shift), 16);
+    _mm256_storeu_ps(pOut + i, ScaleToFloat(samples, neg, pos));
+  }
+  gAudioConvertKernels_SSE2.INint16ToDEfloat(pIn + 2 * i, pOut + i, curChannel, nbChannels, nbSampleFrames - i);
+}
+
+static void DEfloatToINint16_AVX2(const float* pIn, int16* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels == 1)
+  {
+    FloatToInt16_AVX2(pIn, pOut, nbSampleFrames);
+    return;
+  }
+  gAudioConvertKernels_Scalar.DEfloatToINint16(pIn, pOut, curChannel, nbChannels, nbSampleFrames);
+}
+
+const nuiAudioConvertKernels gAudioConvertKernels_AVX2 =
+{
+  Int16ToFloat_AVX2,
+  FloatToInt16_AVX2,
+  FloatToInt16Dither_AVX2,
+  Int24LEToFloat_AVX2,
+  FloatToInt24LE_AVX2,
+  Int32ToFloat_AVX2,
+  FloatToInt32_AVX2,
+  Interleave_AVX2,
+  Deinterleave_AVX2,
+  INint16ToDEfloat_AVX2,
+  DEfloatToINint16_AVX2
+};
+
+NGL_TARGET_END
+
+#endif
+
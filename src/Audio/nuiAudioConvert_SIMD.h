@@ -0,0 +1,102 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+// Sample format conversion kernels. There is one table per instruction set, nuiAudioConvert.cpp picks one at runtime (see nuiAudioConvert_SetImplementation).
+// All the kernels process the buffers forward and read a block of samples before writing it, which keeps the legacy in-place expansions
+// (nuiAudioConvert_16bitsBufferToFloat...) valid.
+class nuiAudioConvertKernels
+{
+public:
+  void (*Int16ToFloat)(const int16* pIn, float* pOut, int64 count);
+  void (*FloatToInt16)(const float* pIn, int16* pOut, int64 count);
+  void (*FloatToInt16Dither)(const float* pIn, int16* pOut, int64 count, uint32& rSeed);
+  void (*Int24LEToFloat)(const uint8* pIn, float* pOut, int64 count);
+  void (*FloatToInt24LE)(const float* pIn, uint8* pOut, int64 count);
+  void (*Int32ToFloat)(const int32* pIn, float* pOut, int64 count);
+  void (*FloatToInt32)(const float* pIn, int32* pOut, int64 count);
+  void (*Interleave)(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames);
+  void (*Deinterleave)(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames);
+  void (*INint16ToDEfloat)(const int16* pIn, float* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames);
+  void (*DEfloatToINint16)(const float* pIn, int16* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames);
+};
+
+extern const nuiAudioConvertKernels gAudioConvertKernels_Scalar;
+
+#if (defined _NGL_X86_) || (defined _NGL_X64_)
+#define NUI_AUDIOCONVERT_X86
+extern const nuiAudioConvertKernels gAudioConvertKernels_SSE2;
+extern const nuiAudioConvertKernels gAudioConvertKernels_AVX2;
+#endif
+
+// Constants shared by all the implementations so that they produce the same samples:
+#define NUI_AUDIOCONVERT_INT16_NEG 32768.0f
+#define NUI_AUDIOCONVERT_INT16_POS 32767.0f
+#define NUI_AUDIOCONVERT_INT24_NEG 8388608.0f
+#define NUI_AUDIOCONVERT_INT24_POS 8388607.0f
+#define NUI_AUDIOCONVERT_INT32_NEG 2147483648.0f
+#define NUI_AUDIOCONVERT_INT32_POS 2147483647.0f
+#define NUI_AUDIOCONVERT_INT32_MAXFLOAT 2147483520.0f // Biggest float below 2^31: 2147483647.0f rounds to 2^31 which doesn't fit in an int32
+
+// xorshift32 generator used by the TPDF dither. Returns a float in [0, 1).
+inline float nuiAudioConvert_DitherRandom(uint32& rState)
+{
+  rState ^= rState << 13;
+  rState ^= rState >> 17;
+  rState ^= rState << 5;
+  union
+  {
+    uint32 i;
+    float f;
+  } r;
+  r.i = (rState >> 9) | 0x3f800000;
+  return r.f - 1.0f;
+}
+
+// The dither noise of sample i comes from generator i % NUI_AUDIOCONVERT_DITHER_LANES, which matches the lanes of the vector kernels so
+// that all the implementations produce the same samples. Each lane draws two numbers per sample.
+#define NUI_AUDIOCONVERT_DITHER_LANES 8
+
+// splitmix64, gives independent xorshift32 seeds for the lanes:
+inline uint64 nuiAudioConvert_SplitMix64(uint64 x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+inline uint32 nuiAudioConvert_DitherSeed(uint32 Seed, uint32 Index)
+{
+  uint32 res = (uint32)nuiAudioConvert_SplitMix64(((uint64)Seed << 32) | Index);
+  return res ? res : 1; // xorshift32 never leaves 0
+}
+
+// Seeds the lanes for one buffer and advances the state the caller keeps for the next one:
+inline void nuiAudioConvert_DitherBegin(uint32& rSeed, uint32* pStates)
+{
+  for (uint32 l = 0; l < NUI_AUDIOCONVERT_DITHER_LANES; l++)
+    pStates[l] = nuiAudioConvert_DitherSeed(rSeed, l);
+  rSeed = nuiAudioConvert_DitherSeed(rSeed, NUI_AUDIOCONVERT_DITHER_LANES);
+}
+
+// Scalar loop shared by all the implementations, pIn[0] must be a sample of lane 0:
+inline void nuiAudioConvert_DitherSamples(const float* pIn, int16* pOut, int64 count, uint32* pStates)
+{
+  for (int64 i = 0; i < count; i++)
+  {
+    // Triangular noise of +/- 1 LSB, then round half up:
+    uint32& rState(pStates[i % NUI_AUDIOCONVERT_DITHER_LANES]);
+    const float r0 = nuiAudioConvert_DitherRandom(rState);
+    const float r1 = nuiAudioConvert_DitherRandom(rState);
+    float value = nuiClamp(pIn[i], -1.0f, 1.0f) * NUI_AUDIOCONVERT_INT16_POS;
+    value += r0 - r1;
+    int32 res = (int32)floorf(value + 0.5f);
+    pOut[i] = nuiClamp(res, -32768, 32767);
+  }
+}
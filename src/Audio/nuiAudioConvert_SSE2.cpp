@@ -0,0 +1,293 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiAudioConvert_SIMD.h"
+
+#ifdef NUI_AUDIOCONVERT_X86
+
+#include <emmintrin.h>
+
+NGL_TARGET_BEGIN("sse2")
+
+// (mask ? a : b)
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Integer to float with the asymmetric scaling, branchless:
+static inline __m128 ScaleToFloat(__m128i in, __m128 neg, __m128 pos)
+{
+  __m128 f = _mm_cvtepi32_ps(in);
+  return _mm_mul_ps(f, Select(_mm_cmplt_ps(f, _mm_setzero_ps()), neg, pos));
+}
+
+// Clamp, scale and truncate:
+static inline __m128i ScaleToInt(__m128 in, __m128 neg, __m128 pos)
+{
+  in = _mm_min_ps(_mm_max_ps(in, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+  return _mm_cvttps_epi32(_mm_mul_ps(in, Select(_mm_cmplt_ps(in, _mm_setzero_ps()), neg, pos)));
+}
+
+static void Int16ToFloat_SSE2(const int16* pIn, float* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_NEG));
+  const __m128 pos = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_POS));
+
+  int64 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(pIn + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(pOut + i, ScaleToFloat(lo, neg, pos));
+    _mm_storeu_ps(pOut + i + 4, ScaleToFloat(hi, neg, pos));
+  }
+  gAudioConvertKernels_Scalar.Int16ToFloat(pIn + i, pOut + i, count - i);
+}
+
+static void FloatToInt16_SSE2(const float* pIn, int16* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps(NUI_AUDIOCONVERT_INT16_NEG);
+  const __m128 pos = _mm_set1_ps(NUI_AUDIOCONVERT_INT16_POS);
+
+  int64 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo = ScaleToInt(_mm_loadu_ps(pIn + i), neg, pos);
+    __m128i hi = ScaleToInt(_mm_loadu_ps(pIn + i + 4), neg, pos);
+    _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(lo, hi));
+  }
+  gAudioConvertKernels_Scalar.FloatToInt16(pIn + i, pOut + i, count - i);
+}
+
+// Four xorshift32 generators in parallel, returns floats in [0, 1):
+static inline __m128 DitherRandom(__m128i& rState)
+{
+  rState = _mm_xor_si128(rState, _mm_slli_epi32(rState, 13));
+  rState = _mm_xor_si128(rState, _mm_srli_epi32(rState, 17));
+  rState = _mm_xor_si128(rState, _mm_slli_epi32(rState, 5));
+  __m128i bits = _mm_or_si128(_mm_srli_epi32(rState, 9), _mm_set1_epi32(0x3f800000));
+  return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+}
+
+// Clamp, scale, add the noise and round half up like floorf(x + 0.5f). SSE2 has no floor: truncate and step down where that rounded up.
+static inline __m128i DitherToInt(__m128 in, __m128i& rState)
+{
+  const __m128 r0 = DitherRandom(rState);
+  const __m128 r1 = DitherRandom(rState);
+  __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(in, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)), _mm_set1_ps(NUI_AUDIOCONVERT_INT16_POS));
+  value = _mm_add_ps(_mm_add_ps(value, _mm_sub_ps(r0, r1)), _mm_set1_ps(0.5f));
+  __m128i res = _mm_cvttps_epi32(value);
+  return _mm_add_epi32(res, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(res), value)));
+}
+
+static void FloatToInt16Dither_SSE2(const float* pIn, int16* pOut, int64 count, uint32& rSeed)
+{
+  uint32 states[NUI_AUDIOCONVERT_DITHER_LANES];
+  nuiAudioConvert_DitherBegin(rSeed, states);
+  __m128i state0 = _mm_loadu_si128((const __m128i*)states);
+  __m128i state1 = _mm_loadu_si128((const __m128i*)(states + 4));
+
+  int64 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo = DitherToInt(_mm_loadu_ps(pIn + i), state0);
+    __m128i hi = DitherToInt(_mm_loadu_ps(pIn + i + 4), state1);
+    _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(lo, hi)); // Saturates to the int16 range
+  }
+
+  _mm_storeu_si128((__m128i*)states, state0);
+  _mm_storeu_si128((__m128i*)(states + 4), state1);
+  nuiAudioConvert_DitherSamples(pIn + i, pOut + i, count - i, states);
+}
+
+static inline int32 Unpack24(const uint8* p)
+{
+  return (int32)(((uint32)p[2] << 24) | ((uint32)p[1] << 16) | ((uint32)p[0] << 8));
+}
+
+static void Int24LEToFloat_SSE2(const uint8* pIn, float* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT24_NEG));
+  const __m128 pos = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT24_POS));
+
+  // SSE2 has no byte shuffle: unpack the samples in the top of 32 bits integers and let the arithmetic shift sign extend them.
+  int64 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const uint8* p = pIn + 3 * i;
+    __m128i in = _mm_set_epi32(Unpack24(p + 9), Unpack24(p + 6), Unpack24(p + 3), Unpack24(p));
+    _mm_storeu_ps(pOut + i, ScaleToFloat(_mm_srai_epi32(in, 8), neg, pos));
+  }
+  gAudioConvertKernels_Scalar.Int24LEToFloat(pIn + 3 * i, pOut + i, count - i);
+}
+
+static void FloatToInt24LE_SSE2(const float* pIn, uint8* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps(NUI_AUDIOCONVERT_INT24_NEG);
+  const __m128 pos = _mm_set1_ps(NUI_AUDIOCONVERT_INT24_POS);
+
+  int64 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    int32 values[4];
+    _mm_storeu_si128((__m128i*)values, ScaleToInt(_mm_loadu_ps(pIn + i), neg, pos));
+    uint8* p = pOut + 3 * i;
+    for (int32 j = 0; j < 4; j++, p += 3)
+    {
+      p[0] = (uint8)(values[j]);
+      p[1] = (uint8)(values[j] >> 8);
+      p[2] = (uint8)(values[j] >> 16);
+    }
+  }
+  gAudioConvertKernels_Scalar.FloatToInt24LE(pIn + i, pOut + 3 * i, count - i);
+}
+
+static void Int32ToFloat_SSE2(const int32* pIn, float* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT32_NEG));
+  const __m128 pos = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT32_POS));
+
+  int64 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i in0 = _mm_loadu_si128((const __m128i*)(pIn + i));
+    __m128i in1 = _mm_loadu_si128((const __m128i*)(pIn + i + 4));
+    _mm_storeu_ps(pOut + i, ScaleToFloat(in0, neg, pos));
+    _mm_storeu_ps(pOut + i + 4, ScaleToFloat(in1, neg, pos));
+  }
+  gAudioConvertKernels_Scalar.Int32ToFloat(pIn + i, pOut + i, count - i);
+}
+
+static void FloatToInt32_SSE2(const float* pIn, int32* pOut, int64 count)
+{
+  const __m128 neg = _mm_set1_ps(NUI_AUDIOCONVERT_INT32_NEG);
+  const __m128 pos = _mm_set1_ps(NUI_AUDIOCONVERT_INT32_POS);
+  const __m128 minus1 = _mm_set1_ps(-1.0f);
+  const __m128 plus1 = _mm_set1_ps(1.0f);
+  const __m128 top = _mm_set1_ps(NUI_AUDIOCONVERT_INT32_MAXFLOAT);
+
+  int64 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 in = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i), minus1), plus1);
+    __m128 scaled = _mm_mul_ps(in, Select(_mm_cmplt_ps(in, _mm_setzero_ps()), neg, pos));
+    _mm_storeu_si128((__m128i*)(pOut + i), _mm_cvttps_epi32(_mm_min_ps(scaled, top)));
+  }
+  gAudioConvertKernels_Scalar.FloatToInt32(pIn + i, pOut + i, count - i);
+}
+
+static void Interleave_SSE2(const float* const* pIn, float* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.Interleave(pIn, pOut, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  const float* pLeft = pIn[0];
+  const float* pRight = pIn[1];
+  int64 i = 0;
+  for (; i + 4 <= nbSampleFrames; i += 4)
+  {
+    __m128 l = _mm_loadu_ps(pLeft + i);
+    __m128 r = _mm_loadu_ps(pRight + i);
+    _mm_storeu_ps(pOut + 2 * i, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(pOut + 2 * i + 4, _mm_unpackhi_ps(l, r));
+  }
+  for (; i < nbSampleFrames; i++)
+  {
+    pOut[2 * i] = pLeft[i];
+    pOut[2 * i + 1] = pRight[i];
+  }
+}
+
+static void Deinterleave_SSE2(const float* pIn, float* const* pOut, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.Deinterleave(pIn, pOut, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  float* pLeft = pOut[0];
+  float* pRight = pOut[1];
+  int64 i = 0;
+  for (; i + 4 <= nbSampleFrames; i += 4)
+  {
+    __m128 a = _mm_loadu_ps(pIn + 2 * i);
+    __m128 b = _mm_loadu_ps(pIn + 2 * i + 4);
+    _mm_storeu_ps(pLeft + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(pRight + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  for (; i < nbSampleFrames; i++)
+  {
+    pLeft[i] = pIn[2 * i];
+    pRight[i] = pIn[2 * i + 1];
+  }
+}
+
+static void INint16ToDEfloat_SSE2(const int16* pIn, float* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels == 1)
+  {
+    Int16ToFloat_SSE2(pIn, pOut, nbSampleFrames);
+    return;
+  }
+  if (nbChannels != 2)
+  {
+    gAudioConvertKernels_Scalar.INint16ToDEfloat(pIn, pOut, curChannel, nbChannels, nbSampleFrames);
+    return;
+  }
+
+  // Stereo: each 32 bits word holds one frame, the arithmetic shifts pick the channel and sign extend it.
+  const __m128 neg = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_NEG));
+  const __m128 pos = _mm_set1_ps((float)(1.0 / NUI_AUDIOCONVERT_INT16_POS));
+  const int32 shift = curChannel ? 0 : 16;
+
+  int64 i = 0;
+  for (; i + 4 <= nbSampleFrames; i += 4)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(pIn + 2 * i));
+    __m128i samples = _mm_srai_epi32(_mm_sll_epi32(in, _mm_cvtsi32_si128(shift)), 16);
+    _mm_storeu_ps(pOut + i, ScaleToFloat(samples, neg, pos));
+  }
+  gAudioConvertKernels_Scalar.INint16ToDEfloat(pIn + 2 * i, pOut + i, curChannel, nbChannels, nbSampleFrames - i);
+}
+
+static void DEfloatToINint16_SSE2(const float* pIn, int16* pOut, int32 curChannel, int32 nbChannels, int64 nbSampleFrames)
+{
+  if (nbChannels == 1)
+  {
+    FloatToInt16_SSE2(pIn, pOut, nbSampleFrames);
+    return;
+  }
+  // Writing one channel of an interleaved buffer would need a read/modify/write of the others, the scalar loop does just as well:
+  gAudioConvertKernels_Scalar.DEfloatToINint16(pIn, pOut, curChannel, nbChannels, nbSampleFrames);
+}
+
+const nuiAudioConvertKernels gAudioConvertKernels_SSE2 =
+{
+  Int16ToFloat_SSE2,
+  FloatToInt16_SSE2,
+  FloatToInt16Dither_SSE2,
+  Int24LEToFloat_SSE2,
+  FloatToInt24LE_SSE2,
+  Int32ToFloat_SSE2,
+  FloatToInt32_SSE2,
+  Interleave_SSE2,
+  Deinterleave_SSE2,
+  INint16ToDEfloat_SSE2,
+  DEfloatToINint16_SSE2
+};
+
+NGL_TARGET_END
+
+#endif
+
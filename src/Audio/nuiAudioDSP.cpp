@@ -0,0 +1,369 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiAudioDSP.h"
+#include "nuiAudioConvert_SIMD.h"
+
+#ifdef NUI_AUDIOCONVERT_X86
+#include <emmintrin.h>
+#endif
+
+// -1 until the CPU has been checked:
+static std::atomic<int32> gAudioDSPSIMD(-1);
+
+static inline bool UseSIMD()
+{
+  int32 simd = gAudioDSPSIMD.load(std::memory_order_relaxed);
+  if (simd < 0)
+  {
+#ifdef NUI_AUDIOCONVERT_X86
+    simd = nglCPUInfo::HasSSE2() ? 1 : 0;
+#else
+    simd = 0;
+#endif
+    gAudioDSPSIMD.store(simd, std::memory_order_relaxed);
+  }
+  return simd != 0;
+}
+
+void nuiAudioDSP_EnableSIMD(bool Enable)
+{
+#ifdef NUI_AUDIOCONVERT_X86
+  gAudioDSPSIMD.store((Enable && nglCPUInfo::HasSSE2()) ? 1 : 0, std::memory_order_relaxed);
+#endif
+}
+
+bool nuiAudioDSP_IsSIMDEnabled()
+{
+  return UseSIMD();
+}
+
+void nuiAudioDSP_PanGains(float Pan, nuiAudioPanLaw Law, float& rLeft, float& rRight)
+{
+  Pan = nuiClamp(Pan, -1.0f, 1.0f);
+  switch (Law)
+  {
+    case eAudioPanConstantPower:
+    {
+      float angle = (Pan + 1.0f) * (float)(M_PI / 4.0);
+      rLeft = cosf(angle);
+      rRight = sinf(angle);
+      break;
+    }
+    case eAudioPanBalance:
+    default:
+      rLeft = MIN(1.0f, 1.0f - Pan);
+      rRight = MIN(1.0f, 1.0f + Pan);
+      break;
+  }
+}
+
+
+#ifdef NUI_AUDIOCONVERT_X86
+NGL_TARGET_BEGIN("sse2")
+
+// Gains of the 4 frames starting at index (the ramps are computed from the index, not accumulated, so they don't drift):
+static inline __m128 RampGains(__m128 start, __m128 step, __m128 index)
+{
+  return _mm_add_ps(start, _mm_mul_ps(step, index));
+}
+
+static void Scale_SSE(float* pBuffer, int32 SampleFrames, float Gain)
+{
+  const __m128 gain = _mm_set1_ps(Gain);
+  int32 i = 0;
+  for (; i + 8 <= SampleFrames; i += 8)
+  {
+    _mm_storeu_ps(pBuffer + i, _mm_mul_ps(_mm_loadu_ps(pBuffer + i), gain));
+    _mm_storeu_ps(pBuffer + i + 4, _mm_mul_ps(_mm_loadu_ps(pBuffer + i + 4), gain));
+  }
+  for (; i < SampleFrames; i++)
+    pBuffer[i] *= Gain;
+}
+
+static void Ramp_SSE(float* pBuffer, int32 SampleFrames, float StartGain, float Step)
+{
+  const __m128 start = _mm_set1_ps(StartGain);
+  const __m128 step = _mm_set1_ps(Step);
+  const __m128 four = _mm_set1_ps(4.0f);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+  {
+    _mm_storeu_ps(pBuffer + i, _mm_mul_ps(_mm_loadu_ps(pBuffer + i), RampGains(start, step, index)));
+    index = _mm_add_ps(index, four);
+  }
+  for (; i < SampleFrames; i++)
+    pBuffer[i] *= StartGain + Step * (float)i;
+}
+
+static void MixAdd_SSE(const float* pSrc, float* pDst, int32 SampleFrames, float Gain)
+{
+  const __m128 gain = _mm_set1_ps(Gain);
+  int32 i = 0;
+  for (; i + 8 <= SampleFrames; i += 8)
+  {
+    __m128 d0 = _mm_add_ps(_mm_loadu_ps(pDst + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), gain));
+    __m128 d1 = _mm_add_ps(_mm_loadu_ps(pDst + i + 4), _mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), gain));
+    _mm_storeu_ps(pDst + i, d0);
+    _mm_storeu_ps(pDst + i + 4, d1);
+  }
+  for (; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * Gain;
+}
+
+static void MixAddRamp_SSE(const float* pSrc, float* pDst, int32 SampleFrames, float StartGain, float Step)
+{
+  const __m128 start = _mm_set1_ps(StartGain);
+  const __m128 step = _mm_set1_ps(Step);
+  const __m128 four = _mm_set1_ps(4.0f);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+  {
+    __m128 s = _mm_mul_ps(_mm_loadu_ps(pSrc + i), RampGains(start, step, index));
+    _mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), s));
+    index = _mm_add_ps(index, four);
+  }
+  for (; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * (StartGain + Step * (float)i);
+}
+
+static void MixAddStereo_SSE(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float GainLeft, float GainRight)
+{
+  const __m128 left = _mm_set1_ps(GainLeft);
+  const __m128 right = _mm_set1_ps(GainRight);
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+  {
+    __m128 s = _mm_loadu_ps(pSrc + i);
+    _mm_storeu_ps(pLeft + i, _mm_add_ps(_mm_loadu_ps(pLeft + i), _mm_mul_ps(s, left)));
+    _mm_storeu_ps(pRight + i, _mm_add_ps(_mm_loadu_ps(pRight + i), _mm_mul_ps(s, right)));
+  }
+  for (; i < SampleFrames; i++)
+  {
+    pLeft[i] += pSrc[i] * GainLeft;
+    pRight[i] += pSrc[i] * GainRight;
+  }
+}
+
+static void MixAddStereoRamp_SSE(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float StartLeft, float StepLeft, float StartRight, float StepRight)
+{
+  const __m128 startLeft = _mm_set1_ps(StartLeft);
+  const __m128 stepLeft = _mm_set1_ps(StepLeft);
+  const __m128 startRight = _mm_set1_ps(StartRight);
+  const __m128 stepRight = _mm_set1_ps(StepRight);
+  const __m128 four = _mm_set1_ps(4.0f);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+  {
+    __m128 s = _mm_loadu_ps(pSrc + i);
+    _mm_storeu_ps(pLeft + i, _mm_add_ps(_mm_loadu_ps(pLeft + i), _mm_mul_ps(s, RampGains(startLeft, stepLeft, index))));
+    _mm_storeu_ps(pRight + i, _mm_add_ps(_mm_loadu_ps(pRight + i), _mm_mul_ps(s, RampGains(startRight, stepRight, index))));
+    index = _mm_add_ps(index, four);
+  }
+  for (; i < SampleFrames; i++)
+  {
+    pLeft[i] += pSrc[i] * (StartLeft + StepLeft * (float)i);
+    pRight[i] += pSrc[i] * (StartRight + StepRight * (float)i);
+  }
+}
+
+static float Peak_SSE(const float* pBuffer, int32 SampleFrames)
+{
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 peak = _mm_setzero_ps();
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+    peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(pBuffer + i), absMask));
+
+  float peaks[4];
+  _mm_storeu_ps(peaks, peak);
+  float res = MAX(MAX(peaks[0], peaks[1]), MAX(peaks[2], peaks[3]));
+  for (; i < SampleFrames; i++)
+    res = MAX(res, fabsf(pBuffer[i]));
+  return res;
+}
+
+static float SumOfSquares_SSE(const float* pBuffer, int32 SampleFrames)
+{
+  __m128 sum = _mm_setzero_ps();
+  int32 i = 0;
+  for (; i + 4 <= SampleFrames; i += 4)
+  {
+    __m128 s = _mm_loadu_ps(pBuffer + i);
+    sum = _mm_add_ps(sum, _mm_mul_ps(s, s));
+  }
+
+  float sums[4];
+  _mm_storeu_ps(sums, sum);
+  float res = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  for (; i < SampleFrames; i++)
+    res += pBuffer[i] * pBuffer[i];
+  return res;
+}
+
+NGL_TARGET_END
+#endif
+
+
+void nuiAudioDSP_Clear(float* pBuffer, int32 SampleFrames)
+{
+  memset(pBuffer, 0, SampleFrames * sizeof(float));
+}
+
+void nuiAudioDSP_Copy(const float* pSrc, float* pDst, int32 SampleFrames)
+{
+  memmove(pDst, pSrc, SampleFrames * sizeof(float));
+}
+
+void nuiAudioDSP_Scale(float* pBuffer, int32 SampleFrames, float Gain)
+{
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    Scale_SSE(pBuffer, SampleFrames, Gain);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+    pBuffer[i] *= Gain;
+}
+
+void nuiAudioDSP_Ramp(float* pBuffer, int32 SampleFrames, float StartGain, float EndGain)
+{
+  if (SampleFrames <= 0)
+    return;
+  const float step = (EndGain - StartGain) / (float)SampleFrames;
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    Ramp_SSE(pBuffer, SampleFrames, StartGain, step);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+    pBuffer[i] *= StartGain + step * (float)i;
+}
+
+void nuiAudioDSP_MixAdd(const float* pSrc, float* pDst, int32 SampleFrames, float Gain)
+{
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    MixAdd_SSE(pSrc, pDst, SampleFrames, Gain);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * Gain;
+}
+
+void nuiAudioDSP_MixAddRamp(const float* pSrc, float* pDst, int32 SampleFrames, float StartGain, float EndGain)
+{
+  if (SampleFrames <= 0)
+    return;
+  if (StartGain == EndGain)
+  {
+    nuiAudioDSP_MixAdd(pSrc, pDst, SampleFrames, StartGain);
+    return;
+  }
+
+  const float step = (EndGain - StartGain) / (float)SampleFrames;
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    MixAddRamp_SSE(pSrc, pDst, SampleFrames, StartGain, step);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+    pDst[i] += pSrc[i] * (StartGain + step * (float)i);
+}
+
+void nuiAudioDSP_MixAddStereo(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float GainLeft, float GainRight)
+{
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    MixAddStereo_SSE(pSrc, pLeft, pRight, SampleFrames, GainLeft, GainRight);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+  {
+    pLeft[i] += pSrc[i] * GainLeft;
+    pRight[i] += pSrc[i] * GainRight;
+  }
+}
+
+void nuiAudioDSP_MixAddStereoRamp(const float* pSrc, float* pLeft, float* pRight, int32 SampleFrames, float StartLeft, float EndLeft, float StartRight, float EndRight)
+{
+  if (SampleFrames <= 0)
+    return;
+  if (StartLeft == EndLeft && StartRight == EndRight)
+  {
+    nuiAudioDSP_MixAddStereo(pSrc, pLeft, pRight, SampleFrames, StartLeft, StartRight);
+    return;
+  }
+
+  const float stepLeft = (EndLeft - StartLeft) / (float)SampleFrames;
+  const float stepRight = (EndRight - StartRight) / (float)SampleFrames;
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+  {
+    MixAddStereoRamp_SSE(pSrc, pLeft, pRight, SampleFrames, StartLeft, stepLeft, StartRight, stepRight);
+    return;
+  }
+#endif
+
+  for (int32 i = 0; i < SampleFrames; i++)
+  {
+    pLeft[i] += pSrc[i] * (StartLeft + stepLeft * (float)i);
+    pRight[i] += pSrc[i] * (StartRight + stepRight * (float)i);
+  }
+}
+
+float nuiAudioDSP_Peak(const float* pBuffer, int32 SampleFrames)
+{
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+    return Peak_SSE(pBuffer, SampleFrames);
+#endif
+
+  float res = 0;
+  for (int32 i = 0; i < SampleFrames; i++)
+    res = MAX(res, fabsf(pBuffer[i]));
+  return res;
+}
+
+float nuiAudioDSP_RMS(const float* pBuffer, int32 SampleFrames)
+{
+  if (SampleFrames <= 0)
+    return 0;
+
+  float sum = 0;
+#ifdef NUI_AUDIOCONVERT_X86
+  if (UseSIMD())
+    sum = SumOfSquares_SSE(pBuffer, SampleFrames);
+  else
+#endif
+  {
+    for (int32 i = 0; i < SampleFrames; i++)
+      sum += pBuffer[i] * pBuffer[i];
+  }
+
+  return sqrtf(sum / (float)SampleFrames);
+}
+
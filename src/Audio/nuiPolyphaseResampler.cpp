@@ -0,0 +1,369 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiPolyphaseResampler.h"
+#include "nuiAudioDSP.h"
+#include "nuiAudioConvert_SIMD.h"
+
+#ifdef NUI_AUDIOCONVERT_X86
+#include <emmintrin.h>
+#endif
+
+#define NUI_POLYPHASE_SCALE_STEPS 64 // Downsampling cutoffs are rounded down to 1/64 of the input Nyquist frequency so that few tables are built
+#define NUI_POLYPHASE_MAX_STRETCH 4 // Below 1/4 of the input rate the filter stops growing and the transition band widens instead
+
+struct nuiPolyphasePreset
+{
+  int32 mTaps;
+  int32 mPhaseBits; ///< log2 of the number of polyphase branches.
+  double mBeta; ///< Kaiser window parameter.
+  double mCutoff; ///< Relative to the Nyquist frequency of the slower side.
+  const char* mpName;
+};
+
+static const nuiPolyphasePreset gPolyphasePresets[] =
+{
+  {  8,  6,  5.0, 0.80, "fast" },
+  { 24,  8,  8.0, 0.88, "normal" },
+  { 64, 10, 10.0, 0.94, "best" }
+};
+
+// One table of branches: for each phase p, mTaps coefficients followed by the mTaps differences with the next phase.
+class nuiPolyphaseFilter
+{
+public:
+  nuiPolyphaseFilter(const nuiPolyphasePreset& rPreset, int32 ScaleKey)
+  {
+    const double scale = (double)ScaleKey / (double)NUI_POLYPHASE_SCALE_STEPS;
+    const int32 stretch = (int32)ceil((double)rPreset.mTaps / MAX(scale, 1.0 / NUI_POLYPHASE_MAX_STRETCH));
+    mTaps = (stretch + 3) & ~3; // Multiple of 4 for the SIMD loop, even so the window is centered
+    mPhaseBits = rPreset.mPhaseBits;
+    const int32 phases = 1 << mPhaseBits;
+    const int32 half = mTaps / 2;
+    const double cutoff = rPreset.mCutoff * scale; // Relative to the input Nyquist frequency
+    const double i0beta = BesselI0(rPreset.mBeta);
+
+    std::vector<double> rows((phases + 1) * mTaps);
+    for (int32 p = 0; p <= phases; p++)
+    {
+      double* pRow = &rows[p * mTaps];
+      double sum = 0;
+      for (int32 k = 0; k < mTaps; k++)
+      {
+        const double t = (double)(k - half + 1) - (double)p / (double)phases;
+        const double x = t / (double)half;
+        double w = 0;
+        if (x > -1.0 && x < 1.0)
+          w = BesselI0(rPreset.mBeta * sqrt(1.0 - x * x)) / i0beta;
+        const double a = M_PI * cutoff * t;
+        const double sinc = (fabs(a) < 1e-9) ? 1.0 : sin(a) / a;
+        pRow[k] = cutoff * sinc * w;
+        sum += pRow[k];
+      }
+
+      // Unity gain at DC on every branch:
+      for (int32 k = 0; k < mTaps; k++)
+        pRow[k] /= sum;
+    }
+
+    mCoefs.resize(phases * mTaps * 2);
+    for (int32 p = 0; p < phases; p++)
+    {
+      float* pDst = &mCoefs[p * mTaps * 2];
+      for (int32 k = 0; k < mTaps; k++)
+      {
+        pDst[k] = (float)rows[p * mTaps + k];
+        pDst[mTaps + k] = (float)(rows[(p + 1) * mTaps + k] - rows[p * mTaps + k]);
+      }
+    }
+  }
+
+  const float* GetBranch(uint32 Phase) const
+  {
+    return &mCoefs[Phase * mTaps * 2];
+  }
+
+  static const nuiPolyphaseFilter* Get(nuiPolyphaseResampler::Quality quality, double Scale);
+
+  int32 mTaps;
+  int32 mPhaseBits;
+
+private:
+  static double BesselI0(double x)
+  {
+    double sum = 1;
+    double term = 1;
+    for (int32 k = 1; k < 64 && term > sum * 1e-12; k++)
+    {
+      const double h = x / (2.0 * k);
+      term *= h * h;
+      sum += term;
+    }
+    return sum;
+  }
+
+  std::vector<float> mCoefs;
+};
+
+// The tables are built once and kept until exit:
+static nglCriticalSection gPolyphaseFiltersCS(nglString(_T("nuiPolyphaseFilter")));
+static std::map<int32, nuiPolyphaseFilter> gPolyphaseFilters;
+
+const nuiPolyphaseFilter* nuiPolyphaseFilter::Get(nuiPolyphaseResampler::Quality quality, double Scale)
+{
+  const int32 key = nuiClamp((int32)floor(Scale * NUI_POLYPHASE_SCALE_STEPS + 1e-6), 1, NUI_POLYPHASE_SCALE_STEPS);
+
+  nglCriticalSectionGuard guard(gPolyphaseFiltersCS);
+  const int32 id = (int32)quality * (NUI_POLYPHASE_SCALE_STEPS + 1) + key;
+  std::map<int32, nuiPolyphaseFilter>::iterator it = gPolyphaseFilters.find(id);
+  if (it == gPolyphaseFilters.end())
+    it = gPolyphaseFilters.insert(std::make_pair(id, nuiPolyphaseFilter(gPolyphasePresets[quality], key))).first;
+  return &it->second;
+}
+
+
+// Dot products of the input window with a branch and with its differences:
+static inline void DotBranch(const float* pInput, const float* pBranch, int32 Taps, float& rCoef, float& rDelta)
+{
+  const float* pDelta = pBranch + Taps;
+  float c = 0;
+  float d = 0;
+  for (int32 k = 0; k < Taps; k++)
+  {
+    c += pInput[k] * pBranch[k];
+    d += pInput[k] * pDelta[k];
+  }
+  rCoef = c;
+  rDelta = d;
+}
+
+#ifdef NUI_AUDIOCONVERT_X86
+NGL_TARGET_BEGIN("sse2")
+
+static inline float HorizontalSum(__m128 v)
+{
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+  return _mm_cvtss_f32(v);
+}
+
+static void DotBranch_SSE(const float* pInput, const float* pBranch, int32 Taps, float& rCoef, float& rDelta)
+{
+  const float* pDelta = pBranch + Taps;
+  __m128 c = _mm_setzero_ps();
+  __m128 d = _mm_setzero_ps();
+  for (int32 k = 0; k < Taps; k += 4)
+  {
+    const __m128 x = _mm_loadu_ps(pInput + k);
+    c = _mm_add_ps(c, _mm_mul_ps(x, _mm_loadu_ps(pBranch + k)));
+    d = _mm_add_ps(d, _mm_mul_ps(x, _mm_loadu_ps(pDelta + k)));
+  }
+  rCoef = HorizontalSum(c);
+  rDelta = HorizontalSum(d);
+}
+
+NGL_TARGET_END
+#endif
+
+
+nuiPolyphaseResampler::nuiPolyphaseResampler(int32 Channels, double InputRate, double OutputRate, Quality quality)
+: mChannels(Channels),
+  mInputRate(InputRate),
+  mOutputRate(OutputRate),
+  mQuality(quality),
+  mpFilter(NULL),
+  mStep(0),
+  mPosition(0),
+  mFraction(0),
+  mHistory(Channels),
+  mFrames(0)
+{
+  SetFilter();
+  Reset();
+}
+
+nuiPolyphaseResampler::~nuiPolyphaseResampler()
+{
+}
+
+int32 nuiPolyphaseResampler::GetChannels() const
+{
+  return mChannels;
+}
+
+double nuiPolyphaseResampler::GetInputRate() const
+{
+  return mInputRate;
+}
+
+double nuiPolyphaseResampler::GetOutputRate() const
+{
+  return mOutputRate;
+}
+
+nuiPolyphaseResampler::Quality nuiPolyphaseResampler::GetQuality() const
+{
+  return mQuality;
+}
+
+const char* nuiPolyphaseResampler::GetQualityName(Quality quality)
+{
+  return gPolyphasePresets[quality].mpName;
+}
+
+void nuiPolyphaseResampler::SetFilter()
+{
+  NGL_ASSERT(mInputRate > 0 && mOutputRate > 0);
+  const double ratio = mInputRate / mOutputRate;
+  mStep = (uint64)(ratio * 4294967296.0 + 0.5);
+  mpFilter = nuiPolyphaseFilter::Get(mQuality, MIN(1.0, 1.0 / ratio));
+}
+
+void nuiPolyphaseResampler::SetRates(double InputRate, double OutputRate)
+{
+  mInputRate = InputRate;
+  mOutputRate = OutputRate;
+  SetFilter();
+
+  // A longer filter needs more past input, pretend it was silence:
+  const int32 missing = GetLatency() - 1 - (int32)mPosition;
+  if (missing > 0)
+  {
+    Reserve(missing);
+    for (int32 c = 0; c < mChannels; c++)
+    {
+      float* pHistory = &mHistory[c][0];
+      memmove(pHistory + missing, pHistory, mFrames * sizeof(float));
+      memset(pHistory, 0, missing * sizeof(float));
+    }
+    mFrames += missing;
+    mPosition += missing;
+  }
+}
+
+void nuiPolyphaseResampler::SetQuality(Quality quality)
+{
+  mQuality = quality;
+  SetFilter();
+  Reset();
+}
+
+int32 nuiPolyphaseResampler::GetLatency() const
+{
+  return mpFilter->mTaps / 2;
+}
+
+void nuiPolyphaseResampler::Reserve(int32 Frames)
+{
+  if (!mHistory.empty() && mHistory[0].size() >= (size_t)(mFrames + Frames))
+    return;
+  for (int32 c = 0; c < mChannels; c++)
+    mHistory[c].resize(mFrames + Frames);
+}
+
+void nuiPolyphaseResampler::Prepare(int32 MaxOutputFrames)
+{
+  const double ratio = mInputRate / mOutputRate;
+  Reserve(mpFilter->mTaps * 2 + (int32)ceil(MaxOutputFrames * ratio) + 4);
+}
+
+void nuiPolyphaseResampler::Reset()
+{
+  // Start with a silent past so that the first output frame is aligned with the first input frame:
+  const int32 past = GetLatency() - 1;
+  mFrames = 0;
+  Reserve(past);
+  for (int32 c = 0; c < mChannels; c++)
+    memset(&mHistory[c][0], 0, past * sizeof(float));
+  mFrames = past;
+  mPosition = past;
+  mFraction = 0;
+}
+
+int32 nuiPolyphaseResampler::GetInputFramesNeeded(int32 OutputFrames) const
+{
+  if (OutputFrames <= 0)
+    return 0;
+  const uint64 last = (uint64)mFraction + (uint64)(OutputFrames - 1) * mStep;
+  const int64 needed = mPosition + (int64)(last >> 32) + GetLatency() + 1 - mFrames;
+  return (int32)MAX(needed, (int64)0);
+}
+
+void nuiPolyphaseResampler::Push(const std::vector<const float*>& rInput, int32 Frames)
+{
+  if (Frames <= 0)
+    return;
+  Reserve(Frames);
+  for (int32 c = 0; c < mChannels; c++)
+    memcpy(&mHistory[c][mFrames], rInput[c], Frames * sizeof(float));
+  mFrames += Frames;
+}
+
+void nuiPolyphaseResampler::PushSilence(int32 Frames)
+{
+  if (Frames <= 0)
+    return;
+  Reserve(Frames);
+  for (int32 c = 0; c < mChannels; c++)
+    memset(&mHistory[c][mFrames], 0, Frames * sizeof(float));
+  mFrames += Frames;
+}
+
+int32 nuiPolyphaseResampler::Pull(const std::vector<float*>& rOutput, int32 Frames)
+{
+  const nuiPolyphaseFilter& rFilter(*mpFilter);
+  const int32 taps = rFilter.mTaps;
+  const int32 half = taps / 2;
+  const int32 fractionBits = 32 - rFilter.mPhaseBits;
+  const uint32 fractionMask = (1u << fractionBits) - 1;
+  const float fractionScale = 1.0f / (float)(1u << fractionBits);
+
+  void (*pDot)(const float*, const float*, int32, float&, float&) = DotBranch;
+#ifdef NUI_AUDIOCONVERT_X86
+  if (nuiAudioDSP_IsSIMDEnabled())
+    pDot = DotBranch_SSE;
+#endif
+
+  int32 done = 0;
+  for (; done < Frames && mPosition + half < mFrames; done++)
+  {
+    const float* pBranch = rFilter.GetBranch(mFraction >> fractionBits);
+    const float interpolation = (float)(mFraction & fractionMask) * fractionScale;
+    const int64 start = mPosition - half + 1;
+    for (int32 c = 0; c < mChannels; c++)
+    {
+      float coef;
+      float delta;
+      pDot(&mHistory[c][start], pBranch, taps, coef, delta);
+      rOutput[c][done] = coef + interpolation * delta;
+    }
+
+    const uint64 fraction = (uint64)mFraction + (mStep & 0xffffffff);
+    mPosition += (int64)(mStep >> 32) + (int64)(fraction >> 32);
+    mFraction = (uint32)fraction;
+  }
+
+  Compact();
+  return done;
+}
+
+void nuiPolyphaseResampler::Compact()
+{
+  // Drop the input that is behind the filter window:
+  const int64 consumed = MIN(mPosition - GetLatency() + 1, (int64)mFrames);
+  if (consumed <= 0)
+    return;
+
+  for (int32 c = 0; c < mChannels; c++)
+  {
+    float* pHistory = &mHistory[c][0];
+    memmove(pHistory, pHistory + consumed, (mFrames - consumed) * sizeof(float));
+  }
+  mFrames -= (int32)consumed;
+  mPosition -= consumed;
+}
@@ -13,8 +13,7 @@
 
 
 
-
-nuiAudioEngine::nuiAudioEngine(double SampleRate, int32 BufferSize, ChannelConfig inputConfig)
+nuiAudioEngine::nuiAudioEngine(double SampleRate, int32 BufferSize, ChannelConfig inputConfig, uint32 MaxVoices, bool Offline)
 : mSampleRate(SampleRate),
   mBufferSize(BufferSize),
   mInputDelegateSet(false),
@@ -23,14 +22,32 @@ nuiAudioEngine::nuiAudioEngine(double SampleRate, int32 BufferSize, ChannelConfi
   mMute(false),
   mPan(0),
   mPlaying(true),
-  mCs(_T("nuiAudioEngineCriticalSection"))
+  mCs(_T("nuiAudioEngineCriticalSection")),
+  mVoiceCommands(MAX(256, MaxVoices * 2)),
+  mReleasedVoices(MaxVoices + MAX(256, MaxVoices * 2)),
+  mVoices(MaxVoices, NULL),
+  mVoiceCount(0),
+  mDroppedVoices(0),
+  mOffline(Offline),
+  mRenderThreads(1),
+  mRenderedFrames(0)
 {  
   if (SetObjectClass(_T("nuiAudioEngine")))
     InitAttributes();
   
+  // Everything the audio thread needs is allocated here, ProcessAudioOutput never allocates:
+  mMixData.resize(NUI_AUDIOENGINE_CHANNELS * mBufferSize, 0.0f);
+  for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
+  {
+    mMixBuffers.push_back(&mMixData[c * mBufferSize]);
+    mOutputPeak[c] = 0.f;
+    mOutputRMS[c] = 0.f;
+  }
+  
   mpOutAudioDevice = NULL;
   mpInAudioDevice = NULL;
-  AudioInit(inputConfig);
+  if (!mOffline)
+    AudioInit(inputConfig);
 }
 
 nuiAudioEngine::~nuiAudioEngine()
@@ -38,9 +55,17 @@ nuiAudioEngine::~nuiAudioEngine()
   delete mpOutAudioDevice;
   delete mpInAudioDevice;
   
-  for (int32 i = 0; i < mVoices.size(); i++)
-    mVoices[i]->Release();
+  // The devices are closed, we are now the only thread touching the voice table and fifos:
+  ProcessVoiceCommands();
+  ReleaseStoppedVoices();
   
+  for (uint32 i = 0; i < mVoiceCount; i++)
+  {
+    mVoices[i]->mEngineSlot = -1;
+    mVoices[i]->Release();
+  }
+  mVoiceCount = 0;
+
 }
 
 void nuiAudioEngine::InitAttributes()
@@ -80,6 +105,11 @@ void nuiAudioEngine::InitAttributes()
 bool nuiAudioEngine::AudioInit(ChannelConfig inputConfig)
 {
   mpOutAudioDevice = nuiAudioDeviceManager::Get().GetDefaultOutputDevice();
+  if (!mpOutAudioDevice)
+  {
+    NGL_LOG(_T("nuiAudioEngine"), NGL_LOG_ERROR, _T("No output device, use an offline engine to render without audio hardware\n"));
+    return false;
+  }
 
   NGL_OUT(_T("Default output: %s\n"), mpOutAudioDevice->GetName().GetChars());
 
@@ -89,6 +119,8 @@ bool nuiAudioEngine::AudioInit(ChannelConfig inputConfig)
     return res;
   
   mpInAudioDevice = nuiAudioDeviceManager::Get().GetDefaultInputDevice();
+  if (!mpInAudioDevice)
+    return false;
   res &= ActivateInputDevice(inputConfig);
   
   return res;
@@ -100,18 +132,23 @@ bool nuiAudioEngine::AudioInit(ChannelConfig inputConfig)
 
 void nuiAudioEngine::DeactivateOutputDevice()
 {
-  mpOutAudioDevice->Close();
+  if (mpOutAudioDevice)
+    mpOutAudioDevice->Close();
 }
 
 void nuiAudioEngine::DeactivateInputDevice()
 {
-  mpInAudioDevice->Close();
+  if (mpInAudioDevice)
+    mpInAudioDevice->Close();
 }
 
 
 
 bool nuiAudioEngine::ActivateOutputDevice()
 {
+  if (!mpOutAudioDevice)
+    return false;
+  
   std::vector<int32> InputChannels;
   std::vector<int32> OutputChannels;
   OutputChannels.push_back(0);
@@ -124,6 +161,9 @@ bool nuiAudioEngine::ActivateOutputDevice()
 
 bool nuiAudioEngine::ActivateInputDevice(ChannelConfig inputConfig)
 {
+  if (!mpInAudioDevice)
+    return false;
+  
   std::vector<int32> InputChannels;
   std::vector<int32> OutputChannels;
  
@@ -180,36 +220,7 @@ void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput,
   {
 #endif
 
-  std::vector<nuiVoice*> voicesToAdd;
-  std::vector<nuiVoice*> voicesToRemove;
-  mCs.Lock();
-  voicesToAdd = mAddVoicesQueue;
-  mAddVoicesQueue.clear();
-  
-  voicesToRemove = mRemoveVoicesQueue;
-  mRemoveVoicesQueue.clear();
-  mCs.Unlock();
-  
-  for (int32 i = 0; i < voicesToRemove.size(); i++)
-  {
-    nuiVoice* pVoiceToRemove = voicesToRemove[i];
-    std::vector<nuiVoice*>::iterator it = mVoices.begin();
-    std::vector<nuiVoice*>::iterator end = mVoices.end();
-    while (it != end)
-    {
-      nuiVoice* pCurrent = *it;
-      if (pCurrent == pVoiceToRemove)
-      {
-        mVoices.erase(it);
-        pCurrent->Release();
-        break;
-      }
-      ++it;
-    }
-  }
-  
-  for (int32 i = 0; i < voicesToAdd.size(); i++)
-    mVoices.push_back(voicesToAdd[i]);
+  ProcessVoiceCommands();
   
   int32 channels = rOutput.size();
   for (int32 c = 0; c < channels; c++)
@@ -219,59 +230,44 @@ void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput,
     
   
   if (!mPlaying)
-    return;
-  
-  std::vector<float*> buffers;
-  for (int32 c = 0; c < channels; c++)
   {
-    float* pBuffer = new float[SampleFrames];
-    memset(pBuffer, 0, SampleFrames * sizeof(float));
-    buffers.push_back(pBuffer);
+    for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
+    {
+      mOutputPeak[c] = 0.f;
+      mOutputRMS[c] = 0.f;
+    }
+    return;
   }
-    
   
-  for (int32 i = 0 ; i < mVoices.size(); i++)
-  {
-    nuiVoice* pVoice = mVoices[i];
-    pVoice->Process(buffers, SampleFrames);
-  }
+  NGL_ASSERT(channels == NUI_AUDIOENGINE_CHANNELS);
   
-  if (!mMute && mGain > 0)
+  // The device may ask for more frames than we have preallocated: mix in slices.
+  for (int32 done = 0; done < SampleFrames; done += mBufferSize)
+    Mix(rOutput, done, MIN(mBufferSize, SampleFrames - done));
+  
+  for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
   {
-    float pan = mPan;
-    pan = MIN(pan, 1.0);
-    pan = MAX(pan, -1.0);
-    float panLeft = MIN(1.0, 1.0 - pan);
-    float panRight = MIN(1.0, 1.0 + pan);
-    for (int32 c = 0; c < channels; c++)
-    {
-      float* pDst = rOutput[c];
-      float* pSrc = buffers[c];
-      float mult = mGain * (c == 0 ? panLeft : panRight);
-      for (int32 i = 0; i < SampleFrames; i++)
-        *pDst++ += (*pSrc++) * mult;
-    }
+    mOutputPeak[c] = nuiAudioDSP_Peak(rOutput[c], SampleFrames);
+    mOutputRMS[c] = nuiAudioDSP_RMS(rOutput[c], SampleFrames);
   }
     
   if (mOutputDelegateSet)
     mOutputDelegate(rOutput, SampleFrames);
   
 
-  std::vector<nuiVoice*>::iterator it = mVoices.begin();
-  int32 index = 0;
-  while (it != mVoices.end())
+  // Hand the finished voices we are the last owner of back to the other threads:
+  uint32 i = 0;
+  while (i < mVoiceCount)
   {
-    nuiVoice* pVoice = *it;
-    if (pVoice->IsDone() == pVoice->GetRefCount() == 1)
+    nuiVoice* pVoice = mVoices[i];
+    if (pVoice->IsDone() && pVoice->GetRefCount() == 1 && mReleasedVoices.CanWrite())
     {
-      mVoices.erase(it);
-      it = mVoices.begin() + index;
-      pVoice->Release();
+      RemoveVoice(pVoice); // the last voice is moved to slot i
+      mReleasedVoices.Push(pVoice); // The reference of the voice table
       continue;
     }
-      
-    ++it;
-    ++index;
+    
+    ++i;
   }
   
 #ifdef AUDIO_LOG
@@ -291,10 +287,6 @@ void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput,
   }
 #endif
   
-  
-  for (int32 c = 0; c < channels; c++)
-    delete[] buffers[c];
-
     
 #ifdef AUDIO_PROFILE
     }
@@ -306,6 +298,115 @@ void nuiAudioEngine::ProcessAudioOutput(const std::vector<const float*>& rInput,
    
 }
 
+void nuiAudioEngine::Mix(const std::vector<float*>& rOutput, int32 Offset, int32 SampleFrames)
+{
+  int32 channels = rOutput.size();
+  for (int32 c = 0; c < channels; c++)
+    nuiAudioDSP_Clear(mMixBuffers[c], SampleFrames);
+  
+  const uint32 groups = mOffline ? MIN(mRenderThreads, mVoiceCount) : 1;
+  if (groups > 1)
+  {
+    // Offline only: the voices are independent, split them in groups that mix to their own bus and sum the buses in a fixed order.
+    nuiTaskPool& rPool(nuiTaskPool::GetDefault());
+    nuiTaskGroup group;
+    for (uint32 g = 1; g < groups; g++)
+      rPool.Post(nuiMakeTask(this, &nuiAudioEngine::MixVoices, g, groups, SampleFrames), nuiTaskPool::eHigh, &group);
+    MixVoices(0, groups, SampleFrames);
+    rPool.Wait(group);
+    
+    for (uint32 g = 1; g < groups; g++)
+      for (int32 c = 0; c < channels; c++)
+        nuiAudioDSP_MixAdd(mGroupBus[g - 1][c], mMixBuffers[c], SampleFrames, 1.0f);
+  }
+  else
+  {
+    for (uint32 i = 0 ; i < mVoiceCount; i++)
+    {
+      nuiVoice* pVoice = mVoices[i];
+      pVoice->Process(mMixBuffers, SampleFrames);
+    }
+  }
+  
+  if (!mMute && mGain > 0)
+  {
+    float panLeft;
+    float panRight;
+    nuiAudioDSP_PanGains(mPan, eAudioPanBalance, panLeft, panRight);
+    for (int32 c = 0; c < channels; c++)
+      nuiAudioDSP_MixAdd(mMixBuffers[c], rOutput[c] + Offset, SampleFrames, mGain * (c == 0 ? panLeft : panRight));
+  }
+}
+
+void nuiAudioEngine::MixVoices(uint32 Group, uint32 Groups, int32 SampleFrames)
+{
+  // Group 0 mixes to the main bus, which has already been cleared.
+  const std::vector<float*>* pBus = &mMixBuffers;
+  if (Group > 0)
+  {
+    std::vector<float*>& rBus(mGroupBus[Group - 1]);
+    for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
+      nuiAudioDSP_Clear(rBus[c], SampleFrames);
+    pBus = &rBus;
+  }
+  
+  const uint32 first = mVoiceCount * Group / Groups;
+  const uint32 last = mVoiceCount * (Group + 1) / Groups;
+  for (uint32 i = first; i < last; i++)
+    mVoices[i]->Process(*pBus, SampleFrames);
+}
+
+void nuiAudioEngine::ProcessVoiceCommands()
+{
+  // Each command releases at most two references, stop when there is no room left for them (we'll do the rest on the next buffer).
+  VoiceCommand command;
+  while (mReleasedVoices.GetWritable() >= 2 && mVoiceCommands.Pop(command))
+  {
+    switch (command.mType)
+    {
+    case VoiceCommand::eAdd:
+      AddVoice(command.mpVoice);
+      break;
+    case VoiceCommand::eRemove:
+      if (RemoveVoice(command.mpVoice))
+        mReleasedVoices.Push(command.mpVoice); // The reference of the voice table
+      mReleasedVoices.Push(command.mpVoice); // The reference StopSound took for the command
+      break;
+    }
+  }
+}
+
+void nuiAudioEngine::AddVoice(nuiVoice* pVoice)
+{
+  if (pVoice->mEngineSlot >= 0 || mVoiceCount == mVoices.size())
+  {
+    // Already playing or no slot left: drop it.
+    mDroppedVoices++;
+    mReleasedVoices.Push(pVoice);
+    return;
+  }
+  
+  pVoice->mEngineSlot = mVoiceCount;
+  mVoices[mVoiceCount++] = pVoice;
+}
+
+bool nuiAudioEngine::RemoveVoice(nuiVoice* pVoice)
+{
+  int32 slot = pVoice->mEngineSlot;
+  if (slot < 0)
+    return false;
+  
+  NGL_ASSERT(mVoices[slot] == pVoice);
+  
+  // Fill the hole with the last voice so that the table stays dense:
+  nuiVoice* pLast = mVoices[--mVoiceCount];
+  mVoices[slot] = pLast;
+  pLast->mEngineSlot = slot;
+  mVoices[mVoiceCount] = NULL;
+  pVoice->mEngineSlot = -1;
+  return true;
+}
+
 void nuiAudioEngine::ProcessAudioInput(const std::vector<const float*>& rInput, const std::vector<float*>& rOutput, int32 SampleFrames)
 {
   if (mInputDelegateSet)
@@ -324,17 +425,174 @@ nuiVoice* nuiAudioEngine::PlaySound(nuiSound* pSound)
 {
   nuiVoice* pVoice = pSound->GetVoice();
   
-  nglCriticalSectionGuard guard(mCs);
-  pVoice->Acquire();
-  mAddVoicesQueue.push_back(pVoice);
+  if (!PostVoiceCommand(VoiceCommand::eAdd, pVoice))
+    return NULL;
   return pVoice;
 }
 
 void nuiAudioEngine::StopSound(nuiVoice* pVoice)
+{
+  PostVoiceCommand(VoiceCommand::eRemove, pVoice);
+}
+
+bool nuiAudioEngine::PostVoiceCommand(VoiceCommand::Type type, nuiVoice* pVoice)
+{
+  ReleaseStoppedVoices();
+  
+  if (type == VoiceCommand::eAdd)
+  {
+    pVoice->Prepare(mBufferSize, mSampleRate); // Allocate the voice's work buffers here rather than on the audio thread
+    if (mOffline)
+      pVoice->SetOffline(true); // File voices would stream from a loader thread that can't keep up with Render
+  }
+  
+  nglCriticalSectionGuard guard(mCs);
+  pVoice->Acquire(); // Keep the voice alive until the audio thread gives it back through mReleasedVoices
+  if (!mVoiceCommands.Push(VoiceCommand(type, pVoice)))
+  {
+    NGL_LOG(_T("nuiAudioEngine"), NGL_LOG_ERROR, _T("Voice command fifo full, dropping voice %p\n"), pVoice);
+    mDroppedVoices++;
+    pVoice->Release();
+    return false;
+  }
+  return true;
+}
+
+void nuiAudioEngine::ReleaseStoppedVoices()
 {
   nglCriticalSectionGuard guard(mCs);
+  nuiVoice* pVoice = NULL;
+  while (mReleasedVoices.Pop(pVoice))
+    pVoice->Release();
+}
+
+uint32 nuiAudioEngine::GetMaxVoices() const
+{
+  return mVoices.size();
+}
+
+uint32 nuiAudioEngine::GetDroppedVoices() const
+{
+  return mDroppedVoices;
+}
+
+bool nuiAudioEngine::IsOffline() const
+{
+  return mOffline;
+}
+
+uint32 nuiAudioEngine::GetVoiceCount() const
+{
+  return mVoiceCount;
+}
+
+void nuiAudioEngine::SetRenderThreads(uint32 Threads)
+{
+  NGL_ASSERT(mOffline);
+  if (!Threads)
+    Threads = nuiTaskPool::GetDefault().GetThreadCount();
+  mRenderThreads = MAX(1, Threads);
+  
+  // One extra bus per thread but the first:
+  const uint32 buses = mRenderThreads - 1;
+  mGroupData.resize(buses * NUI_AUDIOENGINE_CHANNELS * mBufferSize);
+  mGroupBus.resize(buses);
+  for (uint32 b = 0; b < buses; b++)
+  {
+    mGroupBus[b].resize(NUI_AUDIOENGINE_CHANNELS);
+    for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
+      mGroupBus[b][c] = &mGroupData[(b * NUI_AUDIOENGINE_CHANNELS + c) * mBufferSize];
+  }
+}
+
+uint32 nuiAudioEngine::GetRenderThreads() const
+{
+  return mRenderThreads;
+}
+
+int64 nuiAudioEngine::GetRenderedFrames() const
+{
+  return mRenderedFrames;
+}
+
+void nuiAudioEngine::Render(const std::vector<float*>& rOutput, int32 SampleFrames)
+{
+  NGL_ASSERT(mOffline); // Otherwise the output device is already calling ProcessAudioOutput
+  std::vector<const float*> input;
+  ProcessAudioOutput(input, rOutput, SampleFrames);
+  mRenderedFrames += SampleFrames;
+}
+
+int64 nuiAudioEngine::Render(nuiSampleWriter& rWriter, int64 SampleFrames)
+{
+  NGL_ASSERT(mOffline);
+  
+  std::vector<float> data(NUI_AUDIOENGINE_CHANNELS * mBufferSize);
+  std::vector<float> interleaved(NUI_AUDIOENGINE_CHANNELS * mBufferSize);
+  std::vector<float*> buffers;
+  for (int32 c = 0; c < NUI_AUDIOENGINE_CHANNELS; c++)
+    buffers.push_back(&data[c * mBufferSize]);
+  
+  int64 done = 0;
+  while (SampleFrames < 0 || done < SampleFrames)
+  {
+    // When rendering until the end, stop once every voice is done and gone:
+    if (SampleFrames < 0 && !mVoiceCount && !mVoiceCommands.CanRead())
+      break;
+    
+    const int32 todo = (SampleFrames < 0) ? mBufferSize : (int32)MIN((int64)mBufferSize, SampleFrames - done);
+    Render(buffers, todo);
+    ReleaseStoppedVoices();
+    
+    nuiAudioConvert_Interleave(&buffers[0], &interleaved[0], NUI_AUDIOENGINE_CHANNELS, todo);
+    const int32 written = rWriter.Write(&interleaved[0], todo, eSampleFloat32);
+    done += written;
+    if (written != todo)
+    {
+      NGL_LOG(_T("nuiAudioEngine"), NGL_LOG_ERROR, _T("Offline render: the writer only took %d of %d frames\n"), written, todo);
+      break;
+    }
+  }
+  
+  return done;
+}
+
+int64 nuiAudioEngine::RenderToFile(const nglPath& rPath, int64 SampleFrames, int32 BitsPerSample)
+{
+  nglOFile file(rPath, eOFileCreate);
+  if (!file.IsOpen())
+    return -1;
   
-  mRemoveVoicesQueue.push_back(pVoice);
+  nuiSampleInfo info;
+  info.SetSampleRate(mSampleRate);
+  info.SetChannels(NUI_AUDIOENGINE_CHANNELS);
+  info.SetBitsPerSample(BitsPerSample);
+  info.SetSampleFrames(0);
+  info.SetFormatTag(BitsPerSample == 32 ? eWaveFormatIEEEfloat : eWaveFormatPcm);
+  
+  nuiWaveWriter writer(file);
+  if (!writer.WriteInfo(info))
+    return -1;
+  
+  int64 done = Render(writer, SampleFrames);
+  
+  if (!writer.Finalize())
+    return -1;
+  return done;
+}
+
+float nuiAudioEngine::GetOutputPeak(int32 Channel) const
+{
+  if (Channel < 0 || Channel >= NUI_AUDIOENGINE_CHANNELS)
+    return 0.f;
+  return mOutputPeak[Channel];
+}
+
+float nuiAudioEngine::GetOutputRMS(int32 Channel) const
+{
+  if (Channel < 0 || Channel >= NUI_AUDIOENGINE_CHANNELS)
+    return 0.f;
+  return mOutputRMS[Channel];
 }
 
 
@@ -7,25 +7,146 @@
 
 #include "nui.h"
 
+#define NUI_FILEVOICE_DECODE_CHUNK 4096 // Max frames decoded at once by the loader for one voice
+#define NUI_FILEVOICE_LOADER_WAIT 5 // ms the loader sleeps when all the streaming voices are full
+
+static bool gFileVoiceStreaming = true;
+static int32 gFileVoicePrefetchFrames = 32768;
+
+// The loader decodes ahead for all the streaming voices so that no file I/O or decoding happens on the audio thread.
+class nuiFileVoiceLoader : public nglThread
+{
+public:
+  nuiFileVoiceLoader()
+  : nglThread(nglString(_T("nuiFileVoiceLoader")), nglThread::High),
+    mCS(nglString(_T("nuiFileVoiceLoader"))),
+    mStop(false)
+  {
+  }
+
+  void Register(nuiFileVoice* pVoice)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    mVoices.push_back(pVoice);
+    mWakeUp.Set();
+  }
+
+  void Unregister(nuiFileVoice* pVoice)
+  {
+    // Blocks until the loader is done with the voice:
+    nglCriticalSectionGuard guard(mCS);
+    std::vector<nuiFileVoice*>::iterator it = std::find(mVoices.begin(), mVoices.end(), pVoice);
+    if (it != mVoices.end())
+      mVoices.erase(it);
+  }
+
+  void Stop()
+  {
+    mStop = true;
+    mWakeUp.Set();
+    Join();
+  }
+
+  void OnStart()
+  {
+    while (!mStop)
+    {
+      bool busy = false;
+      {
+        nglCriticalSectionGuard guard(mCS);
+        for (size_t i = 0; i < mVoices.size(); i++)
+          busy |= mVoices[i]->FillStream();
+      }
+
+      if (!busy)
+      {
+        mWakeUp.Wait(NUI_FILEVOICE_LOADER_WAIT);
+        mWakeUp.Reset();
+      }
+    }
+  }
+
+  static nuiFileVoiceLoader& Get()
+  {
+    nglCriticalSectionGuard guard(mInstanceCS);
+    if (!mpInstance)
+    {
+      mpInstance = new nuiFileVoiceLoader();
+      mpInstance->Start();
+    }
+    return *mpInstance;
+  }
+
+  static void Remove(nuiFileVoice* pVoice)
+  {
+    nglCriticalSectionGuard guard(mInstanceCS);
+    if (mpInstance)
+      mpInstance->Unregister(pVoice);
+  }
+
+  static void Release()
+  {
+    nglCriticalSectionGuard guard(mInstanceCS);
+    if (!mpInstance)
+      return;
+    mpInstance->Stop();
+    delete mpInstance;
+    mpInstance = NULL;
+  }
+
+private:
+  nglCriticalSection mCS;
+  std::vector<nuiFileVoice*> mVoices;
+  nglSyncEvent mWakeUp;
+  volatile bool mStop;
+
+  static nuiFileVoiceLoader* mpInstance;
+  static nglCriticalSection mInstanceCS;
+};
+
+nuiFileVoiceLoader* nuiFileVoiceLoader::mpInstance = NULL;
+nglCriticalSection nuiFileVoiceLoader::mInstanceCS(nglString(_T("nuiFileVoiceLoader::Instance")));
+
+
 nuiFileVoice::nuiFileVoice(nuiFileSound* pSound)
 : nuiVoice(pSound),
   mpFileSound(pSound),
+  mOffline(false),
   mpStream(NULL),
-  mpReader(NULL)
+  mpReader(NULL),
+  mStreamPosition(0),
+  mLoaderPosition(0),
+  mSeekPosition(0),
+  mSeekGeneration(0),
+  mSeekAck(0),
+  mPlayPosition(0),
+  mSeeking(false),
+  mUnderruns(0),
+  mSeeks(0)
 {
   Init();
 }
 
 nuiFileVoice::~nuiFileVoice()
 {
-  
+  Clear();
 }
 
 nuiFileVoice::nuiFileVoice(const nuiFileVoice& rVoice)
 : nuiVoice(rVoice),
   mpFileSound(NULL),
+  mOffline(false),
   mpStream(NULL),
-  mpReader(NULL)
+  mpReader(NULL),
+  mStreamPosition(0),
+  mLoaderPosition(0),
+  mSeekPosition(0),
+  mSeekGeneration(0),
+  mSeekAck(0),
+  mPlayPosition(0),
+  mSeeking(false),
+  mUnderruns(0),
+  mSeeks(0)
 {
   *this = rVoice;
 }
@@ -47,14 +168,19 @@ bool nuiFileVoice::IsValid() const
   return mpSound && mpStream && mpReader;
 }
 
-bool nuiFileVoice::Init()
+void nuiFileVoice::Clear()
 {
-  if (mpStream)
-    delete mpStream;
-  if (mpReader)
-    delete mpReader;
+  ClearStreaming();
+  
+  delete mpReader;
+  delete mpStream;
   mpStream = NULL;
   mpReader = NULL;
+}
+
+bool nuiFileVoice::Init()
+{
+  Clear();
   
   if (!mpSound)
     return false;
@@ -99,6 +225,11 @@ bool nuiFileVoice::Init()
   mpStream = pStream;
   mpReader = pReader;
   mInfo = info;
+  mReadPointers.resize(mInfo.GetChannels(), NULL);
+  
+  if (gFileVoiceStreaming && !mOffline)
+    InitStreaming(gFileVoicePrefetchFrames);
+  
   NGL_OUT(_T("audio file loaded: %s\n"), path.GetNodeName().GetChars());
   return true;
 }
@@ -113,6 +244,11 @@ int32 nuiFileVoice::GetSampleFrames() const
   return mInfo.GetSampleFrames();
 }
 
+double nuiFileVoice::GetSampleRate() const
+{
+  return mInfo.GetSampleRate();
+}
+
 
 
 int32 nuiFileVoice::ReadSamples(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames)
@@ -124,12 +260,241 @@ int32 nuiFileVoice::ReadSamples(const std::vector<float*>& rOutput, int64 positi
     return 0;
   int64 todo = MIN(SampleFrames, mInfo.GetSampleFrames() - position);
   
-  std::vector<void*> temp;
+  if (!mStreamRings.empty())
+    return ReadStream(rOutput, position, todo);
+  
   for (int32 i = 0; i < rOutput.size(); i++)
-    temp.push_back((void*)rOutput[i]);
+    mReadPointers[i] = (void*)rOutput[i];
   
   mpReader->SetPosition(position);
-  int32 read = mpReader->ReadDE(temp, todo, eSampleFloat32);
+  int32 read = mpReader->ReadDE(mReadPointers, todo, eSampleFloat32);
   return read;
 }
 
+// Streaming:
+void nuiFileVoice::SetStreaming(bool Enable, int32 PrefetchFrames)
+{
+  gFileVoiceStreaming = Enable;
+  gFileVoicePrefetchFrames = PrefetchFrames;
+}
+
+bool nuiFileVoice::IsStreaming()
+{
+  return gFileVoiceStreaming;
+}
+
+int32 nuiFileVoice::GetPrefetchFrames()
+{
+  return gFileVoicePrefetchFrames;
+}
+
+void nuiFileVoice::ReleaseLoader()
+{
+  nuiFileVoiceLoader::Release();
+}
+
+bool nuiFileVoice::IsStreamingVoice() const
+{
+  return !mStreamRings.empty();
+}
+
+void nuiFileVoice::SetOffline(bool Offline)
+{
+  mOffline = Offline;
+  if (mOffline)
+    ClearStreaming();
+  else if (gFileVoiceStreaming && IsValid() && mStreamRings.empty())
+    InitStreaming(gFileVoicePrefetchFrames);
+}
+
+uint32 nuiFileVoice::GetUnderruns() const
+{
+  return mUnderruns;
+}
+
+uint32 nuiFileVoice::GetSeeks() const
+{
+  return mSeeks;
+}
+
+void nuiFileVoice::InitStreaming(int32 PrefetchFrames)
+{
+  const int32 channels = mInfo.GetChannels();
+  for (int32 c = 0; c < channels; c++)
+    mStreamRings.push_back(new nglSPSCRing<float>(PrefetchFrames));
+  
+  const int32 chunk = MIN(NUI_FILEVOICE_DECODE_CHUNK, mStreamRings[0]->GetCapacity() / 2);
+  mDecodeData.resize(channels * chunk);
+  mDecodePointers.resize(channels);
+  for (int32 c = 0; c < channels; c++)
+    mDecodePointers[c] = &mDecodeData[c * chunk];
+  
+  mStreamPosition = 0;
+  mLoaderPosition = 0;
+  mSeekPosition = 0;
+  mSeekGeneration = 0;
+  mSeekAck = 0;
+  mPlayPosition = 0;
+  mSeeking = false;
+  mUnderruns = 0;
+  mSeeks = 0;
+  
+  // Prefill so that the first buffers can be played right away, the loader takes over from there.
+  while (FillStream())
+    ;
+  
+  nuiFileVoiceLoader::Get().Register(this);
+}
+
+void nuiFileVoice::ClearStreaming()
+{
+  if (mStreamRings.empty())
+    return;
+  
+  nuiFileVoiceLoader::Remove(this);
+  
+  for (size_t c = 0; c < mStreamRings.size(); c++)
+    delete mStreamRings[c];
+  mStreamRings.clear();
+  mDecodeData.clear();
+  mDecodePointers.clear();
+}
+
+uint32 nuiFileVoice::GetStreamReadable() const
+{
+  uint32 readable = mStreamRings[0]->GetReadable();
+  for (size_t c = 1; c < mStreamRings.size(); c++)
+    readable = MIN(readable, mStreamRings[c]->GetReadable());
+  return readable;
+}
+
+void nuiFileVoice::RequestSeek(int64 position)
+{
+  mStreamPosition = position;
+  mSeekPosition = position;
+  mSeekGeneration++;
+}
+
+int32 nuiFileVoice::ReadStream(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames)
+{
+  const int32 channels = mStreamRings.size();
+  const int64 frames = mInfo.GetSampleFrames();
+  bool pending = mSeekAck.load(std::memory_order_acquire) != mSeekGeneration.load(std::memory_order_relaxed);
+  
+  // The voice was moved since the last call (a loop goes on seamlessly): the silence played until the loader catches up isn't an underrun.
+  int64 expected = mPlayPosition;
+  if (expected >= frames && mLoop)
+    expected -= frames;
+  mPlayPosition = position + SampleFrames;
+  if (position != expected)
+  {
+    mSeeks++;
+    mSeeking = true;
+  }
+  
+  // The loader wraps around when the voice loops:
+  if (!pending && mStreamPosition >= frames && mLoop)
+    mStreamPosition -= frames;
+  
+  if (!pending && position != mStreamPosition)
+  {
+    // Skipping a little forward (after an underrun for example) doesn't need to restart the loader:
+    int64 skip = position - mStreamPosition;
+    if (skip > 0 && skip <= GetStreamReadable())
+    {
+      for (int32 c = 0; c < channels; c++)
+        mStreamRings[c]->Discard(skip);
+      mStreamPosition = position;
+    }
+  }
+  
+  if (position != mStreamPosition)
+  {
+    RequestSeek(position);
+    pending = true;
+  }
+  
+  if (pending)
+  {
+    // The loader has not restarted yet: drop what is left from the previous position and play silence in the meantime.
+    for (int32 c = 0; c < channels; c++)
+    {
+      mStreamRings[c]->Discard(mStreamRings[c]->GetCapacity());
+      memset(rOutput[c], 0, SampleFrames * sizeof(float));
+    }
+    if (!mSeeking)
+      mUnderruns++;
+    RequestSeek(position + SampleFrames);
+    return SampleFrames;
+  }
+  
+  mSeeking = false;
+  const uint32 read = MIN((uint32)SampleFrames, GetStreamReadable());
+  for (int32 c = 0; c < channels; c++)
+  {
+    mStreamRings[c]->Pop(rOutput[c], read);
+    if (read < (uint32)SampleFrames)
+      memset(rOutput[c] + read, 0, (SampleFrames - read) * sizeof(float));
+  }
+  mStreamPosition += read;
+  
+  if (read < (uint32)SampleFrames)
+    mUnderruns++;
+  
+  // Even on underrun we consume the requested frames so that the voice's timeline keeps going.
+  return SampleFrames;
+}
+
+bool nuiFileVoice::FillStream()
+{
+  const int32 channels = mStreamRings.size();
+  const uint32 generation = mSeekGeneration.load(std::memory_order_acquire);
+  if (generation != mSeekAck.load(std::memory_order_relaxed))
+  {
+    // Wait for the audio thread to drop the frames of the previous position.
+    for (int32 c = 0; c < channels; c++)
+    {
+      if (mStreamRings[c]->GetWritable() != mStreamRings[c]->GetCapacity())
+        return false;
+    }
+    
+    int64 position = mSeekPosition;
+    if (generation != mSeekGeneration)
+      return true; // The audio thread moved again, try again
+    
+    mLoaderPosition = position;
+    mSeekAck.store(generation, std::memory_order_release);
+  }
+  
+  const int64 frames = mInfo.GetSampleFrames();
+  if (mLoaderPosition >= frames)
+  {
+    if (!mLoop)
+      return false;
+    mLoaderPosition = 0;
+  }
+  
+  uint32 writable = mStreamRings[0]->GetWritable();
+  for (int32 c = 1; c < channels; c++)
+    writable = MIN(writable, mStreamRings[c]->GetWritable());
+  
+  const uint32 chunk = mDecodeData.size() / channels;
+  if (writable < chunk)
+    return false;
+  
+  const int32 todo = (int32)MIN((int64)chunk, frames - mLoaderPosition);
+  mpReader->SetPosition(mLoaderPosition);
+  int32 read = mpReader->ReadDE(mDecodePointers, todo, eSampleFloat32);
+  if (read <= 0)
+  {
+    mLoaderPosition = frames;
+    return false;
+  }
+  
+  for (int32 c = 0; c < channels; c++)
+    mStreamRings[c]->Push((const float*)mDecodePointers[c], read);
+  mLoaderPosition += read;
+  
+  return true;
+}
+
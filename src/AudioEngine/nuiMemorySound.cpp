@@ -9,6 +9,7 @@
 
 nuiMemorySound::nuiMemorySound(const nglPath& rPath)
 : mLength(0),
+  mSampleRate(0),
   mPath(rPath)
 {
   mType = eMemory;
@@ -17,7 +18,8 @@ nuiMemorySound::nuiMemorySound(const nglPath& rPath)
 }
 
 nuiMemorySound::nuiMemorySound(const nglString& rSoundID, nglIStream* pStream)
-: mLength(0)
+: mLength(0),
+  mSampleRate(0)
 {
   mType = eMemory;
   LoadSamples(pStream);
@@ -86,6 +88,7 @@ bool nuiMemorySound::LoadSamples(nglIStream* pSStream)
   }
   
   mLength = pReader->ReadDE(temp, length, eSampleFloat32);
+  mSampleRate = info.GetSampleRate();
   delete pReader;
   if (!pSStream)
     delete pStream;
@@ -113,6 +116,11 @@ int32 nuiMemorySound::ReadSamples(const std::vector<float*>& rBuffers, int64 pos
   return todo;
 }
 
+const float* nuiMemorySound::GetSamples(int32 Channel) const
+{
+  return mSamples[Channel];
+}
+
 int32 nuiMemorySound::GetSampleFrames() const
 {
   return mLength;
@@ -123,3 +131,8 @@ int32 nuiMemorySound::GetChannels()const
   return mSamples.size();
 }
 
+double nuiMemorySound::GetSampleRate() const
+{
+  return mSampleRate;
+}
+
@@ -54,6 +54,14 @@ int32 nuiMemoryVoice::GetSampleFrames() const
   return mpMemorySound->GetSampleFrames();
 }
 
+double nuiMemoryVoice::GetSampleRate() const
+{
+  if (!IsValid())
+    return 0;
+  
+  return mpMemorySound->GetSampleRate();
+}
+
 int32 nuiMemoryVoice::ReadSamples(const std::vector<float*>& rOutput, int64 position, int32 SampleFrames)
 {
   if (!IsValid())
@@ -67,6 +75,26 @@ int32 nuiMemoryVoice::ReadSamples(const std::vector<float*>& rOutput, int64 posi
   return read;
 }
 
+bool nuiMemoryVoice::HasDirectSamples() const
+{
+  return true;
+}
+
+int32 nuiMemoryVoice::GetDirectSamples(std::vector<const float*>& rChannels, int64 position, int32 SampleFrames)
+{
+  if (!IsValid())
+    return 0;
+  
+  if (position >= mpMemorySound->GetSampleFrames())
+    return 0;
+  
+  // The sound is fully decoded: mix straight from its buffers, no copy.
+  for (uint32 c = 0; c < rChannels.size(); c++)
+    rChannels[c] = mpMemorySound->GetSamples(c) + position;
+  
+  return MIN(SampleFrames, mpMemorySound->GetSampleFrames() - position);
+}
+
 bool nuiMemoryVoice::Init()
 {
   return true;
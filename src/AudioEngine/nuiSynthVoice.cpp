@@ -126,20 +126,20 @@ int32 nuiSynthVoice::ReadSamples(const std::vector<float*>& rOutput, int64 posit
   float interp;
   float val;
   nuiSynthSound::Wave& rWave = nuiSynthSound::mWaveTables[(int)mSignalType][0];
+  float* pOutput = rOutput[0];
   for (int32 i = 0; i < todo; i++)
   {
     posInt = ToBelow(mWavePosition);
     interp = mWavePosition - posInt;
     mLevel += mLevelCoeff * mLevel;
     val = interp * rWave[posInt] + (1.f - interp) * rWave[posInt + 1];
-    val *= mLevel;
-    for (int32 c = 0; c < rOutput.size(); c++)
-    {
-      rOutput[c][i] = val;
-    }
+    pOutput[i] = val * mLevel;
       
     UpdateWavePosition(mIncr);
   }
   
+  for (int32 c = 1; c < rOutput.size(); c++)
+    nuiAudioDSP_Copy(pOutput, rOutput[c], todo);
+  
   return todo;
 }
\ No newline at end of file
@@ -16,13 +16,21 @@ nuiVoice::nuiVoice(nuiSound* pSound)
   mMute(false),
   mGain(1.f),
   mPan(0),
+  mPanLaw(eAudioPanBalance),
   mPosition(0),
   mFadingIn(false),
   mFadeInPosition(0),
   mFadeInLength(0),
   mFadingOut(false),
   mFadeOutPosition(0),
-  mFadeOutLength(0)
+  mFadeOutLength(0),
+  mScratchFrames(0),
+  mOutputSampleRate(0),
+  mResamplingQuality(nuiPolyphaseResampler::eNormal),
+  mpResampler(NULL),
+  mResampleFrames(0),
+  mResampleTail(-1),
+  mEngineSlot(-1)
 {
   if (SetObjectClass(_T("nuiVoice")))
     InitAttributes();
@@ -32,13 +40,20 @@ nuiVoice::nuiVoice(nuiSound* pSound)
 }
 
 nuiVoice::nuiVoice(const nuiVoice& rVoice)
-: mpSound(NULL)
+: mpSound(NULL),
+  mScratchFrames(0),
+  mOutputSampleRate(0),
+  mpResampler(NULL),
+  mResampleFrames(0),
+  mResampleTail(-1),
+  mEngineSlot(-1)
 {
   *this = rVoice;
 }
 
 nuiVoice::~nuiVoice()
 {
+  delete mpResampler;
   if (mpSound)
     mpSound->Release();
 }
@@ -57,7 +72,9 @@ nuiVoice& nuiVoice::operator=(const nuiVoice& rVoice)
   mMute = rVoice.mMute;
   mGain = rVoice.mGain;
   mPan = rVoice.mPan;
+  mPanLaw = rVoice.mPanLaw;
   mPosition = rVoice.mPosition;
+  mResamplingQuality = rVoice.mResamplingQuality;
   
   return *this;
 }
@@ -117,17 +134,13 @@ bool nuiVoice::IsDone() const
 void nuiVoice::Process(const std::vector<float*>& rOutput, int32 SampleFrames)
 {
   int32 done = 0;
-  std::vector<float*> output;
-  for (int c = 0; c < rOutput.size(); c++)
-    output.push_back(rOutput[c]);
-  
   while (done < SampleFrames)
   {
     int64 nextevent = std::numeric_limits<int64>::max();
     int64 pos = GetPosition();
     {
       nglCriticalSectionGuard guard(mEventCs);
-      while (!mEvents.empty() && mEvents.front().mPosition == pos)
+      while (!mEvents.empty() && mEvents.front().mPosition <= pos)
       {
         const nuiVoiceEvent& event(mEvents.front());
         switch (event.mType)
@@ -150,19 +163,107 @@ void nuiVoice::Process(const std::vector<float*>& rOutput, int32 SampleFrames)
     }
     
     const int64 nexteventwait = nextevent - pos;
-    const int64 todo = MIN(SampleFrames, nexteventwait);
-    
-    
+    const int32 todo = MIN(SampleFrames - done, nexteventwait);
     
-    ProcessInternal(rOutput, todo);
-    for (int c = 0; c < output.size(); c++)
-      output[c] += todo;
+    ProcessInternal(rOutput, done, todo);
 
     done += todo;
   }
 }
 
-void nuiVoice::ProcessInternal(const std::vector<float*>& rOutput, int32 SampleFrames)
+void nuiVoice::Prepare(int32 MaxSampleFrames, double SampleRate)
+{
+  nglCriticalSectionGuard guard(mCs);
+  if (SampleRate > 0)
+    mOutputSampleRate = SampleRate;
+  
+  const int32 channels = IsValid() ? GetChannels() : 0;
+  if (mScratch.size() != (size_t)channels || mScratchFrames < MaxSampleFrames)
+  {
+    mScratchFrames = MAX(mScratchFrames, MaxSampleFrames);
+    mScratchData.resize(channels * mScratchFrames);
+    mScratch.resize(channels);
+    for (int32 c = 0; c < channels; c++)
+      mScratch[c] = &mScratchData[c * mScratchFrames];
+    mSources.resize(channels);
+  }
+  
+  const double sourceRate = IsValid() ? GetSampleRate() : 0;
+  if (channels == 0 || sourceRate <= 0 || mOutputSampleRate <= 0 || sourceRate == mOutputSampleRate)
+  {
+    delete mpResampler;
+    mpResampler = NULL;
+    return;
+  }
+  
+  if (mpResampler && (mpResampler->GetChannels() != channels || mpResampler->GetQuality() != mResamplingQuality))
+  {
+    delete mpResampler;
+    mpResampler = NULL;
+  }
+  
+  if (!mpResampler)
+  {
+    mpResampler = new nuiPolyphaseResampler(channels, sourceRate, mOutputSampleRate, mResamplingQuality);
+    mResampleTail = -1;
+  }
+  else if (mpResampler->GetInputRate() != sourceRate || mpResampler->GetOutputRate() != mOutputSampleRate)
+  {
+    mpResampler->SetRates(sourceRate, mOutputSampleRate);
+  }
+  mpResampler->Prepare(mScratchFrames);
+  
+  // Source frames needed for one block of output:
+  const int32 frames = (int32)ceil(mScratchFrames * sourceRate / mOutputSampleRate) + mpResampler->GetLatency() * 2 + 4;
+  if (mResampleInput.size() != (size_t)channels || mResampleFrames < frames)
+  {
+    mResampleFrames = MAX(mResampleFrames, frames);
+    mResampleData.resize(channels * mResampleFrames);
+    mResampleInput.resize(channels);
+    for (int32 c = 0; c < channels; c++)
+      mResampleInput[c] = &mResampleData[c * mResampleFrames];
+    mResampleSources.resize(channels);
+  }
+}
+
+double nuiVoice::GetSampleRate() const
+{
+  return 0;
+}
+
+nuiPolyphaseResampler::Quality nuiVoice::GetResamplingQuality() const
+{
+  return mResamplingQuality;
+}
+
+void nuiVoice::SetResamplingQuality(nuiPolyphaseResampler::Quality quality)
+{
+  nglCriticalSectionGuard guard(mCs);
+  mResamplingQuality = quality;
+  if (mpResampler)
+    Prepare(mScratchFrames);
+}
+
+bool nuiVoice::IsResampling() const
+{
+  return mpResampler != NULL;
+}
+
+bool nuiVoice::HasDirectSamples() const
+{
+  return false;
+}
+
+void nuiVoice::SetOffline(bool Offline)
+{
+}
+
+int32 nuiVoice::GetDirectSamples(std::vector<const float*>& rChannels, int64 position, int32 SampleFrames)
+{
+  return 0;
+}
+
+void nuiVoice::ProcessInternal(const std::vector<float*>& rOutput, int32 Offset, int32 SampleFrames)
 {
   if (!mpSound || !mPlay || !IsValid())
     return;
@@ -177,62 +278,24 @@ void nuiVoice::ProcessInternal(const std::vector<float*>& rOutput, int32 SampleF
     NGL_ASSERT(0);
   }
   
-  // create temp buffers
-  std::vector<float*> buffers;
-  for (int32 c = 0; c < inChannels; c++)
-  {
-    float* pTemp = new float[SampleFrames];
-    memset(pTemp, 0, SampleFrames * sizeof(float));
-    buffers.push_back(pTemp);
-  }
+  // The engine prepares the voices before they reach the audio thread, this only allocates if we are called with bigger buffers:
+  if (mScratch.size() != (size_t)inChannels || mScratchFrames < SampleFrames)
+    Prepare(SampleFrames);
   
   nglCriticalSectionGuard guard(mCs);
   
-  // fill temp buffers with data from the reader
-  int32 done = 0;
-  int32 toread = SampleFrames;
-  while (toread && !mDone)
-  {    
-    std::vector<float*> temp;
-    for (int32 c = 0; c < inChannels; c++)
-      temp.push_back(buffers[c] + done);
-   
-    int32 read = ReadSamples(temp, mPosition, toread);
-    
-    mPosition += read;
-    done += read;
-    toread -= read;
-    
-    if (read == 0)
-    {
-      if (mLoop)
-        mPosition = 0;
-      else 
-        mDone = true;
-    }
-  }
-  
-  // Fades
+  // Fades. They are linear so the fade times the gain is a linear ramp too: it is applied while mixing, in the same pass.
+  int32 fadeFrames = 0;
+  float fadeStart = 1.f;
+  float fadeEnd = 1.f;
+  float fadeTail = 1.f; // Level after the fade
   if (mFadingIn)
   {
-    int32 todo = MIN(SampleFrames, mFadeInLength - mFadeInPosition);
-    
-    float* pFade = new float[todo];
-    float* pTempFade = pFade;
-    for (int32 i = 0; i < todo; i++)
-      *pTempFade++ = (float)(mFadeInPosition + i) / (float)mFadeInLength;
-    
-    for (int32 c = 0; c < inChannels; c++)
-    {
-      float* pDst = buffers[c];
-      pTempFade = pFade;
-      for (int32 i = 0; i < todo; i++)
-        *pDst++ *= *pTempFade++;
-    }
-    
-    delete[] pFade;
+    fadeFrames = MIN(SampleFrames, mFadeInLength - mFadeInPosition);
+    fadeStart = (float)mFadeInPosition / (float)mFadeInLength;
+    fadeEnd = (float)(mFadeInPosition + fadeFrames) / (float)mFadeInLength;
     
-    mFadeInPosition += todo;
+    mFadeInPosition += fadeFrames;
     if (mFadeInPosition == mFadeInLength)
     {
       mFadingIn = false;
@@ -241,61 +304,154 @@ void nuiVoice::ProcessInternal(const std::vector<float*>& rOutput, int32 SampleF
   }
   else if (mFadingOut)
   {
-    int32 todo = MIN(SampleFrames, mFadeOutLength - mFadeOutPosition);
+    fadeFrames = MIN(SampleFrames, mFadeOutLength - mFadeOutPosition);
+    fadeStart = 1.f - ((float)mFadeOutPosition / (float)mFadeOutLength);
+    fadeEnd = 1.f - ((float)(mFadeOutPosition + fadeFrames) / (float)mFadeOutLength);
     
-    float* pFade = new float[todo];
-    float* pTempFade = pFade;
-    for (int32 i = 0; i < todo; i++)
-      *pTempFade++ = 1.f - ((float)(mFadeOutPosition + i) / (float)mFadeOutLength);
-    
-    for (int32 c = 0; c < inChannels; c++)
-    {
-      float* pDst = buffers[c];
-      pTempFade = pFade;
-      for (int32 i = 0; i < todo; i++)
-        *pDst++ *= *pTempFade++;
-    }
-    
-    delete[] pFade;
-    
-    mFadeOutPosition += todo;
+    mFadeOutPosition += fadeFrames;
     if (mFadeOutPosition == mFadeOutLength)
     {
       mFadingOut = false;
       mFadeOutPosition = 0;
       mPlay = false;
+      fadeTail = 0.f;
+    }
+  }
+  
+  float panLeft = 0.f;
+  float panRight = 0.f;
+  if (!mMute && mGain > 0.f)
+  {
+    nuiAudioDSP_PanGains(mPan, mPanLaw, panLeft, panRight);
+    panLeft *= mGain;
+    panRight *= mGain;
+  }
+  const bool silent = (panLeft == 0.f && panRight == 0.f);
+  const float fadeStep = fadeFrames ? (fadeEnd - fadeStart) / (float)fadeFrames : 0.f;
+  
+  // Read the samples (straight from memory if the voice allows it) and mix them as they come:
+  int32 done = 0;
+  while (done < SampleFrames && !mDone)
+  {
+    const int32 toread = SampleFrames - done;
+    const int32 read = mpResampler ? ReadResampled(toread) : ReadSource(toread);
+    if (read == 0)
+      continue;
+    
+    if (!silent)
+    {
+      // The part of this chunk that is in the fade:
+      const int32 rampEnd = MIN(done + read, fadeFrames);
+      if (done < rampEnd)
+        MixSamples(rOutput, 0, Offset + done, rampEnd - done, panLeft, panRight, fadeStart + fadeStep * done, fadeStart + fadeStep * rampEnd);
       
-      for (int32 c = 0; c < inChannels; c++)
-      {
-        float* pDst = buffers[c];
-        for (int32 i = todo; i < SampleFrames; i++)
-          pDst[i] = 0;
-      }
+      // The rest:
+      const int32 from = MAX(done, fadeFrames);
+      if (from < done + read && fadeTail > 0.f)
+        MixSamples(rOutput, from - done, Offset + from, done + read - from, panLeft, panRight, fadeTail, fadeTail);
     }
+    
+    done += read;
+  }
+}
+
+int32 nuiVoice::ReadSource(int32 SampleFrames)
+{
+  int32 read = 0;
+  if (HasDirectSamples())
+  {
+    read = GetDirectSamples(mSources, mPosition, SampleFrames);
+  }
+  else
+  {
+    read = ReadSamples(mScratch, mPosition, SampleFrames);
+    for (int32 c = 0; c < mScratch.size(); c++)
+      mSources[c] = mScratch[c];
   }
   
+  if (read == 0)
+  {
+    if (mLoop)
+      mPosition = 0;
+    else 
+      mDone = true;
+  }
   
-  // copy temp buffers to output and apply gain
-  if (!mMute && mGain > 0.f)
+  mPosition += read;
+  return read;
+}
+
+int32 nuiVoice::ReadResampled(int32 SampleFrames)
+{
+  // Feed the resampler with exactly what it needs for SampleFrames output frames:
+  const bool direct = HasDirectSamples();
+  int32 needed = mpResampler->GetInputFramesNeeded(SampleFrames);
+  while (needed > 0)
   {
-    float pan = mPan;
-    pan = MIN(pan, 1.0);
-    pan = MAX(pan, -1.0);
-    float panLeft = MIN(1.0, 1.0 - pan);
-    float panRight = MIN(1.0, 1.0 + pan);
-    for (int32 c= 0; c < outChannels; c++)
+    if (mResampleTail >= 0)
     {
-      float mult = mGain * (c == 0 ? panLeft : panRight);
-      float* pSrc = (inChannels == outChannels) ? buffers[c] : buffers[0]; // mono input signal: use first channel
-      float* pDst = rOutput[c];
-      for (int32 i = 0; i < SampleFrames; i++)
-        *pDst++ += (*pSrc++) * mult;
+      // The source is over, flush the filter with silence:
+      mpResampler->PushSilence(needed);
+      mResampleTail += needed;
+      break;
     }
+    
+    const int32 toread = MIN(needed, mResampleFrames);
+    int32 read = 0;
+    if (direct)
+    {
+      read = GetDirectSamples(mResampleSources, mPosition, toread);
+    }
+    else
+    {
+      read = ReadSamples(mResampleInput, mPosition, toread);
+      for (int32 c = 0; c < mResampleInput.size(); c++)
+        mResampleSources[c] = mResampleInput[c];
+    }
+    
+    if (read == 0)
+    {
+      if (mLoop)
+        mPosition = 0;
+      else
+        mResampleTail = 0;
+      continue;
+    }
+    
+    mpResampler->Push(mResampleSources, read);
+    mPosition += read;
+    needed -= read;
   }
   
-  for (int32 c = 0; c < buffers.size(); c++)
-    delete[] buffers[c];
+  const int32 read = mpResampler->Pull(mScratch, SampleFrames);
+  for (int32 c = 0; c < mScratch.size(); c++)
+    mSources[c] = mScratch[c];
+  
+  // Done once the last source frame has left the filter window:
+  if (mResampleTail >= mpResampler->GetLatency() * 2)
+    mDone = true;
   
+  return read;
+}
+
+void nuiVoice::MixSamples(const std::vector<float*>& rOutput, int32 SourceOffset, int32 Offset, int32 SampleFrames, float GainLeft, float GainRight, float StartLevel, float EndLevel)
+{
+  const int32 outChannels = rOutput.size();
+  const int32 inChannels = mSources.size();
+  
+  if (inChannels == 1 && outChannels == 2)
+  {
+    const float* pSrc = mSources[0] + SourceOffset;
+    nuiAudioDSP_MixAddStereoRamp(pSrc, rOutput[0] + Offset, rOutput[1] + Offset, SampleFrames, GainLeft * StartLevel, GainLeft * EndLevel, GainRight * StartLevel, GainRight * EndLevel);
+    return;
+  }
+  
+  for (int32 c = 0; c < outChannels; c++)
+  {
+    const float gain = (c == 0) ? GainLeft : GainRight;
+    const float* pSrc = mSources[(inChannels == outChannels) ? c : 0] + SourceOffset; // mono input signal: use first channel
+    nuiAudioDSP_MixAddRamp(pSrc, rOutput[c] + Offset, SampleFrames, gain * StartLevel, gain * EndLevel);
+  }
 }
 
 void nuiVoice::Play()
@@ -367,6 +523,11 @@ void nuiVoice::SetPosition(int64 position)
   nglCriticalSectionGuard guard(mCs);
   SetPositionInternal(position);
   mPosition = position;
+  if (mpResampler)
+  {
+    mpResampler->Reset();
+    mResampleTail = -1;
+  }
 }
 
 void nuiVoice::SetPositionInternal(int64 position)
@@ -418,6 +579,16 @@ void nuiVoice::SetPan(float pan)
   mPan = pan;
 }
 
+nuiAudioPanLaw nuiVoice::GetPanLaw() const
+{
+  return mPanLaw;
+}
+
+void nuiVoice::SetPanLaw(nuiAudioPanLaw Law)
+{
+  mPanLaw = Law;
+}
+
 void nuiVoice::PostEvent(const nuiVoiceEvent& rEvent)
 {
   nglCriticalSectionGuard guard(mEventCs);
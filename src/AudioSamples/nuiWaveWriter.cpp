@@ -317,10 +317,10 @@ int32 nuiWaveWriter::Write(const void* pBuffer, int32 SampleFrames, nuiSampleBit
         {
           float* pTempFloat = (float*)pBuffer;
           
-          int16* pInt16Buffer = new int16[SamplePointsToWrite];
-          nuiAudioConvert_FloatBufferTo16bits(pTempFloat, pInt16Buffer, SamplePointsToWrite);
+          std::vector<int16> TempBuffer(SamplePointsToWrite);
+          nuiAudioConvert_FloatBufferTo16bits(pTempFloat, &TempBuffer[0], SamplePointsToWrite);
           
-          SampleFramesWritten = (int32)mrStream.WriteInt16(pInt16Buffer, SamplePointsToWrite) / mrSampleInfo.GetChannels();
+          SampleFramesWritten = (int32)mrStream.WriteInt16(&TempBuffer[0], SamplePointsToWrite) / mrSampleInfo.GetChannels();
         }
           break;
           
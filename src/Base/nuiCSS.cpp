@@ -2197,6 +2197,23 @@ uint32 nuiCSSRule::GetMatchersTag() const
   return mMatchersTag;
 }
 
+nuiWidgetMatcher* nuiCSSRule::GetIndexMatcher() const
+{
+  // The matchers are stored from right to left, the first ones test the widget itself until one moves to a parent:
+  nuiWidgetMatcher* pClassMatcher = NULL;
+  for (size_t i = 0; i < mMatchers.size(); i++)
+  {
+    nuiWidgetMatcher* pMatcher = mMatchers[i];
+    if (dynamic_cast<nuiWidgetParentMatcher*>(pMatcher) || dynamic_cast<nuiWidgetParentConditionMatcher*>(pMatcher))
+      break;
+    if (dynamic_cast<nuiWidgetNameMatcher*>(pMatcher))
+      return pMatcher;
+    if (!pClassMatcher && dynamic_cast<nuiWidgetClassMatcher*>(pMatcher))
+      pClassMatcher = pMatcher;
+  }
+  return pClassMatcher;
+}
+
 void nuiCSSRule::ApplyAction(nuiObject* pObject)
 {
   nuiWidget* pWidget = dynamic_cast<nuiWidget*> (pObject);
@@ -2244,7 +2261,10 @@ void nuiEventActionHolder::OnEventFired(const nuiEvent& rEvent)
 
 // class nuiCSS
 
+static std::atomic<uint32> gCSSGeneration(0);
+
 nuiCSS::nuiCSS()
+: mGeneration(++gCSSGeneration)
 {
   
 }
@@ -2296,10 +2316,11 @@ bool nuiCSS::Serialize(nglOStream& rStream)
 
 void nuiCSS::ApplyRules(nuiWidget* pWidget, uint32 MatchersTag)
 {
-  int32 count = (int32)mRules.size();
+  const std::vector<nuiCSSRule*>& rRules(GetCandidateRules(pWidget));
+  int32 count = (int32)rRules.size();
   for (int32 i = 0; i < count; i++)
   {
-    nuiCSSRule* pRule = mRules[i];
+    nuiCSSRule* pRule = rRules[i];
     pRule->ApplyRule(pWidget, MatchersTag);
   }
   pWidget->IncrementCSSPass();
@@ -2308,20 +2329,75 @@ void nuiCSS::ApplyRules(nuiWidget* pWidget, uint32 MatchersTag)
 bool nuiCSS::GetMatchingRules(nuiWidget* pWidget, std::vector<nuiCSSRule*>& rMatchingRules, uint32 MatchersTag)
 {
   rMatchingRules.clear();
-  for (int32 i = 0; i < (int32)mRules.size(); i++)
+  const std::vector<nuiCSSRule*>& rRules(GetCandidateRules(pWidget));
+  for (int32 i = 0; i < (int32)rRules.size(); i++)
   {
-    if (mRules[i]->Match(pWidget, MatchersTag))
+    if (rRules[i]->Match(pWidget, MatchersTag))
     {
-      rMatchingRules.push_back(mRules[i]);
+      rMatchingRules.push_back(rRules[i]);
     }
   }
   
   return !rMatchingRules.empty();
  }
 
+const std::vector<nuiCSSRule*>& nuiCSS::GetCandidateRules(nuiWidget* pWidget)
+{
+  const std::vector<nuiCSSRule*>* pRules = pWidget->GetCSSRules(this, mGeneration);
+  if (pRules)
+    return *pRules;
+  
+  // Most names are not used by any rule, these widgets share the list of their class:
+  const int32 classIndex = pWidget->GetObjectClassNameIndex();
+  std::map<nglString, std::vector<uint32> >::const_iterator name = mNameRules.find(pWidget->GetObjectName());
+  std::pair<int32, nglString> key(classIndex, (name != mNameRules.end()) ? name->first : nglString::Null);
+  
+  std::map<std::pair<int32, nglString>, std::vector<nuiCSSRule*> >::iterator it = mCandidates.find(key);
+  if (it == mCandidates.end())
+  {
+    std::vector<uint32> indices(mJokerRules);
+    if (name != mNameRules.end())
+      indices.insert(indices.end(), name->second.begin(), name->second.end());
+    const int32 classes = nuiObject::GetClassCount();
+    int32 depth = 0;
+    for (int32 c = classIndex; c >= 0 && depth < classes; c = nuiObject::GetParentClassIndex(c), depth++)
+    {
+      std::map<int32, std::vector<uint32> >::const_iterator bucket = mClassRules.find(c);
+      if (bucket != mClassRules.end())
+        indices.insert(indices.end(), bucket->second.begin(), bucket->second.end());
+    }
+    
+    // Keep the declaration order, later rules override the earlier ones:
+    std::sort(indices.begin(), indices.end());
+    
+    it = mCandidates.insert(std::make_pair(key, std::vector<nuiCSSRule*>())).first;
+    it->second.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i++)
+      it->second.push_back(mRules[indices[i]]);
+  }
+  
+  pWidget->SetCSSRules(this, mGeneration, &it->second);
+  return it->second;
+}
+
 void nuiCSS::AddRule(nuiCSSRule* pRule)
 {
+  const uint32 index = mRules.size();
   mRules.push_back(pRule);
+  
+  nuiWidgetMatcher* pMatcher = pRule->GetIndexMatcher();
+  nuiWidgetNameMatcher* pNameMatcher = dynamic_cast<nuiWidgetNameMatcher*>(pMatcher);
+  nuiWidgetClassMatcher* pClassMatcher = dynamic_cast<nuiWidgetClassMatcher*>(pMatcher);
+  if (pNameMatcher)
+    mNameRules[pNameMatcher->GetName()].push_back(index);
+  else if (pClassMatcher)
+    mClassRules[pClassMatcher->GetClassIndex()].push_back(index);
+  else
+    mJokerRules.push_back(index);
+  
+  // The candidate lists are rebuilt on demand:
+  mCandidates.clear();
+  mGeneration = ++gCSSGeneration;
 }
 
 nuiObject* nuiCSS::CreateObject(const nglString& rType, const nglString& rName)
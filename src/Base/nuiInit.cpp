@@ -184,6 +184,13 @@ bool nuiUninit()
 
   if (!gNUIReferences)
   {
+    // Stop the shared workers before the objects their tasks could reference go away:
+    nuiTaskPool::ReleaseDefault();
+    nuiTessellator::ReleaseTessellators();
+#ifndef _MINUI3_
+    nuiFileVoice::ReleaseLoader();
+#endif
+
     // Destroy all the windows that are still alive:
 #ifndef _MINUI3_
     nuiMainWindow::DestroyAllWindows();
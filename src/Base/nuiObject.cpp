@@ -554,6 +554,12 @@ const nglString& nuiObject::GetClassNameFromIndex(int32 index)
   return mObjectClassNames[index];
 }
 
+int32 nuiObject::GetParentClassIndex(int32 ClassIndex)
+{
+  const int32 parent = mInheritanceMap[ClassIndex];
+  return (parent >= 0 && parent != ClassIndex) ? parent : -1;
+}
+
 //////////////////////////// Global Properties
 nuiPropertyMap nuiObject::mGlobalProperties;
 
@@ -0,0 +1,332 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+
+#define NUI_TASKPOOL_IDLE_WAIT 100 // ms. Safety net: a parked worker rescans the deques at least this often.
+
+//class nuiTaskGroup
+nuiTaskGroup::nuiTaskGroup()
+: mPending(0)
+{
+  mDone.Set();
+}
+
+nuiTaskGroup::~nuiTaskGroup()
+{
+  NGL_ASSERT(mPending == 0);
+}
+
+bool nuiTaskGroup::IsDone() const
+{
+  return mPending.load(std::memory_order_acquire) == 0;
+}
+
+uint32 nuiTaskGroup::GetPending() const
+{
+  return mPending.load(std::memory_order_acquire);
+}
+
+void nuiTaskGroup::Add()
+{
+  if (mPending.fetch_add(1, std::memory_order_acq_rel) == 0)
+    mDone.Reset();
+}
+
+void nuiTaskGroup::Done()
+{
+  if (mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    mDone.Set();
+}
+
+
+//class nuiTaskPool::Worker
+class nuiTaskPool::Worker : public nglThread
+{
+public:
+  Worker(nuiTaskPool* pPool, uint32 Index, const nglString& rName, Priority priority)
+  : nglThread(rName, priority), mpPool(pPool), mIndex(Index), mCS(rName), mParked(false)
+  {
+  }
+
+  virtual ~Worker()
+  {
+  }
+
+  void OnStart()
+  {
+    while (!mpPool->mStop.load(std::memory_order_acquire))
+    {
+      Job job;
+      if (mpPool->FindJob(mIndex, job))
+      {
+        mpPool->Execute(job);
+        continue;
+      }
+
+      // Announce that we are about to sleep and check again so that a Post racing with us can't be missed:
+      mWakeUp.Reset();
+      mParked.store(true, std::memory_order_seq_cst);
+      if (mpPool->FindJob(mIndex, job))
+      {
+        mParked.store(false, std::memory_order_relaxed);
+        mpPool->Execute(job);
+        continue;
+      }
+
+      if (!mpPool->mStop.load(std::memory_order_acquire))
+        mWakeUp.Wait(NUI_TASKPOOL_IDLE_WAIT);
+      mParked.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  void Push(const Job& rJob, nuiTaskPool::Priority priority)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    mJobs[priority].push_back(rJob);
+  }
+
+  bool Pop(Job& rJob, nuiTaskPool::Priority priority)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    std::deque<Job>& rJobs(mJobs[priority]);
+    if (rJobs.empty())
+      return false;
+    rJob = rJobs.back();
+    rJobs.pop_back();
+    return true;
+  }
+
+  bool Steal(Job& rJob, nuiTaskPool::Priority priority)
+  {
+    if (!mCS.TryLock())
+      return false;
+    std::deque<Job>& rJobs(mJobs[priority]);
+    bool res = !rJobs.empty();
+    if (res)
+    {
+      rJob = rJobs.front();
+      rJobs.pop_front();
+    }
+    mCS.Unlock();
+    return res;
+  }
+
+  bool IsParked() const
+  {
+    return mParked.load(std::memory_order_seq_cst);
+  }
+
+  void WakeUp()
+  {
+    mWakeUp.Set();
+  }
+
+  nuiTaskPool* mpPool;
+  uint32 mIndex;
+  nglCriticalSection mCS;
+  std::deque<Job> mJobs[nuiTaskPool::ePriorityCount];
+  nglSyncEvent mWakeUp;
+  std::atomic<bool> mParked;
+};
+
+
+//class nuiTaskPool
+nuiTaskPool* nuiTaskPool::mpDefault = NULL;
+static nglCriticalSection gDefaultTaskPoolCS(nglString("nuiTaskPool::Default"));
+
+nuiTaskPool::nuiTaskPool(uint32 ThreadCount, const nglString& rName, nglThread::Priority ThreadPriority)
+: mNextWorker(0), mStop(false), mExecuted(0), mStolen(0)
+{
+  if (!ThreadCount)
+    ThreadCount = MAX(1, nglCPUInfo::GetCount());
+
+  for (uint32 i = 0; i < ThreadCount; i++)
+  {
+    nglString name;
+    name.CFormat(_T("%s %d"), rName.GetChars(), i);
+    mWorkers.push_back(new Worker(this, i, name, ThreadPriority));
+  }
+
+  for (uint32 i = 0; i < ThreadCount; i++)
+    mWorkers[i]->Start();
+}
+
+nuiTaskPool::~nuiTaskPool()
+{
+  mStop.store(true, std::memory_order_release);
+  for (uint32 i = 0; i < mWorkers.size(); i++)
+    mWorkers[i]->WakeUp();
+
+  for (uint32 i = 0; i < mWorkers.size(); i++)
+    mWorkers[i]->Join();
+
+  for (uint32 i = 0; i < mWorkers.size(); i++)
+  {
+    Worker* pWorker = mWorkers[i];
+    for (uint32 p = 0; p < ePriorityCount; p++)
+    {
+      std::deque<Job>& rJobs(pWorker->mJobs[p]);
+      for (size_t j = 0; j < rJobs.size(); j++)
+        Discard(rJobs[j]);
+      rJobs.clear();
+    }
+    delete pWorker;
+  }
+  mWorkers.clear();
+}
+
+void nuiTaskPool::Post(nuiTask* pTask, Priority priority, nuiTaskGroup* pGroup)
+{
+  NGL_ASSERT(pTask != NULL);
+  NGL_ASSERT(priority < ePriorityCount);
+  pTask->Acquire();
+  if (pGroup)
+    pGroup->Add();
+
+  Job job(pTask, pGroup);
+
+  Worker* pWorker = GetCurrentWorker();
+  if (!pWorker)
+    pWorker = mWorkers[mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size()];
+
+  pWorker->Push(job, priority);
+  WakeUp(pWorker->mIndex);
+}
+
+void nuiTaskPool::Wait(nuiTaskGroup& rGroup)
+{
+  Worker* pWorker = GetCurrentWorker();
+  if (pWorker)
+  {
+    // Never block a worker: help with the pending work until the group is complete.
+    while (!rGroup.IsDone())
+    {
+      Job job;
+      if (FindJob(pWorker->mIndex, job))
+        Execute(job);
+      else
+        nglThread::USleep(50);
+    }
+    return;
+  }
+
+  while (!rGroup.IsDone())
+    rGroup.mDone.Wait(NUI_TASKPOOL_IDLE_WAIT);
+}
+
+bool nuiTaskPool::RunOne()
+{
+  Worker* pWorker = GetCurrentWorker();
+  Job job;
+  if (!FindJob(pWorker ? pWorker->mIndex : mNextWorker.load(std::memory_order_relaxed) % mWorkers.size(), job))
+    return false;
+  Execute(job);
+  return true;
+}
+
+uint32 nuiTaskPool::GetThreadCount() const
+{
+  return mWorkers.size();
+}
+
+bool nuiTaskPool::IsWorkerThread() const
+{
+  return GetCurrentWorker() != NULL;
+}
+
+uint64 nuiTaskPool::GetExecutedCount() const
+{
+  return mExecuted.load(std::memory_order_relaxed);
+}
+
+uint64 nuiTaskPool::GetStolenCount() const
+{
+  return mStolen.load(std::memory_order_relaxed);
+}
+
+nuiTaskPool::Worker* nuiTaskPool::GetCurrentWorker() const
+{
+  for (uint32 i = 0; i < mWorkers.size(); i++)
+  {
+    if (mWorkers[i]->IsCurrent())
+      return mWorkers[i];
+  }
+  return NULL;
+}
+
+bool nuiTaskPool::FindJob(uint32 WorkerIndex, Job& rJob)
+{
+  const uint32 count = mWorkers.size();
+  Worker* pWorker = mWorkers[WorkerIndex];
+
+  for (int32 p = ePriorityCount - 1; p >= 0; p--)
+  {
+    Priority priority = (Priority)p;
+    if (pWorker->Pop(rJob, priority))
+      return true;
+
+    for (uint32 i = 1; i < count; i++)
+    {
+      Worker* pVictim = mWorkers[(WorkerIndex + i) % count];
+      if (pVictim->Steal(rJob, priority))
+      {
+        mStolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void nuiTaskPool::Execute(const Job& rJob)
+{
+  rJob.mpTask->Run();
+  rJob.mpTask->Release();
+  mExecuted.fetch_add(1, std::memory_order_relaxed);
+  if (rJob.mpGroup)
+    rJob.mpGroup->Done();
+}
+
+void nuiTaskPool::Discard(const Job& rJob)
+{
+  rJob.mpTask->Cancel();
+  rJob.mpTask->Release();
+  if (rJob.mpGroup)
+    rJob.mpGroup->Done();
+}
+
+void nuiTaskPool::WakeUp(uint32 Preferred)
+{
+  const uint32 count = mWorkers.size();
+  for (uint32 i = 0; i < count; i++)
+  {
+    Worker* pWorker = mWorkers[(Preferred + i) % count];
+    if (pWorker->IsParked())
+    {
+      pWorker->WakeUp();
+      return;
+    }
+  }
+}
+
+nuiTaskPool& nuiTaskPool::GetDefault()
+{
+  nglCriticalSectionGuard guard(gDefaultTaskPoolCS);
+  if (!mpDefault)
+    mpDefault = new nuiTaskPool();
+  return *mpDefault;
+}
+
+void nuiTaskPool::ReleaseDefault()
+{
+  nglCriticalSectionGuard guard(gDefaultTaskPoolCS);
+  delete mpDefault;
+  mpDefault = NULL;
+}
+
@@ -20,6 +20,7 @@ using namespace std;
 #include FT_FREETYPE_H
 #include FT_CACHE_H
 #include FT_TRUETYPE_TABLES_H
+#include FT_OUTLINE_H
 
 /* Globals
  */
@@ -35,6 +36,17 @@ float nuiFontBase::DefaultPixelSize = 14.f;
 
 const nuiFontBase::RenderMode nuiFontBase::AntiAliasing = (1 << 0);
 const nuiFontBase::RenderMode nuiFontBase::Hinting      = (1 << 1);
+const nuiFontBase::RenderMode nuiFontBase::DistanceField = (1 << 2);
+
+nuiFontBase::RenderMode nuiFontBase::DefaultRenderMode = nuiFontBase::AntiAliasing | nuiFontBase::Hinting;
+
+/* Distance field glyphs are rendered once per face at NUI_FONT_DISTANCE_FIELD_SIZE pixels and scaled to the size of
+ * each font. Their bitmaps cover NUI_FONT_DISTANCE_FIELD_SPREAD more pixels on each side, where the distance fades out.
+ */
+#define NUI_FONT_DISTANCE_FIELD_SIZE 32
+#define NUI_FONT_DISTANCE_FIELD_SPREAD 4
+
+static std::map<void*, nuiFontBase*> gDistanceFieldAtlases; // By face ID
 
 
 /* FreeType cache settings
@@ -57,6 +69,196 @@ const nuiFontBase::RenderMode nuiFontBase::Hinting      = (1 << 1);
 
 
 
+/* Per thread FreeType objects
+ *
+ * The cache manager is global and FreeType objects can't be used by two threads at once, while Shape and RasterizeGlyphRange
+ * run on any thread (see nuiTextLayout::SetTaskPool and RasterizeGlyphs). So each thread gets its own library in which it
+ * opens its own sized faces, with their HarfBuzz font. Loading a glyph from these faces with the flags of the image cache
+ * gives the same glyph as the image cache. The faces of a font are dropped (by their own thread, the next time it asks for a face) when the font is deleted.
+ */
+#define NUI_FONT_THREAD_FACES 16 // Faces kept open per thread, the least recently used one is closed first
+
+class nuiThreadGlyph
+{
+public:
+  bool mValid;
+  FT_Vector mAdvance; // 26.6, as HarfBuzz wants it
+  nuiGlyphInfo mInfo;
+};
+
+class nuiThreadFace
+{
+public:
+  FTC_FaceID mFaceID;
+  FT_Int mWidth; // Same types as in FTC_ImageTypeRec
+  FT_Int mHeight;
+  FT_Int32 mFlags;
+  int32 mCharMap;
+
+  FT_Face mFace;
+  hb_font_t* mpHBFont; // Created by Shape the first time it needs it
+  std::map<uint32, nuiThreadGlyph> mGlyphs; // Metrics of the glyphs loaded with mFlags, by index
+
+  const nuiThreadGlyph& GetGlyph(uint32 Index);
+};
+
+static bool nuiFillGlyphInfo(nuiGlyphInfo& rInfo, FT_Glyph glyph, uint Index);
+
+const nuiThreadGlyph& nuiThreadFace::GetGlyph(uint32 Index)
+{
+  std::map<uint32, nuiThreadGlyph>::iterator it = mGlyphs.find(Index);
+  if (it != mGlyphs.end())
+    return it->second;
+
+  nuiThreadGlyph& rGlyph(mGlyphs[Index]);
+  rGlyph.mValid = false;
+  rGlyph.mAdvance.x = 0;
+  rGlyph.mAdvance.y = 0;
+
+  FT_Glyph glyph;
+  if (FT_Load_Glyph(mFace, Index, mFlags) == FT_Err_Ok && FT_Get_Glyph(mFace->glyph, &glyph) == FT_Err_Ok)
+  {
+    rGlyph.mAdvance = mFace->glyph->advance;
+    rGlyph.mValid = nuiFillGlyphInfo(rGlyph.mInfo, glyph, Index);
+    FT_Done_Glyph(glyph);
+  }
+  return rGlyph;
+}
+
+class nuiThreadFreeType
+{
+public:
+  nuiThreadFreeType()
+  : mLibrary(NULL)
+  {
+  }
+
+  ~nuiThreadFreeType()
+  {
+    while (!mFaces.empty())
+    {
+      Close(mFaces.back());
+      mFaces.pop_back();
+    }
+    if (mLibrary)
+      FT_Done_FreeType(mLibrary);
+  }
+
+  nuiThreadFace* GetFace(const nuiFontInstance* pInstance, const FTC_ImageTypeRec& rDesc, int32 CharMap)
+  {
+    for (std::list<nuiThreadFace>::iterator it = mFaces.begin(); it != mFaces.end(); ++it)
+    {
+      if (it->mFaceID == rDesc.face_id && it->mWidth == rDesc.width && it->mHeight == rDesc.height && it->mFlags == (FT_Int32)rDesc.flags && it->mCharMap == CharMap)
+      {
+        mFaces.splice(mFaces.begin(), mFaces, it);
+        return &mFaces.front();
+      }
+    }
+
+    if (!mLibrary && FT_Init_FreeType(&mLibrary) != FT_Err_Ok)
+    {
+      mLibrary = NULL;
+      return NULL;
+    }
+
+    nuiThreadFace face;
+    face.mFaceID = rDesc.face_id;
+    face.mWidth = rDesc.width;
+    face.mHeight = rDesc.height;
+    face.mFlags = rDesc.flags;
+    face.mCharMap = CharMap;
+    face.mFace = NULL;
+    face.mpHBFont = NULL;
+    if (pInstance->CreateFace(mLibrary, &face.mFace) != FT_Err_Ok)
+      return NULL;
+    if (FT_Set_Pixel_Sizes(face.mFace, (FT_UInt)face.mWidth, (FT_UInt)face.mHeight) != FT_Err_Ok)
+    {
+      FT_Done_Face(face.mFace);
+      return NULL;
+    }
+    // Same charmap as the charmap cache lookups (see GetGlyphIndex):
+    if (CharMap >= 0 && CharMap < face.mFace->num_charmaps)
+      FT_Set_Charmap(face.mFace, face.mFace->charmaps[CharMap]);
+
+    if (mFaces.size() >= NUI_FONT_THREAD_FACES)
+    {
+      Close(mFaces.back());
+      mFaces.pop_back();
+    }
+    mFaces.push_front(face);
+    return &mFaces.front();
+  }
+
+  void Forget(FTC_FaceID FaceID)
+  {
+    std::list<nuiThreadFace>::iterator it = mFaces.begin();
+    while (it != mFaces.end())
+    {
+      if (it->mFaceID == FaceID)
+      {
+        Close(*it);
+        it = mFaces.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  std::vector<FTC_FaceID> mForgotten; // Faces to drop, filled by the other threads under gThreadFreeTypeCS
+
+private:
+  void Close(nuiThreadFace& rFace)
+  {
+    if (rFace.mpHBFont)
+      hb_font_destroy(rFace.mpHBFont);
+    FT_Done_Face(rFace.mFace);
+  }
+
+  FT_Library mLibrary;
+  std::list<nuiThreadFace> mFaces; // Most recently used first
+};
+
+static nglCriticalSection gThreadFreeTypeCS(nglString("nuiFontBase thread faces"));
+static std::map<nglThread::ID, nuiThreadFreeType*> gThreadFreeTypes;
+
+static nuiThreadFace* nuiGetThreadFace(const nuiFontInstance* pInstance, const FTC_ImageTypeRec& rDesc, int32 CharMap)
+{
+  nuiThreadFreeType* pThread = NULL;
+  std::vector<FTC_FaceID> forgotten;
+  {
+    nglCriticalSectionGuard guard(gThreadFreeTypeCS);
+    nuiThreadFreeType*& rpThread(gThreadFreeTypes[nglThread::GetCurThreadID()]);
+    if (!rpThread)
+      rpThread = new nuiThreadFreeType();
+    pThread = rpThread;
+    forgotten.swap(pThread->mForgotten);
+  }
+
+  for (uint32 i = 0; i < forgotten.size(); i++)
+    pThread->Forget(forgotten[i]);
+  return pThread->GetFace(pInstance, rDesc, CharMap);
+}
+
+static void nuiForgetThreadFaces(FTC_FaceID FaceID)
+{
+  nglCriticalSectionGuard guard(gThreadFreeTypeCS);
+  std::map<nglThread::ID, nuiThreadFreeType*>::iterator it = gThreadFreeTypes.begin();
+  for (; it != gThreadFreeTypes.end(); ++it)
+    it->second->mForgotten.push_back(FaceID);
+}
+
+static void nuiReleaseThreadFaces()
+{
+  nglCriticalSectionGuard guard(gThreadFreeTypeCS);
+  std::map<nglThread::ID, nuiThreadFreeType*>::iterator it = gThreadFreeTypes.begin();
+  for (; it != gThreadFreeTypes.end(); ++it)
+    delete it->second;
+  gThreadFreeTypes.clear();
+}
+
+
 /* Opaque structure which encapsulate FreeType's specific types
  */
 class FaceHandle
@@ -80,6 +282,7 @@ public:
   {
     if (mpFontInstance)
     {
+      nuiForgetThreadFaces(Desc.face_id);
       nuiFontInstance::Uninstall(mpFontInstance);
       mpFontInstance->Release();
     }
@@ -197,6 +400,7 @@ nuiFontDesc::nuiFontDesc(const nglPath& rPath, int32 Face)
   
   mPath = rPath;
   mFace = Face;
+  mLastMod = rPath.GetLastMod();
   
   
   FT_Error error = 0;
@@ -398,6 +602,11 @@ bool nuiFontDesc::CheckPath()
   return mPath.Exists();
 }
 
+double nuiFontDesc::GetLastMod() const
+{
+  return mLastMod;
+}
+
 const nglString& nuiFontDesc::GetName() const
 {
   return mName;
@@ -439,53 +648,24 @@ bool nuiFontDesc::HasEncoding(nglTextEncoding Encoding) const
   return (it != mEncodings.end());
 }
 
+static bool nuiGlyphRangeLess(nglUChar Glyph, const nuiFontDesc::GlyphRange& rRange)
+{
+  return Glyph < rRange.first;
+}
+
 bool nuiFontDesc::HasGlyph(nglUChar Glyph) const
 {
-#if 0
-  // Dichotomic lookup of the charcode:
-  
-  int32 len = mGlyphs.size();
-  int32 start = 0;
-  int32 end = len - 1;
-  int32 middle = (start + end) >> 1;
-  
-  while (len > 0)
-  {
-    const GlyphRange& middleglyph = mGlyphs[middle];
-    const GlyphRange& firstglyph = mGlyphs[start];
-    const GlyphRange& lastglyph = mGlyphs[end];
-    
-    if (Glyph < firstglyph.first || lastglyph.second < Glyph)
-      return false;
-    
-    if (middleglyph.first <= Glyph && Glyph <= middleglyph.second)
-      return true;
-    
-    if (middleglyph.first < Glyph) 
-    {
-      // Return right hand part
-      start = middle + 1;
-    }
-    else
-    {
-      // Return Left hand part
-      end = middle - 1;
-    }
-    
-    len = end - start;
-    middle = (start + end) >> 1;
-  }
-  return false;
-#else
-  
-  for (uint32 i = 0; i < mGlyphs.size(); i++)
-  {
-    if (mGlyphs[i].first <= Glyph && Glyph <= mGlyphs[i].second)
-      return true;
-  }
-  
-  return false;
-#endif
+  // Dichotomic lookup of the first range that starts after the charcode, the one before may contain it:
+  std::vector<GlyphRange>::const_iterator it = std::upper_bound(mGlyphs.begin(), mGlyphs.end(), Glyph, nuiGlyphRangeLess);
+  if (it == mGlyphs.begin())
+    return false;
+  --it;
+  return Glyph <= it->second;
+}
+
+const std::vector<nuiFontDesc::GlyphRange>& nuiFontDesc::GetGlyphRanges() const
+{
+  return mGlyphs;
 }
 
 bool nuiFontDesc::HasSize(int32 Size) const
@@ -569,6 +749,9 @@ bool nuiFontDesc::Save(nglOStream& rStream)
   // Write the panose bytes for this font:
   rStream.Write(&mPanoseBytes, 10, 1);
   
+  // Write the modification time of the file, the manager only rescans the files that changed since:
+  rStream.WriteDouble(&mLastMod);
+  
   delete[] pPath;
   delete[] pName;
   delete[] pStyle;
@@ -644,6 +827,10 @@ bool nuiFontDesc::Load(nglIStream& rStream)
   // Read the panose bytes for this font:
   rStream.Read(&mPanoseBytes, 10, 1);
   
+  // Read the modification time of the file:
+  if (rStream.ReadDouble(&mLastMod) != 1)
+    return false;
+  
   NGL_LOG("font", NGL_LOG_INFO, "Load FontDesc: '%s' / '%s' (%s)\n", mName.GetChars(), mStyle.GetChars(), mPath.GetChars());
   
   return true;
@@ -810,13 +997,35 @@ nuiFontBase::nuiFontBase (const nuiFontBase& rFont)
   mSize        = rFont.mSize;
   mResolution  = rFont.mResolution;
   mRenderMode  = rFont.mRenderMode;
+  mpDistanceFieldAtlas = NULL;
+  mIsDistanceFieldAtlas = false;
+  mTrimFrame = 0;
+  mTextureGeneration = 0;
   
   Init();
   Load(rFont.mpFace->Desc.face_id, mSize);
 }
 
+nuiFontBase::nuiFontBase(const nuiFontBase& rFont, float Size)
+{
+  Defaults();
+  mIsDistanceFieldAtlas = true;
+  Init();
+
+  // Install the face again so that the atlas keeps it alive:
+  nuiFontInstance* pInstance = nuiFontInstance::Lookup(rFont.mpFace->Desc.face_id);
+  mpFace->SetFontInstance(pInstance);
+  mpFace->Desc.face_id = nuiFontInstance::Install(pInstance);
+  LoadFinish(Size);
+}
+
 nuiFontBase::~nuiFontBase()
 {
+  nuiShapedRunCache::Forget(this);
+  if (mIsDistanceFieldAtlas)
+    gDistanceFieldAtlases.erase(mpFace->Desc.face_id);
+  if (mpDistanceFieldAtlas)
+    mpDistanceFieldAtlas->Release();
   delete mpFace;
 
   //NGL_OUT(_T("DestroyFont: %p\n"), this);
@@ -829,7 +1038,8 @@ nuiFontBase::~nuiFontBase()
     pTexture->Release();
   }
   mTextures.clear();
-  mGlyphLocationLookupTable.clear();
+  mTextureShelves.clear();
+  mGlyphLocationLookupTable.Clear();
 }
 
 
@@ -1115,6 +1325,11 @@ bool nuiFontBase::GetGlyphInfo (nuiGlyphInfo& rInfo, uint Index, GlyphType Type)
   if (!(glyph = (FT_Glyph)GetGlyph(Index, Type)))
     return false;
   
+  return nuiFillGlyphInfo(rInfo, glyph, Index);
+}
+
+static bool nuiFillGlyphInfo(nuiGlyphInfo& rInfo, FT_Glyph glyph, uint Index)
+{
   const float f = nuiGetInvScaleFactor();
   switch (glyph->format)
   {
@@ -1339,9 +1554,24 @@ bool nuiFontBase::SetRenderMode (nuiFontBase::RenderMode Mode)
   
   //flags |= FT_LOAD_TARGET_LCD;
   flags |= FT_LOAD_TARGET_LIGHT;
+
+  if (mIsDistanceFieldAtlas)
+    flags |= FT_LOAD_NO_BITMAP; // We need the outlines, even at sizes that have embedded bitmaps
   
   mpFace->Desc.flags = flags;
   mRenderMode = Mode;
+  nuiShapedRunCache::Forget(this); // Hinting changes the advances
+
+  if ((Mode & DistanceField) && !mIsDistanceFieldAtlas)
+  {
+    if (!mpDistanceFieldAtlas)
+      mpDistanceFieldAtlas = AcquireDistanceFieldAtlas();
+  }
+  else if (mpDistanceFieldAtlas)
+  {
+    mpDistanceFieldAtlas->Release();
+    mpDistanceFieldAtlas = NULL;
+  }
   
   return true;
 }
@@ -1531,16 +1761,14 @@ void nuiFontBase::Defaults()
   
   mLastResort = false;
 
+  mpDistanceFieldAtlas = NULL;
+  mIsDistanceFieldAtlas = false;
+  mTrimFrame = 0;
+  mTextureGeneration = 0;
+
   SetAlphaTest();
   
-  mCurrentX = 0;
-  mCurrentY = 0;
-  mCurrentTexture = 0;
-  
-  mRowMaxWidth = 0;
-  
-  nuiTexture *texture = AllocateTexture(nuiFontBase::TEXTURE_SIZE);
-  mTextures.push_back(texture);
+  // The glyph textures are allocated when the first glyph is cached (see FindGlyphLocation)
 }
 
 #define NGL_FTCACHE_MAX_FACES 10
@@ -1644,7 +1872,7 @@ bool nuiFontBase::LoadFinish(float Size)
   if (!SetSize(Size, eFontUnitPixel))
     return false;
   if (IsScalable())
-    SetRenderMode(AntiAliasing | Hinting);
+    SetRenderMode(mIsDistanceFieldAtlas ? AntiAliasing : DefaultRenderMode); // The distance fields are scaled, they can't be hinted
   
 
   FT_Face face = mpFace->Face;
@@ -1730,6 +1958,7 @@ void nuiFontBase::GetSizes(std::set<int32>& rSizes)
 
 void nuiFontBase::OnExit()
 {
+  nuiReleaseThreadFaces();
   nuiFontInstance::OnExit();
   
   if (gFTCacheManager)
@@ -1825,7 +2054,7 @@ void nuiFontBase::Blit8BitsBitmapToTexture(const GlyphBitmap &rBitmap, nuiTextur
       *pDst++ = *pSrc++;
     }
   }
-  pTexture->ForceReload();
+  pTexture->ForceReloadRect(nuiRect((float)OffsetX, (float)OffsetY, (float)rBitmap.Width, (float)rBitmap.Height));
 }
 
 bool nuiFontBase::CopyBitmapToTexture(const GlyphBitmap &rBitmap, nuiTexture *pTexture, unsigned int OffsetX, unsigned int OffsetY)
@@ -1867,40 +2096,56 @@ bool nuiFontBase::CopyBitmapToTexture(const GlyphBitmap &rBitmap, nuiTexture *pT
   return true;
 }
 
-bool nuiFontBase::FindNextGlyphLocation(int Width, int Height, int &rOffsetX, int &rOffsetY)
+void nuiFontBase::AddTexture(int size)
 {
-  int32 w = mTextures[mCurrentTexture]->GetWidth();
-  int32 h = mTextures[mCurrentTexture]->GetHeight();
+  mTextures.push_back(AllocateTexture(size));
+  mTextureShelves.push_back(TextureShelves());
+  if (mIsDistanceFieldAtlas)
+    mTextures.back()->SetDistanceFieldSpread(NUI_FONT_DISTANCE_FIELD_SPREAD);
+}
 
-  if ((rOffsetX + Width) < w)
+bool nuiFontBase::FindGlyphLocation(int Texture, int Width, int Height, bool BestFit, int &rOffsetX, int &rOffsetY)
+{
+  int32 w = mTextures[Texture]->GetWidth();
+  int32 h = mTextures[Texture]->GetHeight();
+  TextureShelves& rShelves(mTextureShelves[Texture]);
+
+  // Look for the lowest shelf that is high enough. When BestFit is set the shelf can't be much higher than the glyph:
+  Shelf* pShelf = NULL;
+  for (uint32 i = 0; i < rShelves.mShelves.size(); i++)
   {
-    if ((rOffsetY + Height) < h)
-    {
-      // there is enough space available
-      mRowMaxWidth = max(mRowMaxWidth, Width);
-      return true; 
-    }
-    
-    // Go back to the top of the texture, on the next column:
-    rOffsetX += mRowMaxWidth + 2;
-    rOffsetY = 0;     
+    Shelf& rShelf(rShelves.mShelves[i]);
+    if (rShelf.mHeight < Height || rShelf.mX + Width > w)
+      continue;
+    if (BestFit && rShelf.mHeight > Height + Height / 2 + 4)
+      continue;
+    if (!pShelf || rShelf.mHeight < pShelf->mHeight)
+      pShelf = &rShelf;
+  }
 
-    if ((rOffsetX + Width) < w)
-    {
-      if ((rOffsetY + Height) < h)
-      {
-        mRowMaxWidth = Width;
-        return true;
-      }
-      else // should move to another texture
-      {
-        return false;
-      }
-    }
+  if (!pShelf && BestFit)
+  {
+    // Open a new shelf below the others:
+    if (Width > w || rShelves.mBottom + Height > h)
+      return false;
+
+    rShelves.mShelves.push_back(Shelf(rShelves.mBottom, Height));
+    rShelves.mBottom += Height;
+    pShelf = &rShelves.mShelves.back();
   }
-  return false; // Move to another texture, this one is full...
+
+  if (!pShelf)
+    return false;
+
+  rOffsetX = pShelf->mX;
+  rOffsetY = pShelf->mY;
+  pShelf->mX += Width;
+  return true;
 }
 
+#define NUI_FONT_MAX_TEXTURE_SIZE 1024
+#define NUI_FONT_MAX_TEXTURES 4 // TrimTextures leaves the fonts that have fewer textures alone
+
 uint32 POT(uint32 i)
 {
   uint32 t = 1;
@@ -1914,52 +2159,303 @@ uint32 POT(uint32 i)
 
 const int nuiFontBase::TEXTURE_SIZE = 256;
 
-void nuiFontBase::AddCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation)
+void nuiFontBase::FindGlyphLocation(int Width, int Height, int &rTexture, int &rOffsetX, int &rOffsetY)
+{
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (rTexture = 0; rTexture < (int)mTextures.size(); rTexture++)
+    {
+      if (FindGlyphLocation(rTexture, Width, Height, pass == 0, rOffsetX, rOffsetY))
+        return;
+    }
+  }
+
+  // All the textures are full, each new one is twice as big as the previous one, up to NUI_FONT_MAX_TEXTURE_SIZE:
+  int size = TEXTURE_SIZE;
+  for (uint32 i = 0; i < mTextures.size() && size < NUI_FONT_MAX_TEXTURE_SIZE; i++)
+    size *= 2;
+  AddTexture(MAX(size, (int)(2 * POT(MAX(Width, Height)))));
+  rTexture = mTextures.size() - 1;
+  if (!FindGlyphLocation(rTexture, Width, Height, true, rOffsetX, rOffsetY))
+  {
+    NGL_ASSERT(0); // The new texture is always big enough for the glyph
+  }
+}
+
+bool nuiFontBase::AddCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation)
 {
+  if (mIsDistanceFieldAtlas)
+  {
+    GlyphBitmap bmp;
+    std::vector<uint8> pixels;
+    if (!GetDistanceFieldBitmap(Index, bmp, pixels))
+    {
+      NGL_OUT("Error getting glyph outline %d", Index);
+      return false;
+    }
+
+    AddCacheGlyph(Index, bmp, rGlyphLocation);
+    return true;
+  }
+
   // Fetch rendered glyph
   GlyphHandle glyph = GetGlyph(Index, eGlyphBitmap);
+  
+  // If we don't have this glyph, assert it has not been rendered
+  if (!glyph)
+  {
+    NGL_OUT("Error getting glyph %d", Index);
+    return false;
+  }
+
   GlyphBitmap bmp;
-  GetGlyphBitmap(glyph, bmp);
+  if (!GetGlyphBitmap(glyph, bmp))
+  {
+    NGL_OUT("Error getting glyph bitmap %d - %p", Index, glyph);
+    return false;
+  }
+
+  AddCacheGlyph(Index, bmp, rGlyphLocation);
+  return true;
+}
+
+void nuiFontBase::AddCacheGlyph(int Index, const GlyphBitmap& rBitmap, nuiFontBase::GlyphLocation &rGlyphLocation)
+{
+  int Texture = 0;
+  int OffsetX = 0;
+  int OffsetY = 0;
+  FindGlyphLocation(rBitmap.Width + 4, rBitmap.Height + 4, Texture, OffsetX, OffsetY);
+
+  rGlyphLocation = GlyphLocation (OffsetX + 2, OffsetY + 2, rBitmap.Width, rBitmap.Height, Texture, rBitmap.Left, rBitmap.Top);
+  mGlyphLocationLookupTable.Insert(Index, rGlyphLocation);
+
+  mTextureShelves[Texture].mLastUse = nuiDrawContext::GetFrame();
+
+  //NGL_DEBUG( NGL_LOG("font", NGL_LOG_INFO, "Glyph: %d %d (%d,%d) [%d * %d]\n", Index, (int)mGlyphLocationLookupTable.GetSize(), OffsetX + 1, OffsetY + 1, rBitmap.Width, rBitmap.Height); )
+
+  CopyBitmapToTexture(rBitmap, mTextures[Texture], OffsetX + 1, OffsetY + 1);
+}
+
+bool nuiFontBase::GetCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation)
+{
+  const GlyphLocation* pLocation = mGlyphLocationLookupTable.Find(Index);
+  if (!pLocation)
+    return AddCacheGlyph(Index, rGlyphLocation);
 
-  int OffsetX = mCurrentX;
-  int OffsetY = mCurrentY;
+  rGlyphLocation = *pLocation;
+  mTextureShelves[pLocation->mOffsetTexture].mLastUse = nuiDrawContext::GetFrame();
+  return true;
+}
+
+void nuiFontBase::TrimTextures()
+{
+  nuiFontBase* pCache = mpDistanceFieldAtlas ? mpDistanceFieldAtlas : this;
+  const uint32 frame = nuiDrawContext::GetFrame();
+  if (pCache->mTrimFrame == frame)
+    return;
+  const uint32 last = pCache->mTrimFrame;
+  pCache->mTrimFrame = frame;
+  if (pCache->mTextures.size() <= NUI_FONT_MAX_TEXTURES)
+    return;
+
+  // Keep the textures used since the last frame that printed with this font, in their current order:
+  std::vector<int> remap(pCache->mTextures.size(), -1);
+  Textures textures;
+  std::vector<TextureShelves> shelves;
+  for (uint32 i = 0; i < pCache->mTextures.size(); i++)
+  {
+    if (pCache->mTextureShelves[i].mLastUse >= last)
+    {
+      remap[i] = textures.size();
+      textures.push_back(pCache->mTextures[i]);
+      shelves.push_back(pCache->mTextureShelves[i]);
+    }
+  }
+  if (textures.size() == pCache->mTextures.size())
+    return;
 
-  if (!FindNextGlyphLocation(bmp.Width + 4, bmp.Height + 4, OffsetX, OffsetY))
+  // The draws that were already made with the dropped textures hold their own reference:
+  for (uint32 i = 0; i < pCache->mTextures.size(); i++)
   {
-    mCurrentTexture++;
-    nuiTexture *texture = AllocateTexture(MAX(TEXTURE_SIZE, 2 * POT(MAX(bmp.Width, bmp.Height))));
-    mTextures.push_back(texture);
+    if (remap[i] < 0)
+      pCache->mTextures[i]->Release();
+  }
+
+  pCache->mTextures.swap(textures);
+  pCache->mTextureShelves.swap(shelves);
+  pCache->mGlyphLocationLookupTable.RemapTextures(remap);
+  pCache->mTextureGeneration++;
+}
+
+void nuiFontBase::UpdateGlyphTextures(nuiTextRun* pRun)
+{
+  nuiFontBase* pCache = mpDistanceFieldAtlas ? mpDistanceFieldAtlas : this;
+  std::vector<nuiTextGlyph>& rGlyphs(pRun->GetGlyphs());
 
-    mCurrentX = 0;
-    mCurrentY = 0;
-    mRowMaxWidth = 0;
-    OffsetX = 0;
-    OffsetY = 0;
+  if (pRun->mTextureGeneration == pCache->mTextureGeneration)
+  {
+    // The glyphs are where they were, only keep their textures from being trimmed:
+    const uint32 frame = nuiDrawContext::GetFrame();
+    nuiTexture* pLast = NULL;
+    for (uint32 g = 0; g < rGlyphs.size(); g++)
+    {
+      if (rGlyphs[g].mpTexture == pLast)
+        continue;
+      pLast = rGlyphs[g].mpTexture;
+      for (uint32 t = 0; t < pCache->mTextures.size(); t++)
+      {
+        if (pCache->mTextures[t] == pLast)
+          pCache->mTextureShelves[t].mLastUse = frame;
+      }
+    }
+    return;
   }
 
-  nuiTexture *pCurrentTexture = mTextures[mCurrentTexture];
+  for (uint32 g = 0; g < rGlyphs.size(); g++)
+  {
+    GlyphLocation location;
+    if (pCache->GetCacheGlyph(rGlyphs[g].Index, location))
+      SetGlyphSource(pCache, location, rGlyphs[g]);
+  }
+  pRun->mTextureGeneration = pCache->mTextureGeneration;
+}
 
-  rGlyphLocation = GlyphLocation (OffsetX + 2, OffsetY + 2, bmp.Width, bmp.Height, mCurrentTexture);
-  mGlyphLocationLookupTable.insert(std::make_pair(Index, rGlyphLocation));
+uint32 nuiFontBase::GetTextureGeneration() const
+{
+  return mpDistanceFieldAtlas ? mpDistanceFieldAtlas->mTextureGeneration : mTextureGeneration;
+}
 
-  //NGL_DEBUG( NGL_LOG("font", NGL_LOG_INFO, "Glyph: %d %d (%d,%d) [%d * %d]\n", Index, (int)mGlyphLocationLookupTable.size(), OffsetX + 1, OffsetY + 1, bmp.Width, bmp.Height); )
+void nuiFontBase::SetGlyphSource(const nuiFontBase* pCache, const GlyphLocation& rLocation, nuiTextGlyph& rGlyph) const
+{
+  const float w = rLocation.mWidth;
+  const float h = rLocation.mHeight;
+  rGlyph.mpTexture = pCache->mTextures[rLocation.mOffsetTexture];
 
-  CopyBitmapToTexture(bmp, pCurrentTexture, OffsetX + 1, OffsetY + 1);
+  if (mpDistanceFieldAtlas)
+  {
+    rGlyph.mSourceRect.Set((float)rLocation.mOffsetX, (float)rLocation.mOffsetY, w, h);
+    return;
+  }
 
-  mCurrentX = OffsetX;
-  mCurrentY = OffsetY + bmp.Height + 4;
+  const float f = nuiGetScaleFactor();
+  rGlyph.mSourceRect.Set(rLocation.mOffsetX - f, rLocation.mOffsetY - f, w + 2 * f, h + 2 * f);
 }
 
-void nuiFontBase::GetCacheGlyph(int Index, nuiFontBase::GlyphLocation &rGlyphLocation)
+// Below this many missing glyphs the tasks cost more than rendering them on the calling thread:
+#define NUI_FONT_PARALLEL_RASTER_MIN_GLYPHS 32
+
+class nuiFontBase::RasterizedGlyph
 {
-  GlyphLocationLookupTableIterator iterator = mGlyphLocationLookupTable.find(Index);
-  if (iterator == mGlyphLocationLookupTable.end())
+public:
+  RasterizedGlyph(int Index)
+  : mIndex(Index), mValid(false), mWidth(0), mHeight(0), mLeft(0), mTop(0), mPitch(0), mDepth(0)
   {
-    AddCacheGlyph(Index, rGlyphLocation); 
   }
-  else
+
+  static bool Higher(const RasterizedGlyph* pA, const RasterizedGlyph* pB)
   {
-    rGlyphLocation = iterator->second;
+    return pA->mHeight > pB->mHeight;
+  }
+
+  int mIndex;
+  bool mValid;
+  uint mWidth, mHeight;
+  int mLeft, mTop;
+  uint mPitch;
+  uint8 mDepth;
+  std::vector<uint8> mPixels;
+};
+
+void nuiFontBase::RasterizeGlyphs(const std::vector<int>& rIndices, nuiTaskPool& rPool)
+{
+  std::vector<int> indices;
+  for (uint32 i = 0; i < rIndices.size(); i++)
+  {
+    if (rIndices[i] >= 0 && !mGlyphLocationLookupTable.Find(rIndices[i]))
+      indices.push_back(rIndices[i]);
+  }
+
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+  if (indices.size() < NUI_FONT_PARALLEL_RASTER_MIN_GLYPHS || mpDistanceFieldAtlas)
+    return; // PrepareGlyph will take care of them (the distance fields are generated from the outlines, not rendered by FreeType)
+
+  std::vector<RasterizedGlyph> glyphs;
+  glyphs.reserve(indices.size());
+  for (uint32 i = 0; i < indices.size(); i++)
+    glyphs.push_back(RasterizedGlyph(indices[i]));
+
+  // Each range opens the font again, don't give too few glyphs to a worker:
+  const uint32 count = glyphs.size();
+  const uint32 ranges = MAX(1, MIN(rPool.GetThreadCount() + 1, count / NUI_FONT_PARALLEL_RASTER_MIN_GLYPHS));
+  nuiTaskGroup group;
+  for (uint32 r = 1; r < ranges; r++)
+    rPool.Post(nuiMakeTask(this, &nuiFontBase::RasterizeGlyphRange, &glyphs, count * r / ranges, count * (r + 1) / ranges), nuiTaskPool::eHigh, &group);
+  RasterizeGlyphRange(&glyphs, 0, count / ranges);
+  rPool.Wait(group);
+
+  // The shelves waste less space when the highest glyphs come first:
+  std::vector<RasterizedGlyph*> sorted;
+  for (uint32 i = 0; i < count; i++)
+  {
+    if (glyphs[i].mValid)
+      sorted.push_back(&glyphs[i]);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), &nuiFontBase::RasterizedGlyph::Higher);
+
+  for (uint32 i = 0; i < sorted.size(); i++)
+  {
+    const RasterizedGlyph& rGlyph(*sorted[i]);
+    GlyphBitmap bmp;
+    bmp.Width = rGlyph.mWidth;
+    bmp.Height = rGlyph.mHeight;
+    bmp.Left = rGlyph.mLeft;
+    bmp.Top = rGlyph.mTop;
+    bmp.Pitch = rGlyph.mPitch;
+    bmp.Depth = rGlyph.mDepth;
+    bmp.pData = rGlyph.mPixels.empty() ? NULL : const_cast<uint8*>(&rGlyph.mPixels[0]);
+
+    GlyphLocation location;
+    AddCacheGlyph(rGlyph.mIndex, bmp, location);
+  }
+}
+
+void nuiFontBase::RasterizeGlyphRange(std::vector<RasterizedGlyph>* pGlyphs, uint32 First, uint32 Last)
+{
+  // This runs on the workers of the pool: FreeType objects can't be shared between threads, each thread renders with its own face.
+  nuiThreadFace* pThreadFace = nuiGetThreadFace(mpFace->GetFontInstance(), mpFace->Desc, mCharMap);
+  if (!pThreadFace)
+    return;
+
+  FT_Face face = pThreadFace->mFace;
+  for (uint32 i = First; i < Last; i++)
+  {
+    RasterizedGlyph& rGlyph((*pGlyphs)[i]);
+    // Same flags as the glyphs of the image cache (see GetGlyph):
+    if (FT_Load_Glyph(face, rGlyph.mIndex, mpFace->Desc.flags | FT_LOAD_RENDER) != FT_Err_Ok)
+      continue;
+
+    FT_GlyphSlot slot = face->glyph;
+    FT_Bitmap* bmp = &slot->bitmap;
+    if (slot->format != FT_GLYPH_FORMAT_BITMAP || bmp->pitch < 0)
+      continue;
+
+    rGlyph.mWidth = bmp->width;
+    rGlyph.mHeight = bmp->rows;
+    rGlyph.mLeft = slot->bitmap_left;
+    rGlyph.mTop = slot->bitmap_top;
+    rGlyph.mPitch = bmp->pitch;
+    switch (bmp->pixel_mode)
+    {
+      case FT_PIXEL_MODE_MONO: rGlyph.mDepth = 1; break;
+      case FT_PIXEL_MODE_GRAY: rGlyph.mDepth = 8; break;
+      default:
+        continue; // Let GetGlyph report the problem
+    }
+
+    // The slot is overwritten by the next glyph:
+    rGlyph.mPixels.assign(bmp->buffer, bmp->buffer + rGlyph.mPitch * rGlyph.mHeight);
+    rGlyph.mValid = true;
   }
 }
 
@@ -1977,41 +2473,240 @@ void nuiFontBase::Print(nuiDrawContext *pContext, float X, float Y, const nglStr
 
 bool nuiFontBase::PrepareGlyph(float X, float Y, nuiTextGlyph& rGlyph)
 {
-  // Fetch rendered glyph
-  GlyphHandle glyph = GetGlyph(rGlyph.Index, eGlyphBitmap);
-  
-  // If we don't have this glyph, assert it has not been rendered
-  if (!glyph)
-  {
-    NGL_OUT("Error getting glyph %d - %d", rGlyph.Index);
-    return false;
-  }
+  // In DistanceField mode the glyphs come from the atlas of the face and are scaled to our size:
+  nuiFontBase* pCache = mpDistanceFieldAtlas ? mpDistanceFieldAtlas : this;
+  const float scale = nuiGetInvScaleFactor() * (mpDistanceFieldAtlas ? mSize / mpDistanceFieldAtlas->mSize : 1.0f);
 
-  GlyphBitmap bmp;
-  if (!GetGlyphBitmap(glyph, bmp))
-  {
-    NGL_OUT("Error getting glyph bitmap %d - %d", rGlyph.Index, glyph);
-    return false;
-  }
-  
   nuiFontBase::GlyphLocation GlyphLocation;
-  GetCacheGlyph(rGlyph.Index, GlyphLocation);
+  if (!pCache->GetCacheGlyph(rGlyph.Index, GlyphLocation))
+    return false;
   
   float w = GlyphLocation.mWidth;
   float h = GlyphLocation.mHeight;
   
-  float x = rGlyph.mX + bmp.Left * nuiGetInvScaleFactor();
-  float y = rGlyph.mY - bmp.Top * nuiGetInvScaleFactor();
+  float x = rGlyph.mX + GlyphLocation.mLeft * scale;
+  float y = rGlyph.mY - GlyphLocation.mTop * scale;
   
-  rGlyph.mpTexture = mTextures[GlyphLocation.mOffsetTexture];
+  SetGlyphSource(pCache, GlyphLocation, rGlyph);
   
-  float ww = w * nuiGetInvScaleFactor();
-  float hh = h * nuiGetInvScaleFactor();
+  float ww = w * scale;
+  float hh = h * scale;
   
+  if (mpDistanceFieldAtlas)
+  {
+    // The distance fields already fade out on their borders:
+    rGlyph.mDestRect.Set(X + x, Y + y, ww, hh);
+    return true;
+  }
+
   rGlyph.mDestRect.Set(X + x - 1, Y + y - 1, ww + 2, hh + 2);
-  float f = nuiGetScaleFactor();
-  rGlyph.mSourceRect.Set(GlyphLocation.mOffsetX - f, GlyphLocation.mOffsetY - f, w + 2 * f, h + 2 * f);
+  return true;
+}
+
+nuiFontBase* nuiFontBase::AcquireDistanceFieldAtlas()
+{
+  std::map<void*, nuiFontBase*>::iterator it = gDistanceFieldAtlases.find(mpFace->Desc.face_id);
+  if (it != gDistanceFieldAtlases.end())
+  {
+    it->second->Acquire();
+    return it->second;
+  }
+
+  nuiFontBase* pAtlas = new nuiFontBase(*this, NUI_FONT_DISTANCE_FIELD_SIZE);
+  pAtlas->Acquire();
+  gDistanceFieldAtlases[pAtlas->mpFace->Desc.face_id] = pAtlas;
+  return pAtlas;
+}
+
+/* Flattens the contours of an outline in line segments and computes the signed distance from each pixel of a
+ * bitmap to them (positive inside).
+ */
+class nuiDistanceFieldBuilder
+{
+public:
+  nuiDistanceFieldBuilder()
+  : mX(0), mY(0), mStartX(0), mStartY(0)
+  {
+  }
+
+  bool Decompose(FT_Outline* pOutline)
+  {
+    FT_Outline_Funcs funcs;
+    funcs.move_to = &nuiDistanceFieldBuilder::MoveTo;
+    funcs.line_to = &nuiDistanceFieldBuilder::LineTo;
+    funcs.conic_to = &nuiDistanceFieldBuilder::ConicTo;
+    funcs.cubic_to = &nuiDistanceFieldBuilder::CubicTo;
+    funcs.shift = 0;
+    funcs.delta = 0;
+    if (FT_Outline_Decompose(pOutline, &funcs, this) != FT_Err_Ok)
+      return false;
+    Close();
+    return true;
+  }
+
+  void Render(uint8* pPixels, int32 Width, int32 Height, float Left, float Top, float Spread, bool EvenOdd) const
+  {
+    const uint32 count = mSegments.size() / 4;
+    for (int32 py = 0; py < Height; py++)
+    {
+      const float y = Top - py - 0.5f;
+      for (int32 px = 0; px < Width; px++)
+      {
+        const float x = Left + px + 0.5f;
+        float dist = Spread * Spread;
+        int32 winding = 0;
+        for (uint32 i = 0; i < count; i++)
+        {
+          const float* pSeg = &mSegments[i * 4];
+          const float x0 = pSeg[0], y0 = pSeg[1], x1 = pSeg[2], y1 = pSeg[3];
+
+          // Non zero winding rule: count the edges that cross the horizontal line on the right of the point
+          if ((y0 <= y) != (y1 <= y))
+          {
+            const float cx = x0 + (y - y0) * (x1 - x0) / (y1 - y0);
+            if (cx > x)
+              winding += (y1 > y0) ? 1 : -1;
+          }
+
+          const float dx = x1 - x0;
+          const float dy = y1 - y0;
+          const float len2 = dx * dx + dy * dy;
+          float t = len2 > 0 ? ((x - x0) * dx + (y - y0) * dy) / len2 : 0;
+          t = MAX(0.0f, MIN(1.0f, t));
+          const float ex = x0 + t * dx - x;
+          const float ey = y0 + t * dy - y;
+          dist = MIN(dist, ex * ex + ey * ey);
+        }
+
+        const bool inside = EvenOdd ? (winding & 1) != 0 : winding != 0;
+        const float d = inside ? sqrtf(dist) : -sqrtf(dist);
+        pPixels[px + py * Width] = (uint8)ToNearest(MAX(0.0f, MIN(255.0f, 127.5f + d * 127.5f / Spread)));
+      }
+    }
+  }
+
+private:
+  static float ToPixels(FT_Pos Pos)
+  {
+    return (float)Pos / 64.0f;
+  }
+
+  static int MoveTo(const FT_Vector* pTo, void* pUser)
+  {
+    nuiDistanceFieldBuilder* pThis = (nuiDistanceFieldBuilder*)pUser;
+    pThis->Close();
+    pThis->mX = pThis->mStartX = ToPixels(pTo->x);
+    pThis->mY = pThis->mStartY = ToPixels(pTo->y);
+    return 0;
+  }
+
+  static int LineTo(const FT_Vector* pTo, void* pUser)
+  {
+    ((nuiDistanceFieldBuilder*)pUser)->AddLine(ToPixels(pTo->x), ToPixels(pTo->y));
+    return 0;
+  }
+
+  static int ConicTo(const FT_Vector* pControl, const FT_Vector* pTo, void* pUser)
+  {
+    nuiDistanceFieldBuilder* pThis = (nuiDistanceFieldBuilder*)pUser;
+    const float x0 = pThis->mX, y0 = pThis->mY;
+    const float cx = ToPixels(pControl->x), cy = ToPixels(pControl->y);
+    const float x1 = ToPixels(pTo->x), y1 = ToPixels(pTo->y);
+    const int32 steps = GetSteps(fabsf(cx - x0) + fabsf(cy - y0) + fabsf(x1 - cx) + fabsf(y1 - cy));
+    for (int32 i = 1; i <= steps; i++)
+    {
+      const float t = (float)i / (float)steps;
+      const float u = 1 - t;
+      pThis->AddLine(u * u * x0 + 2 * u * t * cx + t * t * x1, u * u * y0 + 2 * u * t * cy + t * t * y1);
+    }
+    return 0;
+  }
 
+  static int CubicTo(const FT_Vector* pControl1, const FT_Vector* pControl2, const FT_Vector* pTo, void* pUser)
+  {
+    nuiDistanceFieldBuilder* pThis = (nuiDistanceFieldBuilder*)pUser;
+    const float x0 = pThis->mX, y0 = pThis->mY;
+    const float c1x = ToPixels(pControl1->x), c1y = ToPixels(pControl1->y);
+    const float c2x = ToPixels(pControl2->x), c2y = ToPixels(pControl2->y);
+    const float x1 = ToPixels(pTo->x), y1 = ToPixels(pTo->y);
+    const int32 steps = GetSteps(fabsf(c1x - x0) + fabsf(c1y - y0) + fabsf(c2x - c1x) + fabsf(c2y - c1y) + fabsf(x1 - c2x) + fabsf(y1 - c2y));
+    for (int32 i = 1; i <= steps; i++)
+    {
+      const float t = (float)i / (float)steps;
+      const float u = 1 - t;
+      const float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+      pThis->AddLine(a * x0 + b * c1x + c * c2x + d * x1, a * y0 + b * c1y + c * c2y + d * y1);
+    }
+    return 0;
+  }
+
+  static int32 GetSteps(float Length)
+  {
+    // About one segment every two pixels of the control polygon:
+    return MAX(2, MIN(16, (int32)(Length / 2)));
+  }
+
+  void AddLine(float X, float Y)
+  {
+    mSegments.push_back(mX);
+    mSegments.push_back(mY);
+    mSegments.push_back(X);
+    mSegments.push_back(Y);
+    mX = X;
+    mY = Y;
+  }
+
+  void Close()
+  {
+    if (mX != mStartX || mY != mStartY)
+      AddLine(mStartX, mStartY);
+  }
+
+  std::vector<float> mSegments; ///< x0, y0, x1, y1 for each segment
+  float mX, mY;
+  float mStartX, mStartY;
+};
+
+bool nuiFontBase::GetDistanceFieldBitmap(int Index, GlyphBitmap& rBitmap, std::vector<uint8>& rPixels)
+{
+  GlyphHandle glyph = GetGlyph(Index, eGlyphOutline);
+  if (!glyph)
+    return false;
+
+  FT_Outline* pOutline = &((FT_OutlineGlyph)glyph)->outline;
+  const int32 spread = NUI_FONT_DISTANCE_FIELD_SPREAD;
+
+  rBitmap.Width = 0;
+  rBitmap.Height = 0;
+  rBitmap.Left = 0;
+  rBitmap.Top = 0;
+  rBitmap.Depth = 8;
+  rBitmap.Pitch = 0;
+  rBitmap.pData = NULL;
+  rPixels.clear();
+
+  if (pOutline->n_contours <= 0)
+    return true; // A blank glyph (space...)
+
+  FT_BBox box;
+  FT_Outline_Get_CBox(pOutline, &box);
+  const int32 left = (int32)floorf(box.xMin / 64.0f) - spread;
+  const int32 right = (int32)ceilf(box.xMax / 64.0f) + spread;
+  const int32 top = (int32)ceilf(box.yMax / 64.0f) + spread;
+  const int32 bottom = (int32)floorf(box.yMin / 64.0f) - spread;
+
+  nuiDistanceFieldBuilder builder;
+  if (!builder.Decompose(pOutline))
+    return false;
+
+  rBitmap.Width = right - left;
+  rBitmap.Height = top - bottom;
+  rBitmap.Left = left;
+  rBitmap.Top = top;
+  rBitmap.Pitch = rBitmap.Width;
+  rPixels.resize(rBitmap.Width * rBitmap.Height);
+  builder.Render(&rPixels[0], rBitmap.Width, rBitmap.Height, (float)left, (float)top, (float)spread, (pOutline->flags & FT_OUTLINE_EVEN_ODD_FILL) != 0);
+  rBitmap.pData = &rPixels[0];
   return true;
 }
 
@@ -2020,8 +2715,8 @@ nuiFontBase::GlyphLocation::GlyphLocation()
 {
 }
 
-nuiFontBase::GlyphLocation::GlyphLocation(int OffsetX, int OffsetY, int Width, int Height, int OffsetTexture)
-: mOffsetX(OffsetX), mOffsetY(OffsetY), mWidth(Width), mHeight(Height), mOffsetTexture(OffsetTexture)
+nuiFontBase::GlyphLocation::GlyphLocation(int OffsetX, int OffsetY, int Width, int Height, int OffsetTexture, int Left, int Top)
+: mOffsetX(OffsetX), mOffsetY(OffsetY), mWidth(Width), mHeight(Height), mOffsetTexture(OffsetTexture), mLeft(Left), mTop(Top)
 {
 }
 
@@ -2029,6 +2724,110 @@ nuiFontBase::GlyphLocation::~GlyphLocation()
 {
 }
 
+nuiFontBase::GlyphLocationTable::GlyphLocationTable()
+: mCount(0)
+{
+}
+
+static inline uint32 nuiGlyphHash(int Index, uint32 Mask)
+{
+  return ((uint32)Index * 2654435761U) & Mask;
+}
+
+const nuiFontBase::GlyphLocation* nuiFontBase::GlyphLocationTable::Find(int Index) const
+{
+  if (mKeys.empty())
+    return NULL;
+
+  const uint32 mask = mKeys.size() - 1;
+  for (uint32 i = nuiGlyphHash(Index, mask); ; i = (i + 1) & mask)
+  {
+    if (mKeys[i] == Index)
+      return &mLocations[i];
+    if (mKeys[i] < 0)
+      return NULL;
+  }
+}
+
+void nuiFontBase::GlyphLocationTable::Insert(int Index, const GlyphLocation& rLocation)
+{
+  NGL_ASSERT(Index >= 0);
+  // Keep at least half of the slots free so that the probe sequences stay short:
+  if ((mCount + 1) * 2 > mKeys.size())
+    Grow();
+
+  const uint32 mask = mKeys.size() - 1;
+  uint32 i = nuiGlyphHash(Index, mask);
+  while (mKeys[i] >= 0 && mKeys[i] != Index)
+    i = (i + 1) & mask;
+
+  if (mKeys[i] < 0)
+    mCount++;
+  mKeys[i] = Index;
+  mLocations[i] = rLocation;
+}
+
+void nuiFontBase::GlyphLocationTable::Grow()
+{
+  std::vector<int> keys;
+  std::vector<GlyphLocation> locations;
+  keys.swap(mKeys);
+  locations.swap(mLocations);
+
+  const uint32 size = MAX(64, keys.size() * 2);
+  mKeys.resize(size, -1);
+  mLocations.resize(size);
+  mCount = 0;
+
+  for (uint32 i = 0; i < keys.size(); i++)
+  {
+    if (keys[i] >= 0)
+      Insert(keys[i], locations[i]);
+  }
+}
+
+void nuiFontBase::GlyphLocationTable::RemapTextures(const std::vector<int>& rTextures)
+{
+  std::vector<int> keys;
+  std::vector<GlyphLocation> locations;
+  keys.swap(mKeys);
+  locations.swap(mLocations);
+
+  mKeys.resize(keys.size(), -1);
+  mLocations.resize(keys.size());
+  mCount = 0;
+
+  for (uint32 i = 0; i < keys.size(); i++)
+  {
+    if (keys[i] < 0 || rTextures[locations[i].mOffsetTexture] < 0)
+      continue;
+    locations[i].mOffsetTexture = rTextures[locations[i].mOffsetTexture];
+    Insert(keys[i], locations[i]);
+  }
+}
+
+void nuiFontBase::GlyphLocationTable::Clear()
+{
+  mKeys.clear();
+  mLocations.clear();
+  mCount = 0;
+}
+
+uint32 nuiFontBase::GlyphLocationTable::GetSize() const
+{
+  return mCount;
+}
+
+nuiFontBase::Shelf::Shelf(int Y, int Height)
+: mY(Y), mHeight(Height), mX(0)
+{
+}
+
+nuiFontBase::TextureShelves::TextureShelves()
+: mBottom(0), mLastUse(0)
+{
+}
+
 
 ////////////
 
@@ -2041,9 +2840,12 @@ nui_hb_get_glyph (hb_font_t *font,
                  void *user_data)
 
 {
-  nuiFontBase* pFont = (nuiFontBase*)user_data;
-  NGL_ASSERT(pFont);
-  *glyph = pFont->GetGlyphIndex(unicode, variation_selector);
+  // Same as nuiFontBase::GetGlyphIndex, on the face of this thread:
+  FT_Face ft_face = ((nuiThreadFace*)font_data)->mFace;
+  if (!ft_face->charmap || ft_face->charmap->encoding == ft_encoding_none)
+    *glyph = unicode;
+  else
+    *glyph = FT_Get_Char_Index(ft_face, unicode);
   return *glyph != 0;
 }
 
@@ -2053,13 +2855,7 @@ nui_hb_get_glyph_h_advance(hb_font_t *font,
                            hb_codepoint_t glyph,
                            void *user_data)
 {
-  nuiFontBase* pFont = (nuiFontBase*)user_data;
-  NGL_ASSERT(pFont);
-  FT_Glyph ftglyph;
-  
-  ftglyph = (FT_Glyph)pFont->GetGlyph(glyph, nuiFontBase::eGlyphNative);
-  NGL_ASSERT(ftglyph);
-  return ftglyph->advance.x >> 10;
+  return ((nuiThreadFace*)font_data)->GetGlyph(glyph).mAdvance.x;
 }
 
 static hb_position_t
@@ -2068,13 +2864,7 @@ nui_hb_get_glyph_v_advance(hb_font_t *font,
                            hb_codepoint_t glyph,
                            void *user_data)
 {
-  nuiFontBase* pFont = (nuiFontBase*)user_data;
-  NGL_ASSERT(pFont);
-  FT_Glyph ftglyph;
-  
-  ftglyph = (FT_Glyph)pFont->GetGlyph(glyph, nuiFontBase::eGlyphNative);
-  NGL_ASSERT(ftglyph);
-  return ftglyph->advance.y >> 10;
+  return ((nuiThreadFace*)font_data)->GetGlyph(glyph).mAdvance.y;
 }
 
 static hb_bool_t
@@ -2097,7 +2887,7 @@ nui_hb_get_glyph_v_origin (hb_font_t *font,
                           hb_position_t *y,
                           void *user_data)
 {
-  FT_Face ft_face = (FT_Face) font_data;
+  FT_Face ft_face = ((nuiThreadFace*)font_data)->mFace;
   int load_flags = FT_LOAD_DEFAULT;
   
   if (FT_Load_Glyph (ft_face, glyph, load_flags))
@@ -2118,7 +2908,7 @@ nui_hb_get_glyph_h_kerning (hb_font_t *font,
                            hb_codepoint_t right_glyph,
                            void *user_data)
 {
-  FT_Face ft_face = (FT_Face) font_data;
+  FT_Face ft_face = ((nuiThreadFace*)font_data)->mFace;
   FT_Vector kerningv;
   
   if (FT_Get_Kerning (ft_face, left_glyph, right_glyph, FT_KERNING_DEFAULT, &kerningv))
@@ -2145,7 +2935,7 @@ nui_hb_get_glyph_extents (hb_font_t *font,
                          hb_glyph_extents_t *extents,
                          void *user_data)
 {
-  FT_Face ft_face = (FT_Face) font_data;
+  FT_Face ft_face = ((nuiThreadFace*)font_data)->mFace;
   int load_flags = FT_LOAD_DEFAULT;
   
   if (FT_Load_Glyph (ft_face, glyph, load_flags))
@@ -2167,7 +2957,7 @@ nui_hb_get_glyph_contour_point (hb_font_t *font,
                                hb_position_t *y,
                                void *user_data)
 {
-  FT_Face ft_face = (FT_Face) font_data;
+  FT_Face ft_face = ((nuiThreadFace*)font_data)->mFace;
   int load_flags = FT_LOAD_DEFAULT;
   
   if (FT_Load_Glyph (ft_face, glyph, load_flags))
@@ -2186,43 +2976,82 @@ nui_hb_get_glyph_contour_point (hb_font_t *font,
 }
 
 
+// The functions only use their font data (the nuiThreadFace), one set is shared by all the fonts of all the threads:
+static hb_font_funcs_t* gpHBFontFuncs = NULL;
+
+static hb_font_funcs_t* nui_hb_get_font_funcs()
+{
+  nglCriticalSectionGuard guard(gThreadFreeTypeCS);
+  if (!gpHBFontFuncs)
+  {
+    hb_font_funcs_t* funcs = hb_font_funcs_create();
+    hb_font_funcs_set_glyph_func(funcs, &nui_hb_get_glyph, NULL, NULL);
+    hb_font_funcs_set_glyph_h_advance_func(funcs, &nui_hb_get_glyph_h_advance, NULL, NULL);
+    hb_font_funcs_set_glyph_v_advance_func(funcs, &nui_hb_get_glyph_v_advance, NULL, NULL);
+    hb_font_funcs_set_glyph_h_origin_func(funcs, &nui_hb_get_glyph_h_origin, NULL, NULL);
+    hb_font_funcs_set_glyph_v_origin_func(funcs, &nui_hb_get_glyph_v_origin, NULL, NULL);
+    hb_font_funcs_set_glyph_h_kerning_func(funcs, &nui_hb_get_glyph_h_kerning, NULL, NULL);
+    hb_font_funcs_set_glyph_v_kerning_func(funcs, &nui_hb_get_glyph_v_kerning, NULL, NULL);
+    hb_font_funcs_set_glyph_extents_func(funcs, &nui_hb_get_glyph_extents, NULL, NULL);
+    hb_font_funcs_set_glyph_contour_point_func(funcs, &nui_hb_get_glyph_contour_point, NULL, NULL);
+    hb_font_funcs_make_immutable(funcs);
+    gpHBFontFuncs = funcs;
+  }
+  return gpHBFontFuncs;
+}
+
 void nuiFontBase::Shape(nuiTextRun* pRun)
 {
   //NGL_OUT("nuiFontBase::Shape with font %s", GetFamilyName().GetChars());
   if (pRun->IsDummy())
     return;
   NGL_ASSERT(this == pRun->mStyle.GetFont());
+
+  const nuiTextStyle& style = pRun->GetStyle();
+  nuiColor color = style.GetColor();
+  bool usecolor = style.UseColor();
+
+  nuiShapedRunCache& rCache(nuiShapedRunCache::Get());
+  if (rCache.Find(this, pRun->GetScript(), pRun->GetUnicodeChars(), pRun->GetLength(), pRun->mGlyphs, pRun->mAdvanceX))
+  {
+    for (uint32 g = 0; g < pRun->mGlyphs.size(); g++)
+    {
+      pRun->mGlyphs[g].mColor = color;
+      pRun->mGlyphs[g].mUseColor = usecolor;
+    }
+    return;
+  }
+
+  // nuiTextLayout can shape paragraphs on several threads: each thread shapes with its own face, so the misses of different
+  // threads run in parallel (see nuiGetThreadFace).
+  nuiThreadFace* pThreadFace = nuiGetThreadFace(mpFace->GetFontInstance(), mpFace->Desc, mCharMap);
+  if (!pThreadFace)
+  {
+    pRun->mGlyphs.clear();
+    pRun->mAdvanceX = 0;
+    return;
+  }
+
+  FT_Face ft_face = pThreadFace->mFace;
   
-  FT_Face ft_face = mpFace->GetFace();
-  
-  hb_font_t *hb_font;
-  hb_face_t *face;
-  
-  face = hb_ft_face_create (ft_face, NULL);
-  hb_font = hb_font_create (face);
-  hb_face_destroy (face);
-  
-  hb_font_funcs_t* funcs = hb_font_funcs_create();
-  
-  hb_font_funcs_set_glyph_func(funcs, &nui_hb_get_glyph, this, NULL);
-  hb_font_funcs_set_glyph_h_advance_func(funcs, &nui_hb_get_glyph_h_advance, this, NULL);
-  hb_font_funcs_set_glyph_v_advance_func(funcs, &nui_hb_get_glyph_v_advance, this, NULL);
-  hb_font_funcs_set_glyph_h_origin_func(funcs, &nui_hb_get_glyph_h_origin, this, NULL);
-  hb_font_funcs_set_glyph_v_origin_func(funcs, &nui_hb_get_glyph_v_origin, this, NULL);
-  hb_font_funcs_set_glyph_h_kerning_func(funcs, &nui_hb_get_glyph_h_kerning, this, NULL);
-  hb_font_funcs_set_glyph_v_kerning_func(funcs, &nui_hb_get_glyph_v_kerning, this, NULL);
-  hb_font_funcs_set_glyph_extents_func(funcs, &nui_hb_get_glyph_extents, this, NULL);
-  hb_font_funcs_set_glyph_contour_point_func(funcs, &nui_hb_get_glyph_contour_point, this, NULL);
-
-  hb_font_set_funcs (hb_font,
-                     funcs,
-                     ft_face, NULL);
-  hb_font_set_scale (hb_font,
-                     ((uint64_t) ft_face->size->metrics.x_scale * (uint64_t) ft_face->units_per_EM) >> 16,
-                     ((uint64_t) ft_face->size->metrics.y_scale * (uint64_t) ft_face->units_per_EM) >> 16);
-  hb_font_set_ppem (hb_font,
-                    ft_face->size->metrics.x_ppem,
-                    ft_face->size->metrics.y_ppem);
+  if (!pThreadFace->mpHBFont)
+  {
+    hb_face_t *face = hb_ft_face_create (ft_face, NULL);
+    hb_font_t *hb_font = hb_font_create (face);
+    hb_face_destroy (face);
+    
+    hb_font_set_funcs (hb_font,
+                       nui_hb_get_font_funcs(),
+                       pThreadFace, NULL);
+    hb_font_set_scale (hb_font,
+                       ((uint64_t) ft_face->size->metrics.x_scale * (uint64_t) ft_face->units_per_EM) >> 16,
+                       ((uint64_t) ft_face->size->metrics.y_scale * (uint64_t) ft_face->units_per_EM) >> 16);
+    hb_font_set_ppem (hb_font,
+                      ft_face->size->metrics.x_ppem,
+                      ft_face->size->metrics.y_ppem);
+    pThreadFace->mpHBFont = hb_font;
+  }
+  hb_font_t *hb_font = pThreadFace->mpHBFont;
 
   hb_buffer_t *hb_buffer;
   hb_glyph_info_t *hb_glyph;
@@ -2275,15 +3104,13 @@ void nuiFontBase::Shape(nuiTextRun* pRun)
   x = 0;
 
   const float factor = nuiGetInvScaleFactor() * (1.0 / 64.0);
-  const nuiTextStyle& style = pRun->GetStyle();
-
-  nuiColor color = style.GetColor();
-  bool usecolor = style.UseColor();
 
   //NGL_OUT("Shape %p\n", pRun);
   for (i = 0; i < num_glyphs; i++)
   {
-    GetGlyphInfo(pRun->mGlyphs[i], hb_glyph->codepoint, eGlyphNative);
+    const nuiThreadGlyph& rGlyph(pThreadFace->GetGlyph(hb_glyph->codepoint));
+    if (rGlyph.mValid)
+      static_cast<nuiGlyphInfo&>(pRun->mGlyphs[i]) = rGlyph.mInfo;
     pRun->mGlyphs[i].mCluster = hb_glyph->cluster;
     pRun->mGlyphs[i].mX = (hb_position->x_offset + x) * factor;
     pRun->mGlyphs[i].mY = -(hb_position->y_offset)    * factor;
@@ -2301,8 +3128,8 @@ void nuiFontBase::Shape(nuiTextRun* pRun)
   //NGL_OUT("\n");
   
   pRun->mAdvanceX = x * factor;
+  rCache.Store(this, pRun->GetScript(), text, len, pRun->mGlyphs, pRun->mAdvanceX);
+
   hb_buffer_destroy(hb_buffer);
-  hb_font_destroy(hb_font);
-  hb_font_funcs_destroy(funcs);
 }
 
@@ -188,6 +188,16 @@ FT_Error nuiFontInstance::OnFaceRequest (FT_Library pLibrary, FT_Pointer pData,
   return FT_New_Memory_Face(pLibrary, mpMemBase, mMemSize, mFace, pFace);
 }
 
+FT_Error nuiFontInstance::CreateFace(FT_Library pLibrary, FT_Face* pFace) const
+{
+  // Unlike OnFaceRequest this never loads the file in memory: it can be called from any thread.
+  if (mpMemBase)
+    return FT_New_Memory_Face(pLibrary, mpMemBase, mMemSize, mFace, pFace);
+
+  std::string tmp(mPath.GetPathName().GetStdString());
+  return FT_New_Face(pLibrary, tmp.c_str(), mFace, pFace);
+}
+
 void nuiFontInstance::Dump()
 {
   NGL_DEBUG( NGL_LOG(_T("font"), NGL_LOG_INFO, _T("nuiFontInstance::Dump\n"));)
@@ -34,6 +34,9 @@ public:
   nglPath  GetPath() const;
   uint     GetFace() const;
 
+  /// Open a new face of this font in pLibrary, outside of the cache manager. Used to render glyphs from other threads, each with its own library.
+  FT_Error CreateFace(FT_Library pLibrary, FT_Face* pFace) const;
+
   static FTC_FaceID       Install(nuiFontInstance * pInstance);
   static FTC_FaceID       Uninstall(nuiFontInstance * pInstance);
   static nuiFontInstance* Lookup(const FTC_FaceID FaceID);
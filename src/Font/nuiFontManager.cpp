@@ -42,6 +42,9 @@
 static FT_Library gFTLibrary = NULL;  // Global FT library instance
 nglTextEncoding nglGetCharMapEncoding (FT_CharMap CharMap);
 
+#define NUI_FONT_COVERAGE_SHIFT 8 // The glyph coverage of the fonts is indexed by blocks of 256 code points
+#define NUI_FONT_COVERAGE_BLOCKS (0x110000 >> NUI_FONT_COVERAGE_SHIFT)
+
 std::multimap<nglString, nglString> nuiFontRequest::gFontsForGenericNames;
 std::map<nglString, nglString> nuiFontRequest::gGenericNamesForFonts;
 std::map<nglString, nglString> nuiFontRequest::gDefaultFontsForGenericNames;
@@ -592,6 +595,11 @@ const nuiFontDesc* nuiFontRequestResult::GetFontDesc() const
 
 
 ///! Font Manager class:
+nuiFontManager::ScannedFile::ScannedFile()
+: mLastMod(0)
+{
+}
+
 nuiFontManager::nuiFontManager()
 {
   //std::map<nglString, nglPath> mFontFolders;
@@ -719,6 +727,16 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
   NGL_DEBUG( NGL_LOG("font", NGL_LOG_INFO, "Scan system fonts....\n"); )
   nglTime start_time;
   
+  // Only open the files that changed since the database was saved:
+  ScannedFileMap previous;
+  if (mSavePath.Exists() && mSavePath.IsLeaf())
+  {
+    nglIStream* pStream = mSavePath.OpenRead();
+    if (pStream)
+      ReadIndex(*pStream, previous);
+    delete pStream;
+  }
+  
   Clear();
   
   // Scan each path:
@@ -731,6 +749,7 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
   }
 
   
+  uint32 scanned = 0;
   while (it != end)
   {
     nglPath path(it->second);
@@ -738,16 +757,19 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
     if (mScanedFolders.find(path) == mScanedFolders.end())
     {
       mScanedFolders.insert(path);
-      ScanSubFolder(path);
+      scanned += ScanSubFolder(path, previous);
     }
     
     ++it;
   }
+  
+  AddUnchangedFiles(previous);
+  BuildIndex();
 
   nglTime end_time;
   
   double t = end_time - start_time;
-  NGL_LOG("font", NGL_LOG_INFO, "Scaning the system fonts took %f seconds\n", t);
+  NGL_LOG("font", NGL_LOG_INFO, "Scaning the system fonts took %f seconds (%d files opened)\n", t, scanned);
 
   delete gpWin;
   gpWin = NULL;
@@ -761,7 +783,7 @@ void nuiFontManager::ScanFolders(bool rescanAllFolders /* = false */)
   delete pStream;
 }
 
-bool nuiFontManager::ScanSubFolder(const nglPath& rBasePath)
+uint32 nuiFontManager::ScanSubFolder(const nglPath& rBasePath, ScannedFileMap& rPrevious)
 {
   std::list<nglPath> children;
   rBasePath.GetChildrenTree(children);
@@ -769,6 +791,7 @@ bool nuiFontManager::ScanSubFolder(const nglPath& rBasePath)
   std::list<nglPath>::const_iterator cit = children.begin();
   std::list<nglPath>::const_iterator cend = children.end();
   
+  uint32 scanned = 0;
   while (cit != cend)
   {
     // enumerate all the faces of all the fonts:
@@ -782,45 +805,111 @@ bool nuiFontManager::ScanSubFolder(const nglPath& rBasePath)
     
     if (rPath.IsLeaf())
     {
-      bool cont = true;
-      int32 face = 0;
-
-      NGL_ASSERT(!gFTLibrary);
-      FT_Error error;
-      error = FT_Init_FreeType(&gFTLibrary);
-
-      while (cont)
-      {
-        
-        nuiFontDesc* pFontDesc = new nuiFontDesc(rPath, face);
-                
-        if (pFontDesc->IsValid())
-        {
-          mpFonts.push_back(pFontDesc);
-        }
-        else
-        {
-          delete pFontDesc;
-          cont = false;
-        }
-        face++;
-      }
-      
-      FT_Done_FreeType(gFTLibrary);
-      gFTLibrary = NULL;
-
+      if (ScanFile(rPath, rPrevious))
+        scanned++;
     }
     else
     {
-      ScanSubFolder(rPath);
+      scanned += ScanSubFolder(rPath, rPrevious);
     }
     
     ++cit;
   }
   
+  return scanned;
+}
+
+bool nuiFontManager::ScanFile(const nglPath& rPath, ScannedFileMap& rPrevious)
+{
+  const double lastmod = rPath.GetLastMod();
+  
+  ScannedFileMap::iterator it = rPrevious.find(rPath);
+  if (it != rPrevious.end())
+  {
+    ScannedFile& rFile(it->second);
+    const bool unchanged = rFile.mLastMod == lastmod;
+    if (unchanged)
+    {
+      if (rFile.mpFonts.empty())
+        mSkippedFiles[rPath] = lastmod;
+      mpFonts.insert(mpFonts.end(), rFile.mpFonts.begin(), rFile.mpFonts.end());
+    }
+    else
+    {
+      NGL_LOG("font", NGL_LOG_INFO, "font file changed since the last scan '%s'\n", rPath.GetChars());
+      for (uint32 i = 0; i < rFile.mpFonts.size(); i++)
+        delete rFile.mpFonts[i];
+    }
+    
+    rPrevious.erase(it);
+    if (unchanged)
+      return false;
+  }
+  
+  bool cont = true;
+  int32 face = 0;
+  
+  NGL_ASSERT(!gFTLibrary);
+  FT_Error error;
+  error = FT_Init_FreeType(&gFTLibrary);
+  
+  while (cont)
+  {
+    nuiFontDesc* pFontDesc = new nuiFontDesc(rPath, face);
+    
+    if (pFontDesc->IsValid())
+    {
+      mpFonts.push_back(pFontDesc);
+    }
+    else
+    {
+      delete pFontDesc;
+      cont = false;
+    }
+    face++;
+  }
+  
+  FT_Done_FreeType(gFTLibrary);
+  gFTLibrary = NULL;
+  
+  if (face == 1) // Not even one valid face
+    mSkippedFiles[rPath] = lastmod;
+  
   return true;
 }
 
+uint32 nuiFontManager::AddUnchangedFiles(ScannedFileMap& rPrevious)
+{
+  // Keep the files that were not in the scanned folders if they are still there:
+  uint32 removed = 0;
+  ScannedFileMap::iterator it = rPrevious.begin();
+  ScannedFileMap::iterator end = rPrevious.end();
+  
+  while (it != end)
+  {
+    const nglPath& rPath(it->first);
+    ScannedFile& rFile(it->second);
+    if (rPath.Exists() && rPath.IsLeaf() && rFile.mLastMod == rPath.GetLastMod())
+    {
+      if (rFile.mpFonts.empty())
+        mSkippedFiles[rPath] = rFile.mLastMod;
+      mpFonts.insert(mpFonts.end(), rFile.mpFonts.begin(), rFile.mpFonts.end());
+    }
+    else
+    {
+      NGL_LOG("font", NGL_LOG_INFO, "remove font from database '%s'\n", rPath.GetChars());
+      for (uint32 i = 0; i < rFile.mpFonts.size(); i++)
+        delete rFile.mpFonts[i];
+      removed++;
+    }
+    
+    ++it;
+  }
+  
+  rPrevious.clear();
+  return removed;
+}
+
 void nuiFontManager::GetFolderList(std::vector<nglString>& rList) const
 {
   rList.clear();
@@ -915,17 +1004,156 @@ void nuiFontManager::RequestFont(nuiFontRequest& rRequest, std::list<nuiFontRequ
     rRequest.mName.mElement = nuiFontRequest::gDefaultFontsForGenericNames[rRequest.mGenericName.mElement];
   }
   
-  std::vector<nuiFontDesc*>::const_iterator it = mpFonts.begin();
-  std::vector<nuiFontDesc*>::const_iterator end = mpFonts.end();
-  
-  nglString dump;
   uint32 glyphcount = rRequest.mMustHaveGlyphs.mElement.size();
 
-  while (it != end)
+  // Use the lookup tables to only score the fonts that can match the strict conditions:
+  std::vector<uint32> candidates;
+  bool allfonts = true;
+  
+  if (rRequest.mName.mStrict)
   {
+    nglString name(rRequest.mName.mElement);
+    name.ToLower();
+    std::map<nglString, uint32>::const_iterator found = mFamilyIds.find(name);
+    if (found != mFamilyIds.end())
+      candidates = mFamilyFonts[found->second];
+    allfonts = false;
+  }
+  
+  // A strict generic name rules out the families of the other generic names, the families that have none can still match:
+  if (rRequest.mGenericName.mStrict && !rRequest.mGenericName.mElement.IsNull())
+  {
+    std::vector<bool> excluded(mFamilies.size(), false);
+    std::map<nglString, nglString>::const_iterator it = nuiFontRequest::gGenericNamesForFonts.begin();
+    std::map<nglString, nglString>::const_iterator end = nuiFontRequest::gGenericNamesForFonts.end();
+    for (; it != end; ++it)
+    {
+      if (it->second.Compare(rRequest.mGenericName.mElement) == 0)
+        continue;
+      std::map<nglString, uint32>::const_iterator found = mFamilyIds.find(it->first);
+      if (found != mFamilyIds.end())
+        excluded[found->second] = true;
+    }
+    
+    std::vector<uint32> fonts;
+    if (allfonts)
+    {
+      for (uint32 i = 0; i < mpFonts.size(); i++)
+        if (!excluded[mFontFamilies[i]])
+          fonts.push_back(i);
+    }
+    else
+    {
+      for (uint32 i = 0; i < candidates.size(); i++)
+        if (!excluded[mFontFamilies[candidates[i]]])
+          fonts.push_back(candidates[i]);
+    }
+    candidates.swap(fonts);
+    allfonts = false;
+  }
+  
+  // Fonts that have at least one glyph in the blocks of the requested glyphs, the others can't have any of them:
+  std::vector<bool> covering;
+  if (glyphcount)
+  {
+    covering.resize(mpFonts.size(), false);
+    uint32 lastblock = (uint32)-1;
+    std::set<nglUChar>::const_iterator it = rRequest.mMustHaveGlyphs.mElement.begin();
+    std::set<nglUChar>::const_iterator end = rRequest.mMustHaveGlyphs.mElement.end();
+    
+    while (it != end)
+    {
+      const uint32 block = ((uint32)*it) >> NUI_FONT_COVERAGE_SHIFT;
+      if (block != lastblock && block < mBlockFonts.size())
+      {
+        const std::vector<uint32>& rFonts(mBlockFonts[block]);
+        for (uint32 i = 0; i < rFonts.size(); i++)
+          covering[rFonts[i]] = true;
+      }
+      lastblock = block;
+      ++it;
+    }
+    
+    if (rRequest.mMustHaveGlyphs.mStrict)
+    {
+      std::vector<uint32> fonts;
+      if (allfonts)
+      {
+        for (uint32 i = 0; i < mpFonts.size(); i++)
+          if (covering[i])
+            fonts.push_back(i);
+      }
+      else
+      {
+        for (uint32 i = 0; i < candidates.size(); i++)
+          if (covering[candidates[i]])
+            fonts.push_back(candidates[i]);
+      }
+      candidates.swap(fonts);
+      allfonts = false;
+    }
+  }
+  
+  if (allfonts)
+  {
+    candidates.resize(mpFonts.size());
+    for (uint32 i = 0; i < mpFonts.size(); i++)
+      candidates[i] = i;
+  }
+  
+  bool scored = false;
+  if (glyphcount && !rRequest.mMustHaveGlyphs.mStrict)
+  {
+    // Score the fonts that have glyphs in the blocks of the requested ones first, and all the others only if none of them has any
+    // of the glyphs:
+    std::vector<uint32> fonts;
+    for (uint32 i = 0; i < candidates.size(); i++)
+      if (covering[candidates[i]])
+        fonts.push_back(candidates[i]);
+    
+    scored = ScoreFonts(rRequest, fonts, covering, rFoundFonts);
+    if (!scored)
+      rFoundFonts.clear();
+  }
+  
+  if (!scored)
+    ScoreFonts(rRequest, candidates, covering, rFoundFonts);
+  rFoundFonts.sort(greater_score);
+  
+  if (0)
+  {
+    std::list<nuiFontRequestResult>::const_iterator it = rFoundFonts.begin();
+    std::list<nuiFontRequestResult>::const_iterator end = rFoundFonts.end();
+    
+    while (it != end)
+    {
+      const nuiFontRequestResult& r(*it);
+      const nuiFontDesc* pDesc = r.GetFontDesc();
+    NGL_LOG("font", NGL_LOG_INFO, "font '%s' bold: %s italic: %s (%f)\n", pDesc->GetName().GetChars(), pDesc->GetBold()?"Y":"N", pDesc->GetItalic()?"Y":"N", r.GetScore());
+      ++it;
+    }
+  }
+}
+
+bool nuiFontManager::ScoreFonts(const nuiFontRequest& rRequest, const std::vector<uint32>& rCandidates, const std::vector<bool>& rCovering, std::list<nuiFontRequestResult>& rFoundFonts) const
+{
+  const uint32 glyphcount = rRequest.mMustHaveGlyphs.mElement.size();
+  bool hasglyphs = false;
+  
+  // The generic names can be added at any time, look them up once per family:
+  std::vector<const nglString*> genericnames(mFamilies.size(), (const nglString*)NULL);
+  
+  for (uint32 c = 0; c < rCandidates.size(); c++)
+  {
+    const uint32 index = rCandidates[c];
+    nuiFontDesc* pFontDesc = mpFonts[index];
+    
+    //#FIXME: hacky-hack to avoid bitmap fonts
+    if (!pFontDesc->GetScalable())
+      continue;
+    
     float score = 1.f;
     float sscore = 1.f;
-    nuiFontDesc* pFontDesc = *it;
     //pFontDesc->GetPath()
     if (pFontDesc->GetName().Compare("LastResort", false) == 0)
       score *= 0.1;
@@ -938,7 +1166,13 @@ void nuiFontManager::RequestFont(nuiFontRequest& rRequest, std::list<nuiFontRequ
     SET_SCORE(Monospace);
     
     {
-      nglString genName = nuiFontRequest::GetGenericNameForFont(pFontDesc->GetName());
+      const uint32 family = mFontFamilies[index];
+      if (!genericnames[family])
+      {
+        std::map<nglString, nglString>::const_iterator found = nuiFontRequest::gGenericNamesForFonts.find(mFamilies[family]);
+        genericnames[family] = (found != nuiFontRequest::gGenericNamesForFonts.end()) ? &found->second : &nglString::Null;
+      }
+      const nglString& genName(*genericnames[family]);
       if (!genName.IsNull())
       {
         if (rRequest.mGenericName.mStrict)
@@ -976,13 +1210,14 @@ void nuiFontManager::RequestFont(nuiFontRequest& rRequest, std::list<nuiFontRequ
         score += _s;
     }
     
+    uint32 glyphs = 0;
     if (glyphcount)
     {
       uint32 count = 0;  
       std::set<nglUChar>::const_iterator it = rRequest.mMustHaveGlyphs.mElement.begin();
       std::set<nglUChar>::const_iterator end = rRequest.mMustHaveGlyphs.mElement.end();
       
-      while (it != end)
+      while (rCovering[index] && it != end)
       {
         const nglUChar glyph = *it;
         if (pFontDesc->HasGlyph(glyph))
@@ -990,6 +1225,7 @@ void nuiFontManager::RequestFont(nuiFontRequest& rRequest, std::list<nuiFontRequ
         ++it;
       }
       
+      glyphs = count;
       float f = (float)count / (float)glyphcount;
       float _s = rRequest.mMustHaveGlyphs.mScore * f;
       if (rRequest.mMustHaveGlyphs.mStrict)
@@ -1032,29 +1268,14 @@ void nuiFontManager::RequestFont(nuiFontRequest& rRequest, std::list<nuiFontRequ
     
     score *= sscore;
     
-    //#FIXME: hacky-hack to avoid bitmap fonts
     if (score > 0.f)
-      if (pFontDesc->GetScalable())
-        rFoundFonts.push_back(nuiFontRequestResult(pFontDesc->GetPath(), pFontDesc->GetFace(), score, pFontDesc));
-    
-    ++it;
-  }
-  
-  rFoundFonts.sort(greater_score);
-  
-  if (0)
-  {
-    std::list<nuiFontRequestResult>::const_iterator it = rFoundFonts.begin();
-    std::list<nuiFontRequestResult>::const_iterator end = rFoundFonts.end();
-    
-    while (it != end)
     {
-      const nuiFontRequestResult& r(*it);
-      const nuiFontDesc* pDesc = r.GetFontDesc();
-    NGL_LOG("font", NGL_LOG_INFO, "font '%s' bold: %s italic: %s (%f)\n", pDesc->GetName().GetChars(), pDesc->GetBold()?"Y":"N", pDesc->GetItalic()?"Y":"N", r.GetScore());
-      ++it;
+      rFoundFonts.push_back(nuiFontRequestResult(pFontDesc->GetPath(), pFontDesc->GetFace(), score, pFontDesc));
+      hasglyphs |= (glyphs > 0);
     }
   }
+  
+  return hasglyphs;
 }
 
 
@@ -1119,7 +1340,7 @@ nuiFontManager& nuiFontManager::LoadManager(nglIStream& rStream, double lastscan
 }
 
 
-#define NUI_FONTDB_MARKER "nuiFontDatabase5"
+#define NUI_FONTDB_MARKER "nuiFontDatabase6"
 
 
 bool nuiFontManager::Save(nglOStream& rStream)
@@ -1130,6 +1351,9 @@ bool nuiFontManager::Save(nglOStream& rStream)
   if (s != rStream.Write(NUI_FONTDB_MARKER, s, 1))
     return false;
   
+  uint32 count = mpFonts.size();
+  rStream.WriteUInt32(&count);
+  
   std::vector<nuiFontDesc*>::iterator it = mpFonts.begin(); 
   std::vector<nuiFontDesc*>::iterator end = mpFonts.end(); 
   
@@ -1142,145 +1366,116 @@ bool nuiFontManager::Save(nglOStream& rStream)
     ++it;
   }
   
+  // Write the files that are not fonts so that they are not opened again:
+  count = mSkippedFiles.size();
+  rStream.WriteUInt32(&count);
   
-  return true;
-}
-
-bool nuiFontManager::Load(nglIStream& rStream, double lastscantime)
-{
-  rStream.SetEndian(eEndianLittle);
+  std::map<nglPath, double>::const_iterator fit = mSkippedFiles.begin();
+  std::map<nglPath, double>::const_iterator fend = mSkippedFiles.end();
   
-  int s = strlen(NUI_FONTDB_MARKER) + 1;
-  char* marker = new char[s];
-  if (s != rStream.Read(marker, s, 1))
+  while (fit != fend)
   {
-    delete marker;
+    const char* pPath = fit->first.GetPathName().Export(eUTF8);
+    uint32 size = strlen(pPath);
+    rStream.WriteUInt32(&size);
+    rStream.Write(pPath, size, 1);
+    rStream.WriteDouble(&fit->second);
+    delete[] pPath;
     
-    return false;
+    ++fit;
   }
   
-  if (strcmp(NUI_FONTDB_MARKER, marker))
-  {
-    delete marker;
-    
+  return true;
+}
+
+bool nuiFontManager::ReadIndex(nglIStream& rStream, ScannedFileMap& rFiles) const
+{
+  // Read the whole database at once and parse it from memory:
+  std::vector<uint8> buffer((size_t)rStream.Available());
+  if (buffer.empty() || rStream.Read(&buffer[0], buffer.size(), 1) != (int64)buffer.size())
     return false;
-  }
   
-  delete[] marker;
-  
-  Clear();
-
-  // compile list of font files
-  std::set<nglPath> fontFiles;
-  std::set<nglPath>::iterator itf;
-  std::map<nglString, nglPath>::iterator it;
+  nglIMemory stream(&buffer[0], buffer.size());
+  stream.SetEndian(eEndianLittle);
   
-  bool scanfolders = true;
+  int s = strlen(NUI_FONTDB_MARKER) + 1;
+  std::vector<char> marker(s);
+  if (s != stream.Read(&marker[0], s, 1) || strcmp(NUI_FONTDB_MARKER, &marker[0]))
+    return false;
   
-  if (scanfolders)
+  bool valid = true;
+  uint32 count = 0;
+  valid = stream.ReadUInt32(&count) == 1;
+  for (uint32 i = 0; valid && i < count; i++)
   {
-    // All OSes 
-    for (it = mFontFolders.begin(); it != mFontFolders.end(); ++it)
+    nuiFontDesc* pFontDesc = new nuiFontDesc(stream);
+    if (pFontDesc->IsValid())
     {
-      const nglString& str = it->first;
-      const nglPath& pth = it->second;
-      NGL_LOG("font", NGL_LOG_INFO, "scanning font folder '%s' '%s' for font files\n", str.GetChars(), pth.GetChars());
-      
-      std::list<nglPath> children;
-      std::list<nglPath>::iterator itc;
-      pth.GetChildrenTree(children);
-      
-      for (itc = children.begin(); itc != children.end(); ++itc)
-      {
-        const nglPath& path = *itc;
-        if (path.IsLeaf())
-        {
-          fontFiles.insert(path);
-          NGL_LOG("font", NGL_LOG_INFO, "font file found '%s'\n", path.GetChars());
-        }
-        else
-        {
-          NGL_LOG("font", NGL_LOG_INFO, "skip '%s'\n", path.GetChars());
-        }
-      }
-    }
-  }
-  
-  while (rStream.GetState() == eStreamReady)
-  {
-    nuiFontDesc* pFontDesc = new nuiFontDesc(rStream);
-    
-    if (pFontDesc->IsValid() && pFontDesc->GetScalable())
-    {
-      // check font file existence
-      if (!pFontDesc->CheckPath())
-      {
-        NGL_LOG("font", NGL_LOG_INFO, "remove font from database '%s'\n", pFontDesc->GetPath().GetChars());
-        
-        continue;
-      }
-      
-      // register the font 
-      mpFonts.push_back(pFontDesc);
-      NGL_OUT("Font %s (%s) available\n", pFontDesc->GetName().GetChars(), pFontDesc->GetPath().GetChars());
-      // remove it from the compiled list
-      itf = fontFiles.find(pFontDesc->GetPath());
-      if (itf != fontFiles.end())
-        fontFiles.erase(itf);
-      
+      ScannedFile& rFile(rFiles[pFontDesc->GetPath()]);
+      rFile.mLastMod = pFontDesc->GetLastMod();
+      rFile.mpFonts.push_back(pFontDesc);
     }
     else
     {
       delete pFontDesc;
+      valid = false;
     }
   }
   
-  // now, the files that are still in the compiled list are supposed to be newly installed fonts
-  // let's add'em to the font database
-  FT_Error error;
-  error = FT_Init_FreeType(&gFTLibrary);
-  for (itf = fontFiles.begin(); itf != fontFiles.end(); ++itf)
+  valid = valid && stream.ReadUInt32(&count) == 1;
+  std::vector<char> chars;
+  for (uint32 i = 0; valid && i < count; i++)
   {
-    const nglPath& path = *itf;
-   
-#ifndef NUI_IOS // On iOS the db is never saved so we need to scan every times...
-    if (path.GetLastMod() > lastscantime)
-#else
-    if (1)
-#endif
+    uint32 size = 0;
+    double lastmod = 0;
+    valid = stream.ReadUInt32(&size) == 1 && size <= stream.Available();
+    if (valid)
     {
-      bool cont = true;
-      int32 face = 0;
-      while (cont)
-      {
-        NGL_ASSERT(gFTLibrary);
-        
-        nuiFontDesc* pFontDesc = new nuiFontDesc(path, face);
-        
-        
-        if (pFontDesc->IsValid())
-        {
-          mpFonts.push_back(pFontDesc);
-          
-          NGL_LOG("font", NGL_LOG_INFO, "add new font in database '%s'\n", path.GetChars());
-        }
-        else
-        {
-          delete pFontDesc;
-          cont = false;
-        }
-        face++;
-      }
+      chars.resize(size + 1);
+      stream.Read(&chars[0], size, 1);
+      valid = stream.ReadDouble(&lastmod) == 1;
+      if (valid)
+        rFiles[nglPath(nglString(&chars[0], size, eUTF8))].mLastMod = lastmod;
     }
-    else
-    {
-      NGL_LOG("font", NGL_LOG_INFO, "skip already scanned font '%s'\n", path.GetChars());
-    }
-    
   }
   
-  FT_Done_FreeType(gFTLibrary);
-  gFTLibrary = NULL;  
+  if (!valid)
+  {
+    NGL_LOG("font", NGL_LOG_ERROR, "The font database is corrupted\n");
+    for (ScannedFileMap::iterator it = rFiles.begin(); it != rFiles.end(); ++it)
+      for (uint32 i = 0; i < it->second.mpFonts.size(); i++)
+        delete it->second.mpFonts[i];
+    rFiles.clear();
+  }
+  
+  return valid;
+}
+
+bool nuiFontManager::Load(nglIStream& rStream, double lastscantime)
+{
+  nglTime start_time;
+  
+  ScannedFileMap previous;
+  if (!ReadIndex(rStream, previous))
+    return false;
+  
+  Clear();
+
+  // Only open the files of the font folders that are new or that changed since the database was saved:
+  uint32 scanned = 0;
+  std::map<nglString, nglPath>::iterator it;
+  for (it = mFontFolders.begin(); it != mFontFolders.end(); ++it)
+  {
+    const nglPath& pth = it->second;
+    mScanedFolders.insert(pth);
+    scanned += ScanSubFolder(pth, previous);
+  }
+  
+  const uint32 removed = AddUnchangedFiles(previous);
+  BuildIndex();
+  
+  nglTime end_time;
+  NGL_LOG("font", NGL_LOG_INFO, "Loading the font database took %f seconds (%d fonts, %d files opened, %d removed)\n", (double)(end_time - start_time), (int32)mpFonts.size(), scanned, removed);
   return true;
 }
 
@@ -1349,6 +1544,8 @@ void nuiFontManager::UpdateFonts()
   
   FT_Done_FreeType(gFTLibrary);
   gFTLibrary = NULL;  
+  
+  BuildIndex();
 }
 
 void nuiFontManager::Clear()
@@ -1366,7 +1563,62 @@ void nuiFontManager::Clear()
   }
   
   mpFonts.clear();
+  mSkippedFiles.clear();
+  ClearIndex();
+}
+
+void nuiFontManager::BuildIndex()
+{
+  ClearIndex();
   
+  mFontFamilies.resize(mpFonts.size());
+  mBlockFonts.resize(NUI_FONT_COVERAGE_BLOCKS);
+  
+  for (uint32 i = 0; i < mpFonts.size(); i++)
+  {
+    const nuiFontDesc* pFontDesc = mpFonts[i];
+    
+    nglString name(pFontDesc->GetName());
+    name.ToLower();
+    std::map<nglString, uint32>::const_iterator found = mFamilyIds.find(name);
+    uint32 family = 0;
+    if (found == mFamilyIds.end())
+    {
+      family = mFamilies.size();
+      mFamilyIds[name] = family;
+      mFamilies.push_back(name);
+      mFamilyFonts.push_back(std::vector<uint32>());
+    }
+    else
+    {
+      family = found->second;
+    }
+    mFamilyFonts[family].push_back(i);
+    mFontFamilies[i] = family;
+    
+    // The ranges are sorted so each block only needs to be compared with the last one:
+    const std::vector<nuiFontDesc::GlyphRange>& rRanges(pFontDesc->GetGlyphRanges());
+    for (uint32 r = 0; r < rRanges.size(); r++)
+    {
+      const uint32 first = ((uint32)rRanges[r].first) >> NUI_FONT_COVERAGE_SHIFT;
+      const uint32 last = MIN(((uint32)rRanges[r].second) >> NUI_FONT_COVERAGE_SHIFT, NUI_FONT_COVERAGE_BLOCKS - 1);
+      for (uint32 block = first; block <= last; block++)
+      {
+        std::vector<uint32>& rFonts(mBlockFonts[block]);
+        if (rFonts.empty() || rFonts.back() != i)
+          rFonts.push_back(i);
+      }
+    }
+  }
+}
+
+void nuiFontManager::ClearIndex()
+{
+  mFamilies.clear();
+  mFamilyIds.clear();
+  mFamilyFonts.clear();
+  mFontFamilies.clear();
+  mBlockFonts.clear();
 }
 
 uint32 nuiFontManager::GetFontCount() const
@@ -0,0 +1,236 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiShapedRunCache.h"
+
+// Never deleted: fonts can still be destroyed (and call Forget) while the application exits.
+static nuiShapedRunCache* gpShapedRunCache = NULL;
+static nglCriticalSection gShapedRunCacheCS(nglString("nuiShapedRunCache::Get"));
+
+// class nuiShapedRunCache::Key
+nuiShapedRunCache::Key::Key(nuiFontBase* pFont, float Size, nuiUnicodeScript Script, const nglUChar* pText, int32 Length)
+: mpFont(pFont), mSize(Size), mScript(Script), mText(pText, pText + Length)
+{
+}
+
+bool nuiShapedRunCache::Key::operator<(const Key& rKey) const
+{
+  // The font must come first, ForgetFont relies on it:
+  if (mpFont != rKey.mpFont)
+    return mpFont < rKey.mpFont;
+  if (mSize != rKey.mSize)
+    return mSize < rKey.mSize;
+  if (mScript != rKey.mScript)
+    return mScript < rKey.mScript;
+  // Most strings differ by their length, which is cheaper to compare than their contents:
+  if (mText.size() != rKey.mText.size())
+    return mText.size() < rKey.mText.size();
+  return mText < rKey.mText;
+}
+
+// class nuiShapedRunCache::Entry
+nuiShapedRunCache::Entry::Entry(const Key& rKey, const std::vector<nuiTextGlyph>& rGlyphs, float AdvanceX)
+: mKey(rKey), mGlyphs(rGlyphs), mAdvanceX(AdvanceX)
+{
+}
+
+// class nuiShapedRunCache
+nuiShapedRunCache::nuiShapedRunCache(uint32 MaxEntries, uint32 MaxGlyphs, uint32 MaxLength)
+: mCS(nglString("nuiShapedRunCache"))
+{
+  mEnabled = true;
+  mMaxEntries = MaxEntries;
+  mMaxGlyphs = MaxGlyphs;
+  mMaxLength = MaxLength;
+  mGlyphs = 0;
+  mHits = 0;
+  mMisses = 0;
+  mEvictions = 0;
+}
+
+nuiShapedRunCache::~nuiShapedRunCache()
+{
+  Clear();
+  if (gpShapedRunCache == this)
+    gpShapedRunCache = NULL;
+}
+
+nuiShapedRunCache& nuiShapedRunCache::Get()
+{
+  nglCriticalSectionGuard guard(gShapedRunCacheCS);
+  if (!gpShapedRunCache)
+    gpShapedRunCache = new nuiShapedRunCache();
+  return *gpShapedRunCache;
+}
+
+void nuiShapedRunCache::Forget(nuiFontBase* pFont)
+{
+  if (gpShapedRunCache)
+    gpShapedRunCache->ForgetFont(pFont);
+}
+
+bool nuiShapedRunCache::Find(nuiFontBase* pFont, nuiUnicodeScript Script, const nglUChar* pText, int32 Length, std::vector<nuiTextGlyph>& rGlyphs, float& rAdvanceX)
+{
+  if (!mEnabled || Length > (int32)mMaxLength)
+    return false;
+
+  Key key(pFont, pFont->GetSize(), Script, pText, Length);
+
+  nglCriticalSectionGuard guard(mCS);
+  EntryMap::iterator it = mIndex.find(key);
+  if (it == mIndex.end())
+  {
+    mMisses++;
+    return false;
+  }
+
+  mHits++;
+  mEntries.splice(mEntries.begin(), mEntries, it->second);
+  rGlyphs = it->second->mGlyphs;
+  rAdvanceX = it->second->mAdvanceX;
+  return true;
+}
+
+void nuiShapedRunCache::Store(nuiFontBase* pFont, nuiUnicodeScript Script, const nglUChar* pText, int32 Length, const std::vector<nuiTextGlyph>& rGlyphs, float AdvanceX)
+{
+  if (!mEnabled || Length > (int32)mMaxLength)
+    return;
+
+  Key key(pFont, pFont->GetSize(), Script, pText, Length);
+
+  nglCriticalSectionGuard guard(mCS);
+  if (mIndex.find(key) != mIndex.end())
+    return; // Another thread was faster
+
+  mEntries.push_front(Entry(key, rGlyphs, AdvanceX));
+  mIndex[key] = mEntries.begin();
+  mGlyphs += rGlyphs.size();
+  Trim();
+}
+
+void nuiShapedRunCache::ForgetFont(nuiFontBase* pFont)
+{
+  nglCriticalSectionGuard guard(mCS);
+  EntryMap::iterator it = mIndex.lower_bound(Key(pFont, -FLT_MAX, eScriptCommon, NULL, 0));
+  while (it != mIndex.end() && it->first.mpFont == pFont)
+    Remove(it++);
+}
+
+void nuiShapedRunCache::Remove(EntryMap::iterator it)
+{
+  EntryList::iterator entry = it->second;
+  mGlyphs -= entry->mGlyphs.size();
+  mEntries.erase(entry);
+  mIndex.erase(it);
+}
+
+void nuiShapedRunCache::Trim()
+{
+  while (!mEntries.empty() && (mEntries.size() > mMaxEntries || mGlyphs > mMaxGlyphs))
+  {
+    Remove(mIndex.find(mEntries.back().mKey));
+    mEvictions++;
+  }
+}
+
+void nuiShapedRunCache::SetEnabled(bool Set)
+{
+  mEnabled = Set;
+  if (!Set)
+    Clear();
+}
+
+bool nuiShapedRunCache::GetEnabled() const
+{
+  return mEnabled;
+}
+
+void nuiShapedRunCache::SetMaxEntries(uint32 MaxEntries)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mMaxEntries = MaxEntries;
+  Trim();
+}
+
+uint32 nuiShapedRunCache::GetMaxEntries() const
+{
+  return mMaxEntries;
+}
+
+void nuiShapedRunCache::SetMaxGlyphs(uint32 MaxGlyphs)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mMaxGlyphs = MaxGlyphs;
+  Trim();
+}
+
+uint32 nuiShapedRunCache::GetMaxGlyphs() const
+{
+  return mMaxGlyphs;
+}
+
+void nuiShapedRunCache::SetMaxLength(uint32 MaxLength)
+{
+  mMaxLength = MaxLength;
+}
+
+uint32 nuiShapedRunCache::GetMaxLength() const
+{
+  return mMaxLength;
+}
+
+void nuiShapedRunCache::Clear()
+{
+  nglCriticalSectionGuard guard(mCS);
+  mEntries.clear();
+  mIndex.clear();
+  mGlyphs = 0;
+}
+
+uint32 nuiShapedRunCache::GetEntryCount() const
+{
+  nglCriticalSectionGuard guard(mCS);
+  return (uint32)mEntries.size();
+}
+
+uint32 nuiShapedRunCache::GetGlyphCount() const
+{
+  return mGlyphs;
+}
+
+uint64 nuiShapedRunCache::GetHits() const
+{
+  return mHits;
+}
+
+uint64 nuiShapedRunCache::GetMisses() const
+{
+  return mMisses;
+}
+
+uint64 nuiShapedRunCache::GetEvictions() const
+{
+  return mEvictions;
+}
+
+float nuiShapedRunCache::GetHitRate() const
+{
+  nglCriticalSectionGuard guard(mCS);
+  const uint64 lookups = mHits + mMisses;
+  if (!lookups)
+    return 0;
+  return (float)((double)mHits / (double)lookups);
+}
+
+void nuiShapedRunCache::ResetStats()
+{
+  nglCriticalSectionGuard guard(mCS);
+  mHits = 0;
+  mMisses = 0;
+  mEvictions = 0;
+}
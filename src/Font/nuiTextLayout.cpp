@@ -9,6 +9,25 @@
 #include "ucdata.h"
 
 
+/////////////////
+// nuiTextLayout::Paragraph
+nuiTextLayout::Paragraph::Paragraph(int32 Start, int32 Length, uint32 Hash)
+: mStart(Start), mLength(Length), mHash(Hash), mWidth(0)
+{
+}
+
+nuiTextLayout::Paragraph::~Paragraph()
+{
+  Clear();
+}
+
+void nuiTextLayout::Paragraph::Clear()
+{
+  for (uint32 l = 0; l < size(); l++)
+    delete (*this)[l];
+  clear();
+}
+
 /////////////////
 // nuiTextLayout
 nuiTextLayout::nuiTextLayout(nuiFontBase* pFont, nuiOrientation Orientation)
@@ -33,20 +52,77 @@ nuiTextLayout::nuiTextLayout(const nuiTextStyle& rStyle, nuiOrientation Orientat
 nuiTextLayout::~nuiTextLayout()
 {
   for (uint32 p = 0; p < mpParagraphs.size(); p++)
+    delete mpParagraphs[p];
+}
+
+// Below this many chars the tasks cost more than shaping the paragraphs on the calling thread:
+#define NUI_TEXTLAYOUT_PARALLEL_MIN_CHARS 16384
+
+static uint32 HashParagraph(const nglUChar* pText, int32 Length)
+{
+  // FNV-1a
+  uint32 hash = 2166136261U;
+  for (int32 i = 0; i < Length; i++)
   {
-    Paragraph* pParagraph = mpParagraphs[p];
-    for (uint32 l = 0; l < pParagraph->size(); l++)
-    {
-      nuiTextLine* pLine = (*pParagraph)[l];
-      delete pLine;
-    }
-    
-    delete pParagraph;
+    hash ^= (uint32)pText[i];
+    hash *= 16777619U;
   }
+  return hash;
 }
 
 bool nuiTextLayout::Layout(const nglString& rString)
 {
+  std::vector<Paragraph*> toshape;
+  BeginLayout(rString, toshape);
+
+  LayoutParagraphs paragraphs;
+  for (uint32 p = 0; p < toshape.size(); p++)
+    paragraphs.push_back(std::make_pair(this, toshape[p]));
+  ShapeParagraphs(paragraphs, mpTaskPool);
+  RasterizeGlyphs(paragraphs, mpTaskPool ? *mpTaskPool : nuiTaskPool::GetDefault());
+
+  EndLayout();
+  return true;
+}
+
+void nuiTextLayout::Layout(const std::vector<nuiTextLayout*>& rLayouts, const std::vector<nglString>& rStrings, nuiTaskPool& rPool)
+{
+  NGL_ASSERT(rLayouts.size() == rStrings.size());
+  LayoutParagraphs paragraphs;
+  for (uint32 i = 0; i < rLayouts.size(); i++)
+  {
+    std::vector<Paragraph*> toshape;
+    rLayouts[i]->BeginLayout(rStrings[i], toshape);
+    for (uint32 p = 0; p < toshape.size(); p++)
+      paragraphs.push_back(std::make_pair(rLayouts[i], toshape[p]));
+  }
+
+  ShapeParagraphs(paragraphs, &rPool);
+  RasterizeGlyphs(paragraphs, rPool);
+
+  for (uint32 i = 0; i < rLayouts.size(); i++)
+    rLayouts[i]->EndLayout();
+}
+
+void nuiTextLayout::BeginLayout(const nglString& rString, std::vector<Paragraph*>& rToShape)
+{
+  // Keep the paragraphs of the previous layout around, the ones whose text didn't change will be reused:
+  std::vector<nglUChar> oldunicode;
+  oldunicode.swap(mUnicode);
+  std::multimap<uint32, Paragraph*> oldparagraphs;
+  const bool reuse = mReuseParagraphs && mStyleChanges.empty();
+  for (uint32 p = 0; p < mpParagraphs.size(); p++)
+  {
+    if (reuse)
+      oldparagraphs.insert(std::make_pair(mpParagraphs[p]->mHash, mpParagraphs[p]));
+    else
+      delete mpParagraphs[p];
+  }
+  mpParagraphs.clear();
+  mOffsetInString.clear();
+  mOffsetInUnicode.clear();
+  mReusedParagraphs = 0;
+
   // Transform the string in a vector of nglUChar, also keep the offsets from the original chars to the nglUChar and vice versa
   int32 len = rString.GetLength();
   int32 i = 0;
@@ -64,7 +140,16 @@ bool nuiTextLayout::Layout(const nglString& rString)
   }
   
   //printf("\n");
-  
+
+  {
+    nuiFontBase* pFont = mStyle.GetFont();
+    nuiGlyphInfo glyphinfo;
+    uint32 space = pFont->GetGlyphIndex(32);
+    pFont->GetGlyphInfo(glyphinfo, space, nuiFontBase::eGlyphNative);
+    mSpaceWidth = glyphinfo.AdvanceX;
+    mTabWidth = 4 * mSpaceWidth;
+  }
+
   // General algorithm:
   // 1. Split text into paragraphs (LayoutText)
   // 2. Split text into fonts
@@ -72,6 +157,7 @@ bool nuiTextLayout::Layout(const nglString& rString)
   // 4. Split ranges into fonts
   // 5. Split ranges into lines / words if needed
   
+  std::vector<std::pair<int32, int32> > ranges;
   int32 start = 0;
   int32 position = 0;
   int32 count = mUnicode.size();
@@ -83,7 +169,7 @@ bool nuiTextLayout::Layout(const nglString& rString)
     {
       // Found a paragraph
       //printf("Paragraph %d -> %d (%d chars)\n", start, position, position - start);
-      LayoutParagraph(start, position - start); // Eat the \n char
+      ranges.push_back(std::make_pair(start, position - start)); // Eat the \n char
       start = position + 1;
     }
     position++;
@@ -92,19 +178,44 @@ bool nuiTextLayout::Layout(const nglString& rString)
   if (start < position)
   {
     //printf("last Paragraph %d -> %d (%d chars)\n", start, position, position - start);
-    LayoutParagraph(start, position - start); // Eat the \n char
+    ranges.push_back(std::make_pair(start, position - start)); // Eat the \n char
     start = position;
   }
 
+  for (uint32 r = 0; r < ranges.size(); r++)
+  {
+    const int32 start = ranges[r].first;
+    const int32 length = ranges[r].second;
+    const uint32 hash = HashParagraph(&mUnicode[0] + start, length);
+    Paragraph* pParagraph = ReuseParagraph(start, length, hash, oldunicode, oldparagraphs);
+    if (!pParagraph)
+    {
+      pParagraph = new Paragraph(start, length, hash);
+      LayoutParagraph(pParagraph);
+      rToShape.push_back(pParagraph);
+    }
+    mpParagraphs.push_back(pParagraph);
+  }
+
+  for (std::multimap<uint32, Paragraph*>::iterator it = oldparagraphs.begin(); it != oldparagraphs.end(); ++it)
+    delete it->second;
+
   mAscender = 0;
   mDescender = 0;
 
   //printf("Map scripts to fonts:\n");
+  Charsets charsets;
+  for (uint32 p = 0; p < mpParagraphs.size(); p++)
+  {
+    for (auto& item : mpParagraphs[p]->mCharsets)
+      for (auto& script : item.second)
+        charsets[item.first][script.first].insert(script.second.begin(), script.second.end());
+  }
+
   int32 c = 0;
   // Find the needed fonts for each script:
-
-  std::map< std::pair<nuiFontBase*, nuiUnicodeScript> , nuiFontBase*> FontSet;
-  for (auto& item : mCharsets)
+  mFontSet.clear();
+  for (auto& item : charsets)
   {
     nuiFontBase* pFontBase = item.first;
     auto it = item.second.begin();
@@ -139,7 +250,7 @@ bool nuiTextLayout::Layout(const nglString& rString)
         pFont = nuiFontManager::GetManager().GetFont(request);
       }
       
-      FontSet[std::make_pair(pFontBase, it->first)] = pFont;
+      mFontSet[std::make_pair(pFontBase, it->first)] = pFont;
       
       //printf("%s\n", pFont->GetFamilyName().GetChars());
       
@@ -149,80 +260,43 @@ bool nuiTextLayout::Layout(const nglString& rString)
   }
   //printf("Map scripts to fonts DONE\n");
 
-  i = 0;
-  nuiRect rect;
-  float PenX = 0;
-  float PenY = 0;
-  float maxwidth = 0;
-  // First pass: Assign the correct font to each run, shape the runs and calculate wraping if needed:
+  // The reused paragraphs were shaped with the fonts chosen for the previous text, lay them out again if the new text changed that choice:
   for (uint32 p = 0; p < mpParagraphs.size(); p++)
   {
     Paragraph* pParagraph = mpParagraphs[p];
-    for (uint32 l = 0; l < pParagraph->size(); l++)
-    {
-      nuiTextLine* pLine = (*pParagraph)[l];
-      
-      pLine->SetPosition(PenX, PenY);
-      
-      PenX = 0;
-      float x = 0;
-      float y = 0;
-      for (uint32 r = 0; r < pLine->GetRunCount(); r++)
-      { 
-        nuiTextRun* pRun = pLine->GetRun(r);
-        pRun->mX = x;
-        pRun->mY = y;
-        nuiFontBase* pFont = FontSet[std::make_pair(pRun->GetFont(), pRun->GetScript())];
-        if (!pFont)
-          pFont = mStyle.GetFont();
-        if (!pRun->IsDummy())
-        {
-          // Only shape real runs.
-          pRun->SetFont(pFont);
-          pFont->Shape(pRun);
-
-          nuiFontInfo finfo;
-          pFont->GetInfo(finfo);
-
-          std::vector<nuiTextGlyph>& rGlyphs(pRun->GetGlyphs());
-
-          if (mWrapX > 0)
-          {
-            // compute the bounding box:
-            float runw = 0;
-            for (int32 g = 0; g < rGlyphs.size(); g++)
-            {
-              const nuiTextGlyph& rGlyph(rGlyphs.at(g));
-              runw += rGlyph.AdvanceX;
-            }
-
-            if (PenX + x + runw >= mWrapX)
-            {
-              PenX = 0;
-              x = 0;
-              y += finfo.Height;
-              pRun->SetWrapStart(true);
-            }
-          }
-
-        }
-
-        x += pRun->GetAdvanceX();
-        maxwidth = MAX(maxwidth, PenX + x);
-
-        //y += pRun->GetAdvanceY();
+    if (pParagraph->mFonts.empty())
+      continue;
 
-
-        //printf("\trange %d <%d.%d.%d> (%d - %d) (%s --> %s / %s) (advance: %f / %f)\n", i, p, l, r, pRun->GetPosition(), pRun->GetLength(), nuiGetUnicodeScriptName(pRun->GetScript()).GetChars(), pFont->GetFamilyName().GetChars(), pFont->GetStyleName().GetChars(), pRun->GetAdvanceX(), pRun->GetAdvanceY());
-
-        i++;
+    for (FontSet::const_iterator it = pParagraph->mFonts.begin(); it != pParagraph->mFonts.end(); ++it)
+    {
+      FontSet::const_iterator font = mFontSet.find(it->first);
+      if (font == mFontSet.end() || font->second != it->second)
+      {
+        pParagraph->Clear();
+        pParagraph->mCharsets.clear();
+        LayoutParagraph(pParagraph);
+        rToShape.push_back(pParagraph);
+        mReusedParagraphs--;
+        break;
       }
-      PenY += pLine->GetAdvanceY();
     }
   }
 
-  PenX = 0;
-  PenY = 0;
+  // First pass: Assign the correct font to each run, on the calling thread. The runs are shaped and the wraping is calculated before EndLayout:
+  for (uint32 p = 0; p < rToShape.size(); p++)
+    SetParagraphFonts(rToShape[p]);
+}
+
+void nuiTextLayout::EndLayout()
+{
+  mFontHeights.clear();
+
+  nuiRect rect;
+  float PenX = 0;
+  float PenY = 0;
+  float maxwidth = 0;
+  for (uint32 p = 0; p < mpParagraphs.size(); p++)
+    maxwidth = MAX(maxwidth, mpParagraphs[p]->mWidth);
 
   // Now place the glyphs correctly
   for (uint32 p = 0; p < mpParagraphs.size(); p++)
@@ -260,8 +334,205 @@ bool nuiTextLayout::Layout(const nglString& rString)
   mYMin = rect.Top();
   mYMax = rect.Bottom();
 
-  mCharsets.clear();
-  return true;
+  mReuseParagraphs = true;
+}
+
+nuiTextLayout::Paragraph* nuiTextLayout::ReuseParagraph(int32 Start, int32 Length, uint32 Hash, const std::vector<nglUChar>& rOldUnicode, std::multimap<uint32, Paragraph*>& rOldParagraphs)
+{
+  std::multimap<uint32, Paragraph*>::iterator it = rOldParagraphs.lower_bound(Hash);
+  for (; it != rOldParagraphs.end() && it->first == Hash; ++it)
+  {
+    Paragraph* pParagraph = it->second;
+    if (pParagraph->mLength != Length || (Length && memcmp(&rOldUnicode[pParagraph->mStart], &mUnicode[Start], Length * sizeof(nglUChar))))
+      continue;
+
+    // The runs point in mUnicode:
+    const int32 offset = Start - pParagraph->mStart;
+    for (uint32 l = 0; l < pParagraph->size(); l++)
+    {
+      nuiTextLine* pLine = (*pParagraph)[l];
+      for (int32 r = 0; r < pLine->GetRunCount(); r++)
+        pLine->GetRun(r)->mPosition += offset;
+    }
+
+    pParagraph->mStart = Start;
+    rOldParagraphs.erase(it);
+    mReusedParagraphs++;
+    return pParagraph;
+  }
+
+  return NULL;
+}
+
+void nuiTextLayout::SetParagraphFonts(Paragraph* pParagraph)
+{
+  // The fonts are reference counted, they must be given to the runs on the calling thread:
+  pParagraph->mFonts.clear();
+  for (uint32 l = 0; l < pParagraph->size(); l++)
+  {
+    nuiTextLine* pLine = (*pParagraph)[l];
+    for (int32 r = 0; r < pLine->GetRunCount(); r++)
+    {
+      nuiTextRun* pRun = pLine->GetRun(r);
+      if (pRun->IsDummy())
+        continue;
+
+      const std::pair<nuiFontBase*, nuiUnicodeScript> key(pRun->GetFont(), pRun->GetScript());
+      FontSet::const_iterator it = mFontSet.find(key);
+      nuiFontBase* pFont = (it != mFontSet.end() && it->second) ? it->second : mStyle.GetFont();
+      pParagraph->mFonts[key] = pFont;
+
+      pRun->SetFont(pFont);
+      if (mWrapX > 0 && mFontHeights.find(pFont) == mFontHeights.end())
+      {
+        nuiFontInfo finfo;
+        pFont->GetInfo(finfo);
+        mFontHeights[pFont] = finfo.Height;
+      }
+    }
+  }
+}
+
+void nuiTextLayout::ShapeParagraphs(LayoutParagraphs& rParagraphs, nuiTaskPool* pPool)
+{
+  const uint32 count = rParagraphs.size();
+  int32 chars = 0;
+  for (uint32 p = 0; p < count; p++)
+    chars += rParagraphs[p].second->mLength;
+
+  if (!pPool || count < 2 || chars < NUI_TEXTLAYOUT_PARALLEL_MIN_CHARS)
+  {
+    ShapeParagraphRange(&rParagraphs, 0, count);
+    return;
+  }
+
+  // Cut the paragraphs in ranges of about the same size, a few per worker so that the pool can balance them, and shape the last one here:
+  const int32 chunk = chars / (pPool->GetThreadCount() * 4) + 1;
+  nuiTaskGroup group;
+  uint32 first = 0;
+  int32 size = 0;
+  for (uint32 p = 0; p + 1 < count; p++)
+  {
+    size += rParagraphs[p].second->mLength + 1;
+    if (size >= chunk)
+    {
+      pPool->Post(nuiMakeTask(&nuiTextLayout::ShapeParagraphRange, &rParagraphs, first, p + 1), nuiTaskPool::eNormal, &group);
+      first = p + 1;
+      size = 0;
+    }
+  }
+
+  ShapeParagraphRange(&rParagraphs, first, count);
+  pPool->Wait(group);
+}
+
+void nuiTextLayout::RasterizeGlyphs(const LayoutParagraphs& rParagraphs, nuiTaskPool& rPool)
+{
+  // Render the glyphs that the fonts don't have yet in one go before the lines are placed (which renders the missing ones one by one):
+  std::map<nuiFontBase*, std::vector<bool> > used;
+  for (uint32 p = 0; p < rParagraphs.size(); p++)
+  {
+    Paragraph* pParagraph = rParagraphs[p].second;
+    for (uint32 l = 0; l < pParagraph->size(); l++)
+    {
+      nuiTextLine* pLine = (*pParagraph)[l];
+      for (int32 r = 0; r < pLine->GetRunCount(); r++)
+      {
+        nuiTextRun* pRun = pLine->GetRun(r);
+        if (pRun->IsDummy())
+          continue;
+
+        nuiFontBase* pFont = pRun->GetFont();
+        std::vector<bool>& rUsed(used[pFont]);
+        if (rUsed.empty())
+          rUsed.resize(pFont->GetGlyphCount() + 1, false);
+
+        const std::vector<nuiTextGlyph>& rGlyphs(pRun->GetGlyphs());
+        for (uint32 g = 0; g < rGlyphs.size(); g++)
+        {
+          const int32 index = rGlyphs[g].Index;
+          if (index >= 0 && index < (int32)rUsed.size())
+            rUsed[index] = true;
+        }
+      }
+    }
+  }
+
+  for (std::map<nuiFontBase*, std::vector<bool> >::const_iterator it = used.begin(); it != used.end(); ++it)
+  {
+    const std::vector<bool>& rUsed(it->second);
+    std::vector<int> indices;
+    for (uint32 i = 0; i < rUsed.size(); i++)
+    {
+      if (rUsed[i])
+        indices.push_back(i);
+    }
+    it->first->RasterizeGlyphs(indices, rPool);
+  }
+}
+
+void nuiTextLayout::ShapeParagraphRange(LayoutParagraphs* pParagraphs, uint32 First, uint32 Last)
+{
+  for (uint32 p = First; p < Last; p++)
+    (*pParagraphs)[p].first->ShapeParagraph((*pParagraphs)[p].second);
+}
+
+void nuiTextLayout::ShapeParagraph(Paragraph* pParagraph)
+{
+  // This can run on any thread: it must not change any reference count nor touch the members of the layout except mUnicode.
+  float maxwidth = 0;
+  for (uint32 l = 0; l < pParagraph->size(); l++)
+  {
+    nuiTextLine* pLine = (*pParagraph)[l];
+
+    float PenX = 0;
+    float x = 0;
+    float y = 0;
+    for (int32 r = 0; r < pLine->GetRunCount(); r++)
+    {
+      nuiTextRun* pRun = pLine->GetRun(r);
+      pRun->mX = x;
+      pRun->mY = y;
+      if (!pRun->IsDummy())
+      {
+        // Only shape real runs.
+        nuiFontBase* pFont = pRun->GetFont();
+        pFont->Shape(pRun);
+
+        std::vector<nuiTextGlyph>& rGlyphs(pRun->GetGlyphs());
+
+        if (mWrapX > 0)
+        {
+          // compute the bounding box:
+          float runw = 0;
+          for (uint32 g = 0; g < rGlyphs.size(); g++)
+          {
+            const nuiTextGlyph& rGlyph(rGlyphs.at(g));
+            runw += rGlyph.AdvanceX;
+          }
+
+          if (PenX + x + runw >= mWrapX)
+          {
+            PenX = 0;
+            x = 0;
+            y += mFontHeights.find(pFont)->second;
+            pRun->SetWrapStart(true);
+          }
+        }
+
+      }
+
+      x += pRun->GetAdvanceX();
+      maxwidth = MAX(maxwidth, PenX + x);
+
+      //y += pRun->GetAdvanceY();
+
+
+      //printf("\trange <%d.%d> (%d - %d) (%s --> %s / %s) (advance: %f / %f)\n", l, r, pRun->GetPosition(), pRun->GetLength(), nuiGetUnicodeScriptName(pRun->GetScript()).GetChars(), pFont->GetFamilyName().GetChars(), pFont->GetStyleName().GetChars(), pRun->GetAdvanceX(), pRun->GetAdvanceY());
+    }
+  }
+
+  pParagraph->mWidth = maxwidth;
 }
 
 bool Split(nglUChar previousch, nglUChar ch, int32 index)
@@ -271,7 +542,7 @@ bool Split(nglUChar previousch, nglUChar ch, int32 index)
   return false;
 }
 
-void nuiTextLayout::SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const nuiTextStyle& style, int32& pos, int32 len)
+void nuiTextLayout::SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const nuiTextStyle& style, Charsets& rCharsets, int32& pos, int32 len)
 {
   int32 oldpos = pos;
   if (len != 0)
@@ -289,7 +560,7 @@ void nuiTextLayout::SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const
         //printf("\trange %d (%d - %d) (%s - %s)\n", i, localpos, rlen, nuiGetUnicodeScriptName(range.mScript).GetChars(), nuiGetUnicodeRangeName(range.mRange).GetChars());
 
         // Walk the range for this charset and create runs as well as populate the font/charset structures:
-        std::set<nglUChar>& charset(mCharsets[pFont][range.mScript]);
+        std::set<nglUChar>& charset(rCharsets[pFont][range.mScript]);
         {
           int32 runstart = localpos;
           bool lastisspace = false;
@@ -359,23 +630,14 @@ void nuiTextLayout::SplitFontRange(nuiTextLine* pLine, nuiFontBase* pFont, const
   NGL_ASSERT(pos == oldpos + len);
 }
 
-bool nuiTextLayout::LayoutParagraph(int32 start, int32 length)
+bool nuiTextLayout::LayoutParagraph(Paragraph* pParagraph)
 {
+  const int32 start = pParagraph->mStart;
+  const int32 length = pParagraph->mLength;
   //printf("new paragraph: %d + %d\n", start, length);
 
-  {
-    nuiFontBase* pFont = mStyle.GetFont();
-    nuiGlyphInfo glyphinfo;
-    uint32 space = pFont->GetGlyphIndex(32);
-    pFont->GetGlyphInfo(glyphinfo, space, nuiFontBase::eGlyphNative);
-    mSpaceWidth = glyphinfo.AdvanceX;
-    mTabWidth = 4 * mSpaceWidth;
-  }
-  
-  mpParagraphs.push_back(new Paragraph());
-
   nuiTextLine* pLine = new nuiTextLine(*this, 0, 0);
-  mpParagraphs.back()->push_back(pLine);
+  pParagraph->push_back(pLine);
 
   // Split the paragraph into font chunks:
   nuiFontBase* pFont = mStyle.GetFont();
@@ -386,7 +648,7 @@ bool nuiTextLayout::LayoutParagraph(int32 start, int32 length)
     const nuiTextStyle& newstyle(it->second);
     nuiFontBase* pNewFont = newstyle.GetFont();
     int32 len = mOffsetInUnicode[it->first] - pos;
-    SplitFontRange(pLine, pFont, style, pos, len);
+    SplitFontRange(pLine, pFont, style, pParagraph->mCharsets, pos, len);
     style = newstyle;
     if (pNewFont != nullptr)
       pFont = pNewFont;
@@ -395,7 +657,7 @@ bool nuiTextLayout::LayoutParagraph(int32 start, int32 length)
   int32 len = start + length - pos;
   if (len > 0)
   {
-    SplitFontRange(pLine, pFont, style, pos, len);
+    SplitFontRange(pLine, pFont, style, pParagraph->mCharsets, pos, len);
   }
   return true;
 }
@@ -547,6 +809,8 @@ nuiRect nuiTextLayout::GetRect() const
 
 void nuiTextLayout::SetWrapX(nuiSize WrapX)
 {
+  if (mWrapX != WrapX)
+    InvalidateParagraphs();
   mWrapX = WrapX;
 }
 
@@ -579,6 +843,7 @@ bool nuiTextLayout::PrintGlyphs(nuiDrawContext *pContext, float X, float Y, cons
     int i;
     
     nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLES);
+    pArray->SetFormat(nuiRenderArray::eFormat2DTexColor);
     pArray->EnableArray(nuiRenderArray::eVertex);
     pArray->EnableArray(nuiRenderArray::eTexCoord);
     pArray->EnableArray(nuiRenderArray::eColor);
@@ -683,6 +948,24 @@ void nuiTextLayout::Print(nuiDrawContext* pContext, float X, float Y, bool Align
   float x = X;
   float y = Y;
   
+  // Drop the unused font textures before any glyph is collected, the runs that had glyphs in them are updated below:
+  std::set<nuiFontBase*> fonts;
+  for (int32 p = 0; p < GetParagraphCount(); p++)
+  {
+    for (int32 l = 0; l < GetLineCount(p); l++)
+    {
+      nuiTextLine* pLine = GetLine(p, l);
+      for (int32 r = 0; r < pLine->GetRunCount(); r++)
+      {
+        nuiFontBase* pFont = pLine->GetRun(r)->GetFont();
+        if (pFont)
+          fonts.insert(pFont);
+      }
+    }
+  }
+  for (std::set<nuiFontBase*>::iterator it = fonts.begin(); it != fonts.end(); ++it)
+    (*it)->TrimTextures();
+  
   // Iterate runs:
   for (int32 p = 0; p < GetParagraphCount(); p++)
   {
@@ -695,6 +978,8 @@ void nuiTextLayout::Print(nuiDrawContext* pContext, float X, float Y, bool Align
         nuiTextRun* pRun = pLine->GetRun(r);
         std::vector<nuiTextGlyph>& rGlyphs(pRun->GetGlyphs());
         nuiFontBase* pFont = pRun->GetFont();
+        if (pFont)
+          pFont->UpdateGlyphTextures(pRun);
         
         for (int32 g = 0; g < rGlyphs.size(); g++)
         {
@@ -760,6 +1045,7 @@ void nuiTextLayout::GetLines(std::vector<uint>& rLines) const
 
 void nuiTextLayout::SetUnderline(bool set)
 {
+  InvalidateParagraphs();
   mStyle.SetUnderline(set);
 }
 
@@ -770,6 +1056,7 @@ bool nuiTextLayout::GetUnderline() const
 
 void nuiTextLayout::SetStrikeThrough(bool set)
 {
+  InvalidateParagraphs();
   mStyle.SetStrikeThrough(set);
 }
 
@@ -780,6 +1067,7 @@ bool nuiTextLayout::GetStrikeThrough() const
 
 void nuiTextLayout::SetTextLayoutMode(nuiTextLayoutMode set)
 {
+  InvalidateParagraphs();
   mStyle.SetMode(set);
 }
 
@@ -790,6 +1078,7 @@ nuiTextLayoutMode nuiTextLayout::GetTextLayoutMode() const
 
 void nuiTextLayout::AddStyleChange(int32 StringPosition, const nuiTextStyle& rNewStyle)
 {
+  InvalidateParagraphs();
   mStyleChanges[StringPosition] = rNewStyle;
 }
 
@@ -800,6 +1089,7 @@ void nuiTextLayout::DelStyleChanges(int32 StringPosition)
     return;
 
   mStyleChanges.erase(it);
+  InvalidateParagraphs();
 }
 
 const std::map<int32, nuiTextStyle>& nuiTextLayout::GetStyleChanges() const
@@ -810,6 +1100,27 @@ const std::map<int32, nuiTextStyle>& nuiTextLayout::GetStyleChanges() const
 void nuiTextLayout::ClearStyleChanges()
 {
   mStyleChanges.clear();
+  InvalidateParagraphs();
+}
+
+void nuiTextLayout::InvalidateParagraphs()
+{
+  mReuseParagraphs = false;
+}
+
+void nuiTextLayout::SetTaskPool(nuiTaskPool* pPool)
+{
+  mpTaskPool = pPool;
+}
+
+nuiTaskPool* nuiTextLayout::GetTaskPool() const
+{
+  return mpTaskPool;
+}
+
+int32 nuiTextLayout::GetReusedParagraphCount() const
+{
+  return mReusedParagraphs;
 }
 
 
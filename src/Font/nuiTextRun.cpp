@@ -17,12 +17,15 @@ nuiTextRun::nuiTextRun(const nuiTextLayout& rLayout, nuiUnicodeScript script, in
   mY(0),
   mAdvanceX(0),
   mAdvanceY(0),
+  mTextureGeneration(0),
   mUnderline(false),
   mStrikeThrough(false),
   mDummy(false),
   mWrapStart(false),
   mStyle(rStyle)
 {
+  if (mStyle.GetFont())
+    mTextureGeneration = mStyle.GetFont()->GetTextureGeneration();
 }
 
 nuiTextRun::nuiTextRun(const nuiTextLayout& rLayout, int32 Position, int32 Length, float AdvanceX, float AdvanceY, const nuiTextStyle& rStyle)
@@ -34,12 +37,15 @@ nuiTextRun::nuiTextRun(const nuiTextLayout& rLayout, int32 Position, int32 Lengt
   mY(0),
   mAdvanceX(AdvanceX),
   mAdvanceY(AdvanceY),
+  mTextureGeneration(0),
   mUnderline(false),
   mStrikeThrough(false),
   mDummy(true), 
   mWrapStart(false),
   mStyle(rStyle)
 {
+  if (mStyle.GetFont())
+    mTextureGeneration = mStyle.GetFont()->GetTextureGeneration();
 }
 
 nuiTextRun::~nuiTextRun()
@@ -58,6 +64,7 @@ void nuiTextRun::SetFont(nuiFontBase* pFont)
   nuiFontInfo info;
   pFont->GetInfo(info);
   mAdvanceY = info.AdvanceMaxH;
+  mTextureGeneration = pFont->GetTextureGeneration();
 }
 
 nuiUnicodeScript nuiTextRun::GetScript() const
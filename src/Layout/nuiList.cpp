@@ -32,6 +32,8 @@ nuiList::nuiList(nuiOrientation Orientation)
   mDisplayCursor = false;
   mMoveOnly = false;
   mSelectionStart = 0;
+  mItemIndexValid = false;
+  mItemIndexSorted = false;
 
   SetWantKeyboardFocus(true);
 
@@ -58,10 +60,12 @@ bool nuiList::Draw(nuiDrawContext* pContext)
 {
   nuiTheme *pTheme = GetTheme();
 
-  IteratorPtr pIt;
-  for (pIt = GetFirstChild(); pIt && pIt->IsValid(); GetNextChild(pIt))
+  uint32 first = 0;
+  uint32 last = 0;
+  GetVisibleItems(pContext, first, last);
+  for (uint32 i = first; i < last; i++)
   {
-    nuiWidgetPtr pItem = pIt->GetWidget();
+    nuiWidgetPtr pItem = mpChildren[i];
     if (pItem)
     {
       nuiRect irect = pItem->GetIdealRect();
@@ -81,12 +85,80 @@ bool nuiList::Draw(nuiDrawContext* pContext)
         pTheme->DrawSelectionForeground(pContext, irect, pItem);
     }
   }
-  delete pIt;
 
   pTheme->Release();
   return true;
 }
 
+void nuiList::GetVisibleItems(nuiDrawContext* pContext, uint32& rFirst, uint32& rLast)
+{
+  rFirst = 0;
+  rLast = mpChildren.size();
+
+  // Same conditions as nuiWidget::CanCull: a render cache being recorded must see all the items.
+  if (!GetGlobalUseCulling() || rLast < 2 || IsDrawingInCache(true))
+    return;
+
+  // The clip rect can only be brought back to the list's coordinates without rotation, mirroring nor projection:
+  const nuiMatrix m(pContext->GetMatrix());
+  if (m.Elt.M12 != 0 || m.Elt.M21 != 0 || m.Elt.M11 <= 0 || m.Elt.M22 <= 0 || m.Elt.M41 != 0 || m.Elt.M42 != 0 || m.Elt.M43 != 0 || m.Elt.M44 != 1)
+    return;
+
+  UpdateItemIndex();
+  if (!mItemIndexSorted)
+    return;
+
+  nuiRect clip;
+  pContext->GetClipRect(clip, true);
+  const float begin = (mOrientation == nuiVertical) ? clip.Top() : clip.Left();
+  const float end = (mOrientation == nuiVertical) ? clip.Bottom() : clip.Right();
+
+  // Skip the items that end before the clip rect and the ones that start after it. The size of the last item can change without
+  // moving it and thus without clearing the index, DrawChild still checks it:
+  rFirst = std::upper_bound(mItemEnds.begin(), mItemEnds.end(), begin) - mItemEnds.begin();
+  rFirst = MIN(rFirst, rLast - 1);
+  rLast = std::lower_bound(mItemStarts.begin(), mItemStarts.end(), end) - mItemStarts.begin();
+  rLast = MAX(rLast, rFirst);
+  mCulledCount += mpChildren.size() - (rLast - rFirst);
+}
+
+void nuiList::UpdateItemIndex()
+{
+  // Also rebuild it if the children changed without an event (see Clear):
+  if (mItemIndexValid && mItemStarts.size() == mpChildren.size())
+    return;
+  mItemIndexValid = true;
+  mItemIndexSorted = true;
+
+  const uint32 count = mpChildren.size();
+  mItemStarts.resize(count);
+  mItemEnds.resize(count);
+  float start = -FLT_MAX;
+  float end = -FLT_MAX;
+  for (uint32 i = 0; i < count; i++)
+  {
+    nuiWidget* pItem = mpChildren[i];
+    const nuiRect r(pItem->GetOverDrawRect(false, true));
+    const float s = (mOrientation == nuiVertical) ? r.Top() : r.Left();
+    const float e = (mOrientation == nuiVertical) ? r.Bottom() : r.Right();
+
+    // A transformed item isn't where its rect says, and the items are not in order while they are being moved around:
+    if (!pItem->IsMatrixIdentity() || s < start)
+      mItemIndexSorted = false;
+
+    start = s;
+    end = MAX(end, e);
+    mItemStarts[i] = s;
+    mItemEnds[i] = end;
+  }
+}
+
+void nuiList::ChildMoved(nuiWidgetPtr pChild)
+{
+  mItemIndexValid = false;
+  nuiSimpleContainer::ChildMoved(pChild);
+}
+
 nuiRect nuiList::CalcIdealSize()
 {
   nuiSize Height=0,Width=0;
@@ -138,6 +210,7 @@ nuiRect nuiList::CalcIdealSize()
 bool nuiList::SetRect(const nuiRect& rRect)
 {
   nuiWidget::SetRect(rRect);
+  mItemIndexValid = false;
   nuiSize Height = (nuiSize)rRect.GetHeight();
   nuiSize Width = (nuiSize)rRect.GetWidth();
   nuiSize pageincr = 0;
@@ -742,6 +815,7 @@ bool nuiList::MouseMoved  (nuiSize X, nuiSize Y)
       
 void nuiList::MoveChild(nuiWidget* pSelectedChild, nuiWidget* pDestinationChild)
 {
+  mItemIndexValid = false;
   nuiWidgetList::iterator it;
   for (it = mpChildren.begin(); it != mpChildren.end(); ++it)
   {
@@ -985,6 +1059,7 @@ bool nuiList::GetFixedAspectRatio()
 void nuiList::OnChildAdded(const nuiEvent& rEvent)
 {
   const nuiTreeEvent<nuiWidget>& rTreeEvent((const nuiTreeEvent<nuiWidget>&)rEvent);
+  mItemIndexValid = false;
   if (mMoveAnimDuration)
   {
     rTreeEvent.mpChild->SetLayoutAnimationDuration(mMoveAnimDuration);
@@ -1004,6 +1079,7 @@ void nuiList::OnChildAdded(const nuiEvent& rEvent)
 void nuiList::OnChildDeleted(const nuiEvent& rEvent)
 {
   const nuiTreeEvent<nuiWidget>& rTreeEvent((const nuiTreeEvent<nuiWidget>&)rEvent);
+  mItemIndexValid = false;
 }
 
 void nuiList::SetMoveAnimationDuration(float duration)
@@ -1038,6 +1114,7 @@ private:
 void nuiList::Sort(const nuiFastDelegate2<nuiWidget*, nuiWidget*, bool>& rSortDelegate)
 {
   std::sort(mpChildren.begin(), mpChildren.end(), SortFunctor(rSortDelegate));
+  mItemIndexValid = false;
   UpdateLayout();
 }
 
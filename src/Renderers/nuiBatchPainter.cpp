@@ -0,0 +1,407 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiBatchPainter.h"
+
+// The GL painters shift lines, points and shapes by half a pixel in local coordinates. It only gives the same result
+// in screen coordinates if the matrix doesn't scale or rotate:
+static bool IsTranslation(const nuiMatrix& rM)
+{
+  return rM.Elt.M11 == 1.0f && rM.Elt.M22 == 1.0f && rM.Elt.M33 == 1.0f && rM.Elt.M44 == 1.0f
+      && rM.Elt.M12 == 0.0f && rM.Elt.M13 == 0.0f
+      && rM.Elt.M21 == 0.0f && rM.Elt.M23 == 0.0f
+      && rM.Elt.M31 == 0.0f && rM.Elt.M32 == 0.0f && rM.Elt.M34 == 0.0f
+      && rM.Elt.M41 == 0.0f && rM.Elt.M42 == 0.0f && rM.Elt.M43 == 0.0f;
+}
+
+nuiBatchPainter::nuiBatchPainter(nuiPainter* pTarget, nglContext* pContext)
+: nuiPainter(pContext)
+{
+  NGL_ASSERT(pTarget);
+  mpTarget = pTarget;
+  mpTarget->GetSize(mWidth, mHeight);
+  mBatching = true;
+  mMaxBatchSize = 4096;
+
+  mpFirstArray = NULL;
+  mpBatch = NULL;
+  mBatchMode = GL_TRIANGLES;
+  mBatchColors = false;
+  mBatchTexCoords = false;
+  mBatchShape = false;
+  mBatchFormat = nuiRenderArray::eFormatFull;
+  mBatchSize = 0;
+}
+
+nuiBatchPainter::~nuiBatchPainter()
+{
+  // Too late to draw the pending batch:
+  if (mpFirstArray)
+    mpFirstArray->Release();
+  if (mpBatch)
+    mpBatch->Release();
+  delete mpTarget;
+}
+
+nuiPainter* nuiBatchPainter::GetTarget() const
+{
+  return mpTarget;
+}
+
+void nuiBatchPainter::SetBatching(bool Set)
+{
+  if (!Set)
+    Flush();
+  mBatching = Set;
+}
+
+bool nuiBatchPainter::GetBatching() const
+{
+  return mBatching;
+}
+
+void nuiBatchPainter::SetMaxBatchSize(uint32 Vertices)
+{
+  Flush();
+  mMaxBatchSize = Vertices;
+}
+
+uint32 nuiBatchPainter::GetMaxBatchSize() const
+{
+  return mMaxBatchSize;
+}
+
+void nuiBatchPainter::SetSize(uint32 sizex, uint32 sizey)
+{
+  Flush();
+  mWidth = sizex;
+  mHeight = sizey;
+  mpTarget->SetSize(sizex, sizey);
+}
+
+void nuiBatchPainter::StartRendering()
+{
+  Flush();
+  nuiPainter::StartRendering();
+  mpTarget->SetAngle(mAngle);
+  mpTarget->StartRendering();
+}
+
+void nuiBatchPainter::BeginSession()
+{
+  mpTarget->BeginSession();
+}
+
+void nuiBatchPainter::EndSession()
+{
+  Flush();
+  mpTarget->EndSession();
+}
+
+void nuiBatchPainter::SetState(const nuiRenderState& rState, bool ForceApply)
+{
+  // The state is compared with the one of the pending batch when the next array comes:
+  mpState = &rState;
+}
+
+bool nuiBatchPainter::CanBatch(const nuiRenderArray* pArray, GLenum& rMode) const
+{
+  if (!mBatching || !pArray->GetSize() || pArray->GetSize() > mMaxBatchSize)
+    return false;
+  // Don't look at IsStatic(): nuiRenderArray currently makes all its arrays static.
+  if (pArray->Is3DMesh() || pArray->GetDebug() || pArray->GetIndexArrayCount() || pArray->GetStreamCount())
+    return false;
+  // The uniforms of a shader state can change between two draws:
+  if (mpState->mpShaderState)
+    return false;
+
+  switch (pArray->GetMode())
+  {
+    case GL_TRIANGLES:
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+#ifndef _OPENGL_ES_
+    case GL_QUADS:
+#endif
+      rMode = GL_TRIANGLES;
+      break;
+    case GL_LINES:
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+      rMode = GL_LINES;
+      break;
+    case GL_POINTS:
+      rMode = GL_POINTS;
+      break;
+    default:
+      return false;
+  }
+
+  const nuiMatrix& rMatrix(mMatrixStack.top());
+  if ((rMode != GL_TRIANGLES || pArray->IsShape()) && !IsTranslation(rMatrix))
+    return false;
+  // The batch doesn't keep W:
+  if (rMatrix.Elt.M41 != 0.0f || rMatrix.Elt.M42 != 0.0f || rMatrix.Elt.M43 != 0.0f || rMatrix.Elt.M44 != 1.0f)
+    return false;
+
+  return true;
+}
+
+bool nuiBatchPainter::IsCompatible(const nuiRenderArray* pArray, GLenum Mode) const
+{
+  return mpFirstArray
+      && Mode == mBatchMode
+      && pArray->IsArrayEnabled(nuiRenderArray::eColor) == mBatchColors
+      && pArray->IsArrayEnabled(nuiRenderArray::eTexCoord) == mBatchTexCoords
+      && pArray->IsShape() == mBatchShape
+      && pArray->GetFormat() == mBatchFormat
+      && mBatchSize + pArray->GetSize() <= mMaxBatchSize
+      && mClip.mEnabled == mBatchClip.mEnabled
+      && (!mClip.mEnabled || mClip == mBatchClip)
+      && *mpState == mBatchState;
+}
+
+void nuiBatchPainter::DrawArray(nuiRenderArray* pArray)
+{
+  mRenderOperations++;
+  mVertices += pArray->GetSize();
+
+  GLenum mode = GL_TRIANGLES;
+  if (!CanBatch(pArray, mode))
+  {
+    Flush();
+    Forward(pArray, *mpState, mMatrixStack.top(), mClip);
+    return;
+  }
+
+  if (IsCompatible(pArray, mode))
+  {
+    if (!mpBatch)
+    {
+      mpBatch = new nuiRenderArray(mBatchMode);
+      mpBatch->EnableArray(nuiRenderArray::eColor, mBatchColors);
+      mpBatch->EnableArray(nuiRenderArray::eTexCoord, mBatchTexCoords);
+      mpBatch->SetShape(mBatchShape);
+      mpBatch->SetFormat(mBatchFormat);
+      mpBatch->Reserve(mMaxBatchSize);
+      AddToBatch(mpFirstArray, mFirstMatrix);
+    }
+    AddToBatch(pArray, mMatrixStack.top());
+    mBatchSize += pArray->GetSize();
+    pArray->Release();
+    return;
+  }
+
+  // Start a new batch with this array:
+  Flush();
+  mpFirstArray = pArray;
+  mFirstMatrix = mMatrixStack.top();
+  mBatchState = *mpState;
+  mBatchClip = mClip;
+  mBatchMode = mode;
+  mBatchColors = pArray->IsArrayEnabled(nuiRenderArray::eColor);
+  mBatchTexCoords = pArray->IsArrayEnabled(nuiRenderArray::eTexCoord);
+  mBatchShape = pArray->IsShape();
+  mBatchFormat = pArray->GetFormat();
+  mBatchSize = pArray->GetSize();
+}
+
+void nuiBatchPainter::AddToBatch(const nuiRenderArray* pArray, const nuiMatrix& rMatrix)
+{
+  // The scratch buffer keeps its capacity from one array to the next so merging doesn't allocate once the biggest array has been seen:
+  std::vector<nuiRenderArray::Vertex>& vertices(mScratchVertices);
+  vertices.resize(pArray->GetSize());
+  for (uint32 i = 0; i < vertices.size(); i++)
+  {
+    nuiRenderArray::Vertex& rVertex(vertices[i]);
+    pArray->GetVertex(i, rVertex);
+    nuiVector vec(rVertex.mX, rVertex.mY, rVertex.mZ);
+    vec = rMatrix * vec;
+    rVertex.mX = vec[0];
+    rVertex.mY = vec[1];
+    rVertex.mZ = vec[2];
+  }
+
+  const int32 count = vertices.size();
+  switch (pArray->GetMode())
+  {
+    case GL_TRIANGLES:
+      for (int32 i = 0; i < count - count % 3; i++)
+        mpBatch->PushVertex(vertices[i]);
+      break;
+    case GL_TRIANGLE_STRIP:
+      // Every other triangle of a strip is flipped to keep the orientation of the first one:
+      for (int32 i = 0; i + 2 < count; i++)
+      {
+        mpBatch->PushVertex(vertices[(i & 1) ? i + 1 : i]);
+        mpBatch->PushVertex(vertices[(i & 1) ? i : i + 1]);
+        mpBatch->PushVertex(vertices[i + 2]);
+      }
+      break;
+    case GL_TRIANGLE_FAN:
+      for (int32 i = 1; i + 1 < count; i++)
+      {
+        mpBatch->PushVertex(vertices[0]);
+        mpBatch->PushVertex(vertices[i]);
+        mpBatch->PushVertex(vertices[i + 1]);
+      }
+      break;
+#ifndef _OPENGL_ES_
+    case GL_QUADS:
+      for (int32 i = 0; i + 3 < count; i += 4)
+      {
+        mpBatch->PushVertex(vertices[i]);
+        mpBatch->PushVertex(vertices[i + 1]);
+        mpBatch->PushVertex(vertices[i + 2]);
+        mpBatch->PushVertex(vertices[i]);
+        mpBatch->PushVertex(vertices[i + 2]);
+        mpBatch->PushVertex(vertices[i + 3]);
+      }
+      break;
+#endif
+    case GL_LINES:
+      for (int32 i = 0; i < (count & ~1); i++)
+        mpBatch->PushVertex(vertices[i]);
+      break;
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+      for (int32 i = 0; i + 1 < count; i++)
+      {
+        mpBatch->PushVertex(vertices[i]);
+        mpBatch->PushVertex(vertices[i + 1]);
+      }
+      if (pArray->GetMode() == GL_LINE_LOOP && count > 2)
+      {
+        mpBatch->PushVertex(vertices[count - 1]);
+        mpBatch->PushVertex(vertices[0]);
+      }
+      break;
+    case GL_POINTS:
+      for (int32 i = 0; i < count; i++)
+        mpBatch->PushVertex(vertices[i]);
+      break;
+  }
+}
+
+void nuiBatchPainter::Flush()
+{
+  if (!mpFirstArray)
+    return;
+
+  if (mpBatch)
+  {
+    // The vertices are already transformed:
+    mpFirstArray->Release();
+    Forward(mpBatch, mBatchState, nuiMatrix(), mBatchClip);
+  }
+  else
+  {
+    Forward(mpFirstArray, mBatchState, mFirstMatrix, mBatchClip);
+  }
+
+  mpFirstArray = NULL;
+  mpBatch = NULL;
+  mBatchSize = 0;
+}
+
+void nuiBatchPainter::SyncTarget(const nuiRenderState& rState, const nuiMatrix& rMatrix, const nuiClipper& rClip)
+{
+  // Our clip rect is already in screen coordinates, apply it with the identity matrix:
+  mpTarget->LoadMatrix(nuiMatrix());
+  mpTarget->ResetClipRect();
+  mpTarget->Clip(rClip);
+  mpTarget->EnableClipping(rClip.mEnabled);
+  mpTarget->LoadMatrix(rMatrix);
+  mpTarget->SetState(rState);
+}
+
+void nuiBatchPainter::Forward(nuiRenderArray* pArray, const nuiRenderState& rState, const nuiMatrix& rMatrix, const nuiClipper& rClip)
+{
+  mBatches++;
+  SyncTarget(rState, rMatrix, rClip);
+  mpTarget->DrawArray(pArray);
+}
+
+bool nuiBatchPainter::DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality)
+{
+  Flush();
+  SyncTarget(*mpState, mMatrixStack.top(), mClip);
+  return mpTarget->DrawShape(pShape, Mode, Quality);
+}
+
+void nuiBatchPainter::Clear(bool color, bool depth, bool stencil)
+{
+  Flush();
+  SyncTarget(*mpState, mMatrixStack.top(), mClip);
+  mpTarget->Clear(color, depth, stencil);
+}
+
+void nuiBatchPainter::LoadProjectionMatrix(const nuiRect& rViewport, const nuiMatrix& rMatrix)
+{
+  Flush();
+  nuiPainter::LoadProjectionMatrix(rViewport, rMatrix);
+  // The viewport is transformed by the current matrix:
+  mpTarget->LoadMatrix(mMatrixStack.top());
+  mpTarget->LoadProjectionMatrix(rViewport, rMatrix);
+}
+
+void nuiBatchPainter::MultProjectionMatrix(const nuiMatrix& rMatrix)
+{
+  Flush();
+  nuiPainter::MultProjectionMatrix(rMatrix);
+  mpTarget->MultProjectionMatrix(rMatrix);
+}
+
+void nuiBatchPainter::PushProjectionMatrix()
+{
+  Flush();
+  nuiPainter::PushProjectionMatrix();
+  mpTarget->PushProjectionMatrix();
+}
+
+void nuiBatchPainter::PopProjectionMatrix()
+{
+  Flush();
+  nuiPainter::PopProjectionMatrix();
+  mpTarget->PopProjectionMatrix();
+}
+
+uint32 nuiBatchPainter::GetRectangleTextureSupport() const
+{
+  return mpTarget->GetRectangleTextureSupport();
+}
+
+void nuiBatchPainter::AddBreakPoint()
+{
+  Flush();
+  mpTarget->AddBreakPoint();
+}
+
+void nuiBatchPainter::SetSurface(nuiSurface* pSurface)
+{
+  Flush();
+  mpTarget->SetSurface(pSurface);
+  mpSurface = mpTarget->GetSurface();
+}
+
+nuiSurface* nuiBatchPainter::GetSurface() const
+{
+  return mpTarget->GetSurface();
+}
+
+void nuiBatchPainter::DestroySurface(nuiSurface* pSurface)
+{
+}
+
+void nuiBatchPainter::DestroyRenderArray(nuiRenderArray* pArray)
+{
+}
+
+void nuiBatchPainter::DestroyTexture(nuiTexture* pTexture)
+{
+}
@@ -0,0 +1,402 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiCoverageRasterizer.h"
+
+nuiCoverageRasterizer::nuiCoverageRasterizer()
+{
+  mClipX0 = mClipY0 = mClipX1 = mClipY1 = 0;
+  mMinRow = 0;
+  mMaxRow = -1;
+  mX0 = mY0 = mX1 = mY1 = 0;
+  mRows.push_back(0);
+}
+
+nuiCoverageRasterizer::~nuiCoverageRasterizer()
+{
+}
+
+void nuiCoverageRasterizer::Reset(int32 X0, int32 Y0, int32 X1, int32 Y1)
+{
+  // Only the rows used by the last shape need to be cleared, the others are already empty:
+  for (int32 row = mMinRow; row <= mMaxRow; row++)
+    mCells[row].clear();
+
+  mClipX0 = X0;
+  mClipY0 = Y0;
+  mClipX1 = MAX(X0, X1);
+  mClipY1 = MAX(Y0, Y1);
+  if (mCells.size() < (size_t)(mClipY1 - mClipY0))
+    mCells.resize(mClipY1 - mClipY0);
+  mMinRow = mClipY1 - mClipY0;
+  mMaxRow = -1;
+
+  mSpans.clear();
+  mRows.clear();
+  mRows.push_back(0);
+  mCoverage.clear();
+  mX0 = mY0 = mX1 = mY1 = 0;
+}
+
+void nuiCoverageRasterizer::AddPath(const nuiPath& rPath, const nuiMatrix& rMatrix)
+{
+  const uint32 count = rPath.GetCount();
+  bool first = true;
+  float startx = 0, starty = 0;
+  float lastx = 0, lasty = 0;
+  for (uint32 i = 0; i < count; i++)
+  {
+    const nuiPoint& rPoint(rPath[i]);
+    if (rPoint.GetType() == nuiPointTypeStop)
+    {
+      if (!first)
+        AddLine(lastx, lasty, startx, starty);
+      first = true;
+      continue;
+    }
+
+    nuiVector vec(rPoint[0], rPoint[1], 0.0f);
+    vec = rMatrix * vec;
+    if (first)
+    {
+      startx = vec[0];
+      starty = vec[1];
+      first = false;
+    }
+    else
+    {
+      AddLine(lastx, lasty, vec[0], vec[1]);
+    }
+    lastx = vec[0];
+    lasty = vec[1];
+  }
+
+  if (!first)
+    AddLine(lastx, lasty, startx, starty);
+}
+
+void nuiCoverageRasterizer::AddLine(float X0, float Y0, float X1, float Y1)
+{
+  if (Y0 == Y1 || !(Y0 == Y0) || !(Y1 == Y1) || !(X0 == X0) || !(X1 == X1))
+    return;
+
+  // Clip to the rows of the clip rect:
+  const float top = (float)mClipY0;
+  const float bottom = (float)mClipY1;
+  if ((Y0 <= top && Y1 <= top) || (Y0 >= bottom && Y1 >= bottom))
+    return;
+
+  const float dxdy = (X1 - X0) / (Y1 - Y0);
+  if (Y0 < top)
+  {
+    X0 += (top - Y0) * dxdy;
+    Y0 = top;
+  }
+  else if (Y0 > bottom)
+  {
+    X0 += (bottom - Y0) * dxdy;
+    Y0 = bottom;
+  }
+  if (Y1 < top)
+  {
+    X1 += (top - Y1) * dxdy;
+    Y1 = top;
+  }
+  else if (Y1 > bottom)
+  {
+    X1 += (bottom - Y1) * dxdy;
+    Y1 = bottom;
+  }
+
+  // Split the edge where it leaves the clip rect horizontally. The parts on the left are moved on its left side where they
+  // still change the winding of the whole row, the parts on the right can't change any visible pixel.
+  const float left = (float)mClipX0;
+  const float right = (float)mClipX1;
+  float splits[2];
+  int32 count = 0;
+  if ((X0 < left) != (X1 < left))
+    splits[count++] = (left - X0) / (X1 - X0);
+  if ((X0 < right) != (X1 < right))
+    splits[count++] = (right - X0) / (X1 - X0);
+  if (count == 2 && splits[0] > splits[1])
+  {
+    const float t = splits[0];
+    splits[0] = splits[1];
+    splits[1] = t;
+  }
+
+  float x = X0;
+  float y = Y0;
+  for (int32 i = 0; i <= count; i++)
+  {
+    float nx = X1;
+    float ny = Y1;
+    if (i < count)
+    {
+      nx = X0 + (X1 - X0) * splits[i];
+      ny = Y0 + (Y1 - Y0) * splits[i];
+    }
+
+    if (x < right || nx < right)
+      AddClippedLine(MIN(MAX(x, left), right), y, MIN(MAX(nx, left), right), ny);
+
+    x = nx;
+    y = ny;
+  }
+}
+
+void nuiCoverageRasterizer::AddClippedLine(float X0, float Y0, float X1, float Y1)
+{
+  if (Y0 == Y1)
+    return;
+
+  float direction = 1;
+  if (Y0 > Y1)
+  {
+    float t = X0; X0 = X1; X1 = t;
+    t = Y0; Y0 = Y1; Y1 = t;
+    direction = -1;
+  }
+
+  const float dxdy = (X1 - X0) / (Y1 - Y0);
+  int32 row = (int32)floorf(Y0);
+  float x = X0;
+  float y = Y0;
+  while (y < Y1)
+  {
+    const float rowbottom = (float)(row + 1);
+    float nx = X1;
+    float ny = Y1;
+    if (rowbottom < Y1)
+    {
+      ny = rowbottom;
+      nx = X0 + (ny - Y0) * dxdy;
+    }
+
+    AddRowSegment(row, x, y - (float)row, nx, ny - (float)row, direction);
+
+    x = nx;
+    y = ny;
+    row++;
+  }
+}
+
+void nuiCoverageRasterizer::AddRowSegment(int32 Row, float X0, float Y0, float X1, float Y1, float Direction)
+{
+  const int32 cell0 = (int32)floorf(X0);
+  const int32 cell1 = (int32)floorf(X1);
+
+  if (cell0 == cell1)
+  {
+    const float cover = (Y1 - Y0) * Direction;
+    AddCell(Row, cell0, cover, cover * (1.0f - ((X0 + X1) * 0.5f - (float)cell0)));
+    return;
+  }
+
+  // Walk the cells crossed by the segment, cutting it on each vertical pixel border:
+  const float dydx = (Y1 - Y0) / (X1 - X0);
+  const int32 step = cell1 > cell0 ? 1 : -1;
+  float x = X0;
+  float y = Y0;
+  for (int32 cell = cell0; ; cell += step)
+  {
+    float nx = X1;
+    float ny = Y1;
+    if (cell != cell1)
+    {
+      nx = (float)(step > 0 ? cell + 1 : cell);
+      ny = Y0 + (nx - X0) * dydx;
+    }
+
+    const float cover = (ny - y) * Direction;
+    if (cover != 0)
+      AddCell(Row, cell, cover, cover * (1.0f - ((x + nx) * 0.5f - (float)cell)));
+
+    if (cell == cell1)
+      break;
+    x = nx;
+    y = ny;
+  }
+}
+
+void nuiCoverageRasterizer::AddCell(int32 Row, int32 X, float Cover, float Area)
+{
+  if (X >= mClipX1)
+    return;
+  X = MAX(X, mClipX0);
+
+  const int32 index = Row - mClipY0;
+  if (index < 0 || index >= mClipY1 - mClipY0)
+    return;
+
+  std::vector<Cell>& rCells(mCells[index]);
+  if (!rCells.empty() && rCells.back().mX == X)
+  {
+    rCells.back().mCover += Cover;
+    rCells.back().mArea += Area;
+    return;
+  }
+
+  rCells.push_back(Cell(X, Cover, Area));
+  mMinRow = MIN(mMinRow, index);
+  mMaxRow = MAX(mMaxRow, index);
+}
+
+uint8 nuiCoverageRasterizer::GetCoverage(float Winding, nuiShape::Winding Rule) const
+{
+  float coverage = fabsf(Winding);
+  if (Rule == nuiShape::eOdd)
+  {
+    coverage = fmodf(coverage, 2.0f);
+    if (coverage > 1.0f)
+      coverage = 2.0f - coverage;
+  }
+  else if (coverage > 1.0f)
+  {
+    coverage = 1.0f;
+  }
+
+  return (uint8)(coverage * 255.0f + 0.5f);
+}
+
+void nuiCoverageRasterizer::AddPixel(int32 X, uint8 Coverage)
+{
+  if (!Coverage)
+    return;
+
+  const int32 first = mRows.back();
+  if ((int32)mSpans.size() > first)
+  {
+    Span& rLast(mSpans.back());
+    if (rLast.mOffset >= 0 && rLast.mX + rLast.mCount == X)
+    {
+      rLast.mCount++;
+      mCoverage.push_back(Coverage);
+      return;
+    }
+  }
+
+  mSpans.push_back(Span(X, 1, mCoverage.size()));
+  mCoverage.push_back(Coverage);
+}
+
+void nuiCoverageRasterizer::AddRun(int32 X0, int32 X1, uint8 Coverage)
+{
+  if (!Coverage || X0 >= X1)
+    return;
+
+  if (Coverage == 255)
+  {
+    mSpans.push_back(Span(X0, X1 - X0, -1));
+    return;
+  }
+
+  // The winding between the cells is a whole number, only rounding errors can make it partial:
+  for (int32 x = X0; x < X1; x++)
+    AddPixel(x, Coverage);
+}
+
+bool nuiCoverageRasterizer::Sweep(nuiShape::Winding Rule)
+{
+  if (Rule != nuiShape::eOdd && Rule != nuiShape::eNonZero)
+    return false;
+
+  mSpans.clear();
+  mRows.clear();
+  mCoverage.clear();
+
+  mX0 = mY0 = mX1 = mY1 = 0;
+  if (mMaxRow < mMinRow)
+  {
+    mRows.push_back(0);
+    return true;
+  }
+
+  const int32 rows = mClipY1 - mClipY0;
+  mRows.resize(mMinRow + 1, 0);
+  mX0 = mClipX1;
+  mY0 = mClipY1;
+  mX1 = mClipX0;
+  mY1 = mClipY0;
+
+  for (int32 row = mMinRow; row <= mMaxRow && row < rows; row++)
+  {
+    std::vector<Cell>& rCells(mCells[row]);
+    std::sort(rCells.begin(), rCells.end());
+
+    const int32 first = mSpans.size();
+    float winding = 0;
+    int32 x = mClipX0;
+    const uint32 count = rCells.size();
+    for (uint32 i = 0; i < count; )
+    {
+      const int32 cellx = rCells[i].mX;
+      float cover = 0;
+      float area = 0;
+      for (; i < count && rCells[i].mX == cellx; i++)
+      {
+        cover += rCells[i].mCover;
+        area += rCells[i].mArea;
+      }
+
+      AddRun(x, cellx, GetCoverage(winding, Rule));
+      AddPixel(cellx, GetCoverage(winding + area, Rule));
+      winding += cover;
+      x = cellx + 1;
+    }
+    // The shape can continue after the right side of the clip rect:
+    AddRun(x, mClipX1, GetCoverage(winding, Rule));
+
+    if ((int32)mSpans.size() > first)
+    {
+      mX0 = MIN(mX0, mSpans[first].mX);
+      mX1 = MAX(mX1, mSpans.back().mX + mSpans.back().mCount);
+      mY0 = MIN(mY0, mClipY0 + row);
+      mY1 = MAX(mY1, mClipY0 + row + 1);
+    }
+    mRows.push_back(mSpans.size());
+  }
+
+  if (mSpans.empty())
+    mX0 = mY0 = mX1 = mY1 = 0;
+  return true;
+}
+
+bool nuiCoverageRasterizer::IsEmpty() const
+{
+  return mSpans.empty();
+}
+
+void nuiCoverageRasterizer::GetBounds(int32& rX0, int32& rY0, int32& rX1, int32& rY1) const
+{
+  rX0 = mX0;
+  rY0 = mY0;
+  rX1 = mX1;
+  rY1 = mY1;
+}
+
+const nuiCoverageRasterizer::Span* nuiCoverageRasterizer::GetSpans(int32 Y, int32& rCount) const
+{
+  rCount = 0;
+  const int32 row = Y - mClipY0;
+  if (row < mMinRow || row + 1 >= (int32)mRows.size())
+    return NULL;
+
+  const int32 first = mRows[row];
+  rCount = mRows[row + 1] - first;
+  if (!rCount)
+    return NULL;
+  return &mSpans[first];
+}
+
+const uint8* nuiCoverageRasterizer::GetCoverage() const
+{
+  if (mCoverage.empty())
+    return NULL;
+  return &mCoverage[0];
+}
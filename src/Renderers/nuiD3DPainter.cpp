@@ -792,6 +792,15 @@ void nuiD3DPainter::DrawArray(nuiRenderArray* pArray)
     pArray->Release();
     return;
   }
+
+  // NuiD3DVertex is filled from full vertices:
+  if (pArray->GetFormat() != nuiRenderArray::eFormatFull)
+  {
+    nuiRenderArray* pFull = new nuiRenderArray(*pArray);
+    pFull->SetFormat(nuiRenderArray::eFormatFull);
+    pArray->Release();
+    pArray = pFull;
+  }
   
   LPDIRECT3DDEVICE9 pDev = mpContext->GetDirect3DDevice();
   mRenderOperations++;
@@ -50,8 +50,11 @@ nuiDrawContext::~nuiDrawContext()
   }
 }
 
+uint32 nuiDrawContext::mFrame = 0;
+
 void nuiDrawContext::StartRendering()
 { 
+  mFrame++;
   mpPainter->StartRendering(); 
 }
 
@@ -71,6 +74,11 @@ void nuiDrawContext::StopRendering()
   SetShader(NULL, NULL);
 }
 
+uint32 nuiDrawContext::GetFrame()
+{
+  return mFrame;
+}
+
 
 void nuiDrawContext::SetPainter(nuiPainter* pPainter)
 {
@@ -499,53 +507,61 @@ void nuiDrawContext::Clear(bool color, bool depth, bool stencil)
 void nuiDrawContext::DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality)
 {
   NGL_ASSERT(pShape != NULL);
+
+  // Some painters anti-alias the shapes themselves (see nuiSoftwarePainter):
+  if (mPermitAntialising)
+  {
+    if (mStateChanges)
+      mpPainter->SetState(mCurrentState);
+    mStateChanges = 0;
+    if (mpPainter->DrawShape(pShape, Mode, Quality))
+      return;
+  }
+
+  // The tessellations are kept by the cache, the painters only get new references on the arrays:
+  nuiTessellationCache& rCache(nuiTessellationCache::Get());
+
   PushState();
   switch (Mode)
   {
   case eStrokeShape:
     {
-      nuiRenderObject* pObject = pShape->Outline(Quality, mCurrentState.mLineWidth, mCurrentState.mLineJoin, mCurrentState.mLineCap, mCurrentState.mMitterLimit);
-      if (!pObject)
-        return;
+      nuiRenderObject object;
+      if (!rCache.Outline(pShape, Quality, mCurrentState.mLineWidth, mCurrentState.mLineJoin, mCurrentState.mLineCap, mCurrentState.mMitterLimit, object))
+        break;
       SetFillColor(GetStrokeColor());
       //SetTexture(mpAATexture);
       //EnableTexturing(true);
       EnableBlending(true);
       SetBlendFunc(nuiBlendTransp);//GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      DrawObject(*pObject);
-      delete pObject;
+      DrawSharedObject(object);
     }
     break;
   case eFillShape:
     {
-      nuiTessellator* pTess = new nuiTessellator(pShape);
-      pTess->SetFill(true);
-      nuiRenderObject* pObject = pTess->Generate(Quality);
-      if (pObject)
-        DrawObject(*pObject);
-      delete pObject;
-      delete pTess;
+      nuiRenderObject object;
+      if (rCache.Fill(pShape, Quality, object))
+        DrawSharedObject(object);
     }
     break;
   case eStrokeAndFillShape:
     {
       {
-        nuiRenderObject* pObject = pShape->Fill(Quality);
-        if (pObject)
-          DrawObject(*pObject);
-        delete pObject;
+        nuiRenderObject object;
+        if (rCache.Fill(pShape, Quality, object))
+          DrawSharedObject(object);
       }
 
       {
-        nuiRenderObject* pObject = pShape->Outline(Quality, mCurrentState.mLineWidth, mCurrentState.mLineJoin, mCurrentState.mLineCap, mCurrentState.mMitterLimit);
+        nuiRenderObject object;
+        bool res = rCache.Outline(pShape, Quality, mCurrentState.mLineWidth, mCurrentState.mLineJoin, mCurrentState.mLineCap, mCurrentState.mMitterLimit, object);
         SetFillColor(GetStrokeColor());
         //SetTexture(mpAATexture);
         //EnableTexturing(true);
         EnableBlending(true);
         SetBlendFunc(nuiBlendTransp);//GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        if (pObject)
-          DrawObject(*pObject);
-        delete pObject;
+        if (res)
+          DrawSharedObject(object);
       }
     }
     break;
@@ -649,6 +665,7 @@ void nuiDrawContext::DrawImageQuad(float x0, float y0, float x1, float y1, float
   mCurrentState.mpTexture[0]->ImageToTextureCoord(tx3, ty3);
 
   nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLE_STRIP);
+  pArray->SetFormat(nuiRenderArray::eFormat2DTexColor);
   pArray->Reserve(4);
   pArray->EnableArray(nuiRenderArray::eVertex, true);
   pArray->EnableArray(nuiRenderArray::eTexCoord, true);
@@ -851,6 +868,7 @@ void nuiDrawContext::DrawGradient(const nuiGradient& rGradient, const nuiRect& r
   EnableClipping(true);
 
   nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLE_STRIP);
+  pArray->SetFormat(nuiRenderArray::eFormat2DColor);
   pArray->EnableArray(nuiRenderArray::eVertex);
   pArray->EnableArray(nuiRenderArray::eColor);
   
@@ -954,6 +972,7 @@ void nuiDrawContext::DrawRect(const nuiRect& rRect, nuiShapeMode Mode)
     else
     {
       nuiRenderArray* pStrokeArray = new nuiRenderArray(mode);
+      pStrokeArray->SetFormat(nuiRenderArray::eFormat2DColor);
       pStrokeArray->EnableArray(nuiRenderArray::eColor, true);
       pStrokeArray->SetColor(mCurrentState.mStrokeColor);
       nuiDrawRect(rRect, *pStrokeArray, mCurrentState.mLineWidth);
@@ -972,6 +991,7 @@ void nuiDrawContext::DrawRect(const nuiRect& rRect, nuiShapeMode Mode)
     rect.Grow(-v, -v);
     // Draw the filled part:
     nuiRenderArray* pFillArray = new nuiRenderArray(GL_TRIANGLE_STRIP);
+    pFillArray->SetFormat(nuiRenderArray::eFormat2DColor);
     pFillArray->EnableArray(nuiRenderArray::eVertex, true);
     pFillArray->EnableArray(nuiRenderArray::eColor, true);
     pFillArray->Reserve(4);
@@ -996,6 +1016,7 @@ void nuiDrawContext::DrawRect(const nuiRect& rRect, nuiShapeMode Mode)
     nuiRect rect(rRect);
     // Draw the filled rectangle:
     nuiRenderArray* pFillArray = new nuiRenderArray(GL_TRIANGLE_STRIP);
+    pFillArray->SetFormat(nuiRenderArray::eFormat2DColor);
     pFillArray->EnableArray(nuiRenderArray::eVertex, true);
     pFillArray->EnableArray(nuiRenderArray::eColor, true);
     pFillArray->Reserve(4);
@@ -1118,6 +1139,17 @@ void nuiDrawContext::DrawObject(const nuiRenderObject& rObject)
   }
 }
 
+void nuiDrawContext::DrawSharedObject(const nuiRenderObject& rObject)
+{
+  uint32 count = rObject.GetSize();
+  for (uint32 i = 0; i < count; i++)
+  {
+    nuiRenderArray* pArray = rObject.GetArray(i);
+    pArray->Acquire();
+    DrawArray(pArray);
+  }
+}
+
 void nuiDrawContext::Translate(const nuiVector& Vector)
 {
   Translate(Vector[0],Vector[1]);
@@ -1338,6 +1370,7 @@ void nuiDrawContext::DrawShade(const nuiRect& rSourceRect, const nuiRect& rShade
   SetTexture(pShade);
 
   nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLES);
+  pArray->SetFormat(nuiRenderArray::eFormat2DTexColor);
   pArray->EnableArray(nuiRenderArray::eVertex);
   pArray->EnableArray(nuiRenderArray::eColor);
   pArray->EnableArray(nuiRenderArray::eTexCoord);
@@ -163,6 +163,35 @@ void main()
 }
 );
 
+//////////////////////////////////////////////////////////////////////////////////
+// Signed distance field textures (see nuiTexture::SetDistanceFieldSpread): the edge is at 0.5 and fwidth gives the size of a pixel in
+// distance units, whatever the scale the texture is drawn at.
+static const char* TextureDistanceFieldVertexColor_FGT =
+SHADER_STRING (
+uniform sampler2D texture;
+varying vec4 ColorVar;
+varying vec2 TexCoordVar;
+void main()
+{
+  float d = texture2D(texture, TexCoordVar)[3] - 0.5;
+  float v = clamp(d / max(fwidth(d), 0.0001) + 0.5, 0.0, 1.0);
+  gl_FragColor = ColorVar * v;
+}
+);
+
+static const char* TextureDistanceFieldDifuseColor_FGT =
+SHADER_STRING (
+uniform sampler2D texture;
+uniform vec4 DifuseColor;
+varying vec2 TexCoordVar;
+void main()
+{
+  float d = texture2D(texture, TexCoordVar)[3] - 0.5;
+  float v = clamp(d / max(fwidth(d), 0.0001) + 0.5, 0.0, 1.0);
+  gl_FragColor = DifuseColor * vec4(v, v, v, v);
+}
+);
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // No texture cases:
 static const char* VertexColor_VTX =
@@ -283,6 +312,39 @@ nuiGL2Painter::nuiGL2Painter(nglContext* pContext)
   }
   nuiCheckForGLErrors();
 
+  mpShader_TextureDistanceFieldVertexColor = nuiShaderProgram::GetProgram("TextureDistanceFieldVertexColor");
+  if (!mpShader_TextureDistanceFieldVertexColor)
+  {
+    mpShader_TextureDistanceFieldVertexColor = new nuiShaderProgram("TextureDistanceFieldVertexColor");
+    mpShader_TextureDistanceFieldVertexColor->Acquire();
+#ifdef _OPENGL_ES_
+    mpShader_TextureDistanceFieldVertexColor->SetPrefix("#extension GL_OES_standard_derivatives : enable\nprecision mediump float;\n");
+#endif
+    mpShader_TextureDistanceFieldVertexColor->AddShader(eVertexShader, TextureAlphaVertexColor_VTX);
+    mpShader_TextureDistanceFieldVertexColor->AddShader(eFragmentShader, TextureDistanceFieldVertexColor_FGT);
+    mpShader_TextureDistanceFieldVertexColor->Link();
+    mpShader_TextureDistanceFieldVertexColor->GetCurrentState()->Set("Offset", 0.0f, 0.0f);
+    mpShader_TextureDistanceFieldVertexColor->GetCurrentState()->Set("texture", 0);
+  }
+  nuiCheckForGLErrors();
+
+  mpShader_TextureDistanceFieldDifuseColor = nuiShaderProgram::GetProgram("TextureDistanceFieldDifuseColor");
+  if (!mpShader_TextureDistanceFieldDifuseColor)
+  {
+    mpShader_TextureDistanceFieldDifuseColor = new nuiShaderProgram("TextureDistanceFieldDifuseColor");
+    mpShader_TextureDistanceFieldDifuseColor->Acquire();
+#ifdef _OPENGL_ES_
+    mpShader_TextureDistanceFieldDifuseColor->SetPrefix("#extension GL_OES_standard_derivatives : enable\nprecision mediump float;\n");
+#endif
+    mpShader_TextureDistanceFieldDifuseColor->AddShader(eVertexShader, TextureAlphaDifuseColor_VTX);
+    mpShader_TextureDistanceFieldDifuseColor->AddShader(eFragmentShader, TextureDistanceFieldDifuseColor_FGT);
+    mpShader_TextureDistanceFieldDifuseColor->Link();
+    mpShader_TextureDistanceFieldDifuseColor->GetCurrentState()->Set("DifuseColor", nuiColor(255, 255, 255, 255));
+    mpShader_TextureDistanceFieldDifuseColor->GetCurrentState()->Set("Offset", 0.0f, 0.0f);
+    mpShader_TextureDistanceFieldDifuseColor->GetCurrentState()->Set("texture", 0);
+  }
+  nuiCheckForGLErrors();
+
   mpShader_VertexColor = nuiShaderProgram::GetProgram("VertexColor");
   if (!mpShader_VertexColor)
   {
@@ -319,6 +381,8 @@ nuiGL2Painter::~nuiGL2Painter()
   mpShader_TextureDifuseColor->Release();
   mpShader_TextureAlphaVertexColor->Release();
   mpShader_TextureAlphaDifuseColor->Release();
+  mpShader_TextureDistanceFieldVertexColor->Release();
+  mpShader_TextureDistanceFieldDifuseColor->Release();
   mpShader_DifuseColor->Release();
   mpShader_VertexColor->Release();
 }
@@ -520,7 +584,7 @@ void nuiGL2Painter::DrawArray(nuiRenderArray* pArray)
       {
         // texture on
         if (mpState->mpTexture[0]->GetPixelFormat() == eImagePixelAlpha)
-          pShader = mpShader_TextureAlphaVertexColor;
+          pShader = mpState->mpTexture[0]->GetDistanceFieldSpread() > 0 ? mpShader_TextureDistanceFieldVertexColor : mpShader_TextureAlphaVertexColor;
         else
           pShader = mpShader_TextureVertexColor;
       }
@@ -536,7 +600,7 @@ void nuiGL2Painter::DrawArray(nuiRenderArray* pArray)
       {
         // texture on
         if (mpState->mpTexture[0]->GetPixelFormat() == eImagePixelAlpha)
-          pShader = mpShader_TextureAlphaDifuseColor;
+          pShader = mpState->mpTexture[0]->GetDistanceFieldSpread() > 0 ? mpShader_TextureDistanceFieldDifuseColor : mpShader_TextureAlphaDifuseColor;
         else
           pShader = mpShader_TextureDifuseColor;
       }
@@ -829,21 +893,29 @@ void nuiGL2Painter::SetVertexPointers(const nuiRenderArray& rArray)
   GLint TexCoord = pPgm->GetVATexCoordLocation();
   GLint Color = pPgm->GetVAColorLocation();
   GLint Normal = pPgm->GetVANormalLocation();
+  const nuiRenderArray::VertexLayout& rLayout(rArray.GetLayout());
+  const GLubyte* pVertexData = (const GLubyte*)rArray.GetVertexData();
 
   if (Position != -1)
   {
     glEnableVertexAttribArray(Position);
-    glVertexAttribPointer(Position, 3, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), &rArray.GetVertices()[0].mX);
+    glVertexAttribPointer(Position, rLayout.mPositionCount, GL_FLOAT, GL_FALSE, rLayout.mStride, pVertexData + rLayout.mPosition);
   }
   else
   {
     //glDisableVertexAttribArray(Position);
   }
 
-  if (TexCoord != -1)
+  if (TexCoord != -1 && rLayout.mTexCoord >= 0)
   {
     glEnableVertexAttribArray(TexCoord);
-    glVertexAttribPointer(TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), &rArray.GetVertices()[0].mTX);
+    glVertexAttribPointer(TexCoord, 2, GL_FLOAT, GL_FALSE, rLayout.mStride, pVertexData + rLayout.mTexCoord);
+  }
+  else if (TexCoord != -1)
+  {
+    // This vertex format has no texture coordinates:
+    glDisableVertexAttribArray(TexCoord);
+    glVertexAttrib2f(TexCoord, 0, 0);
   }
   else
   {
@@ -853,17 +925,22 @@ void nuiGL2Painter::SetVertexPointers(const nuiRenderArray& rArray)
   if (Color != -1)
   {
     glEnableVertexAttribArray(Color);
-    glVertexAttribPointer(Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(nuiRenderArray::Vertex), &rArray.GetVertices()[0].mR);
+    glVertexAttribPointer(Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, rLayout.mStride, pVertexData + rLayout.mColor);
   }
   else
   {
     //glDisableVertexAttribArray(Color);
   }
 
-  if (Normal != -1)
+  if (Normal != -1 && rLayout.mNormal >= 0)
   {
     glEnableVertexAttribArray(Normal);
-    glVertexAttribPointer(Normal, 3, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), &rArray.GetVertices()[0].mNX);
+    glVertexAttribPointer(Normal, 3, GL_FLOAT, GL_FALSE, rLayout.mStride, pVertexData + rLayout.mNormal);
+  }
+  else if (Normal != -1)
+  {
+    glDisableVertexAttribArray(Normal);
+    glVertexAttrib3f(Normal, 0, 0, 1);
   }
   else
   {
@@ -885,6 +962,13 @@ void nuiGL2Painter::SetVertexBuffersPointers(const nuiRenderArray& rArray, Rende
   static int64 bound = 0;
   total++;
   nuiShaderProgram* pPgm = mFinalState.mpShader;
+  const nuiRenderArray::VertexLayout& rLayout(rArray.GetLayout());
+
+  // The VAO leaves the attributes missing from the vertex format disabled, they read these constants:
+  if (rLayout.mTexCoord < 0 && pPgm->GetVATexCoordLocation() != -1)
+    glVertexAttrib2f(pPgm->GetVATexCoordLocation(), 0, 0);
+  if (rLayout.mNormal < 0 && pPgm->GetVANormalLocation() != -1)
+    glVertexAttrib3f(pPgm->GetVANormalLocation(), 0, 0, 1);
 
   // Look for VAO:
   auto it = rInfo.mVAOs.find(pPgm);
@@ -909,7 +993,7 @@ void nuiGL2Painter::SetVertexBuffersPointers(const nuiRenderArray& rArray, Rende
     rInfo.BindVertices();
     if (Position != -1)
     {
-      glVertexAttribPointer(Position, 3, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), (void*)offsetof(nuiRenderArray::Vertex, mX));
+      glVertexAttribPointer(Position, rLayout.mPositionCount, GL_FLOAT, GL_FALSE, rLayout.mStride, (void*)(size_t)rLayout.mPosition);
       nuiCheckForGLErrors();
       glEnableVertexAttribArray(Position);
       nuiCheckForGLErrors();
@@ -919,9 +1003,9 @@ void nuiGL2Painter::SetVertexBuffersPointers(const nuiRenderArray& rArray, Rende
       //glDisableVertexAttribArray(Position);
     }
 
-    if (TexCoord != -1)
+    if (TexCoord != -1 && rLayout.mTexCoord >= 0)
     {
-      glVertexAttribPointer(TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), (void*)offsetof(nuiRenderArray::Vertex, mTX));
+      glVertexAttribPointer(TexCoord, 2, GL_FLOAT, GL_FALSE, rLayout.mStride, (void*)(size_t)rLayout.mTexCoord);
       nuiCheckForGLErrors();
       glEnableVertexAttribArray(TexCoord);
       nuiCheckForGLErrors();
@@ -933,7 +1017,7 @@ void nuiGL2Painter::SetVertexBuffersPointers(const nuiRenderArray& rArray, Rende
 
     if (Color != -1)
     {
-      glVertexAttribPointer(Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(nuiRenderArray::Vertex), (void*)offsetof(nuiRenderArray::Vertex, mR));
+      glVertexAttribPointer(Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, rLayout.mStride, (void*)(size_t)rLayout.mColor);
       nuiCheckForGLErrors();
       glEnableVertexAttribArray(Color);
       nuiCheckForGLErrors();
@@ -943,9 +1027,9 @@ void nuiGL2Painter::SetVertexBuffersPointers(const nuiRenderArray& rArray, Rende
       //glDisableVertexAttribArray(Color);
     }
 
-    if (Normal != -1)
+    if (Normal != -1 && rLayout.mNormal >= 0)
     {
-      glVertexAttribPointer(Normal, 3, GL_FLOAT, GL_FALSE, sizeof(nuiRenderArray::Vertex), (void*)offsetof(nuiRenderArray::Vertex, mNX));
+      glVertexAttribPointer(Normal, 3, GL_FLOAT, GL_FALSE, rLayout.mStride, (void*)(size_t)rLayout.mNormal);
       nuiCheckForGLErrors();
       glEnableVertexAttribArray(Normal);
       nuiCheckForGLErrors();
@@ -978,12 +978,15 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
 
 
 
+  const nuiRenderArray::VertexLayout& rLayout(pArray->GetLayout());
+  const GLubyte* pVertexData = (const GLubyte*)pArray->GetVertexData();
+
 //  if (pArray->IsArrayEnabled(nuiRenderArray::eVertex))
 //  {
 //    if (!mClientVertex)
       glEnableClientState(GL_VERTEX_ARRAY);
     mClientVertex = true;
-    glVertexPointer(3, GL_FLOAT, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mX);
+    glVertexPointer(rLayout.mPositionCount, GL_FLOAT, rLayout.mStride, pVertexData + rLayout.mPosition);
     nuiCheckForGLErrors();
 //  }
 //  else
@@ -999,7 +1002,7 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
     if (!mClientColor)
       glEnableClientState(GL_COLOR_ARRAY);
     mClientColor = true;
-    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mR);
+    glColorPointer(4, GL_UNSIGNED_BYTE, rLayout.mStride, pVertexData + rLayout.mColor);
     nuiCheckForGLErrors();
   }
   else
@@ -1051,7 +1054,7 @@ void nuiGLPainter::DrawArray(nuiRenderArray* pArray)
     if (!mClientTexCoord)
       glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     mClientTexCoord = true;
-    glTexCoordPointer(2, GL_FLOAT, sizeof(nuiRenderArray::Vertex), &pArray->GetVertices()[0].mTX);
+    glTexCoordPointer(2, GL_FLOAT, rLayout.mStride, pVertexData + rLayout.mTexCoord);
     nuiCheckForGLErrors();
   }
   else
@@ -1486,17 +1489,33 @@ void nuiGLPainter::UploadTexture(nuiTexture* pTexture, int slot)
 #if (!defined _MACOSX_)
       if (!firstload)
       {
-        glTexSubImage2D
-        (
-         target,
-         0,
-         0,0,
-         (int)Width,
-         (int)Height,
-         pixelformat,
-         type,
-         pBuffer
-         );
+        int32 top = 0;
+        int32 rows = (int32)Height;
+        GLbyte* pRows = pBuffer;
+        const nuiRect& rDirty(pTexture->GetReloadRect());
+        if (pImage && rDirty.GetWidth() > 0 && rDirty.GetHeight() > 0)
+        {
+          // Only the rows that changed need to be sent:
+          const uint32 stride = allocated ? (uint32)(Width * pImage->GetPixelSize()) : pImage->GetBytesPerLine();
+          top = MAX(0, ToBelow(rDirty.Top()));
+          rows = MIN((int32)Height, (int32)ToAbove(rDirty.Bottom())) - top;
+          pRows += top * stride;
+        }
+
+        if (rows > 0)
+        {
+          glTexSubImage2D
+          (
+           target,
+           0,
+           0,top,
+           (int)Width,
+           rows,
+           pixelformat,
+           type,
+           pRows
+           );
+        }
         nuiCheckForGLErrors();
         pTexture->ResetForceReload();
       }
@@ -2094,7 +2113,7 @@ void nuiGLPainter::RenderArrayInfo::Rebind(nuiRenderArray* pRenderArray)
   nuiCheckForGLErrors();
   glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
   nuiCheckForGLErrors();
-  glBufferData(GL_ARRAY_BUFFER, sizeof(nuiRenderArray::Vertex) * count, &pRenderArray->GetVertices()[0], GL_STATIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, pRenderArray->GetTotalSize(), pRenderArray->GetVertexData(), GL_STATIC_DRAW);
   nuiCheckForGLErrors();
 
   if (pRenderArray->GetIndexArrayCount() > 0)
@@ -7,6 +7,17 @@
 
 #include "nui.h"
 
+// Number of recently stored render states that SetState compares with before storing a new one:
+#define NUI_METAPAINTER_STATE_LOOKUP 8
+
+static bool IsTranslation(const nuiMatrix& rMatrix)
+{
+  return rMatrix.Elt.M11 == 1 && rMatrix.Elt.M12 == 0 && rMatrix.Elt.M13 == 0
+      && rMatrix.Elt.M21 == 0 && rMatrix.Elt.M22 == 1 && rMatrix.Elt.M23 == 0
+      && rMatrix.Elt.M31 == 0 && rMatrix.Elt.M32 == 0 && rMatrix.Elt.M33 == 1
+      && rMatrix.Elt.M41 == 0 && rMatrix.Elt.M42 == 0 && rMatrix.Elt.M43 == 0 && rMatrix.Elt.M44 == 1;
+}
+
 // nuiMetaPainter:
 nuiMetaPainter::nuiMetaPainter(nglContext* pContext)
 : nuiPainter(pContext)
@@ -15,11 +26,12 @@ nuiMetaPainter::nuiMetaPainter(nglContext* pContext)
   mLastStateValid = false;
   mpCache = &mOperations;
   mNbDrawChild = 0;
+  mNbSharedStates = 0;
   mNbDrawArray = 0;
   mNbClearColor = 0;
   mNbOperations = 0;
   mDrawChildrenImmediat = false;
-  mLastSize = -1;
+  mLastSize = (size_t)-1;
   
 #ifdef _DEBUG_
   mpDebugObjectRef = NULL;
@@ -47,52 +59,29 @@ void nuiMetaPainter::DestroyTexture(nuiTexture* pTexture)
 
 void nuiMetaPainter::StoreOpCode(OpCode code)
 {
-  StoreInt((int32)code);
+  if (!mDummyMode)
+    mOperations.push_back((uint8)code);
   mNbOperations++;
 }
 
 void nuiMetaPainter::StoreInt(int32 Val)
 {
-  //  StoreBuffer(&Val, sizeof(int32), 1);
-  if (mDummyMode)
-    return;
-  
-  uint pos = mOperations.size();
-  mOperations.resize(pos + sizeof(Val));
-  *(int32*)&(mOperations[pos]) = Val;
+  StoreBuffer(&Val, sizeof(int32), 1);
 }
 
 void nuiMetaPainter::StoreFloat(float Val)
 {
-  //  StoreBuffer(&Val, sizeof(float), 1);
-  if (mDummyMode)
-    return;
-  
-  uint pos = mOperations.size();
-  mOperations.resize(pos + sizeof(Val));
-  *(float*)&(mOperations[pos]) = Val;
+  StoreBuffer(&Val, sizeof(float), 1);
 }
 
 void nuiMetaPainter::StoreFloat(double Val)
 {
-  //  StoreBuffer(&Val, sizeof(double), 1);
-  if (mDummyMode)
-    return;
-  
-  uint pos = mOperations.size();
-  mOperations.resize(pos + sizeof(Val));
-  *(double*)&(mOperations[pos]) = Val;
+  StoreBuffer(&Val, sizeof(double), 1);
 }
 
 void nuiMetaPainter::StorePointer(void* pVal)
 {
-  //  StoreBuffer(&pVal, sizeof(void*), 1);
-  if (mDummyMode)
-    return;
-  
-  uint pos = mOperations.size();
-  mOperations.resize(pos + sizeof(void*));
-  *(void**)&(mOperations[pos]) = pVal;
+  StoreBuffer(&pVal, sizeof(void*), 1);
 }
 
 void nuiMetaPainter::StoreBuffer(const void* pBuffer, uint ElementSize, uint ElementCount)
@@ -100,6 +89,7 @@ void nuiMetaPainter::StoreBuffer(const void* pBuffer, uint ElementSize, uint Ele
   if (mDummyMode)
     return;
 
+  // The values are not aligned in the stream, always copy them byte per byte:
   uint size = ElementSize * ElementCount;
   uint pos = mOperations.size();
   mOperations.resize(pos + size);
@@ -108,48 +98,32 @@ void nuiMetaPainter::StoreBuffer(const void* pBuffer, uint ElementSize, uint Ele
 
 nuiMetaPainter::OpCode nuiMetaPainter::FetchOpCode() const
 {
-  return (OpCode)FetchInt();
+  NGL_ASSERT(mOperationPos < mOperations.size());
+  return (OpCode)mOperations[mOperationPos++];
 }
 
 int32 nuiMetaPainter::FetchInt() const
 {
-  //  int32 tmp;
-//  FetchBuffer(&tmp, sizeof(int32), 1);
-//  return tmp;
   int32 tmp;
-  NGL_ASSERT(mOperationPos + sizeof(tmp) <= mOperations.size());
-  tmp = *(int32*)&mOperations[mOperationPos];
-  mOperationPos += sizeof(tmp);
+  FetchBuffer(&tmp, sizeof(int32), 1);
   return tmp;
 }
 
 void nuiMetaPainter::FetchFloat(double& rDouble) const
 {
-  //  FetchBuffer(&rDouble, sizeof(double), 1);
-  NGL_ASSERT(mOperationPos + sizeof(rDouble) <= mOperations.size());
-  rDouble = *(double*)&mOperations[mOperationPos];
-  mOperationPos += sizeof(rDouble);
+  FetchBuffer(&rDouble, sizeof(double), 1);
 }
 
 void nuiMetaPainter::FetchFloat(float& rFloat) const
 {
-  //  FetchBuffer(&rFloat, sizeof(float), 1);
-  NGL_ASSERT(mOperationPos + sizeof(rFloat) <= mOperations.size());
-  rFloat = *(float*)&mOperations[mOperationPos];
-  mOperationPos += sizeof(rFloat);
+  FetchBuffer(&rFloat, sizeof(float), 1);
 }
 
 void* nuiMetaPainter::FetchPointer() const
 {
-//  void* pTmp;
-//  FetchBuffer(&pTmp, sizeof(void*), 1);
-//  return pTmp;
-
-  void* tmp;
-  NGL_ASSERT(mOperationPos + sizeof(tmp) <= mOperations.size());
-  tmp = *(void**)&mOperations[mOperationPos];
-  mOperationPos += sizeof(tmp);
-  return tmp;
+  void* pTmp;
+  FetchBuffer(&pTmp, sizeof(void*), 1);
+  return pTmp;
 }
 
 void nuiMetaPainter::FetchBuffer(void* pBuffer, uint ElementSize, uint ElementCount) const
@@ -204,9 +178,27 @@ void nuiMetaPainter::SetState(const nuiRenderState& rState, bool ForceApply)
   mLastStateValid = true;
   mLastState = rState;
   StoreOpCode(eSetState);
-  //StorePointer(new nuiRenderState(rState));
-  StoreInt(mRenderStates.size());
-  mRenderStates.push_back(rState);
+
+  // Widgets tend to switch between a few states (fill, stroke, text...), reuse a recent copy if there is one:
+  int32 index = -1;
+  const int32 count = mRenderStates.size();
+  for (int32 i = count - 1; i >= 0 && i >= count - NUI_METAPAINTER_STATE_LOOKUP; i--)
+  {
+    if (mRenderStates[i] == rState)
+    {
+      index = i;
+      mNbSharedStates++;
+      break;
+    }
+  }
+
+  if (index < 0)
+  {
+    index = count;
+    mRenderStates.push_back(rState);
+  }
+
+  StoreInt(index);
   StoreInt(ForceApply?1:0);
 }
 
@@ -267,6 +259,7 @@ void nuiMetaPainter::DrawChild(nuiDrawContext* pContext, nuiWidget* pChild)
   }
   else
   {
+    // The position of the child is read on replay so that it can move without invalidating this cache:
     StoreOpCode(eDrawChild);
     StorePointer(pChild);
   }
@@ -286,8 +279,18 @@ void nuiMetaPainter::LoadMatrix(const nuiMatrix& rMatrix)
 
 void nuiMetaPainter::MultMatrix(const nuiMatrix& rMatrix)
 {
-  StoreOpCode(eMultMatrix);
-  StoreBuffer(rMatrix.Array, sizeof(nuiSize), 16);
+  if (IsTranslation(rMatrix))
+  {
+    StoreOpCode(eTranslate);
+    StoreFloat(rMatrix.Elt.M14);
+    StoreFloat(rMatrix.Elt.M24);
+    StoreFloat(rMatrix.Elt.M34);
+  }
+  else
+  {
+    StoreOpCode(eMultMatrix);
+    StoreBuffer(rMatrix.Array, sizeof(nuiSize), 16);
+  }
 
   nuiPainter::MultMatrix(rMatrix);
 }
@@ -419,10 +422,11 @@ void nuiMetaPainter::Reset(nuiPainter const * pFrom)
 {
   mOperationIndices.clear();
   mNbOperations = 0;
-  mLastSize = -1;
+  mLastSize = (size_t)-1;
   mOperationPos = 0;
   mLastStateValid = false;
   mNbDrawChild = 0;
+  mNbSharedStates = 0;
   mNbDrawArray = 0;
   mNbClearColor = 0;
   mRenderOperations = 0;
@@ -461,16 +465,17 @@ int32 nuiMetaPainter::GetNbOperations() const
 void nuiMetaPainter::PartialReDraw(nuiDrawContext* pContext, int32 first, int32 last) const
 {
   nuiPainter* pPainter = pContext->GetPainter();
-  mOperationPos = 0;
   uint size = mOperations.size();
   
   const bool DoDrawChild = mNbDrawChild;
   const bool DoDrawArray = mNbDrawArray;
   const bool DoDrawSelf = DoDrawArray || mNbClearColor;
-  if (!(DoDrawChild || DoDrawSelf))
+  if (!(DoDrawChild || DoDrawSelf) || first >= mNbOperations)
     return;
   
-  int32 currentop = 0;
+  // Skipped operations would have to be parsed anyway, jump to the first one:
+  int32 currentop = MAX(first, 0);
+  mOperationPos = currentop ? GetOffsetFromOperationIndex(currentop) : 0;
   while (mOperationPos < size && currentop < last)
   {
     bool draw = currentop >= first;
@@ -534,7 +539,20 @@ void nuiMetaPainter::PartialReDraw(nuiDrawContext* pContext, int32 first, int32
         if (draw)
         {
           nuiWidget* pChild = (nuiWidget*)FetchPointer();
+          const nuiRect& rRect(pChild->GetRect());
+          const bool translate = rRect.Left() != 0 || rRect.Top() != 0;
+          if (translate)
+          {
+            nuiMatrix m;
+            m.SetTranslation(rRect.Left(), rRect.Top(), 0);
+            pPainter->PushMatrix();
+            pPainter->MultMatrix(m);
+          }
+
           pChild->DrawWidget(pContext);
+
+          if (translate)
+            pPainter->PopMatrix();
         }
         break;
       case eLoadMatrix:
@@ -553,6 +571,18 @@ void nuiMetaPainter::PartialReDraw(nuiDrawContext* pContext, int32 first, int32
           pPainter->MultMatrix(m);
         }
         break;
+      case eTranslate:
+        if (draw)
+        {
+          float x, y, z;
+          FetchFloat(x);
+          FetchFloat(y);
+          FetchFloat(z);
+          nuiMatrix m;
+          m.SetTranslation(x, y, z);
+          pPainter->MultMatrix(m);
+        }
+        break;
       case ePopMatrix:
         if (draw)
           pPainter->PopMatrix();
@@ -682,12 +712,7 @@ nglString nuiMetaPainter::GetOperationDescription(int32 OperationIndex) const
       }
       break;
     case eStartRendering:
-      {
-        nuiSize x, y;
-        FetchFloat(x);
-        FetchFloat(y);
-        str.CFormat(_T("StartRendering(%f, %f)"), x, y);
-      }
+      str = _T("StartRendering");
       break;
     case eSetState:
       {
@@ -705,7 +730,7 @@ nglString nuiMetaPainter::GetOperationDescription(int32 OperationIndex) const
         const nglChar* pMode = GetGLMode(pArray->GetMode());
         float bounds[6];
         pArray->GetBounds(bounds);
-        str.CFormat(_T("DrawArray 0x%x (size %d mode:%s) (%f , %f)->(%f, %f)"), pArray, pArray->GetVertices().size(), pMode, bounds[0], bounds[1], bounds[3], bounds[4]);
+        str.CFormat(_T("DrawArray 0x%x (size %d mode:%s) (%f , %f)->(%f, %f)"), pArray, pArray->GetSize(), pMode, bounds[0], bounds[1], bounds[3], bounds[4]);
       }
       break;
     case eClear:
@@ -749,6 +774,15 @@ nglString nuiMetaPainter::GetOperationDescription(int32 OperationIndex) const
         str = _T("MultMatrix") + v;
       }
       break;
+    case eTranslate:
+      {
+        float x, y, z;
+        FetchFloat(x);
+        FetchFloat(y);
+        FetchFloat(z);
+        str.CFormat(_T("Translate(%f, %f, %f)"), x, y, z);
+      }
+      break;
     case ePopMatrix:
       str = _T("PopMatrix");
       break;
@@ -836,14 +870,14 @@ const nglString& nuiMetaPainter::GetName() const
 int32 nuiMetaPainter::GetOffsetFromOperationIndex(int32 index) const
 {
   UpdateIndices();
-  NGL_ASSERT(index < mOperationIndices.size());
+  NGL_ASSERT(index >= 0 && (size_t)index < mOperationIndices.size());
   return mOperationIndices[index];
 }
 
 
 void nuiMetaPainter::UpdateIndices() const
 {
-  if (!mOperationIndices.empty()) // || mLastSize == mOperations.size())
+  if (mLastSize == mOperations.size())
     return;
   
   mOperationIndices.clear();
@@ -893,6 +927,14 @@ void nuiMetaPainter::UpdateIndices() const
         FetchBuffer(m.Array, sizeof(nuiSize), 16);
       }
         break;
+      case eTranslate:
+      {
+        float tmp;
+        FetchFloat(tmp);
+        FetchFloat(tmp);
+        FetchFloat(tmp);
+      }
+        break;
       case ePopMatrix:
         break;
       case ePushMatrix:
@@ -961,6 +1003,33 @@ bool nuiMetaPainter::GetDrawChildrenImmediat() const
   return mDrawChildrenImmediat;
 }
 
+uint32 nuiMetaPainter::GetMemoryUsage(bool IncludeArrays) const
+{
+  uint32 size = sizeof(nuiMetaPainter);
+  size += mOperations.capacity();
+  size += mOperationIndices.capacity() * sizeof(int32);
+  size += mRenderStates.capacity() * sizeof(nuiRenderState);
+  size += mRenderArrays.capacity() * sizeof(nuiRenderArray*);
+
+  if (IncludeArrays)
+  {
+    for (uint32 i = 0; i < mRenderArrays.size(); i++)
+      size += sizeof(nuiRenderArray) + mRenderArrays[i]->GetTotalSize();
+  }
+
+  return size;
+}
+
+int32 nuiMetaPainter::GetNbRenderStates() const
+{
+  return mRenderStates.size();
+}
+
+int32 nuiMetaPainter::GetNbSharedRenderStates() const
+{
+  return mNbSharedStates;
+}
+
 #ifdef _DEBUG_
 void nuiMetaPainter::DBGSetReferenceObject(const nuiObject* pRef)
 {
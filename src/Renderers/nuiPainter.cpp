@@ -223,6 +223,11 @@ uint32 nuiPainter::GetClipStackSize() const
 }
 
 
+bool nuiPainter::DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality)
+{
+  return false;
+}
+
 uint32 nuiPainter::GetRectangleTextureSupport() const
 {
   return 0;
@@ -7,7 +7,90 @@
 
 #include "nui.h"
 
-
+static void UnpackVertex(const nuiRenderArray::Vertex2DTexColor& rSrc, nuiRenderArray::Vertex& rDst)
+{
+  rDst.mX = rSrc.mX;
+  rDst.mY = rSrc.mY;
+  rDst.mZ = 0.0f;
+  rDst.mW = 1.0f;
+  rDst.mTX = rSrc.mTX;
+  rDst.mTY = rSrc.mTY;
+  rDst.mNX = 0.0f;
+  rDst.mNY = 0.0f;
+  rDst.mNZ = 1.0f;
+  rDst.mNW = 0.0f;
+  rDst.mR = rSrc.mR;
+  rDst.mG = rSrc.mG;
+  rDst.mB = rSrc.mB;
+  rDst.mA = rSrc.mA;
+}
+
+static void UnpackVertex(const nuiRenderArray::Vertex2DColor& rSrc, nuiRenderArray::Vertex& rDst)
+{
+  rDst.mX = rSrc.mX;
+  rDst.mY = rSrc.mY;
+  rDst.mZ = 0.0f;
+  rDst.mW = 1.0f;
+  rDst.mTX = 0.0f;
+  rDst.mTY = 0.0f;
+  rDst.mNX = 0.0f;
+  rDst.mNY = 0.0f;
+  rDst.mNZ = 1.0f;
+  rDst.mNW = 0.0f;
+  rDst.mR = rSrc.mR;
+  rDst.mG = rSrc.mG;
+  rDst.mB = rSrc.mB;
+  rDst.mA = rSrc.mA;
+}
+
+static void PackVertex(const nuiRenderArray::Vertex& rSrc, nuiRenderArray::Vertex2DTexColor& rDst)
+{
+  rDst.mX = rSrc.mX;
+  rDst.mY = rSrc.mY;
+  rDst.mTX = rSrc.mTX;
+  rDst.mTY = rSrc.mTY;
+  rDst.mR = rSrc.mR;
+  rDst.mG = rSrc.mG;
+  rDst.mB = rSrc.mB;
+  rDst.mA = rSrc.mA;
+}
+
+static void PackVertex(const nuiRenderArray::Vertex& rSrc, nuiRenderArray::Vertex2DColor& rDst)
+{
+  rDst.mX = rSrc.mX;
+  rDst.mY = rSrc.mY;
+  rDst.mR = rSrc.mR;
+  rDst.mG = rSrc.mG;
+  rDst.mB = rSrc.mB;
+  rDst.mA = rSrc.mA;
+}
+
+// The indexed setters write the components straight into the storage of the current format, all the formats share these names:
+template <class VertexType>
+static inline void StorePosition(VertexType& rDst, float x, float y)
+{
+  rDst.mX = x;
+  rDst.mY = y;
+}
+
+template <class VertexType>
+static inline void StoreColor(VertexType& rDst, uint8 r, uint8 g, uint8 b, uint8 a)
+{
+  rDst.mR = r;
+  rDst.mG = g;
+  rDst.mB = b;
+  rDst.mA = a;
+}
+
+static const nuiRenderArray::VertexLayout gVertexLayouts[] =
+{
+  // eFormatFull:
+  { sizeof(nuiRenderArray::Vertex), 3, offsetof(nuiRenderArray::Vertex, mX), offsetof(nuiRenderArray::Vertex, mTX), offsetof(nuiRenderArray::Vertex, mR), offsetof(nuiRenderArray::Vertex, mNX) },
+  // eFormat2DTexColor:
+  { sizeof(nuiRenderArray::Vertex2DTexColor), 2, offsetof(nuiRenderArray::Vertex2DTexColor, mX), offsetof(nuiRenderArray::Vertex2DTexColor, mTX), offsetof(nuiRenderArray::Vertex2DTexColor, mR), -1 },
+  // eFormat2DColor:
+  { sizeof(nuiRenderArray::Vertex2DColor), 2, offsetof(nuiRenderArray::Vertex2DColor, mX), -1, offsetof(nuiRenderArray::Vertex2DColor, mR), -1 }
+};
 
 /// class nuiRenderArray
 nuiRenderArray::nuiRenderArray(uint32 mode, bool Static, bool _3dmesh, bool _shape)
@@ -26,6 +109,7 @@ nuiRenderArray::nuiRenderArray(uint32 mode, bool Static, bool _3dmesh, bool _sha
 #endif
   m3DMesh = _3dmesh;
   mShape = _shape;
+  mFormat = eFormatFull;
 
   mCurrentVertex.mX = 0.0f;
   mCurrentVertex.mY = 0.0f;
@@ -45,19 +129,32 @@ nuiRenderArray::nuiRenderArray(uint32 mode, bool Static, bool _3dmesh, bool _sha
 }
 
 nuiRenderArray::nuiRenderArray(const nuiRenderArray& rArray)
-: mVertices(rArray.mVertices)
+: mVertices(rArray.mVertices),
+  mVertices2DTexColor(rArray.mVertices2DTexColor),
+  mVertices2DColor(rArray.mVertices2DColor)
 {
   Acquire();
   mDebug = false;
 
-  for (uint i = 0; i < 5; i++)
+  for (uint i = 0; i < 4; i++)
     mEnabled[i] = rArray.mEnabled[i];
   mStatic = rArray.mStatic;
   mMode = rArray.mMode;
   m3DMesh = rArray.m3DMesh;
   mShape = rArray.mShape;
+  mFormat = rArray.mFormat;
 
   mCurrentVertex = rArray.mCurrentVertex;
+
+  mMinX = rArray.mMinX;
+  mMinY = rArray.mMinY;
+  mMinZ = rArray.mMinZ;
+  mMaxX = rArray.mMaxX;
+  mMaxY = rArray.mMaxY;
+  mMaxZ = rArray.mMaxZ;
+
+  for (uint32 i = 0; i < rArray.mIndexedArrays.size(); i++)
+    mIndexedArrays.push_back(new IndexArray(*rArray.mIndexedArrays[i]));
 }
 
 nuiRenderArray::~nuiRenderArray()
@@ -85,7 +182,101 @@ void nuiRenderArray::EnableArray(DataType tpe, bool Set)
 
 bool nuiRenderArray::IsArrayEnabled(DataType tpe) const
 {
-  return mEnabled[tpe];
+  const VertexLayout& rLayout(GetLayout());
+  switch (tpe)
+  {
+    case eColor:
+      return mEnabled[tpe] && rLayout.mColor >= 0;
+    case eTexCoord:
+      return mEnabled[tpe] && rLayout.mTexCoord >= 0;
+    case eNormal:
+      return mEnabled[tpe] && rLayout.mNormal >= 0;
+    default:
+      return mEnabled[tpe];
+  }
+}
+
+void nuiRenderArray::SetFormat(VertexFormat Format)
+{
+  if (Format == mFormat)
+    return;
+
+  const uint32 count = GetSize();
+  std::vector<Vertex> vertices(count);
+  for (uint32 i = 0; i < count; i++)
+    GetVertex(i, vertices[i]);
+
+  mVertices.clear();
+  mVertices2DTexColor.clear();
+  mVertices2DColor.clear();
+  mFormat = Format;
+
+  Resize(count);
+  for (uint32 i = 0; i < count; i++)
+    StoreVertex(i, vertices[i]);
+}
+
+nuiRenderArray::VertexFormat nuiRenderArray::GetFormat() const
+{
+  return mFormat;
+}
+
+const nuiRenderArray::VertexLayout& nuiRenderArray::GetLayout() const
+{
+  return gVertexLayouts[mFormat];
+}
+
+const nuiRenderArray::VertexLayout& nuiRenderArray::GetLayout(VertexFormat Format)
+{
+  return gVertexLayouts[Format];
+}
+
+const void* nuiRenderArray::GetVertexData() const
+{
+  if (!GetSize())
+    return NULL;
+
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      return &mVertices2DTexColor[0];
+    case eFormat2DColor:
+      return &mVertices2DColor[0];
+    default:
+      return &mVertices[0];
+  }
+}
+
+void nuiRenderArray::GetVertex(uint32 index, Vertex& rVertex) const
+{
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      UnpackVertex(mVertices2DTexColor[index], rVertex);
+      break;
+    case eFormat2DColor:
+      UnpackVertex(mVertices2DColor[index], rVertex);
+      break;
+    default:
+      rVertex = mVertices[index];
+      break;
+  }
+}
+
+void nuiRenderArray::StoreVertex(uint32 index, const Vertex& rVertex)
+{
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      PackVertex(rVertex, mVertices2DTexColor[index]);
+      break;
+    case eFormat2DColor:
+      PackVertex(rVertex, mVertices2DColor[index]);
+      break;
+    default:
+      mVertices[index] = rVertex;
+      break;
+  }
 }
 
 void nuiRenderArray::PushVertex()
@@ -109,44 +300,94 @@ void nuiRenderArray::PushVertex()
   NGL_ASSERT(mCurrentVertex.mNZ != std::numeric_limits<float>::infinity());
   NGL_ASSERT(!std::isnan(mCurrentVertex.mNZ));
 
+  PushVertex(mCurrentVertex);
+}
+
+void nuiRenderArray::PushVertex(const Vertex& rVertex)
+{
   // Grow the bounding rect:
-  UpdateBounds(mCurrentVertex.mX, mCurrentVertex.mY, mCurrentVertex.mZ);
+  UpdateBounds(rVertex.mX, rVertex.mY, rVertex.mZ);
 
-  mVertices.push_back(mCurrentVertex);
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      mVertices2DTexColor.resize(mVertices2DTexColor.size() + 1);
+      PackVertex(rVertex, mVertices2DTexColor.back());
+      break;
+    case eFormat2DColor:
+      mVertices2DColor.resize(mVertices2DColor.size() + 1);
+      PackVertex(rVertex, mVertices2DColor.back());
+      break;
+    default:
+      mVertices.push_back(rVertex);
+      break;
+  }
 }
 
 uint32 nuiRenderArray::GetSize() const
 {
-  return (uint32)mVertices.size();
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      return (uint32)mVertices2DTexColor.size();
+    case eFormat2DColor:
+      return (uint32)mVertices2DColor.size();
+    default:
+      return (uint32)mVertices.size();
+  }
 }
 
 void nuiRenderArray::Reserve(uint Count)
 {
-  mVertices.reserve(Count);
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      mVertices2DTexColor.reserve(Count);
+      break;
+    case eFormat2DColor:
+      mVertices2DColor.reserve(Count);
+      break;
+    default:
+      mVertices.reserve(Count);
+      break;
+  }
 }
 
 void nuiRenderArray::Resize(uint Count)
 {
-  mVertices.resize(Count);
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      mVertices2DTexColor.resize(Count);
+      break;
+    case eFormat2DColor:
+      mVertices2DColor.resize(Count);
+      break;
+    default:
+      mVertices.resize(Count);
+      break;
+  }
 }
 
 void nuiRenderArray::Reset()
 {
   mVertices.clear();
+  mVertices2DTexColor.clear();
+  mVertices2DColor.clear();
 }
 
 uint32 nuiRenderArray::GetTotalSize() const
 {
   uint32 size = GetSize();
-  uint32 vertexsize = sizeof(Vertex);
+  uint32 vertexsize = GetLayout().mStride;
   return vertexsize * size;
 }
 
 void nuiRenderArray::FillBuffer(GLubyte* pBuffer) const
 {
-  uint32 size = GetSize();
-  uint32 bytes = size * sizeof(Vertex);
-  memcpy(pBuffer, &mVertices[0], bytes);
+  uint32 bytes = GetTotalSize();
+  if (bytes)
+    memcpy(pBuffer, GetVertexData(), bytes);
 }
 
 void nuiRenderArray::SetVertex(float x, float y, float z)
@@ -287,37 +528,50 @@ void nuiRenderArray::SetVertex(uint32 index, float x, float y, float z)
 {
   // Grow the bounding rect:
   UpdateBounds(x, y, z);
-  mVertices[index].mX = x;
-  mVertices[index].mY = y;
-  mVertices[index].mZ = z;
-  mVertices[index].mW = 1;
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      StorePosition(mVertices2DTexColor[index], x, y);
+      break;
+    case eFormat2DColor:
+      StorePosition(mVertices2DColor[index], x, y);
+      break;
+    default:
+    {
+      Vertex& rVertex(mVertices[index]);
+      StorePosition(rVertex, x, y);
+      rVertex.mZ = z;
+      rVertex.mW = 1;
+      break;
+    }
+  }
 }
 
 void nuiRenderArray::SetVertex(uint32 index, const nuiVector& rVf)
 {
+  if (mFormat != eFormatFull)
+  {
+    // The 2D formats have no W:
+    SetVertex(index, rVf[0], rVf[1], rVf[2]);
+    return;
+  }
+
   UpdateBounds(rVf[0], rVf[1], rVf[2]);
-  mVertices[index].mX = rVf[0];
-  mVertices[index].mY = rVf[1];
-  mVertices[index].mZ = rVf[2];
-  mVertices[index].mW = rVf[3];
+  Vertex& rVertex(mVertices[index]);
+  rVertex.mX = rVf[0];
+  rVertex.mY = rVf[1];
+  rVertex.mZ = rVf[2];
+  rVertex.mW = rVf[3];
 }
 
 void nuiRenderArray::SetVertex(uint32 index, const nuiVector3& rV3f)
 {
-  UpdateBounds(rV3f[0], rV3f[1], rV3f[2]);
-  mVertices[index].mX = rV3f[0];
-  mVertices[index].mY = rV3f[1];
-  mVertices[index].mZ = rV3f[2];
-  mVertices[index].mW = 1;
+  SetVertex(index, rV3f[0], rV3f[1], rV3f[2]);
 }
 
 void nuiRenderArray::SetVertex(uint32 index, const nuiVector2& rV2f)
 {
-  UpdateBounds(rV2f[0], rV2f[1], 0);
-  mVertices[index].mX = rV2f[0];
-  mVertices[index].mY = rV2f[1];
-  mVertices[index].mZ = 0;
-  mVertices[index].mW = 1;
+  SetVertex(index, rV2f[0], rV2f[1], 0);
 }
 
 void nuiRenderArray::SetColor(uint32 index, float r, float g, float b, float a)
@@ -335,18 +589,23 @@ void nuiRenderArray::SetColor(uint32 index, float r, float g, float b, float a)
   NGL_ASSERT(!std::isnan(b));
   NGL_ASSERT(!std::isnan(a));
   
-  mVertices[index].mR = (uint8)ToBelow(r * 255.0f);
-  mVertices[index].mG = (uint8)ToBelow(g * 255.0f);
-  mVertices[index].mB = (uint8)ToBelow(b * 255.0f);
-  mVertices[index].mA = (uint8)ToBelow(a * 255.0f);
+  SetColor(index, (uint8)ToBelow(r * 255.0f), (uint8)ToBelow(g * 255.0f), (uint8)ToBelow(b * 255.0f), (uint8)ToBelow(a * 255.0f));
 }
 
 void nuiRenderArray::SetColor(uint32 index, uint8 r, uint8 g, uint8 b, uint8 a)
 {
-  mVertices[index].mR = r;
-  mVertices[index].mG = g;
-  mVertices[index].mB = b;
-  mVertices[index].mA = a;
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      StoreColor(mVertices2DTexColor[index], r, g, b, a);
+      break;
+    case eFormat2DColor:
+      StoreColor(mVertices2DColor[index], r, g, b, a);
+      break;
+    default:
+      StoreColor(mVertices[index], r, g, b, a);
+      break;
+  }
 }
 
 void nuiRenderArray::SetColor(uint32 index, uint32 Color)
@@ -363,32 +622,43 @@ void nuiRenderArray::SetColor(uint32 index, const nuiColor& rColor)
 
 void nuiRenderArray::SetTexCoords(uint32 index, float tx, float ty)
 {
-  mVertices[index].mTX = tx;
-  mVertices[index].mTY = ty;
+  switch (mFormat)
+  {
+    case eFormat2DTexColor:
+      mVertices2DTexColor[index].mTX = tx;
+      mVertices2DTexColor[index].mTY = ty;
+      break;
+    case eFormat2DColor:
+      // No texture coordinates in this format.
+      break;
+    default:
+      mVertices[index].mTX = tx;
+      mVertices[index].mTY = ty;
+      break;
+  }
 }
 
 void nuiRenderArray::SetNormal(uint32 index, float x, float y, float z)
 {
-  mVertices[index].mNX = x;
-  mVertices[index].mNY = y;
-  mVertices[index].mNZ = z;
-  mVertices[index].mNW = 0;
+  // Only the full format stores normals:
+  if (mFormat != eFormatFull)
+    return;
+
+  Vertex& rVertex(mVertices[index]);
+  rVertex.mNX = x;
+  rVertex.mNY = y;
+  rVertex.mNZ = z;
+  rVertex.mNW = 0;
 }
 
 void nuiRenderArray::SetNormal(uint32 index, const nuiVector& rVf)
 {
-  mVertices[index].mNX = rVf[0];
-  mVertices[index].mNY = rVf[1];
-  mVertices[index].mNZ = rVf[2];
-  mVertices[index].mNW = 0;
+  SetNormal(index, rVf[0], rVf[1], rVf[2]);
 }
 
 void nuiRenderArray::SetNormal(uint32 index, const nuiVector3& rV3f)
 {
-  mVertices[index].mNX = rV3f[0];
-  mVertices[index].mNY = rV3f[1];
-  mVertices[index].mNZ = rV3f[2];
-  mVertices[index].mNW = 0;
+  SetNormal(index, rV3f[0], rV3f[1], rV3f[2]);
 }
 
 
@@ -455,7 +725,7 @@ void nuiRenderArray::GetBounds(float *pBounds) const
 
 void nuiRenderArray::UpdateBounds(float x, float y, float z)
 {
-  if (mVertices.empty())
+  if (!GetSize())
   {
     mMinX = x;
     mMinY = y;
@@ -478,10 +748,12 @@ void nuiRenderArray::UpdateBounds(float x, float y, float z)
 nglString nuiRenderArray::Dump() const
 {
   nglString str;
-  for (int i = 0; i < mVertices.size(); i++)
+  for (uint32 i = 0; i < GetSize(); i++)
   {
+    Vertex v;
+    GetVertex(i, v);
     nglString f;
-    f.CFormat(_T("%d:  %3f %3f - %3f %3f (%3f %3f)"), i, mVertices[i].mX, mVertices[i].mY, mVertices[i].mTX, mVertices[i].mTY, mVertices[i].mTX * 2, mVertices[i].mTY * 2);
+    f.CFormat(_T("%d:  %3f %3f - %3f %3f (%3f %3f)"), i, v.mX, v.mY, v.mTX, v.mTY, v.mTX * 2, v.mTY * 2);
     NGL_OUT(_T("%s\n"), f.GetChars());
   }
   
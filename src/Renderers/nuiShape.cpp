@@ -7,11 +7,14 @@
 
 #include "nui.h"
 
+static std::atomic<uint64> gShapeRevision(0);
 
 // class nuiShape
 nuiShape::nuiShape()
 {
   mWinding = eNone;
+  mRevision = ++gShapeRevision;
+  mRevisionUsed = false;
 }
 
 nuiShape::nuiShape(const nuiShape& rShape)
@@ -40,20 +43,21 @@ void nuiShape::Clear()
   for (it = mpContours.begin(); it != end; ++it)
     delete (*it);
 
-  EmptyCaches();
-
   mpContours.clear();
+  Changed();
 }
 
 void nuiShape::AddContour(nuiContour* pContour)
 {
   mpContours.push_back(pContour);
+  Changed();
 }
 
 void nuiShape::AddContour()
 {
   nuiContour* pContour = new nuiContour();
   mpContours.push_back(pContour);
+  Changed();
 }
 
 void nuiShape::CloseContour()
@@ -61,6 +65,7 @@ void nuiShape::CloseContour()
   if (mpContours.empty())
     return;
   mpContours.back()->Close();
+  Changed();
 }
 
 void nuiShape::ArcTo(float X, float Y, float XRadius, float YRadius, float Angle, bool LargeArc, bool Sweep)
@@ -69,6 +74,7 @@ void nuiShape::ArcTo(float X, float Y, float XRadius, float YRadius, float Angle
     AddContour();
 
   mpContours.back()->ArcTo(nuiPoint(X, Y), XRadius, YRadius, Angle, LargeArc, Sweep);
+  Changed();
 }
 
 void nuiShape::AddLines(const nuiPath& rVertices)
@@ -77,6 +83,7 @@ void nuiShape::AddLines(const nuiPath& rVertices)
     AddContour();
 
   mpContours.back()->AddLines(rVertices);
+  Changed();
 }
 
 void nuiShape::AddPath(const nuiPath& rVertices)
@@ -113,6 +120,7 @@ void nuiShape::LineTo(const nuiPoint& rVertex)
     AddContour();
 
   mpContours.back()->LineTo(rVertex);
+  Changed();
 }
 
 void nuiShape::AddSpline(const nuiSpline& rSpline)
@@ -121,6 +129,7 @@ void nuiShape::AddSpline(const nuiSpline& rSpline)
     AddContour();
 
   mpContours.back()->AddSpline(rSpline);
+  Changed();
 }
 
 void nuiShape::AddPathGenerator(nuiPathGenerator* pPath)
@@ -129,6 +138,7 @@ void nuiShape::AddPathGenerator(nuiPathGenerator* pPath)
     AddContour();
 
   mpContours.back()->AddPathGenerator(pPath);
+  Changed();
 }
 
 nuiContour* nuiShape::GetContour(uint Index) const
@@ -165,11 +175,29 @@ nuiShape::Winding nuiShape::GetWinding() const
 void nuiShape::SetWinding(nuiShape::Winding Rule)
 {
   mWinding = Rule;
-  //Changed();
+  Changed();
 }
 
 void nuiShape::EmptyCaches()
 {
+  if (mRevisionUsed)
+    nuiTessellationCache::Forget(mRevision);
+}
+
+void nuiShape::Changed()
+{
+  if (!mRevisionUsed)
+    return;
+
+  EmptyCaches();
+  mRevision = ++gShapeRevision;
+  mRevisionUsed = false;
+}
+
+uint64 nuiShape::GetRevision() const
+{
+  mRevisionUsed = true;
+  return mRevision;
 }
 
 
@@ -221,6 +249,7 @@ void nuiShape::AddRect(const nuiRect& rRect, bool CCW)
 {
   AddContour();
   mpContours.back()->AddRect(rRect, CCW);
+  Changed();
 }
 
 void nuiShape::AddRoundRect(const nuiRect& rRect, float Radius, bool CCW, float Quality)
@@ -381,6 +410,7 @@ void nuiShape::AddArc(float cX, float cY, float rX, float rY, float Theta1InDegr
 {
   AddContour();
   mpContours.back()->AddArc(cX, cY, rX, rY, Theta1InDegree, Theta2InDegree, Phi);
+  Changed();
 }
 
 
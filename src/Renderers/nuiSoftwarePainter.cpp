@@ -27,6 +27,8 @@
 #include "nuiVertex.h"
 #include "nuiPixelBlender.h"
 #include "nuiRasterizer.h"
+#include "nuiCoverageRasterizer.h"
+#include "nuiOutliner.h"
 
 /*
 Shark result: 
@@ -111,20 +113,33 @@ nuiSoftwarePainter::nuiSoftwarePainter(nglContext* pContext)
   mWidth = 0;
   mHeight = 0;
   mpRasterizer = new nuiRasterizer(mWidth, mHeight);
+  mRenderThreads = 0;
+  mTileSize = 64;
+  mTilesX = 0;
+  mTilesY = 0;
+  mNextTile = 0;
+  mShapeAntialiasing = true;
+  mCoverageCount = 0;
   AddNeedTextureBackingStore();
 }
 
 nuiSoftwarePainter::~nuiSoftwarePainter()
 {
+  Flush();
+  delete mpRasterizer;
+  for (uint32 i = 0; i < mCoverages.size(); i++)
+    delete mCoverages[i];
   DelNeedTextureBackingStore();
 }
 
 
 void nuiSoftwarePainter::SetSize(uint sizex, uint sizey)
 {
+  Flush();
   mWidth = sizex;
   mHeight = sizey;
   mpRasterizer->Resize(mWidth, mHeight);
+  ResizeTiles();
 }
 
 void nuiSoftwarePainter::StartRendering()
@@ -132,113 +147,487 @@ void nuiSoftwarePainter::StartRendering()
   nuiPainter::StartRendering();
 }
 
-void nuiSoftwarePainter::SetState(const nuiRenderState& rState, bool ForceApply)
+void nuiSoftwarePainter::GetClipRect(int32& rX0, int32& rY0, int32& rX1, int32& rY1) const
 {
-  mpState = &rState;
+  if (!mClip.mEnabled)
+  {
+    rX0 = 0;
+    rY0 = 0;
+    rX1 = mWidth;
+    rY1 = mHeight;
+    return;
+  }
 
   int32 x = MIN(ToNearest(mClip.Left()), (int32)mWidth);
   int32 y = MIN(ToNearest(mClip.Top()), (int32)mHeight);
   int32 xt = MIN(ToNearest(mClip.Right()), (int32)mWidth);
   int32 yt = MIN(ToNearest(mClip.Bottom()), (int32)mHeight);
   
-  x = MAX(0, x);
-  y = MAX(0, y);
-  xt = MAX(0, xt);
-  yt = MAX(0, yt);
-  
-  if (mClip.mEnabled)
-    mpRasterizer->SetClipRect(x, y, xt, yt);
-  else
-    mpRasterizer->SetClipRect(0,0, mWidth, mHeight);  
+  rX0 = MAX(0, x);
+  rY0 = MAX(0, y);
+  rX1 = MAX(0, xt);
+  rY1 = MAX(0, yt);
+}
+
+void nuiSoftwarePainter::SetState(const nuiRenderState& rState, bool ForceApply)
+{
+  mpState = &rState;
+
+  int32 x, y, xt, yt;
+  GetClipRect(x, y, xt, yt);
+  mpRasterizer->SetClipRect(x, y, xt, yt);
+}
+
+bool nuiSoftwarePainter::IsBinning() const
+{
+  return mRenderThreads != 1;
 }
 
 void nuiSoftwarePainter::DrawArray(nuiRenderArray* pArray)
 {
-  if (!mEnableDrawArray)
+  if (!mEnableDrawArray || pArray->GetMode() == GL_POINTS)
   {
+    //NGL_OUT(_T("GL_POINTS Not Implemented\n"));
     pArray->Release();
     return;
   }
-  
+
+  // The rasterizer reads full vertices:
+  if (pArray->GetFormat() != nuiRenderArray::eFormatFull)
+  {
+    nuiRenderArray* pFull = new nuiRenderArray(*pArray);
+    pFull->SetFormat(nuiRenderArray::eFormatFull);
+    pArray->Release();
+    pArray = pFull;
+  }
+
+  if (!IsBinning())
+  {
+    mPrimitives.clear();
+    GetPrimitives(pArray, mPrimitives);
+    for (uint32 i = 0; i < mPrimitives.size(); i++)
+      DrawPrimitive(mpRasterizer, mpState, mMatrixStack.top(), pArray, mPrimitives[i]);
+
+    pArray->Release();
+    return;
+  }
+
+  // Keep the array (it was acquired for us) and a copy of the state until the tiles are rasterized:
+  if (mStates.empty() || !(*mStates.back() == *mpState))
+    mStates.push_back(new nuiRenderState(*mpState));
+
+  const int32 command = mCommands.size();
+  mCommands.resize(command + 1);
+  Command& rCommand(mCommands.back());
+  rCommand.mpArray = pArray;
+  rCommand.mpCoverage = NULL;
+  rCommand.mState = mStates.size() - 1;
+  rCommand.mMatrix = mMatrixStack.top();
+  rCommand.mColor = 0;
+  rCommand.mBlendFunc = nuiBlendSource;
+  GetClipRect(rCommand.mClipX0, rCommand.mClipY0, rCommand.mClipX1, rCommand.mClipY1);
+  rCommand.mPrimitives.clear();
+  GetPrimitives(pArray, rCommand.mPrimitives);
+
+  const int32 count = rCommand.mPrimitives.size();
+  for (int32 i = 0; i < count; i++)
+    BinPrimitive(command, i);
+}
+
+bool nuiSoftwarePainter::DrawShape(nuiShape* pShape, nuiShapeMode Mode, float Quality)
+{
+  if (!mShapeAntialiasing || !mEnableDrawArray || Mode == eDefault)
+    return false;
+  // The spans only carry a plain color:
+  if (mpState->mpTexture[0] && mpState->mTexturing)
+    return false;
+
+  nuiShape::Winding winding = pShape->GetWinding();
+  if (winding == nuiShape::eNone)
+    winding = nuiShape::eNonZero;
+  if (Mode != eStrokeShape && winding != nuiShape::eNonZero && winding != nuiShape::eOdd)
+    return false;
+
+  if (Mode == eFillShape || Mode == eStrokeAndFillShape)
+  {
+    nuiPath path;
+    pShape->Tessellate(path, Quality);
+    FillPath(path, winding, mpState->mFillColor, mpState->mBlendFunc);
+  }
+
+  if (Mode == eStrokeShape || Mode == eStrokeAndFillShape)
+  {
+    // Same outline as nuiShape::Outline, and nuiDrawContext::DrawShape also blends the strokes:
+    nuiOutliner outliner(pShape, mpState->mLineWidth);
+    outliner.SetLineJoin(mpState->mLineJoin);
+    outliner.SetLineCap(mpState->mLineCap);
+    outliner.SetMiterLimit(mpState->mMitterLimit);
+
+    nuiPath path;
+    outliner.Tessellate(path, 1.0f);
+    FillPath(path, nuiShape::eNonZero, mpState->mStrokeColor, nuiBlendTransp);
+  }
+
+  return true;
+}
+
+void nuiSoftwarePainter::FillPath(const nuiPath& rPath, nuiShape::Winding Rule, const nuiColor& rColor, nuiBlendFunc BlendFunc)
+{
+  const uint32 color = NUI_RGBA_F(rColor.Red(), rColor.Green(), rColor.Blue(), rColor.Alpha());
+  int32 x0, y0, x1, y1;
+  GetClipRect(x0, y0, x1, y1);
+
+  if (mCoverageCount == mCoverages.size())
+    mCoverages.push_back(new nuiCoverageRasterizer());
+  nuiCoverageRasterizer* pCoverage = mCoverages[mCoverageCount];
+  pCoverage->Reset(x0, y0, x1, y1);
+  pCoverage->AddPath(rPath, mMatrixStack.top());
+  pCoverage->Sweep(Rule);
+  if (pCoverage->IsEmpty())
+    return;
+
+  if (!IsBinning())
+  {
+    DrawCoverage(mpRasterizer, *pCoverage, color, BlendFunc);
+    return;
+  }
+
+  // Keep the spans until the tiles are rasterized:
+  mCoverageCount++;
+  const int32 command = mCommands.size();
+  mCommands.resize(command + 1);
+  Command& rCommand(mCommands.back());
+  rCommand.mpArray = NULL;
+  rCommand.mpCoverage = pCoverage;
+  rCommand.mState = -1;
+  rCommand.mMatrix = mMatrixStack.top();
+  rCommand.mColor = color;
+  rCommand.mBlendFunc = BlendFunc;
+  rCommand.mClipX0 = x0;
+  rCommand.mClipY0 = y0;
+  rCommand.mClipX1 = x1;
+  rCommand.mClipY1 = y1;
+  rCommand.mPrimitives.clear();
+
+  pCoverage->GetBounds(x0, y0, x1, y1);
+  BinRect(command, -1, x0, y0, x1, y1);
+}
+
+void nuiSoftwarePainter::DrawCoverage(nuiRasterizer* pRasterizer, const nuiCoverageRasterizer& rCoverage, uint32 Color, nuiBlendFunc BlendFunc)
+{
+  switch (BlendFunc)
+  {
+    case nuiBlendTransp:
+      pRasterizer->DrawCoverage<nuiPixelBlender_Transp>(rCoverage, Color);
+      break;
+    case nuiBlendTranspAdd:
+      pRasterizer->DrawCoverage<nuiPixelBlender_TranspAdd>(rCoverage, Color);
+      break;
+    case nuiBlendSource:
+    default:
+      pRasterizer->DrawCoverage<nuiPixelBlender_Copy>(rCoverage, Color);
+      break;
+  }
+}
+
+void nuiSoftwarePainter::Clear(bool color, bool depth, bool stencil)
+{
+  if (color)
+    ClearColor();
+  if (stencil)
+  {
+    Flush();
+    mpRasterizer->ClearStencil(0);
+  }
+}
+
+void nuiSoftwarePainter::ClearColor()
+{
+  uint32 col = NUI_RGBA_F(mpState->mClearColor.Red(), mpState->mClearColor.Green(), mpState->mClearColor.Blue(), mpState->mClearColor.Alpha());
+
+  if (!IsBinning())
+  {
+    mpRasterizer->ClearColor(col);
+    return;
+  }
+
+  const int32 command = mCommands.size();
+  mCommands.resize(command + 1);
+  Command& rCommand(mCommands.back());
+  rCommand.mpArray = NULL;
+  rCommand.mpCoverage = NULL;
+  rCommand.mState = -1;
+  rCommand.mColor = col;
+  rCommand.mBlendFunc = nuiBlendSource;
+  GetClipRect(rCommand.mClipX0, rCommand.mClipY0, rCommand.mClipX1, rCommand.mClipY1);
+  rCommand.mPrimitives.clear();
+  BinRect(command, -1, rCommand.mClipX0, rCommand.mClipY0, rCommand.mClipX1, rCommand.mClipY1);
+}
+
+void nuiSoftwarePainter::BeginSession()
+{
+}
+
+void nuiSoftwarePainter::EndSession()
+{
+  Flush();
+}
+
+void nuiSoftwarePainter::DestroySurface(nuiSurface* pSurface)
+{
+}
+
+void nuiSoftwarePainter::DestroyRenderArray(nuiRenderArray* pArray)
+{
+}
+
+void nuiSoftwarePainter::DestroyTexture(nuiTexture* pTexture)
+{
+}
+
+void nuiSoftwarePainter::SetRenderThreads(uint32 Threads)
+{
+  Flush();
+  mRenderThreads = Threads;
+}
+
+uint32 nuiSoftwarePainter::GetRenderThreads() const
+{
+  return mRenderThreads;
+}
+
+void nuiSoftwarePainter::SetShapeAntialiasing(bool Set)
+{
+  mShapeAntialiasing = Set;
+}
+
+bool nuiSoftwarePainter::GetShapeAntialiasing() const
+{
+  return mShapeAntialiasing;
+}
+
+void nuiSoftwarePainter::SetTileSize(int32 TileSize)
+{
+  Flush();
+  mTileSize = MAX(8, TileSize);
+  ResizeTiles();
+}
+
+int32 nuiSoftwarePainter::GetTileSize() const
+{
+  return mTileSize;
+}
+
+void nuiSoftwarePainter::ResizeTiles()
+{
+  mTilesX = (mWidth + mTileSize - 1) / mTileSize;
+  mTilesY = (mHeight + mTileSize - 1) / mTileSize;
+  mTiles.resize(mTilesX * mTilesY);
+  for (int32 y = 0; y < mTilesY; y++)
+  {
+    for (int32 x = 0; x < mTilesX; x++)
+    {
+      Tile& rTile(mTiles[y * mTilesX + x]);
+      rTile.mX0 = x * mTileSize;
+      rTile.mY0 = y * mTileSize;
+      rTile.mX1 = MIN(rTile.mX0 + mTileSize, (int32)mWidth);
+      rTile.mY1 = MIN(rTile.mY0 + mTileSize, (int32)mHeight);
+      rTile.mEntries.clear();
+    }
+  }
+}
+
+void nuiSoftwarePainter::BinPrimitive(int32 command, int32 primitive)
+{
+  const Command& rCommand(mCommands[command]);
+  const Primitive& rPrimitive(rCommand.mPrimitives[primitive]);
+  const std::vector<nuiRenderArray::Vertex>& rVertices(rCommand.mpArray->GetVertices());
+
+  float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  for (int32 i = 0; i < rPrimitive.mCount; i++)
+  {
+    const nuiRenderArray::Vertex& rVertex(rVertices[rPrimitive.mIndices[i]]);
+    nuiVector vec(rVertex.mX, rVertex.mY, 0.0f);
+    vec = rCommand.mMatrix * vec;
+    if (!i)
+    {
+      x0 = x1 = vec[0];
+      y0 = y1 = vec[1];
+    }
+    else
+    {
+      x0 = MIN(x0, vec[0]);
+      y0 = MIN(y0, vec[1]);
+      x1 = MAX(x1, vec[0]);
+      y1 = MAX(y1, vec[1]);
+    }
+  }
+
+  // Grow the bounding box by a pixel so the rounding of the rasterizer can't leave a tile out:
+  BinRect(command, primitive, ToBelow(x0) - 1, ToBelow(y0) - 1, ToAbove(x1) + 1, ToAbove(y1) + 1);
+}
+
+void nuiSoftwarePainter::BinRect(int32 command, int32 primitive, int32 X0, int32 Y0, int32 X1, int32 Y1)
+{
+  const Command& rCommand(mCommands[command]);
+  X0 = MAX(X0, rCommand.mClipX0);
+  Y0 = MAX(Y0, rCommand.mClipY0);
+  X1 = MIN(X1, rCommand.mClipX1);
+  Y1 = MIN(Y1, rCommand.mClipY1);
+  if (X0 >= X1 || Y0 >= Y1)
+    return;
+
+  const int32 tx0 = X0 / mTileSize;
+  const int32 ty0 = Y0 / mTileSize;
+  const int32 tx1 = MIN((X1 - 1) / mTileSize, mTilesX - 1);
+  const int32 ty1 = MIN((Y1 - 1) / mTileSize, mTilesY - 1);
+  for (int32 y = ty0; y <= ty1; y++)
+    for (int32 x = tx0; x <= tx1; x++)
+      mTiles[y * mTilesX + x].mEntries.push_back(TileEntry(command, primitive));
+}
+
+void nuiSoftwarePainter::Flush()
+{
+  if (mCommands.empty())
+    return;
+
+  uint32 threads = mRenderThreads;
+  nuiTaskPool& rPool(nuiTaskPool::GetDefault());
+  if (!threads)
+    threads = rPool.GetThreadCount();
+
+  // Each thread takes the next tile to render until they are all done. The tiles don't overlap so no locking is needed.
+  mNextTile = 0;
+  nuiTaskGroup group;
+  for (uint32 t = 1; t < threads; t++)
+    rPool.Post(nuiMakeTask(this, &nuiSoftwarePainter::RenderTiles), nuiTaskPool::eHigh, &group);
+  RenderTiles();
+  rPool.Wait(group);
+
+  for (uint32 i = 0; i < mTiles.size(); i++)
+    mTiles[i].mEntries.clear();
+  for (uint32 i = 0; i < mCommands.size(); i++)
+  {
+    if (mCommands[i].mpArray)
+      mCommands[i].mpArray->Release();
+  }
+  mCommands.clear();
+  mCoverageCount = 0;
+  for (uint32 i = 0; i < mStates.size(); i++)
+    delete mStates[i];
+  mStates.clear();
+}
+
+void nuiSoftwarePainter::RenderTiles()
+{
+  const int32 count = mTiles.size();
+  int32 tile;
+  while ((tile = mNextTile++) < count)
+  {
+    if (!mTiles[tile].mEntries.empty())
+      RenderTile(mTiles[tile]);
+  }
+}
+
+void nuiSoftwarePainter::RenderTile(Tile& rTile)
+{
+  // A rasterizer of our own that draws in the shared buffer:
+  nuiRasterizer rasterizer(mWidth, mHeight, mpRasterizer->GetBuffer());
+
+  for (uint32 i = 0; i < rTile.mEntries.size(); i++)
+  {
+    const TileEntry& rEntry(rTile.mEntries[i]);
+    const Command& rCommand(mCommands[rEntry.mCommand]);
+    const int32 x0 = MAX(rTile.mX0, rCommand.mClipX0);
+    const int32 y0 = MAX(rTile.mY0, rCommand.mClipY0);
+    const int32 x1 = MIN(rTile.mX1, rCommand.mClipX1);
+    const int32 y1 = MIN(rTile.mY1, rCommand.mClipY1);
+    rasterizer.SetClipRect(x0, y0, x1, y1);
+
+    if (rCommand.mpCoverage)
+      DrawCoverage(&rasterizer, *rCommand.mpCoverage, rCommand.mColor, rCommand.mBlendFunc);
+    else if (rEntry.mPrimitive < 0)
+      rasterizer.ClearColor(rCommand.mColor);
+    else
+      DrawPrimitive(&rasterizer, mStates[rCommand.mState], rCommand.mMatrix, rCommand.mpArray, rCommand.mPrimitives[rEntry.mPrimitive]);
+  }
+}
+
+
+void nuiSoftwarePainter::GetPrimitives(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
+{
   switch (pArray->GetMode())
   {
   case GL_POINTS:
     //NGL_OUT(_T("GL_POINTS Not Implemented\n"));
     break;
   case GL_LINES:
-    DrawLines(pArray);
+    GetLines(pArray, rPrimitives);
     break;
   case GL_LINE_STRIP:
-    DrawLineStrip(pArray);
+    GetLineStrip(pArray, rPrimitives);
     break;
   case GL_LINE_LOOP:
-    DrawLineLoop(pArray);
+    GetLineLoop(pArray, rPrimitives);
     break;
   case GL_TRIANGLES:
-    DrawTriangles(pArray);
+    GetTriangles(pArray, rPrimitives);
     break;
   case GL_TRIANGLE_FAN:
-    DrawTrianglesFan(pArray);
+    GetTrianglesFan(pArray, rPrimitives);
     break;
   case GL_TRIANGLE_STRIP:
-    DrawTrianglesStrip(pArray);
+    GetTrianglesStrip(pArray, rPrimitives);
     break;
 //  case GL_QUADS:
-//    DrawQuads(pArray);
+//    GetQuads(pArray, rPrimitives);
 //    break;
 //  case GL_QUAD_STRIP:
-//    DrawQuadStrip(pArray);
+//    GetQuadStrip(pArray, rPrimitives);
 //    break;
 //  case GL_POLYGON:
 //    //NGL_OUT(_T("GL_POLYGON Not Implemented\n"));
 //    break;
   }
-
-  pArray->Release();
 }
 
-void nuiSoftwarePainter::ClearColor()
+void nuiSoftwarePainter::DrawPrimitive(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, const Primitive& rPrimitive)
 {
-  uint32 col = NUI_RGBA_F(mpState->mClearColor.Red(), mpState->mClearColor.Green(), mpState->mClearColor.Blue(), mpState->mClearColor.Alpha());
-  mpRasterizer->ClearColor(col);
-
-}
-
-void nuiSoftwarePainter::BeginSession()
-{
-}
-
-void nuiSoftwarePainter::EndSession()
-{
-}
-
-void nuiSoftwarePainter::ReleaseCacheObject(void* pHandle)
-{
-
+  const int32* pIndices = rPrimitive.mIndices;
+  switch (rPrimitive.mCount)
+  {
+  case 2:
+    DrawLine(pRasterizer, pState, rMatrix, pArray, pIndices[0], pIndices[1]);
+    break;
+  case 3:
+    DrawTriangle(pRasterizer, pState, rMatrix, pArray, pIndices[0], pIndices[1], pIndices[2]);
+    break;
+  case 4:
+    DrawRectangle(pRasterizer, pState, rMatrix, pArray, pIndices[0], pIndices[1], pIndices[2], pIndices[3]);
+    break;
+  }
 }
 
-
-
-void nuiSoftwarePainter::DrawLines(const nuiRenderArray* pArray)
+void nuiSoftwarePainter::GetLines(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 count = pArray->GetSize() / 2;
   for (int32 i = 0; i < count; i++)
   {
     int32 ii = i << 1;
-    DrawLine(pArray, ii, ii+1);
+    rPrimitives.push_back(Primitive(ii, ii+1));
   }
 }
 
-void nuiSoftwarePainter::DrawLineStrip(const nuiRenderArray* pArray)
+void nuiSoftwarePainter::GetLineStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 count = pArray->GetSize() - 1;
   for (int32 i = 0; i < count; i++)
   {
-    DrawLine(pArray, i, i + 1);
+    rPrimitives.push_back(Primitive(i, i + 1));
   }
 }
 
-void nuiSoftwarePainter::DrawLineLoop(const nuiRenderArray* pArray)
+void nuiSoftwarePainter::GetLineLoop(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 s = pArray->GetSize();
   int32 count = s / 2;
@@ -246,49 +635,49 @@ void nuiSoftwarePainter::DrawLineLoop(const nuiRenderArray* pArray)
   for (int32 i = 0; i < count; i++)
   {
     int32 ii = i << 1;
-    DrawLine(pArray, ii, (ii + 1) % s);
+    rPrimitives.push_back(Primitive(ii, (ii + 1) % s));
   }
 }
 
-// DrawTriangles (GL_TRIANGLES)
-void nuiSoftwarePainter::DrawTriangles(const nuiRenderArray* pArray)
+// GetTriangles (GL_TRIANGLES)
+void nuiSoftwarePainter::GetTriangles(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 i;
   int32 count = pArray->GetSize() / 3;
   for (i = 0; i < count; i++)
   {
     uint32 ii = i *3;
-    DrawTriangle(pArray, ii, ii+1, ii+2);
+    rPrimitives.push_back(Primitive(ii, ii+1, ii+2));
   }
 }
 
-// DrawTrianglesFan (GL_TRIANGLE_FAN)
-void nuiSoftwarePainter::DrawTrianglesFan(const nuiRenderArray* pArray)
+// GetTrianglesFan (GL_TRIANGLE_FAN)
+void nuiSoftwarePainter::GetTrianglesFan(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 i;
   int32 count = pArray->GetSize() - 1;
   for (i = 1; i < count; i++)
   {
-    DrawTriangle(pArray, 0, i, i + 1);
+    rPrimitives.push_back(Primitive(0, i, i + 1));
   }
 }
 
-// DrawTrianglesStrip (GL_TRIANGLE_STRIP)
-void nuiSoftwarePainter::DrawTrianglesStrip(const nuiRenderArray* pArray)
+// GetTrianglesStrip (GL_TRIANGLE_STRIP)
+void nuiSoftwarePainter::GetTrianglesStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 i;
   int32 count = pArray->GetSize() - 2;
   for (i = 0; i < count; i++)
   {
     if (i & 1)
-      DrawTriangle(pArray, i, i + 1, i + 2);
+      rPrimitives.push_back(Primitive(i, i + 1, i + 2));
     else
-      DrawTriangle(pArray, i + 1, i, i + 2);
+      rPrimitives.push_back(Primitive(i + 1, i, i + 2));
   }
 }
 
-// DrawQuads (GL_QUADS)
-void nuiSoftwarePainter::DrawQuads(const nuiRenderArray* pArray)
+// GetQuads (GL_QUADS)
+void nuiSoftwarePainter::GetQuads(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 i;
   int32 count = pArray->GetSize() / 4;
@@ -307,19 +696,19 @@ void nuiSoftwarePainter::DrawQuads(const nuiRenderArray* pArray)
     if (x0 == x3 && x1 == x2 && y0 == y1 && y2 == y3)
     {
       // This is an axis aligned rectangle
-      DrawRectangle(pArray, ii, ii+1, ii+2, ii+3);
+      rPrimitives.push_back(Primitive(ii, ii+1, ii+2, ii+3));
     }
     else
     {
       // This is not a special quad, draw two triangles:
-      DrawTriangle(pArray, ii, ii+1, ii+2);
-      DrawTriangle(pArray, ii, ii+2, ii+3);
+      rPrimitives.push_back(Primitive(ii, ii+1, ii+2));
+      rPrimitives.push_back(Primitive(ii, ii+2, ii+3));
     }
   }
 }
 
-// DrawQuads (GL_QUADS)
-void nuiSoftwarePainter::DrawQuadStrip(const nuiRenderArray* pArray)
+// GetQuadStrip (GL_QUAD_STRIP)
+void nuiSoftwarePainter::GetQuadStrip(const nuiRenderArray* pArray, std::vector<Primitive>& rPrimitives) const
 {
   int32 i;
   int32 count = (pArray->GetSize() - 2) / 2;
@@ -337,18 +726,19 @@ void nuiSoftwarePainter::DrawQuadStrip(const nuiRenderArray* pArray)
     if (x0 == x3 && x1 == x2 && y0 == y1 && y2 == y3)
     {
       // This is an axis aligned rectangle
-      DrawRectangle(pArray, ii, ii+1, ii+3, ii+2);
+      rPrimitives.push_back(Primitive(ii, ii+1, ii+3, ii+2));
     }
     else
     {
       // This is not a special quad, draw two triangles:
-      DrawTriangle(pArray, ii, ii+1, ii+2);
-      DrawTriangle(pArray, ii+1, ii+3, ii+2);
+      rPrimitives.push_back(Primitive(ii, ii+1, ii+2));
+      rPrimitives.push_back(Primitive(ii+1, ii+3, ii+2));
     }
   }
 }
 
-void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
+
+void nuiSoftwarePainter::DrawLine(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2)
 {
   // Prepare the line points:
 
@@ -364,8 +754,8 @@ void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
   nuiVector vec1(x1,y1, 0.0f);
   nuiVector vec2(x2,y2, 0.0f);
 
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
+  vec1 = rMatrix * vec1;
+  vec2 = rMatrix * vec2;
 
   x1 = vec1[0] + xbias; y1 = vec1[1] + ybias;
   x2 = vec2[0] + xbias; y2 = vec2[1] + ybias;
@@ -380,7 +770,7 @@ void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
   }
   else
   {
-    c1 = c2 = mpState->mFillColor;
+    c1 = c2 = pState->mFillColor;
   }
 
   // Texture coords:
@@ -396,9 +786,9 @@ void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
   }
   
   
-  if (mpState->mpTexture && mpState->mTexturing)
+  if (pState->mpTexture[0] && pState->mTexturing)
   {
-    nuiTexture* pTexture = mpState->mpTexture;
+    nuiTexture* pTexture = pState->mpTexture[0];
     int32 width = pTexture->GetImage()->GetWidth();
     int32 height = pTexture->GetImage()->GetHeight();
     
@@ -416,7 +806,7 @@ void nuiSoftwarePainter::DrawLine(const nuiRenderArray* pArray, int p1, int p2)
 nuiModulatedColor<nuiTexelColor<Y>, nuiGouraudColor>(nuiTexelColor<Y>(pTexture, u##NUM, v##NUM), nuiGouraudColor(c##NUM)))
       
 #define RASTERIZE(X, Y) \
-mpRasterizer->DrawLine<X>(VERTEX(Y, 1), VERTEX(Y, 2));
+pRasterizer->DrawLine<X>(VERTEX(Y, 1), VERTEX(Y, 2));
       
 #define RASTERIZERS(X) \
 case eImagePixelRGB:\
@@ -429,7 +819,10 @@ case eImagePixelLum:\
 RASTERIZE(X, nuiTexelAccessor_Lum);\
 break;\
 case eImagePixelAlpha:\
-RASTERIZE(X, nuiTexelAccessor_Alpha);\
+if (pState->mpTexture[0]->GetDistanceFieldSpread() > 0)\
+{ RASTERIZE(X, nuiTexelAccessor_DistanceField); }\
+else\
+{ RASTERIZE(X, nuiTexelAccessor_Alpha); }\
 break;\
 case eImagePixelLumA:\
 RASTERIZE(X, nuiTexelAccessor_LumA);\
@@ -437,10 +830,10 @@ break; \
 case eImagePixelNone: break; \
 case eImagePixelIndex: break; 
 
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Transp);
             default:
@@ -448,7 +841,7 @@ case eImagePixelIndex: break;
           }
           break;
         case nuiBlendTranspAdd:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_TranspAdd);
             default:
@@ -457,7 +850,7 @@ case eImagePixelIndex: break;
           break;
         case nuiBlendSource:
         default:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Copy);
             default:
@@ -468,21 +861,21 @@ case eImagePixelIndex: break;
     }
     //    else
     //    {
-    //      switch (mpState->mBlendFunc)
+    //      switch (pState->mBlendFunc)
     //      {
     //        case nuiBlendTransp:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                             nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                             nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
     //        case nuiBlendTranspAdd:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                                nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                                nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
     //        case nuiBlendSource:
     //        default:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                           nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                           nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
@@ -497,37 +890,37 @@ case eImagePixelIndex: break;
     { // One Color:
       const uint32 col = NUI_RGBA_F(c1.Red(), c1.Green(), c1.Blue(), c1.Alpha());
       
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          mpRasterizer->DrawLine<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
+          pRasterizer->DrawLine<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawLine<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
+          pRasterizer->DrawLine<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawLine<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
+          pRasterizer->DrawLine<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col));
           break;
       }
     }
     else
     {
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          mpRasterizer->DrawLine<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawLine<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                              nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2))
                                                              );
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawLine<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawLine<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                                 nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2))
                                                                 );
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawLine<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawLine<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                            nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2))
                                                            );
           break;
@@ -537,7 +930,7 @@ case eImagePixelIndex: break;
 }
 
 
-void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int p2, int p3)
+void nuiSoftwarePainter::DrawTriangle(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2, int p3)
 {
   // Prepare the triangle points:
 
@@ -552,9 +945,9 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
   nuiVector vec2(x2,y2, 0.0f);
   nuiVector vec3(x3,y3, 0.0f);
 
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
-  vec3 = mMatrixStack.top() * vec3;
+  vec1 = rMatrix * vec1;
+  vec2 = rMatrix * vec2;
+  vec3 = rMatrix * vec3;
 
   x1 = vec1[0]; y1 = vec1[1];
   x2 = vec2[0]; y2 = vec2[1];
@@ -577,7 +970,7 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
       case GL_LINES:
       case GL_LINE_LOOP:
       case GL_LINE_STRIP:
-        c1 = c2 = c3 = mpState->mStrokeColor;
+        c1 = c2 = c3 = pState->mStrokeColor;
         break;
         
       case GL_TRIANGLES:
@@ -586,7 +979,7 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
 //      case GL_QUADS:
 //      case GL_QUAD_STRIP:
 //      case GL_POLYGON:
-        c1 = c2 = c3 = mpState->mFillColor;
+        c1 = c2 = c3 = pState->mFillColor;
         break;
     }
   }
@@ -606,9 +999,9 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
     v3 = rVertices[p3].mTY;
   }
 
-  if (mpState->mpTexture && mpState->mTexturing)
+  if (pState->mpTexture[0] && pState->mTexturing)
   {
-    nuiTexture* pTexture = mpState->mpTexture;
+    nuiTexture* pTexture = pState->mpTexture[0];
     int32 width = pTexture->GetImage()->GetWidth();
     int32 height = pTexture->GetImage()->GetHeight();
 
@@ -627,7 +1020,7 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
       nuiModulatedColor<nuiTexelColor<Y>, nuiGouraudColor>(nuiTexelColor<Y>(pTexture, u##NUM, v##NUM), nuiGouraudColor(c##NUM)))
 
 #define RASTERIZE(X, Y) \
-  mpRasterizer->DrawTriangle<X>( \
+  pRasterizer->DrawTriangle<X>( \
     VERTEX(Y, 1), \
     VERTEX(Y, 2), \
     VERTEX(Y, 3) \
@@ -644,7 +1037,10 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
       RASTERIZE(X, nuiTexelAccessor_Lum);\
       break;\
     case eImagePixelAlpha:\
-      RASTERIZE(X, nuiTexelAccessor_Alpha);\
+      if (pState->mpTexture[0]->GetDistanceFieldSpread() > 0)\
+      { RASTERIZE(X, nuiTexelAccessor_DistanceField); }\
+      else\
+      { RASTERIZE(X, nuiTexelAccessor_Alpha); }\
       break;\
     case eImagePixelLumA:\
       RASTERIZE(X, nuiTexelAccessor_LumA);\
@@ -652,10 +1048,10 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
 	case eImagePixelNone: break; \
 	case eImagePixelIndex: break;
       
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Transp);
             default:
@@ -663,7 +1059,7 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
           }
           break;
         case nuiBlendTranspAdd:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_TranspAdd);
             default:
@@ -672,7 +1068,7 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
           break;
         case nuiBlendSource:
         default:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Copy);
             default:
@@ -683,21 +1079,21 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
     }
 //    else
 //    {
-//      switch (mpState->mBlendFunc)
+//      switch (pState->mBlendFunc)
 //      {
 //        case nuiBlendTransp:
-//          mpRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+//          pRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
 //                                                             nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
 //                                                             nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
 //          break;
 //        case nuiBlendTranspAdd:
-//          mpRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+//          pRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
 //                                                                nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
 //                                                                nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
 //          break;
 //        case nuiBlendSource:
 //        default:
-//          mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+//          pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
 //                                                           nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
 //                                                           nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
 //          break;
@@ -712,49 +1108,49 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
     { // One Color:
       const uint32 col = NUI_RGBA_F(c1.Red(), c1.Green(), c1.Blue(), c1.Alpha());
       
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
           if (c1.Alpha() < 1.0f)
-            mpRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
+            pRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
           else
-            mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
+            pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
+          pRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
+          pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col));
           break;
       }
     }
     else
     {
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
           if ((c1.Alpha() < 1.0f) && (c2.Alpha() < 1.0f) && (c3.Alpha() < 1.0f))
           {
-            mpRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+            pRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                                nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                                nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
           }
           else
           {
-            mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+            pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                                nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                                nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
           }
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                                 nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                                 nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                            nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                            nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
           break;
@@ -763,14 +1159,14 @@ void nuiSoftwarePainter::DrawTriangle(const nuiRenderArray* pArray, int p1, int
   }
 }
 
-void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int p2, int p3, int p4)
+void nuiSoftwarePainter::DrawRectangle(nuiRasterizer* pRasterizer, const nuiRenderState* pState, const nuiMatrix& rMatrix, const nuiRenderArray* pArray, int p1, int p2, int p3, int p4)
 {
   // Coordinates:
   const std::vector<nuiRenderArray::Vertex>& rVertices(pArray->GetVertices());
 
   float bias = 0.0f;
 
-//  if (!mpState->mAntialiasing && !mpState->mTexturing)
+//  if (!pState->mAntialiasing && !pState->mTexturing)
 //    bias = 0.5f;
 
   float x1 = rVertices[p1].mX, y1 = rVertices[p1].mY;
@@ -783,10 +1179,10 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
   nuiVector vec3(x3,y3, 0.0f);
   nuiVector vec4(x4,y4, 0.0f);
 
-  vec1 = mMatrixStack.top() * vec1;
-  vec2 = mMatrixStack.top() * vec2;
-  vec3 = mMatrixStack.top() * vec3;
-  vec4 = mMatrixStack.top() * vec4;
+  vec1 = rMatrix * vec1;
+  vec2 = rMatrix * vec2;
+  vec3 = rMatrix * vec3;
+  vec4 = rMatrix * vec4;
 
   x1 = vec1[0] + bias; y1 = vec1[1] + bias;
   x2 = vec2[0] + bias; y2 = vec2[1] + bias;
@@ -805,7 +1201,7 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
   }
   else
   {
-    c1 = c2 = c3 = c4 = mpState->mFillColor;
+    c1 = c2 = c3 = c4 = pState->mFillColor;
   }
 
   // Texture coords:
@@ -827,9 +1223,9 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
   }
 
   
-  if (mpState->mpTexture && mpState->mTexturing)
+  if (pState->mpTexture[0] && pState->mTexturing)
   {
-    nuiTexture* pTexture = mpState->mpTexture;
+    nuiTexture* pTexture = pState->mpTexture[0];
     int32 width = pTexture->GetImage()->GetWidth();
     int32 height = pTexture->GetImage()->GetHeight();
     
@@ -846,7 +1242,7 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
     //    if (c1 == c2 && c1 == c3)
     { // One Color:
 #define RASTERIZE(X, Y) \
-  mpRasterizer->DrawRectangle<X>( \
+  pRasterizer->DrawRectangle<X>( \
     VERTEX(Y, 1), \
     VERTEX(Y, 2), \
     VERTEX(Y, 3), \
@@ -864,7 +1260,10 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
   RASTERIZE(X, nuiTexelAccessor_Lum);\
   break;\
   case eImagePixelAlpha:\
-  RASTERIZE(X, nuiTexelAccessor_Alpha);\
+  if (pState->mpTexture[0]->GetDistanceFieldSpread() > 0)\
+  { RASTERIZE(X, nuiTexelAccessor_DistanceField); }\
+  else\
+  { RASTERIZE(X, nuiTexelAccessor_Alpha); }\
   break;\
   case eImagePixelLumA:\
   RASTERIZE(X, nuiTexelAccessor_LumA);\
@@ -872,10 +1271,10 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
   case eImagePixelNone: break; \
   case eImagePixelIndex: break;
 
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Transp);
             default:
@@ -883,7 +1282,7 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
           }
           break;
         case nuiBlendTranspAdd:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_TranspAdd);
             default:
@@ -892,7 +1291,7 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
           break;
         case nuiBlendSource:
         default:
-          switch (mpState->mpTexture->GetImage()->GetPixelFormat())
+          switch (pState->mpTexture[0]->GetImage()->GetPixelFormat())
           {
             RASTERIZERS(nuiPixelBlender_Copy);
             default:
@@ -903,21 +1302,21 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
     }
     //    else
     //    {
-    //      switch (mpState->mBlendFunc)
+    //      switch (pState->mBlendFunc)
     //      {
     //        case nuiBlendTransp:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                             nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                             nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
     //        case nuiBlendTranspAdd:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                                nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                                nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
     //        case nuiBlendSource:
     //        default:
-    //          mpRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+    //          pRasterizer->DrawTriangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
     //                                                           nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
     //                                                           nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)));
     //          break;
@@ -932,39 +1331,39 @@ void nuiSoftwarePainter::DrawRectangle(const nuiRenderArray* pArray, int p1, int
     { // One Color:
       const uint32 col = NUI_RGBA_F(c1.Red(), c1.Green(), c1.Blue(), c1.Alpha());
       
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
+          pRasterizer->DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
+          pRasterizer->DrawRectangle<nuiPixelBlender_TranspAdd>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
+          pRasterizer->DrawRectangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x1, y1, col), nuiVertex_Solid(x2, y2, col), nuiVertex_Solid(x3, y3, col), nuiVertex_Solid(x4, y4, col));
           break;
       }
     }
     else
     {
-      switch (mpState->mBlendFunc)
+      switch (pState->mBlendFunc)
       {
         case nuiBlendTransp:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                               nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                               nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)),
                                                               nuiVertex_Gouraud(x4, y4, nuiGouraudColor(c4)));
           break;
         case nuiBlendTranspAdd:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawRectangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                                  nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                                  nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)),
                                                                  nuiVertex_Gouraud(x4, y4, nuiGouraudColor(c4)));
           break;
         case nuiBlendSource:
         default:
-          mpRasterizer->DrawRectangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
+          pRasterizer->DrawRectangle<nuiPixelBlender_Copy>(nuiVertex_Gouraud(x1, y1, nuiGouraudColor(c1)),
                                                             nuiVertex_Gouraud(x2, y2, nuiGouraudColor(c2)),
                                                             nuiVertex_Gouraud(x3, y3, nuiGouraudColor(c3)),
                                                             nuiVertex_Gouraud(x4, y4, nuiGouraudColor(c4)));
@@ -986,6 +1385,8 @@ void nuiSoftwarePainter::Display(nglWindow* pWindow, const nuiRect& rRect)
   if (!pInfo)
     return;
 
+  Flush();
+
   //TestAgg((char*)&mBuffer[0], mWidth, mHeight);
   
   int32 x, y, w, h;
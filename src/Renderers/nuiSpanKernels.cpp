@@ -0,0 +1,223 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiFixedPoint.h"
+#include "nuiVertex.h"
+#include "nuiSpanKernels_SIMD.h"
+
+// Scalar kernels, used as is when the CPU has no usable vector unit and by the vector kernels to process the remaining pixels.
+// The blends work on two channels at once (16 bits each), none of the intermediate values can carry into the next channel.
+static inline uint32 BlendTransp(uint32 dst, uint32 src)
+{
+  const uint32 w = nuiSpan_AlphaWeight(src >> 24);
+  const uint32 dw = 256 - w;
+  const uint32 ga = ((((dst & 0xff00ff) * dw) + ((src & 0xff00ff) * w)) >> 8) & 0x00ff00ff;
+  const uint32 rb = ((((dst >> 8) & 0xff00ff) * dw) + (((src >> 8) & 0xff00ff) * w)) & 0xff00ff00;
+  return ga | rb;
+}
+
+static inline uint32 BlendTranspAdd(uint32 dst, uint32 src)
+{
+  const uint32 w = nuiSpan_AlphaWeight(src >> 24);
+  uint32 res = dst & 0xff000000;
+  for (int32 shift = 0; shift < 24; shift += 8)
+  {
+    const uint32 c = ((dst >> shift) & 0xff) + ((((src >> shift) & 0xff) * w) >> 8);
+    res |= MIN(255, c) << shift;
+  }
+  return res;
+}
+
+static void Fill_Scalar(uint32* pDst, uint32 Color, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+    pDst[i] = Color;
+}
+
+static void FillTransp_Scalar(uint32* pDst, uint32 Color, int32 Count)
+{
+  const uint32 alpha = Color >> 24;
+  if (alpha == 255)
+  {
+    Fill_Scalar(pDst, Color, Count);
+    return;
+  }
+  if (alpha == 0)
+    return;
+
+  for (int32 i = 0; i < Count; i++)
+    pDst[i] = BlendTransp(pDst[i], Color);
+}
+
+static void FillTranspAdd_Scalar(uint32* pDst, uint32 Color, int32 Count)
+{
+  if (!(Color >> 24))
+    return;
+
+  for (int32 i = 0; i < Count; i++)
+    pDst[i] = BlendTranspAdd(pDst[i], Color);
+}
+
+static void BlendTransp_Scalar(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+    pDst[i] = BlendTransp(pDst[i], pSrc[i]);
+}
+
+static void BlendTranspAdd_Scalar(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+    pDst[i] = BlendTranspAdd(pDst[i], pSrc[i]);
+}
+
+static void Modulate_Scalar(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+  {
+    const uint32 d = pDst[i];
+    const uint32 s = pSrc[i];
+    uint32 res = 0;
+    for (int32 shift = 0; shift < 32; shift += 8)
+      res |= ((((d >> shift) & 0xff) * ((s >> shift) & 0xff)) >> 8) << shift;
+    pDst[i] = res;
+  }
+}
+
+static void Gouraud_Scalar(uint32* pDst, int32* pColor, const int32* pIncr, int32 Count)
+{
+  int32 r = pColor[0], g = pColor[1], b = pColor[2], a = pColor[3];
+  for (int32 i = 0; i < Count; i++)
+  {
+    pDst[i] = NUI_RGBA(ToNearest(r), ToNearest(g), ToNearest(b), ToNearest(a));
+    r += pIncr[0];
+    g += pIncr[1];
+    b += pIncr[2];
+    a += pIncr[3];
+  }
+  pColor[0] = r;
+  pColor[1] = g;
+  pColor[2] = b;
+  pColor[3] = a;
+}
+
+static void FetchRGB24_Scalar(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+  {
+    const uint8* pTexel = pImage + 3 * (nuiSpan_TexelCoord(U, Width) + Width * nuiSpan_TexelCoord(V, Height));
+    pDst[i] = NUI_RGBA(pTexel[0], pTexel[1], pTexel[2], 255);
+    U += IncrU;
+    V += IncrV;
+  }
+}
+
+static void FetchRGBA32_Scalar(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  for (int32 i = 0; i < Count; i++)
+  {
+    const uint8* pTexel = pImage + 4 * (nuiSpan_TexelCoord(U, Width) + Width * nuiSpan_TexelCoord(V, Height));
+    pDst[i] = NUI_RGBA(pTexel[0], pTexel[1], pTexel[2], pTexel[3]);
+    U += IncrU;
+    V += IncrV;
+  }
+}
+
+const nuiSpanKernels gSpanKernels_Scalar =
+{
+  Fill_Scalar,
+  FillTransp_Scalar,
+  FillTranspAdd_Scalar,
+  BlendTransp_Scalar,
+  BlendTranspAdd_Scalar,
+  Modulate_Scalar,
+  Gouraud_Scalar,
+  FetchRGB24_Scalar,
+  FetchRGBA32_Scalar
+};
+
+
+// Runtime dispatch:
+static const nuiSpanKernels* GetKernels(nuiSpanImplementation Implementation)
+{
+  switch (Implementation)
+  {
+#ifdef NUI_SPAN_X86
+    case eSpanSSE2:
+      return nglCPUInfo::HasSSE2() ? &gSpanKernels_SSE2 : NULL;
+    case eSpanAVX2:
+      return nglCPUInfo::HasAVX2() ? &gSpanKernels_AVX2 : NULL;
+#endif
+    case eSpanScalar:
+      return &gSpanKernels_Scalar;
+    default:
+      return NULL;
+  }
+}
+
+static nuiSpanImplementation GetBestImplementation()
+{
+  if (GetKernels(eSpanAVX2))
+    return eSpanAVX2;
+  if (GetKernels(eSpanSSE2))
+    return eSpanSSE2;
+  return eSpanScalar;
+}
+
+// The pointer is only ever swapped between static tables, a reader racing with nuiSpan_SetImplementation uses either one.
+static std::atomic<const nuiSpanKernels*> gpSpanKernels(NULL);
+static std::atomic<nuiSpanImplementation> gSpanImplementation(eSpanScalar);
+
+const nuiSpanKernels& nuiSpan_GetKernels()
+{
+  const nuiSpanKernels* pKernels = gpSpanKernels.load(std::memory_order_acquire);
+  if (pKernels)
+    return *pKernels;
+
+  nuiSpanImplementation implementation = GetBestImplementation();
+  pKernels = GetKernels(implementation);
+  gSpanImplementation.store(implementation, std::memory_order_relaxed);
+  gpSpanKernels.store(pKernels, std::memory_order_release);
+  return *pKernels;
+}
+
+bool nuiSpan_SetImplementation(nuiSpanImplementation Implementation)
+{
+  const nuiSpanKernels* pKernels = GetKernels(Implementation);
+  if (!pKernels)
+    return false;
+  gSpanImplementation.store(Implementation, std::memory_order_relaxed);
+  gpSpanKernels.store(pKernels, std::memory_order_release);
+  return true;
+}
+
+bool nuiSpan_IsImplementationAvailable(nuiSpanImplementation Implementation)
+{
+  return GetKernels(Implementation) != NULL;
+}
+
+nuiSpanImplementation nuiSpan_GetImplementation()
+{
+  nuiSpan_GetKernels();
+  return gSpanImplementation.load(std::memory_order_relaxed);
+}
+
+void nuiSpan_ResetImplementation()
+{
+  nuiSpan_SetImplementation(GetBestImplementation());
+}
+
+const char* nuiSpan_GetImplementationName(nuiSpanImplementation Implementation)
+{
+  switch (Implementation)
+  {
+    case eSpanScalar: return "Scalar";
+    case eSpanSSE2: return "SSE2";
+    case eSpanAVX2: return "AVX2";
+    default: return "Unknown";
+  }
+}
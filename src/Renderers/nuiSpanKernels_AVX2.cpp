@@ -0,0 +1,253 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiFixedPoint.h"
+#include "nuiSpanKernels_SIMD.h"
+
+#ifdef NUI_SPAN_X86
+
+#include <immintrin.h>
+
+NGL_TARGET_BEGIN("avx2")
+
+// Same arithmetic as the SSE2 kernels on eight pixels. The unpack and pack instructions work inside each 128 bits lane, so they keep the pixels in order.
+
+static inline void AlphaWeights(__m256i src, __m256i& rLow, __m256i& rHigh)
+{
+  __m256i alpha = _mm256_srli_epi32(src, 24);
+  __m256i w = _mm256_add_epi32(_mm256_add_epi32(alpha, _mm256_set1_epi32(1)), _mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()));
+  w = _mm256_or_si256(w, _mm256_slli_epi32(w, 16));
+  rLow = _mm256_unpacklo_epi32(w, w);
+  rHigh = _mm256_unpackhi_epi32(w, w);
+}
+
+static inline __m256i Lerp16(__m256i dst, __m256i src, __m256i w)
+{
+  const __m256i dw = _mm256_sub_epi16(_mm256_set1_epi16(256), w);
+  return _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(dst, dw), _mm256_mullo_epi16(src, w)), 8);
+}
+
+static inline __m256i BlendTransp8(__m256i dst, __m256i src)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i wl, wh;
+  AlphaWeights(src, wl, wh);
+  __m256i lo = Lerp16(_mm256_unpacklo_epi8(dst, zero), _mm256_unpacklo_epi8(src, zero), wl);
+  __m256i hi = Lerp16(_mm256_unpackhi_epi8(dst, zero), _mm256_unpackhi_epi8(src, zero), wh);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+static inline __m256i BlendTranspAdd8(__m256i dst, __m256i src)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i rgb = _mm256_set1_epi64x(0x0000ffffffffffffLL); // The alpha of the destination is kept
+  __m256i wl, wh;
+  AlphaWeights(src, wl, wh);
+  __m256i lo = _mm256_and_si256(_mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(src, zero), wl), 8), rgb);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(src, zero), wh), 8), rgb);
+  lo = _mm256_add_epi16(lo, _mm256_unpacklo_epi8(dst, zero));
+  hi = _mm256_add_epi16(hi, _mm256_unpackhi_epi8(dst, zero));
+  return _mm256_packus_epi16(lo, hi);
+}
+
+static void Fill_AVX2(uint32* pDst, uint32 Color, int32 Count)
+{
+  const __m256i color = _mm256_set1_epi32(Color);
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+    _mm256_storeu_si256((__m256i*)(pDst + i), color);
+  gSpanKernels_Scalar.Fill(pDst + i, Color, Count - i);
+}
+
+static void FillTransp_AVX2(uint32* pDst, uint32 Color, int32 Count)
+{
+  const uint32 alpha = Color >> 24;
+  if (alpha == 255)
+  {
+    Fill_AVX2(pDst, Color, Count);
+    return;
+  }
+  if (alpha == 0)
+    return;
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i w = _mm256_set1_epi16(nuiSpan_AlphaWeight(alpha));
+  const __m256i dw = _mm256_sub_epi16(_mm256_set1_epi16(256), w);
+  const __m256i src = _mm256_mullo_epi16(_mm256_unpacklo_epi8(_mm256_set1_epi32(Color), zero), w);
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i));
+    __m256i lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), dw), src), 8);
+    __m256i hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), dw), src), 8);
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_packus_epi16(lo, hi));
+  }
+  gSpanKernels_Scalar.FillTransp(pDst + i, Color, Count - i);
+}
+
+static void FillTranspAdd_AVX2(uint32* pDst, uint32 Color, int32 Count)
+{
+  if (!(Color >> 24))
+    return;
+
+  const __m256i src = _mm256_set1_epi32(Color);
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i));
+    _mm256_storeu_si256((__m256i*)(pDst + i), BlendTranspAdd8(dst, src));
+  }
+  gSpanKernels_Scalar.FillTranspAdd(pDst + i, Color, Count - i);
+}
+
+static void BlendTransp_AVX2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i));
+    __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+    _mm256_storeu_si256((__m256i*)(pDst + i), BlendTransp8(dst, src));
+  }
+  gSpanKernels_Scalar.BlendTransp(pDst + i, pSrc + i, Count - i);
+}
+
+static void BlendTranspAdd_AVX2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i));
+    __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+    _mm256_storeu_si256((__m256i*)(pDst + i), BlendTranspAdd8(dst, src));
+  }
+  gSpanKernels_Scalar.BlendTranspAdd(pDst + i, pSrc + i, Count - i);
+}
+
+static void Modulate_AVX2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i dst = _mm256_loadu_si256((const __m256i*)(pDst + i));
+    __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+    __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_unpacklo_epi8(src, zero)), 8);
+    __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_unpackhi_epi8(src, zero)), 8);
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_packus_epi16(lo, hi));
+  }
+  gSpanKernels_Scalar.Modulate(pDst + i, pSrc + i, Count - i);
+}
+
+static inline __m256i GouraudChannels(__m256i color)
+{
+  return _mm256_and_si256(_mm256_srai_epi32(_mm256_add_epi32(color, _mm256_set1_epi32(NUI_FP_HALF)), NUI_FP_SHIFT), _mm256_set1_epi32(0xff));
+}
+
+static void Gouraud_AVX2(uint32* pDst, int32* pColor, const int32* pIncr, int32 Count)
+{
+  // Two pixels per register (lanes in B, G, R, A order), c01 holds pixels 0 and 1, c23 pixels 2 and 3...
+  const __m128i c = _mm_set_epi32(pColor[3], pColor[0], pColor[1], pColor[2]);
+  const __m128i incr = _mm_set_epi32(pIncr[3], pIncr[0], pIncr[1], pIncr[2]);
+  const __m256i incr2 = _mm256_set_m128i(_mm_add_epi32(incr, incr), _mm_add_epi32(incr, incr));
+  const __m256i incr8 = _mm256_slli_epi32(incr2, 2);
+  __m256i c01 = _mm256_set_m128i(_mm_add_epi32(c, incr), c);
+  // The packs interleave the 128 bits lanes, this puts the pixels back in order:
+  const __m256i order = _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0);
+
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    const __m256i c23 = _mm256_add_epi32(c01, incr2);
+    const __m256i c45 = _mm256_add_epi32(c23, incr2);
+    const __m256i c67 = _mm256_add_epi32(c45, incr2);
+    const __m256i lo = _mm256_packs_epi32(GouraudChannels(c01), GouraudChannels(c23));
+    const __m256i hi = _mm256_packs_epi32(GouraudChannels(c45), GouraudChannels(c67));
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), order));
+    c01 = _mm256_add_epi32(c01, incr8);
+  }
+
+  int32 color[4];
+  _mm_storeu_si128((__m128i*)color, _mm256_castsi256_si128(c01));
+  pColor[0] = color[2];
+  pColor[1] = color[1];
+  pColor[2] = color[0];
+  pColor[3] = color[3];
+  gSpanKernels_Scalar.Gouraud(pDst + i, pColor, pIncr, Count - i);
+}
+
+// Clamped texel indices of eight pixels, see nuiSpan_TexelCoord:
+static inline __m256i TexelIndices(int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Width, int32 Height)
+{
+  const __m256i steps = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m256i round = _mm256_set1_epi32(0xffff);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i u = _mm256_add_epi32(_mm256_set1_epi32(U), _mm256_mullo_epi32(steps, _mm256_set1_epi32(IncrU)));
+  const __m256i v = _mm256_add_epi32(_mm256_set1_epi32(V), _mm256_mullo_epi32(steps, _mm256_set1_epi32(IncrV)));
+  __m256i x = _mm256_srai_epi32(_mm256_add_epi32(u, round), 16);
+  __m256i y = _mm256_srai_epi32(_mm256_add_epi32(v, round), 16);
+  x = _mm256_min_epi32(_mm256_max_epi32(x, zero), _mm256_sub_epi32(_mm256_set1_epi32(Width), one));
+  y = _mm256_min_epi32(_mm256_max_epi32(y, zero), _mm256_sub_epi32(_mm256_set1_epi32(Height), one));
+  return _mm256_add_epi32(x, _mm256_mullo_epi32(y, _mm256_set1_epi32(Width)));
+}
+
+static void FetchRGB24_AVX2(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  // Each gather reads four bytes. For the very last texel of the image, read from one byte before and shift the extra byte out.
+  const __m256i last = _mm256_set1_epi32(3 * Width * Height - 4);
+  const __m256i bgr = _mm256_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+                                       2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m256i alpha = _mm256_set1_epi32(0xff000000);
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    __m256i offsets = _mm256_mullo_epi32(TexelIndices(U, V, IncrU, IncrV, Width, Height), _mm256_set1_epi32(3));
+    const __m256i over = _mm256_cmpgt_epi32(offsets, last);
+    offsets = _mm256_add_epi32(offsets, over);
+    __m256i texels = _mm256_i32gather_epi32((const int*)pImage, offsets, 1);
+    texels = _mm256_srlv_epi32(texels, _mm256_and_si256(over, _mm256_set1_epi32(8)));
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_or_si256(_mm256_shuffle_epi8(texels, bgr), alpha));
+    U += 8 * IncrU;
+    V += 8 * IncrV;
+  }
+  gSpanKernels_Scalar.FetchRGB24(pDst + i, pImage, Width, Height, U, V, IncrU, IncrV, Count - i);
+}
+
+static void FetchRGBA32_AVX2(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  // The texels are R, G, B, A bytes, swap R and B to get NUI_RGBA values:
+  const __m256i bgra = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  int32 i = 0;
+  for (; i + 8 <= Count; i += 8)
+  {
+    const __m256i texels = _mm256_i32gather_epi32((const int*)pImage, TexelIndices(U, V, IncrU, IncrV, Width, Height), 4);
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_shuffle_epi8(texels, bgra));
+    U += 8 * IncrU;
+    V += 8 * IncrV;
+  }
+  gSpanKernels_Scalar.FetchRGBA32(pDst + i, pImage, Width, Height, U, V, IncrU, IncrV, Count - i);
+}
+
+const nuiSpanKernels gSpanKernels_AVX2 =
+{
+  Fill_AVX2,
+  FillTransp_AVX2,
+  FillTranspAdd_AVX2,
+  BlendTransp_AVX2,
+  BlendTranspAdd_AVX2,
+  Modulate_AVX2,
+  Gouraud_AVX2,
+  FetchRGB24_AVX2,
+  FetchRGBA32_AVX2
+};
+
+NGL_TARGET_END
+
+#endif
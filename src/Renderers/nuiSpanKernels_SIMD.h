@@ -0,0 +1,36 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#pragma once
+
+#include "nuiSpanKernels.h"
+
+// One kernel table per instruction set, nuiSpanKernels.cpp picks one at runtime (see nuiSpan_SetImplementation).
+extern const nuiSpanKernels gSpanKernels_Scalar;
+
+#if (defined _NGL_X86_) || (defined _NGL_X64_)
+#define NUI_SPAN_X86
+extern const nuiSpanKernels gSpanKernels_SSE2;
+extern const nuiSpanKernels gSpanKernels_AVX2;
+#endif
+
+// Blend weight of a source alpha: 0 keeps the destination, 256 replaces it.
+inline uint32 nuiSpan_AlphaWeight(uint32 Alpha)
+{
+  return Alpha ? Alpha + 1 : 0;
+}
+
+// Nearest texel coordinate of a 16.16 value, clamped to the image like nuiTexelAccessor_RGB24/RGBA32:
+inline int32 nuiSpan_TexelCoord(int32 Value, int32 Size)
+{
+  int32 i = (Value + 0xffff) >> 16;
+  if (i < 0)
+    i = 0;
+  if (i >= Size)
+    i = Size - 1;
+  return i;
+}
@@ -0,0 +1,254 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiFixedPoint.h"
+#include "nuiSpanKernels_SIMD.h"
+
+#ifdef NUI_SPAN_X86
+
+#include <emmintrin.h>
+
+NGL_TARGET_BEGIN("sse2")
+
+// The blends expand the channels of two pixels to 16 bits: the products are at most 255 * 256 so they never overflow.
+
+// Blend weight of each pixel (see nuiSpan_AlphaWeight) repeated in the four 16 bits channels of the two low / high pixels:
+static inline void AlphaWeights(__m128i src, __m128i& rLow, __m128i& rHigh)
+{
+  __m128i alpha = _mm_srli_epi32(src, 24);
+  __m128i w = _mm_add_epi32(_mm_add_epi32(alpha, _mm_set1_epi32(1)), _mm_cmpeq_epi32(alpha, _mm_setzero_si128()));
+  w = _mm_or_si128(w, _mm_slli_epi32(w, 16));
+  rLow = _mm_unpacklo_epi32(w, w);
+  rHigh = _mm_unpackhi_epi32(w, w);
+}
+
+static inline __m128i Lerp16(__m128i dst, __m128i src, __m128i w)
+{
+  const __m128i dw = _mm_sub_epi16(_mm_set1_epi16(256), w);
+  return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dst, dw), _mm_mullo_epi16(src, w)), 8);
+}
+
+static inline __m128i BlendTransp4(__m128i dst, __m128i src)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i wl, wh;
+  AlphaWeights(src, wl, wh);
+  __m128i lo = Lerp16(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi8(src, zero), wl);
+  __m128i hi = Lerp16(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi8(src, zero), wh);
+  return _mm_packus_epi16(lo, hi);
+}
+
+static inline __m128i BlendTranspAdd4(__m128i dst, __m128i src)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i rgb = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1); // The alpha of the destination is kept
+  __m128i wl, wh;
+  AlphaWeights(src, wl, wh);
+  __m128i lo = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), wl), 8), rgb);
+  __m128i hi = _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), wh), 8), rgb);
+  lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(dst, zero));
+  hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(dst, zero));
+  return _mm_packus_epi16(lo, hi);
+}
+
+static void Fill_SSE2(uint32* pDst, uint32 Color, int32 Count)
+{
+  const __m128i color = _mm_set1_epi32(Color);
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+    _mm_storeu_si128((__m128i*)(pDst + i), color);
+  gSpanKernels_Scalar.Fill(pDst + i, Color, Count - i);
+}
+
+static void FillTransp_SSE2(uint32* pDst, uint32 Color, int32 Count)
+{
+  const uint32 alpha = Color >> 24;
+  if (alpha == 255)
+  {
+    Fill_SSE2(pDst, Color, Count);
+    return;
+  }
+  if (alpha == 0)
+    return;
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i w = _mm_set1_epi16(nuiSpan_AlphaWeight(alpha));
+  const __m128i dw = _mm_sub_epi16(_mm_set1_epi16(256), w);
+  const __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(Color), zero), w);
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+    __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), dw), src), 8);
+    __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), dw), src), 8);
+    _mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+  }
+  gSpanKernels_Scalar.FillTransp(pDst + i, Color, Count - i);
+}
+
+static void FillTranspAdd_SSE2(uint32* pDst, uint32 Color, int32 Count)
+{
+  if (!(Color >> 24))
+    return;
+
+  const __m128i src = _mm_set1_epi32(Color);
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+    _mm_storeu_si128((__m128i*)(pDst + i), BlendTranspAdd4(dst, src));
+  }
+  gSpanKernels_Scalar.FillTranspAdd(pDst + i, Color, Count - i);
+}
+
+static void BlendTransp_SSE2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i));
+    _mm_storeu_si128((__m128i*)(pDst + i), BlendTransp4(dst, src));
+  }
+  gSpanKernels_Scalar.BlendTransp(pDst + i, pSrc + i, Count - i);
+}
+
+static void BlendTranspAdd_SSE2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i));
+    _mm_storeu_si128((__m128i*)(pDst + i), BlendTranspAdd4(dst, src));
+  }
+  gSpanKernels_Scalar.BlendTranspAdd(pDst + i, pSrc + i, Count - i);
+}
+
+static void Modulate_SSE2(uint32* pDst, const uint32* pSrc, int32 Count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    __m128i dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+    __m128i src = _mm_loadu_si128((const __m128i*)(pSrc + i));
+    __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi8(src, zero)), 8);
+    __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi8(src, zero)), 8);
+    _mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+  }
+  gSpanKernels_Scalar.Modulate(pDst + i, pSrc + i, Count - i);
+}
+
+// One pixel per register, the lanes are in memory order (B, G, R, A) so that packing gives NUI_RGBA values:
+static inline __m128i GouraudChannels(__m128i color)
+{
+  return _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(color, _mm_set1_epi32(NUI_FP_HALF)), NUI_FP_SHIFT), _mm_set1_epi32(0xff));
+}
+
+static void Gouraud_SSE2(uint32* pDst, int32* pColor, const int32* pIncr, int32 Count)
+{
+  __m128i c0 = _mm_set_epi32(pColor[3], pColor[0], pColor[1], pColor[2]);
+  const __m128i incr = _mm_set_epi32(pIncr[3], pIncr[0], pIncr[1], pIncr[2]);
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    const __m128i c1 = _mm_add_epi32(c0, incr);
+    const __m128i c2 = _mm_add_epi32(c1, incr);
+    const __m128i c3 = _mm_add_epi32(c2, incr);
+    const __m128i lo = _mm_packs_epi32(GouraudChannels(c0), GouraudChannels(c1));
+    const __m128i hi = _mm_packs_epi32(GouraudChannels(c2), GouraudChannels(c3));
+    _mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+    c0 = _mm_add_epi32(c3, incr);
+  }
+
+  int32 color[4];
+  _mm_storeu_si128((__m128i*)color, c0);
+  pColor[0] = color[2];
+  pColor[1] = color[1];
+  pColor[2] = color[0];
+  pColor[3] = color[3];
+  gSpanKernels_Scalar.Gouraud(pDst + i, pColor, pIncr, Count - i);
+}
+
+// Clamped texel coordinates, see nuiSpan_TexelCoord:
+static inline __m128i TexelCoords(__m128i value, __m128i size)
+{
+  __m128i i = _mm_srai_epi32(_mm_add_epi32(value, _mm_set1_epi32(0xffff)), 16);
+  i = _mm_andnot_si128(_mm_srai_epi32(i, 31), i);
+  const __m128i last = _mm_sub_epi32(size, _mm_set1_epi32(1));
+  const __m128i over = _mm_cmpgt_epi32(i, last);
+  return _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, i));
+}
+
+// Texel indices of four pixels. The coordinates are positive so the unsigned 32 bits multiplies give the right products.
+static inline void TexelIndices(int32* pIndices, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Width, int32 Height)
+{
+  const __m128i width = _mm_set1_epi32(Width);
+  const __m128i x = TexelCoords(_mm_set_epi32(U + 3 * IncrU, U + 2 * IncrU, U + IncrU, U), width);
+  const __m128i y = TexelCoords(_mm_set_epi32(V + 3 * IncrV, V + 2 * IncrV, V + IncrV, V), _mm_set1_epi32(Height));
+  const __m128i y02 = _mm_mul_epu32(y, width);
+  const __m128i y13 = _mm_mul_epu32(_mm_srli_si128(y, 4), width);
+  const __m128i offsets = _mm_unpacklo_epi32(_mm_shuffle_epi32(y02, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(y13, _MM_SHUFFLE(2, 0, 2, 0)));
+  _mm_storeu_si128((__m128i*)pIndices, _mm_add_epi32(x, offsets));
+}
+
+static void FetchRGB24_SSE2(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  int32 indices[4];
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    TexelIndices(indices, U, V, IncrU, IncrV, Width, Height);
+    for (int32 j = 0; j < 4; j++)
+    {
+      const uint8* pTexel = pImage + 3 * indices[j];
+      pDst[i + j] = 0xff000000 | (pTexel[0] << 16) | (pTexel[1] << 8) | pTexel[2];
+    }
+    U += 4 * IncrU;
+    V += 4 * IncrV;
+  }
+  gSpanKernels_Scalar.FetchRGB24(pDst + i, pImage, Width, Height, U, V, IncrU, IncrV, Count - i);
+}
+
+static void FetchRGBA32_SSE2(uint32* pDst, const uint8* pImage, int32 Width, int32 Height, int32 U, int32 V, int32 IncrU, int32 IncrV, int32 Count)
+{
+  const uint32* pTexels = (const uint32*)pImage;
+  const __m128i ga = _mm_set1_epi32(0xff00ff00);
+  const __m128i low = _mm_set1_epi32(0xff);
+  int32 indices[4];
+  int32 i = 0;
+  for (; i + 4 <= Count; i += 4)
+  {
+    TexelIndices(indices, U, V, IncrU, IncrV, Width, Height);
+    const __m128i texels = _mm_set_epi32(pTexels[indices[3]], pTexels[indices[2]], pTexels[indices[1]], pTexels[indices[0]]);
+    // The texels are R, G, B, A bytes, swap R and B to get NUI_RGBA values:
+    const __m128i rb = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(texels, low), 16), _mm_and_si128(_mm_srli_epi32(texels, 16), low));
+    _mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(_mm_and_si128(texels, ga), rb));
+    U += 4 * IncrU;
+    V += 4 * IncrV;
+  }
+  gSpanKernels_Scalar.FetchRGBA32(pDst + i, pImage, Width, Height, U, V, IncrU, IncrV, Count - i);
+}
+
+const nuiSpanKernels gSpanKernels_SSE2 =
+{
+  Fill_SSE2,
+  FillTransp_SSE2,
+  FillTranspAdd_SSE2,
+  BlendTransp_SSE2,
+  BlendTranspAdd_SSE2,
+  Modulate_SSE2,
+  Gouraud_SSE2,
+  FetchRGB24_SSE2,
+  FetchRGBA32_SSE2
+};
+
+NGL_TARGET_END
+
+#endif
@@ -0,0 +1,254 @@
+/*
+  NUI3 - C++ cross-platform GUI framework for OpenGL based applications
+  Copyright (C) 2002-2003 Sebastien Metrot
+
+  licence: see nui3/LICENCE.TXT
+*/
+
+#include "nui.h"
+#include "nuiTessellationCache.h"
+
+// Never deleted: shapes can still be destroyed (and call Forget) while the application exits.
+static nuiTessellationCache* gpTessellationCache = NULL;
+static nglCriticalSection gTessellationCacheCS(nglString("nuiTessellationCache::Get"));
+
+// class nuiTessellationCache::Key
+nuiTessellationCache::Key::Key(uint64 Revision, nuiShapeMode Mode, float Quality, float LineWidth, nuiLineJoin LineJoin, nuiLineCap LineCap, float MiterLimit)
+: mRevision(Revision), mMode(Mode), mQuality(Quality), mLineWidth(LineWidth), mLineJoin(LineJoin), mLineCap(LineCap), mMiterLimit(MiterLimit)
+{
+}
+
+bool nuiTessellationCache::Key::operator<(const Key& rKey) const
+{
+  // The revision must come first, ForgetRevision relies on it:
+  if (mRevision != rKey.mRevision)
+    return mRevision < rKey.mRevision;
+  if (mMode != rKey.mMode)
+    return mMode < rKey.mMode;
+  if (mQuality != rKey.mQuality)
+    return mQuality < rKey.mQuality;
+  if (mLineWidth != rKey.mLineWidth)
+    return mLineWidth < rKey.mLineWidth;
+  if (mLineJoin != rKey.mLineJoin)
+    return mLineJoin < rKey.mLineJoin;
+  if (mLineCap != rKey.mLineCap)
+    return mLineCap < rKey.mLineCap;
+  return mMiterLimit < rKey.mMiterLimit;
+}
+
+// class nuiTessellationCache::Entry
+nuiTessellationCache::Entry::Entry(const Key& rKey, nuiRenderObject* pObject, uint32 Vertices)
+: mKey(rKey), mpObject(pObject), mVertices(Vertices)
+{
+}
+
+// class nuiTessellationCache
+nuiTessellationCache::nuiTessellationCache(uint32 MaxEntries, uint32 MaxVertices)
+: mCS(nglString("nuiTessellationCache"))
+{
+  mEnabled = true;
+  mMaxEntries = MaxEntries;
+  mMaxVertices = MaxVertices;
+  mVertices = 0;
+  mHits = 0;
+  mMisses = 0;
+  mEvictions = 0;
+}
+
+nuiTessellationCache::~nuiTessellationCache()
+{
+  Clear();
+  if (gpTessellationCache == this)
+    gpTessellationCache = NULL;
+}
+
+nuiTessellationCache& nuiTessellationCache::Get()
+{
+  nglCriticalSectionGuard guard(gTessellationCacheCS);
+  if (!gpTessellationCache)
+    gpTessellationCache = new nuiTessellationCache();
+  return *gpTessellationCache;
+}
+
+void nuiTessellationCache::Forget(uint64 ShapeRevision)
+{
+  if (gpTessellationCache)
+    gpTessellationCache->ForgetRevision(ShapeRevision);
+}
+
+bool nuiTessellationCache::Fill(nuiShape* pShape, float Quality, nuiRenderObject& rObject)
+{
+  return GetObject(pShape, Key(pShape->GetRevision(), eFillShape, Quality, 0, nuiLineJoinMiter, nuiLineCapBut, 0), rObject);
+}
+
+bool nuiTessellationCache::Outline(nuiShape* pShape, float Quality, float LineWidth, nuiLineJoin LineJoin, nuiLineCap LineCap, float MiterLimit, nuiRenderObject& rObject)
+{
+  return GetObject(pShape, Key(pShape->GetRevision(), eStrokeShape, Quality, LineWidth, LineJoin, LineCap, MiterLimit), rObject);
+}
+
+bool nuiTessellationCache::GetObject(nuiShape* pShape, const Key& rKey, nuiRenderObject& rObject)
+{
+  if (mEnabled)
+  {
+    nglCriticalSectionGuard guard(mCS);
+    EntryMap::iterator it = mIndex.find(rKey);
+    if (it != mIndex.end())
+    {
+      mHits++;
+      mEntries.splice(mEntries.begin(), mEntries, it->second);
+
+      const nuiRenderObject& rCached(*it->second->mpObject);
+      for (uint32 i = 0; i < rCached.GetSize(); i++)
+        rObject.AddArray(rCached.GetArray(i));
+      return true;
+    }
+
+    mMisses++;
+  }
+
+  // Tessellate without holding the lock:
+  nuiRenderObject* pObject = NULL;
+  if (rKey.mMode == eFillShape)
+    pObject = pShape->Fill(rKey.mQuality);
+  else
+    pObject = pShape->Outline(rKey.mQuality, rKey.mLineWidth, rKey.mLineJoin, rKey.mLineCap, rKey.mMiterLimit);
+
+  if (!pObject)
+    return false;
+
+  // The tessellator leaves an extra reference on each array for the painter that draws it, rObject takes it over:
+  uint32 vertices = 0;
+  for (uint32 i = 0; i < pObject->GetSize(); i++)
+  {
+    nuiRenderArray* pArray = pObject->GetArray(i);
+    vertices += pArray->GetSize();
+    rObject.AddArray(pArray);
+    pArray->Release();
+  }
+
+  if (!mEnabled)
+  {
+    delete pObject;
+    return true;
+  }
+
+  nglCriticalSectionGuard guard(mCS);
+  if (mIndex.find(rKey) != mIndex.end())
+  {
+    // Another thread was faster:
+    delete pObject;
+    return true;
+  }
+
+  mEntries.push_front(Entry(rKey, pObject, vertices));
+  mIndex[rKey] = mEntries.begin();
+  mVertices += vertices;
+  Trim();
+  return true;
+}
+
+void nuiTessellationCache::ForgetRevision(uint64 ShapeRevision)
+{
+  nglCriticalSectionGuard guard(mCS);
+  EntryMap::iterator it = mIndex.lower_bound(Key(ShapeRevision, eStrokeShape, -FLT_MAX, -FLT_MAX, nuiLineJoinMiter, nuiLineCapBut, -FLT_MAX));
+  while (it != mIndex.end() && it->first.mRevision == ShapeRevision)
+    Remove(it++);
+}
+
+void nuiTessellationCache::Remove(EntryMap::iterator it)
+{
+  EntryList::iterator entry = it->second;
+  mVertices -= entry->mVertices;
+  delete entry->mpObject;
+  mEntries.erase(entry);
+  mIndex.erase(it);
+}
+
+void nuiTessellationCache::Trim()
+{
+  while (!mEntries.empty() && (mEntries.size() > mMaxEntries || mVertices > mMaxVertices))
+  {
+    Remove(mIndex.find(mEntries.back().mKey));
+    mEvictions++;
+  }
+}
+
+void nuiTessellationCache::SetEnabled(bool Set)
+{
+  mEnabled = Set;
+  if (!Set)
+    Clear();
+}
+
+bool nuiTessellationCache::GetEnabled() const
+{
+  return mEnabled;
+}
+
+void nuiTessellationCache::SetMaxEntries(uint32 MaxEntries)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mMaxEntries = MaxEntries;
+  Trim();
+}
+
+uint32 nuiTessellationCache::GetMaxEntries() const
+{
+  return mMaxEntries;
+}
+
+void nuiTessellationCache::SetMaxVertices(uint32 MaxVertices)
+{
+  nglCriticalSectionGuard guard(mCS);
+  mMaxVertices = MaxVertices;
+  Trim();
+}
+
+uint32 nuiTessellationCache::GetMaxVertices() const
+{
+  return mMaxVertices;
+}
+
+void nuiTessellationCache::Clear()
+{
+  nglCriticalSectionGuard guard(mCS);
+  for (EntryList::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+    delete it->mpObject;
+  mEntries.clear();
+  mIndex.clear();
+  mVertices = 0;
+}
+
+uint32 nuiTessellationCache::GetEntryCount() const
+{
+  nglCriticalSectionGuard guard(mCS);
+  return (uint32)mEntries.size();
+}
+
+uint32 nuiTessellationCache::GetVertexCount() const
+{
+  return mVertices;
+}
+
+uint64 nuiTessellationCache::GetHits() const
+{
+  return mHits;
+}
+
+uint64 nuiTessellationCache::GetMisses() const
+{
+  return mMisses;
+}
+
+uint64 nuiTessellationCache::GetEvictions() const
+{
+  return mEvictions;
+}
+
+void nuiTessellationCache::ResetStats()
+{
+  nglCriticalSectionGuard guard(mCS);
+  mHits = 0;
+  mMisses = 0;
+  mEvictions = 0;
+}
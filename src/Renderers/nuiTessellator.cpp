@@ -34,21 +34,57 @@ float distance(const nglVectorf& p1, const nglVectorf& p2, const nglVectorf& p3)
 
 
 
-GLUtesselator* nuiTessellator::mpTess = NULL;
-uint32 nuiTessellator::mRefs = 0;
+// The GLU tessellators are not thread safe but they don't share any state: keep a pool of them so that each Generate call has its own.
+static nglCriticalSection gTessellatorsCS(nglString("nuiTessellator::Tessellators"));
+static std::vector<GLUtesselator*> gTessellators;
+
+GLUtesselator* nuiTessellator::AcquireTessellator()
+{
+  {
+    nglCriticalSectionGuard guard(gTessellatorsCS);
+    if (!gTessellators.empty())
+    {
+      GLUtesselator* pTess = gTessellators.back();
+      gTessellators.pop_back();
+      return pTess;
+    }
+  }
+
+  return gluNewTess();
+}
+
+void nuiTessellator::ReleaseTessellator(GLUtesselator* pTess)
+{
+  nglCriticalSectionGuard guard(gTessellatorsCS);
+  gTessellators.push_back(pTess);
+}
+
+void nuiTessellator::ReleaseTessellators()
+{
+  nglCriticalSectionGuard guard(gTessellatorsCS);
+  for (uint32 i = 0; i < gTessellators.size(); i++)
+    gluDeleteTess(gTessellators[i]);
+  gTessellators.clear();
+}
+
+void nuiTessellator::SetFastPath(bool Set)
+{
+  mFastPath = Set;
+}
+
+bool nuiTessellator::GetFastPath()
+{
+  return mFastPath;
+}
 
 nuiTessellator::nuiTessellator(nuiPathGenerator* pPathGenerator)
 {
   mpPath = pPathGenerator;
   mpShape = NULL;
   mpObject = NULL;
+  mpTess = NULL;
   mEdgeFlag = true;
   mOutline = false;
-
-  if (!mpTess)
-    mpTess = gluNewTess();
-
-  mRefs++;
 }
 
 nuiTessellator::nuiTessellator(nuiShape* pShape)
@@ -56,25 +92,14 @@ nuiTessellator::nuiTessellator(nuiShape* pShape)
   mpPath = NULL;
   mpShape = pShape;
   mpObject = NULL;
+  mpTess = NULL;
   mEdgeFlag = true;
   mOutline = false;
-
-  if (!mpTess)
-    mpTess = gluNewTess();
-
-  mRefs++;
 }
 
 nuiTessellator::~nuiTessellator()
 {
-  if (!--mRefs)
-  {
-    if (mpTess)
-    {
-			gluDeleteTess(mpTess);
-			mpTess = NULL;
-    }
-  }
+  NGL_ASSERT(!mpTess);
 }
 
 nuiRenderObject* nuiTessellator::GenerateFromPath(float Quality)
@@ -86,6 +111,13 @@ nuiRenderObject* nuiTessellator::GenerateFromPath(float Quality)
   if (!count)
     return nullptr;
   
+  if (mFastPath && !mOutline)
+  {
+    nuiRenderObject* pObject = GenerateSimple(Points);
+    if (pObject)
+      return pObject;
+  }
+
   gluTessNormal(mpTess, 0,0,1);
   gluTessProperty(mpTess,GLU_TESS_TOLERANCE, 0);
   gluTessCallback(mpTess, GLU_TESS_BEGIN_DATA,    NUI_GLU_CALLBACK &nuiTessellator::StaticInternalTessBegin);
@@ -141,6 +173,24 @@ nuiRenderObject* nuiTessellator::GenerateFromPath(float Quality)
 
 nuiRenderObject* nuiTessellator::GenerateFromShape(float Quality)
 {
+  nuiShape::Winding Winding = mpShape->GetWinding();
+  if (Winding == nuiShape::eNone)
+    Winding = nuiShape::eNonZero;
+
+  // A simple contour is filled the same way by both rules:
+  uint32 countours = mpShape->GetContourCount();
+  nuiPath FirstContour;
+  if (countours == 1)
+  {
+    mpShape->GetContour(0)->Tessellate(FirstContour, Quality);
+    if (mFastPath && !mOutline && (Winding == nuiShape::eNonZero || Winding == nuiShape::eOdd))
+    {
+      nuiRenderObject* pObject = GenerateSimple(FirstContour);
+      if (pObject)
+        return pObject;
+    }
+  }
+
   gluTessNormal(mpTess, 0,0,1);
   gluTessProperty(mpTess,GLU_TESS_TOLERANCE, 0);
   gluTessCallback(mpTess, GLU_TESS_BEGIN_DATA,    NUI_GLU_CALLBACK &nuiTessellator::StaticInternalTessBegin);
@@ -151,25 +201,27 @@ nuiRenderObject* nuiTessellator::GenerateFromShape(float Quality)
   gluTessCallback(mpTess, GLU_TESS_ERROR_DATA,    NUI_GLU_CALLBACK &nuiTessellator::StaticInternalTessError);
 
   gluTessProperty(mpTess,GLU_TESS_BOUNDARY_ONLY, mOutline?GL_TRUE:GL_FALSE);
-  nuiShape::Winding Winding = mpShape->GetWinding();
-  if (Winding == nuiShape::eNone)
-    Winding = nuiShape::eNonZero;
   gluTessProperty(mpTess,GLU_TESS_WINDING_RULE, Winding);
 
   mpObject = new nuiRenderObject();
   mEdgeFlag = true;
 
-  uint32 countours = mpShape->GetContourCount();
-
   gluTessBeginPolygon(mpTess, this);
   
   for (uint32 contour = 0; contour < countours; contour++)
   {
     nuiPath Points;
-    nuiContour* pContour = mpShape->GetContour(contour);
-    NGL_ASSERT(pContour != NULL);
+    if (countours == 1)
+    {
+      Points = FirstContour;
+    }
+    else
+    {
+      nuiContour* pContour = mpShape->GetContour(contour);
+      NGL_ASSERT(pContour != NULL);
 
-    pContour->Tessellate(Points, Quality);
+      pContour->Tessellate(Points, Quality);
+    }
 
     uint count = Points.GetCount();
     bool beginNext = true;
@@ -208,13 +260,257 @@ nuiRenderObject* nuiTessellator::GenerateFromShape(float Quality)
   return pObject;
 }
 
+// Fast path for the fills made of a single simple contour:
+#define NUI_TESS_MAX_CONCAVE_VERTICES 256 // The simplicity test and the ear clipping are quadratic, libtess is faster on larger concave contours.
+
+bool nuiTessellator::mFastPath = true;
+
+static inline float TessCross(const nuiPoint& rA, const nuiPoint& rB, const nuiPoint& rC)
+{
+  return (rB[0] - rA[0]) * (rC[1] - rA[1]) - (rB[1] - rA[1]) * (rC[0] - rA[0]);
+}
+
+static inline bool TessSamePosition(const nuiPoint& rA, const nuiPoint& rB)
+{
+  return rA[0] == rB[0] && rA[1] == rB[1];
+}
+
+// Put the vertices of the only contour of rPoints in rContour, without the repeated and collinear vertices (spikes have no area
+// either). Returns false if rPoints contains more than one contour.
+static bool TessGetContour(const nuiPath& rPoints, std::vector<nuiPoint>& rContour)
+{
+  const uint32 count = rPoints.GetCount();
+  bool stopped = false;
+  for (uint32 i = 0; i < count; i++)
+  {
+    const nuiPoint& rPoint = rPoints[i];
+    if (rPoint.GetType() == nuiPointTypeStop)
+    {
+      stopped = !rContour.empty();
+      continue;
+    }
+
+    if (stopped)
+      return false;
+
+    if (!rContour.empty() && TessSamePosition(rContour.back(), rPoint))
+      continue;
+
+    while (rContour.size() >= 2 && TessCross(rContour[rContour.size() - 2], rContour.back(), rPoint) == 0)
+      rContour.pop_back();
+    rContour.push_back(rPoint);
+  }
+
+  // The contour is implicitly closed:
+  while (rContour.size() >= 2 && TessSamePosition(rContour.back(), rContour.front()))
+    rContour.pop_back();
+  while (rContour.size() >= 3 && TessCross(rContour[rContour.size() - 2], rContour.back(), rContour.front()) == 0)
+    rContour.pop_back();
+  while (rContour.size() >= 3 && TessCross(rContour.back(), rContour[0], rContour[1]) == 0)
+    rContour.erase(rContour.begin());
+
+  return true;
+}
+
+static bool TessIsConvex(const std::vector<nuiPoint>& rContour, float Sign)
+{
+  // Every turn must go the same way and the contour must not wind around twice, which shows as more than two changes of
+  // direction along each axis:
+  const uint32 count = rContour.size();
+  uint32 xflips = 0;
+  uint32 yflips = 0;
+  float lastdx = 0;
+  float lastdy = 0;
+  for (uint32 i = 0; i <= count; i++)
+  {
+    const nuiPoint& rA(rContour[i % count]);
+    const nuiPoint& rB(rContour[(i + 1) % count]);
+    const nuiPoint& rC(rContour[(i + 2) % count]);
+    if (i < count && TessCross(rA, rB, rC) * Sign < 0)
+      return false;
+
+    // The last iteration only checks the closing edge against the first one:
+    const float dx = rB[0] - rA[0];
+    const float dy = rB[1] - rA[1];
+    if (dx != 0)
+    {
+      if (lastdx * dx < 0)
+        xflips++;
+      lastdx = dx;
+    }
+    if (dy != 0)
+    {
+      if (lastdy * dy < 0)
+        yflips++;
+      lastdy = dy;
+    }
+  }
+
+  return xflips <= 2 && yflips <= 2;
+}
+
+static bool TessOnSegment(const nuiPoint& rA, const nuiPoint& rB, const nuiPoint& rP)
+{
+  return rP[0] >= MIN(rA[0], rB[0]) && rP[0] <= MAX(rA[0], rB[0]) && rP[1] >= MIN(rA[1], rB[1]) && rP[1] <= MAX(rA[1], rB[1]);
+}
+
+static bool TessIntersect(const nuiPoint& rA, const nuiPoint& rB, const nuiPoint& rC, const nuiPoint& rD)
+{
+  const float d1 = TessCross(rC, rD, rA);
+  const float d2 = TessCross(rC, rD, rB);
+  const float d3 = TessCross(rA, rB, rC);
+  const float d4 = TessCross(rA, rB, rD);
+  if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+    return true;
+
+  // Touching counts as intersecting:
+  return (d1 == 0 && TessOnSegment(rC, rD, rA))
+      || (d2 == 0 && TessOnSegment(rC, rD, rB))
+      || (d3 == 0 && TessOnSegment(rA, rB, rC))
+      || (d4 == 0 && TessOnSegment(rA, rB, rD));
+}
+
+static bool TessIsSimple(const std::vector<nuiPoint>& rContour)
+{
+  const uint32 count = rContour.size();
+  for (uint32 i = 0; i < count; i++)
+  {
+    const nuiPoint& rA(rContour[i]);
+    const nuiPoint& rB(rContour[(i + 1) % count]);
+    // Skip the two neighbouring edges:
+    for (uint32 j = i + 2; j < count; j++)
+    {
+      if (i == 0 && j == count - 1)
+        continue;
+      if (TessIntersect(rA, rB, rContour[j], rContour[(j + 1) % count]))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool TessEarClip(const std::vector<nuiPoint>& rContour, float Sign, nuiRenderArray* pArray)
+{
+  std::vector<uint32> indices(rContour.size());
+  for (uint32 i = 0; i < indices.size(); i++)
+    indices[i] = i;
+
+  uint32 i = 0;
+  uint32 tries = 2 * indices.size();
+  while (indices.size() > 3)
+  {
+    if (!tries--)
+      return false; // Should not happen with a simple contour, except with rounding errors.
+
+    const uint32 count = indices.size();
+    const nuiPoint& rA(rContour[indices[(i + count - 1) % count]]);
+    const nuiPoint& rB(rContour[indices[i]]);
+    const nuiPoint& rC(rContour[indices[(i + 1) % count]]);
+
+    bool ear = TessCross(rA, rB, rC) * Sign > 0;
+    for (uint32 j = 0; ear && j < count; j++)
+    {
+      const nuiPoint& rP(rContour[indices[j]]);
+      if (&rP == &rA || &rP == &rB || &rP == &rC)
+        continue;
+      ear = !(TessCross(rA, rB, rP) * Sign >= 0 && TessCross(rB, rC, rP) * Sign >= 0 && TessCross(rC, rA, rP) * Sign >= 0);
+    }
+
+    if (ear)
+    {
+      pArray->SetVertex(rA);
+      pArray->PushVertex();
+      pArray->SetVertex(rB);
+      pArray->PushVertex();
+      pArray->SetVertex(rC);
+      pArray->PushVertex();
+
+      indices.erase(indices.begin() + i);
+      if (i == indices.size())
+        i = 0;
+      tries = 2 * indices.size();
+    }
+    else
+    {
+      i = (i + 1) % count;
+    }
+  }
+
+  for (uint32 j = 0; j < 3; j++)
+  {
+    pArray->SetVertex(rContour[indices[j]]);
+    pArray->PushVertex();
+  }
+  return true;
+}
+
+nuiRenderObject* nuiTessellator::GenerateSimple(const nuiPath& rPoints)
+{
+  std::vector<nuiPoint> contour;
+  if (!TessGetContour(rPoints, contour) || contour.size() < 3)
+    return NULL;
+
+  const uint32 count = contour.size();
+  float area = 0;
+  for (uint32 i = 0; i < count; i++)
+  {
+    const nuiPoint& rA(contour[i]);
+    const nuiPoint& rB(contour[(i + 1) % count]);
+    area += rA[0] * rB[1] - rB[0] * rA[1];
+  }
+  if (area == 0)
+    return NULL;
+  const float sign = area > 0 ? 1.0f : -1.0f;
+
+  nuiRenderArray* pArray = new nuiRenderArray(GL_TRIANGLES, false, false, false);
+  pArray->EnableArray(nuiRenderArray::eVertex);
+  pArray->Reserve((count - 2) * 3);
+
+  if (TessIsConvex(contour, sign))
+  {
+    for (uint32 i = 1; i < count - 1; i++)
+    {
+      pArray->SetVertex(contour[0]);
+      pArray->PushVertex();
+      pArray->SetVertex(contour[i]);
+      pArray->PushVertex();
+      pArray->SetVertex(contour[i + 1]);
+      pArray->PushVertex();
+    }
+  }
+  else if (count > NUI_TESS_MAX_CONCAVE_VERTICES || !TessIsSimple(contour) || !TessEarClip(contour, sign, pArray))
+  {
+    pArray->Release();
+    return NULL;
+  }
+
+  nuiRenderObject* pObject = new nuiRenderObject();
+  pObject->AddArray(pArray);
+  return pObject;
+}
+
 nuiRenderObject* nuiTessellator::Generate(float Quality)
 {
+  if (!mpPath && !mpShape)
+    return NULL;
+
+  mpTess = AcquireTessellator();
+  nuiRenderObject* pObject = NULL;
   if (mpPath)
-    return GenerateFromPath(Quality);
-  else if (mpShape)
-    return GenerateFromShape(Quality);
-  return NULL;
+    pObject = GenerateFromPath(Quality);
+  else
+    pObject = GenerateFromShape(Quality);
+  ReleaseTessellator(mpTess);
+  mpTess = NULL;
+
+  return pObject;
+}
+
+nuiTessellationFuture* nuiTessellator::GenerateAsync(float Quality, nuiTaskPool& rPool, nuiTaskPool::Priority Priority) const
+{
+  nuiTessellator* pTessellator = mpPath ? new nuiTessellator(mpPath) : new nuiTessellator(mpShape);
+  pTessellator->SetOutline(mOutline);
+  return new nuiTessellationFuture(pTessellator, Quality, rPool, Priority);
 }
 
 
@@ -297,4 +593,57 @@ void nuiTessellator::InternalTessError(GLenum ErrNo)
 }
 
 
+// class nuiTessellationFuture
+nuiTessellationFuture::nuiTessellationFuture(nuiTessellator* pTessellator, float Quality, nuiTaskPool& rPool, nuiTaskPool::Priority Priority)
+: mpTessellator(pTessellator), mQuality(Quality), mpObject(NULL), mrPool(rPool)
+{
+  // Keep our own reference on the task so that it can still be canceled once the pool is done with it:
+  mpTask = nuiMakeTask(this, &nuiTessellationFuture::Run);
+  mpTask->Acquire();
+  mrPool.Post(mpTask, Priority, &mGroup);
+}
+
+nuiTessellationFuture::~nuiTessellationFuture()
+{
+  mpTask->Cancel();
+  Wait();
+  mpTask->Release();
+  delete mpTessellator;
+
+  if (mpObject)
+  {
+    // Drop the references that Generate left for the painter:
+    for (uint32 i = 0; i < mpObject->GetSize(); i++)
+      mpObject->GetArray(i)->Release();
+    delete mpObject;
+  }
+}
+
+void nuiTessellationFuture::Run()
+{
+  mpObject = mpTessellator->Generate(mQuality);
+}
+
+bool nuiTessellationFuture::IsDone() const
+{
+  return mGroup.IsDone();
+}
+
+void nuiTessellationFuture::Wait()
+{
+  mrPool.Wait(mGroup);
+}
+
+nuiRenderObject* nuiTessellationFuture::GetObject()
+{
+  Wait();
+  return mpObject;
+}
 
+nuiRenderObject* nuiTessellationFuture::TakeObject()
+{
+  Wait();
+  nuiRenderObject* pObject = mpObject;
+  mpObject = NULL;
+  return pObject;
+}
@@ -480,6 +480,7 @@ nuiTexture::nuiTexture(nglIStream* pInput, nglImageCodec* pCodec)
   mOwnImage = true;
   mForceReload = false;
   mRetainBuffer = mRetainBuffers;
+  mDistanceFieldSpread = 0;
 
   static uint count = 0;
   nglString name;
@@ -534,6 +535,7 @@ nuiTexture::nuiTexture (const nglPath& rPath, nglImageCodec* pCodec)
   mOwnImage = true;
   mForceReload = false;
   mRetainBuffer = mRetainBuffers;
+  mDistanceFieldSpread = 0;
 
   SetProperty(_T("Source"),rPath.GetPathName());
   mpTextures[rPath.GetPathName()] = this;
@@ -553,6 +555,7 @@ nuiTexture::nuiTexture (nglImageInfo& rInfo, bool Clone)
   mOwnImage = true;
   mForceReload = false;
   mRetainBuffer = mRetainBuffers;
+  mDistanceFieldSpread = 0;
        
   static uint count = 0;
   nglString name;
@@ -577,6 +580,7 @@ nuiTexture::nuiTexture (const nglImage& rImage)
   mOwnImage = true;
   mForceReload = false;
   mRetainBuffer = mRetainBuffers;
+  mDistanceFieldSpread = 0;
 
   nglString name;
   name.Format(_T("Image 0x%x"),mpImage);
@@ -597,6 +601,7 @@ nuiTexture::nuiTexture (nglImage* pImage, bool OwnImage)
   mOwnImage = OwnImage;
   mForceReload = false;
   mRetainBuffer = mRetainBuffers;
+  mDistanceFieldSpread = 0;
 
   nglString name;
   name.Format(_T("Image 0x%x"),mpImage);
@@ -618,6 +623,7 @@ nuiTexture::nuiTexture(nuiSurface* pSurface)
   mOwnImage = false;
   mForceReload = false;
   mRetainBuffer = false;
+  mDistanceFieldSpread = 0;
 
   nglString name;
   name.Format(_T("Surface 0x%x"), mpSurface);
@@ -639,6 +645,7 @@ nuiTexture::nuiTexture(GLuint TextureID, GLenum Target)
   mOwnImage = false;
   mForceReload = false;
   mRetainBuffer = false;
+  mDistanceFieldSpread = 0;
   
   nglString name;
   name.Format(_T("TextureID %d %d"), mTextureID, mTarget);
@@ -663,6 +670,7 @@ nuiTexture::nuiTexture(const nglString& rName, const nglString& rSourceTextureID
   mOwnImage = false;
   mForceReload = false;
   mRetainBuffer = false;
+  mDistanceFieldSpread = 0;
   
   nglString name = rName;
   SetProperty(_T("Source"), name);
@@ -835,11 +843,31 @@ void nuiTexture::ForceReload(bool Rebind)
   {
     mForceReload = false;
   }
+  mReloadRect = nuiRect();
+}
+
+void nuiTexture::ForceReloadRect(const nuiRect& rRect)
+{
+  if (!mForceReload)
+    mReloadRect = rRect;
+  else if (mReloadRect.GetWidth() > 0 && mReloadRect.GetHeight() > 0)
+  {
+    nuiRect r(mReloadRect);
+    mReloadRect.Union(r, rRect);
+  }
+  // else the whole texture is already waiting to be uploaded
+  mForceReload = true;
+}
+
+const nuiRect& nuiTexture::GetReloadRect() const
+{
+  return mReloadRect;
 }
 
 void nuiTexture::ResetForceReload()
 {
   mForceReload = false;
+  mReloadRect = nuiRect();
 }
 
 bool nuiTexture::IsPowerOfTwo() const
@@ -1035,6 +1063,16 @@ void nuiTexture::SetRetainBuffer(bool Retain)
   mRetainBuffer = Retain;
 }
 
+void nuiTexture::SetDistanceFieldSpread(float Spread)
+{
+  mDistanceFieldSpread = Spread;
+}
+
+float nuiTexture::GetDistanceFieldSpread() const
+{
+  return mDistanceFieldSpread;
+}
+
 bool nuiTexture::SetSource(const nglString& rName)
 {
   mpTextures.erase(GetProperty(_T("Source")));
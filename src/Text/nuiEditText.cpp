@@ -145,6 +145,7 @@ bool nuiEditText::Draw(nuiDrawContext* pContext)
 
 nuiRect nuiEditText::CalcIdealSize()
 {
+  TextBlock::Layout(mpBlocks);
   nuiRect global;
   uint count = (uint)mpBlocks.size();
   for (uint i = 0; i < count; i++)
@@ -162,6 +163,7 @@ nuiRect nuiEditText::CalcIdealSize()
 bool nuiEditText::SetRect(const nuiRect& rRect)
 {
   nuiWidget::SetRect(rRect);
+  TextBlock::Layout(mpBlocks);
   nuiRect global;
   uint count = (uint)mpBlocks.size();
   nuiSize y = 0;
@@ -705,6 +707,7 @@ void nuiEditText::CreateBlocks(const nglString& rText, std::vector<TextBlock*>&
   nuiRect global;
   nuiSize y = 0;
 
+  const uint first = (uint)rpBlocks.size();
   while (pos < len)
   {
     nglChar c = 0;
@@ -721,29 +724,26 @@ void nuiEditText::CreateBlocks(const nglString& rText, std::vector<TextBlock*>&
       }
     }
 
-    TextBlock* pBlock = new TextBlock(mpFont, rText, lastpos, pos);
-    nuiRect rect(pBlock->GetIdealSize());
-    rect.Move(0, y);
-    pBlock->SetRect(rect);
-    y += rect.GetHeight();
-    rpBlocks.push_back(pBlock);
+    rpBlocks.push_back(new TextBlock(mpFont, rText, lastpos, pos));
 
     lastpos = pos;
   }
 
   if (rText.GetChar(pos-1) == '\n')
+    rpBlocks.push_back(new TextBlock(mpFont, rText, pos, pos));
+
+  // Lay the new blocks out all at once, then stack them:
+  TextBlock::Layout(rpBlocks);
+  for (uint i = first; i < rpBlocks.size(); i++)
   {
-    TextBlock* pBlock = new TextBlock(mpFont, rText, pos, pos);
-    nuiRect rect(pBlock->GetIdealSize());
+    nuiRect rect(rpBlocks[i]->GetIdealSize());
     rect.Move(0, y);
-    pBlock->SetRect(rect);
+    rpBlocks[i]->SetRect(rect);
     y += rect.GetHeight();
-    rpBlocks.push_back(pBlock);
   }
 
   // Force relayout:
-  for (uint i = 0; i < mpBlocks.size(); i++)
-    mpBlocks[i]->Layout();
+  TextBlock::Layout(mpBlocks);
 
   InvalidateLayout();
 }
@@ -2212,11 +2212,42 @@ void nuiEditText::TextBlock::Layout()
   delete mpLayout;
   mpLayout = NULL;
 
-  nuiFontInfo fontinfo;
-  mpFont->GetInfo(fontinfo);
   mpLayout = new nuiTextLayout(mpFont, nuiHorizontal);
   nglString tmp(mrString.Extract(GetPos(), GetLength()));
   mpLayout->Layout(tmp);
+  UpdateIdealRect();
+}
+
+void nuiEditText::TextBlock::Layout(const std::vector<TextBlock*>& rpBlocks)
+{
+  std::vector<TextBlock*> blocks;
+  std::vector<nuiTextLayout*> layouts;
+  std::vector<nglString> strings;
+  for (uint i = 0; i < rpBlocks.size(); i++)
+  {
+    TextBlock* pBlock = rpBlocks[i];
+    if (pBlock->mLayoutOK)
+      continue;
+
+    delete pBlock->mpLayout;
+    pBlock->mpLayout = new nuiTextLayout(pBlock->mpFont, nuiHorizontal);
+    blocks.push_back(pBlock);
+    layouts.push_back(pBlock->mpLayout);
+    strings.push_back(pBlock->mrString.Extract(pBlock->GetPos(), pBlock->GetLength()));
+  }
+
+  if (blocks.empty())
+    return;
+
+  nuiTextLayout::Layout(layouts, strings, nuiTaskPool::GetDefault());
+  for (uint i = 0; i < blocks.size(); i++)
+    blocks[i]->UpdateIdealRect();
+}
+
+void nuiEditText::TextBlock::UpdateIdealRect()
+{
+  nuiFontInfo fontinfo;
+  mpFont->GetInfo(fontinfo);
 
   /*
   nuiGlyphInfo metrics;
@@ -392,6 +392,23 @@ bool nuiContainer::DrawChildren(nuiDrawContext* pContext)
   return true;
 }
 
+uint32 nuiContainer::DumpRenderCacheMemory(uint32 Depth)
+{
+  CheckValid();
+  uint32 size = nuiWidget::DumpRenderCacheMemory(Depth);
+
+  IteratorPtr pIt;
+  for (pIt = GetFirstChild(); pIt && pIt->IsValid(); GetNextChild(pIt))
+  {
+    nuiWidgetPtr pItem = pIt->GetWidget();
+    if (pItem)
+      size += pItem->DumpRenderCacheMemory(Depth + 1);
+  }
+  delete pIt;
+
+  return size;
+}
+
 void nuiContainer::DrawChild(nuiDrawContext* pContext, nuiWidget* pChild)
 {  
   CheckValid();
@@ -400,15 +417,27 @@ void nuiContainer::DrawChild(nuiDrawContext* pContext, nuiWidget* pChild)
   x = (float)pChild->GetRect().mLeft;
   y = (float)pChild->GetRect().mTop;
 
+  // Skip the clean children outside of the clip rect before touching the matrix stack and the painter:
+  if (pChild->IsVisible() && pChild->CanCull(pContext, x, y))
+  {
+    mCulledCount++;
+    return;
+  }
+
+  nuiPainter* pPainter = pContext->GetPainter();
+  nuiMetaPainter* pMetaPainter = NULL;
+  if (IsDrawingInCache(true))
+    pMetaPainter = dynamic_cast<nuiMetaPainter*>(pPainter);
+
+  // The render cache places the child itself when it is replayed:
   bool matrixchanged = false;
-  if (x != 0 || y != 0)
+  if ((x != 0 || y != 0) && (!pMetaPainter || pMetaPainter->GetDrawChildrenImmediat()))
   {
     pContext->PushMatrix();
     pContext->Translate( x, y );
     matrixchanged = true;
   }
 
-  nuiPainter* pPainter = pContext->GetPainter();
   if (mpSavedPainter)
     pContext->SetPainter(mpSavedPainter);
 
@@ -417,12 +446,8 @@ void nuiContainer::DrawChild(nuiDrawContext* pContext, nuiWidget* pChild)
   if (mpSavedPainter)
     pContext->SetPainter(pPainter);
 
-  if (IsDrawingInCache(true))
-  {
-    nuiMetaPainter* pMetaPainter = dynamic_cast<nuiMetaPainter*>(pPainter);
-    if (pMetaPainter)
-      pMetaPainter->DrawChild(pContext, pChild);
-  }
+  if (pMetaPainter)
+    pMetaPainter->DrawChild(pContext, pChild);
 
   if (matrixchanged)
   {
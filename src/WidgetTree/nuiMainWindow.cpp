@@ -221,6 +221,18 @@ void nuiMainWindow::Paint()
   //watch.AddIntermediate(_T("After FillTrash()"));
   
   nuiDrawContext* pContext = GetDrawContext();
+
+  nuiBatchPainter* pBatch = dynamic_cast<nuiBatchPainter*>(pContext->GetMainPainter());
+  if (pBatch)
+  {
+    pBatch->SetBatching(mBatchDrawCalls);
+  }
+  else if (mBatchDrawCalls)
+  {
+    pBatch = new nuiBatchPainter(pContext->GetMainPainter());
+    pContext->SetMainPainter(pBatch);
+    pContext->SetPainter(pBatch);
+  }
   
   pContext->GetPainter()->ResetStats();
 
@@ -229,7 +241,7 @@ void nuiMainWindow::Paint()
 #endif
 
 #ifndef __NUI_NO_SOFTWARE__
-  nuiSoftwarePainter* pCTX = dynamic_cast<nuiSoftwarePainter*>(pContext->GetPainter());
+  nuiSoftwarePainter* pCTX = dynamic_cast<nuiSoftwarePainter*>(pBatch ? pBatch->GetTarget() : pContext->GetPainter());
 #endif
 
   mpNGLWindow->BeginSession();
@@ -328,6 +340,8 @@ void nuiMainWindow::Paint()
 #ifndef __NUI_NO_SOFTWARE__
   if (pCTX)
   {
+    if (pBatch)
+      pBatch->Flush();
     if (DrawFullFrame)
     {
       pCTX->Display(GetNGLWindow(), GetRect());      
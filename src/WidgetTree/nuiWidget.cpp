@@ -21,6 +21,29 @@ bool nuiWidget::GetGlobalUseRenderCache()
   return mGlobalUseRenderCache;
 }
 
+bool nuiWidget::mGlobalUseCulling = true;
+uint32 nuiWidget::mCulledCount = 0;
+
+void nuiWidget::SetGlobalUseCulling(bool set)
+{
+  mGlobalUseCulling = set;
+}
+
+bool nuiWidget::GetGlobalUseCulling()
+{
+  return mGlobalUseCulling;
+}
+
+uint32 nuiWidget::GetCulledCount()
+{
+  return mCulledCount;
+}
+
+void nuiWidget::ResetCulledCount()
+{
+  mCulledCount = 0;
+}
+
 //#define NUI_LOG_GETIDEALRECT
 
 // Use like this:  nuiAnimation::RunOnAnimationTick(nuiMakeTask(nuiDelayedPlayAnim, eAnimFromStart, Time, count, loopmode));
@@ -130,6 +153,9 @@ void nuiWidget::InitDefaultValues()
   mPosition = nuiFill;
   mFillRule = nuiFill;
   mCSSPasses = 0;
+  mpCSSRulesOwner = NULL;
+  mCSSRulesGeneration = 0;
+  mpCSSRules = NULL;
   mpMatrixNodes = NULL;
   mpParent = NULL;
   mpTheme = NULL;
@@ -518,6 +544,7 @@ void nuiWidget::Init()
   mDrawingInCache = false;
   mpRenderCache = NULL;
 	mUseRenderCache = false;
+  mPartialRenderCache = false;
 
   mTrashed = false;
   mDoneTrashed = false;
@@ -605,6 +632,7 @@ bool nuiWidget::SetObjectClass(const nglString& rName)
   CheckValid();
   
   bool res = nuiObject::SetObjectClass(rName);
+  mpCSSRules = NULL;
   ResetCSSPass();
   ApplyCSSForStateChange(NUI_WIDGET_MATCHTAG_ALL);
   return res;
@@ -616,6 +644,7 @@ void nuiWidget::SetObjectName(const nglString& rName)
   CheckValid();
   
   nuiObject::SetObjectName(rName);
+  mpCSSRules = NULL;
   ResetCSSPass();
   ApplyCSSForStateChange(NUI_WIDGET_MATCHTAG_ALL);
 }
@@ -1444,6 +1473,13 @@ bool nuiWidget::DrawWidget(nuiDrawContext* pContext)
   {
     bool drawingincache = mpParent ? mpParent->IsDrawingInCache(true) : false;
     
+    // nuiContainer::DrawChild already skips its children this way, this catches the widgets drawn by other means:
+    if (CanCull(pContext))
+    {
+      mCulledCount++;
+      return false;
+    }
+
     nuiRect clip;
     pContext->GetClipRect(clip, true);
     nuiRect _self = GetOverDrawRect(true, false);
@@ -1511,6 +1547,59 @@ bool nuiWidget::DrawWidget(nuiDrawContext* pContext)
   return true;
 }
 
+bool nuiWidget::CanCull(nuiDrawContext* pContext, float X, float Y) const
+{
+  // Nothing to update in this branch and nothing to show in the area being drawn (a dirty rect, the visible part of a scroll view...).
+  // Without auto clipping the children may draw outside of this widget so it can't be skipped. A parent that is recording its render
+  // cache must see all its children.
+  if (!mGlobalUseCulling || !mAutoClip || mSurfaceEnabled || mNeedRender || mNeedSelfRedraw)
+    return false;
+  if (mpParent && mpParent->IsDrawingInCache(true))
+    return false;
+  return IsClippedOut(pContext, X, Y);
+}
+
+bool nuiWidget::IsClippedOut(nuiDrawContext* pContext, float X, float Y) const
+{
+  nuiMatrix m(pContext->GetMatrix());
+  if (X != 0 || Y != 0)
+  {
+    nuiMatrix t;
+    t.SetTranslation(X, Y, 0);
+    m *= t;
+  }
+  if (!IsMatrixIdentity())
+    m *= GetMatrix();
+
+  // Don't try to guess with projections:
+  if (m.Elt.M41 != 0 || m.Elt.M42 != 0 || m.Elt.M43 != 0 || m.Elt.M44 != 1)
+    return false;
+
+  nuiRect clip;
+  pContext->GetClipRect(clip, false);
+
+  const nuiRect r(GetOverDrawRect(true, true));
+  nuiVector corners[4] =
+  {
+    nuiVector(r.Left(), r.Top(), 0),
+    nuiVector(r.Right(), r.Top(), 0),
+    nuiVector(r.Right(), r.Bottom(), 0),
+    nuiVector(r.Left(), r.Bottom(), 0)
+  };
+
+  float left = FLT_MAX, top = FLT_MAX, right = -FLT_MAX, bottom = -FLT_MAX;
+  for (int32 i = 0; i < 4; i++)
+  {
+    const nuiVector v(m * corners[i]);
+    left = MIN(left, v[0]);
+    top = MIN(top, v[1]);
+    right = MAX(right, v[0]);
+    bottom = MAX(bottom, v[1]);
+  }
+
+  return right <= clip.Left() || left >= clip.Right() || bottom <= clip.Top() || top >= clip.Bottom();
+}
+
 void nuiWidget::DrawSurface(nuiDrawContext* pContext)
 {
   CheckValid();
@@ -3413,7 +3502,7 @@ void nuiWidget::InternalSetLayout(const nuiRect& rect)
     mVisibleRect = GetOverDrawRect(true, true);
   
   if (PositionChanged && mpParent)
-    mpParent->Invalidate();
+    mpParent->ChildMoved(this);
   
   mNeedSelfLayout = false;
   mNeedLayout = false;
@@ -4143,6 +4232,58 @@ const nuiMetaPainter* nuiWidget::GetRenderCache() const
   return mpRenderCache;
 }
 
+void nuiWidget::EnablePartialRenderCache(bool set)
+{
+  CheckValid();
+  mPartialRenderCache = set;
+}
+
+bool nuiWidget::IsPartialRenderCacheEnabled() const
+{
+  CheckValid();
+  return mPartialRenderCache;
+}
+
+void nuiWidget::ChildMoved(nuiWidgetPtr pChild)
+{
+  CheckValid();
+  if (!mPartialRenderCache || (mpRenderCache && mpRenderCache->GetDrawChildrenImmediat()))
+  {
+    Invalidate();
+    return;
+  }
+
+  if (!IsVisible(true))
+    return;
+
+  // Redraw without resetting the render cache:
+  nuiRect r(GetOverDrawRect(true, true));
+  r.Intersect(r, GetVisibleRect());
+  r.RoundToBiggest();
+  BroadcastInvalidateRect(this, r);
+  InvalidateSurface();
+  if (mpParent)
+    mpParent->BroadcastInvalidate(this);
+  DebugRefreshInfo();
+}
+
+uint32 nuiWidget::DumpRenderCacheMemory(uint32 Depth)
+{
+  CheckValid();
+  uint32 size = 0;
+  if (mpRenderCache)
+  {
+    size = mpRenderCache->GetMemoryUsage(true);
+    NGL_OUT(_T("%*s%s '%s': %d bytes, %d operations, %d render states (%d shared)\n"), Depth * 2, "", GetObjectClass().GetChars(), GetObjectName().GetChars(),
+            size, mpRenderCache->GetNbOperations(), mpRenderCache->GetNbRenderStates(), mpRenderCache->GetNbSharedRenderStates());
+  }
+  else
+  {
+    NGL_OUT(_T("%*s%s '%s': no render cache\n"), Depth * 2, "", GetObjectClass().GetChars(), GetObjectName().GetChars());
+  }
+  return size;
+}
+
 void nuiWidget::EnableSurface(bool Set)
 {
   CheckValid();
@@ -5018,6 +5159,22 @@ uint32 nuiWidget::GetCSSPass() const
   return mCSSPasses;
 }
 
+const std::vector<nuiCSSRule*>* nuiWidget::GetCSSRules(const nuiCSS* pCSS, uint32 Generation) const
+{
+  CheckValid();
+  if (mpCSSRulesOwner != pCSS || mCSSRulesGeneration != Generation)
+    return NULL;
+  return mpCSSRules;
+}
+
+void nuiWidget::SetCSSRules(const nuiCSS* pCSS, uint32 Generation, const std::vector<nuiCSSRule*>* pRules)
+{
+  CheckValid();
+  mpCSSRulesOwner = pCSS;
+  mCSSRulesGeneration = Generation;
+  mpCSSRules = pRules;
+}
+
 void nuiWidget::DrawFocus(nuiDrawContext* pContext, bool FrontOrBack)
 {
   CheckValid();
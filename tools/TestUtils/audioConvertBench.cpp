@@ -0,0 +1,105 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioConvert.h"
+
+#define BENCH_SAMPLES (1024 * 1024)
+
+typedef void (*BenchFunction)(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count);
+
+void benchInt16ToFloat(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_Int16ToFloat((const int16*)&rIn[0], (float*)&rOut[0], count);
+}
+
+void benchFloatToInt16(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_FloatToInt16((const float*)&rIn[0], (int16*)&rOut[0], count);
+}
+
+void benchFloatToInt16Dither(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  static uint32 state = 1;
+  nuiAudioConvert_FloatToInt16Dither((const float*)&rIn[0], (int16*)&rOut[0], count, state);
+}
+
+void benchInt24ToFloat(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_Int24LEToFloat(&rIn[0], (float*)&rOut[0], count);
+}
+
+void benchFloatToInt24(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_FloatToInt24LE((const float*)&rIn[0], &rOut[0], count);
+}
+
+void benchInt32ToFloat(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_Int32ToFloat((const int32*)&rIn[0], (float*)&rOut[0], count);
+}
+
+void benchFloatToInt32(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  nuiAudioConvert_FloatToInt32((const float*)&rIn[0], (int32*)&rOut[0], count);
+}
+
+void benchInterleave(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  const float* pChannels[2] = { (const float*)&rIn[0], (const float*)&rIn[0] + count / 2 };
+  nuiAudioConvert_Interleave(pChannels, (float*)&rOut[0], 2, count / 2);
+}
+
+void benchDeinterleave(std::vector<uint8>& rIn, std::vector<uint8>& rOut, int64 count)
+{
+  float* pChannels[2] = { (float*)&rOut[0], (float*)&rOut[0] + count / 2 };
+  nuiAudioConvert_Deinterleave((const float*)&rIn[0], pChannels, 2, count / 2);
+}
+
+void performTest(const char* pName, BenchFunction pFunction, int iterations)
+{
+  // Big enough for any of the formats, filled with valid floats that are also acceptable integer samples:
+  std::vector<uint8> in(BENCH_SAMPLES * sizeof(float));
+  std::vector<uint8> out(BENCH_SAMPLES * sizeof(float));
+  float* pIn = (float*)&in[0];
+  for (int64 i = 0; i < BENCH_SAMPLES; i++)
+    pIn[i] = sinf((float)i * 0.01f) * 0.9f;
+
+  printf("%-20s", pName);
+  for (int32 impl = eAudioConvertScalar; impl <= eAudioConvertAVX2; impl++)
+  {
+    if (!nuiAudioConvert_SetImplementation((nuiAudioConvertImplementation)impl))
+    {
+      printf("  %6s:        n/a", nuiAudioConvert_GetImplementationName((nuiAudioConvertImplementation)impl));
+      continue;
+    }
+
+    pFunction(in, out, BENCH_SAMPLES); // Warm up the caches
+    nglTime start;
+    for (int32 i = 0; i < iterations; i++)
+      pFunction(in, out, BENCH_SAMPLES);
+    nglTime end;
+
+    double seconds = (double)end - (double)start;
+    printf("  %6s: %8.1f Ms/s", nuiAudioConvert_GetImplementationName((nuiAudioConvertImplementation)impl), (double)BENCH_SAMPLES * iterations / seconds / 1000000.0);
+  }
+  printf("\n");
+  nuiAudioConvert_ResetImplementation();
+}
+
+int main(int argc, char** argv)
+{
+  int iterations = 200;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    iterations = atoi(argv[1]);
+
+  printf("Converting %d x %d samples (million samples per second).\n", iterations, BENCH_SAMPLES);
+  performTest("int16 -> float", benchInt16ToFloat, iterations);
+  performTest("float -> int16", benchFloatToInt16, iterations);
+  performTest("float -> int16 TPDF", benchFloatToInt16Dither, iterations);
+  performTest("int24 -> float", benchInt24ToFloat, iterations);
+  performTest("float -> int24", benchFloatToInt24, iterations);
+  performTest("int32 -> float", benchInt32ToFloat, iterations);
+  performTest("float -> int32", benchFloatToInt32, iterations);
+  performTest("interleave", benchInterleave, iterations);
+  performTest("deinterleave", benchDeinterleave, iterations);
+  return 0;
+}
+
@@ -0,0 +1,108 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioConvert.h"
+
+// Run every conversion with each implementation the CPU supports and check that the results are bit for bit the same as the scalar
+// ones. The input mixes silence, full scale, out of range values and values on the rounding boundaries, the buffer sizes are odd so
+// that the vector kernels also go through their scalar tails. Returns the number of failures.
+
+#define TEST_SAMPLES 4099
+
+static uint32 Random(uint32& rSeed)
+{
+  rSeed = rSeed * 1664525 + 1013904223;
+  return rSeed >> 8;
+}
+
+static void FillInput(std::vector<float>& rIn)
+{
+  uint32 seed = 1;
+  for (uint32 i = 0; i < rIn.size(); i++)
+  {
+    switch (i % 6)
+    {
+    case 0: rIn[i] = 0; break;
+    case 1: rIn[i] = (i & 8) ? 1.0f : -1.0f; break;
+    case 2: rIn[i] = (float)(Random(seed) % 30000) / 10000.0f - 1.5f; break; // Out of range too
+    case 3: rIn[i] = ((float)(Random(seed) % 65536) - 32768.0f + 0.5f) / 32767.0f; break; // Half way between two steps
+    default: rIn[i] = (float)(Random(seed) % 20000) / 10000.0f - 1.0f; break;
+    }
+  }
+}
+
+static void Convert(const std::vector<float>& rIn, int64 count, uint32 DitherSeed, std::vector<uint8>& rOut)
+{
+  std::vector<int16> int16s(count);
+  std::vector<int16> dithered(count);
+  std::vector<uint8> int24s(count * 3);
+  std::vector<int32> int32s(count);
+  std::vector<float> floats(count * 2);
+  std::vector<float> interleaved(count);
+  std::vector<float> left(count / 2);
+  std::vector<float> right(count / 2);
+
+  nuiAudioConvert_FloatToInt16(&rIn[0], &int16s[0], count);
+  nuiAudioConvert_FloatToInt24LE(&rIn[0], &int24s[0], count);
+  nuiAudioConvert_FloatToInt32(&rIn[0], &int32s[0], count);
+
+  // Two buffers in a row to check the state kept between them:
+  uint32 state = DitherSeed;
+  nuiAudioConvert_FloatToInt16Dither(&rIn[0], &dithered[0], count / 2, state);
+  nuiAudioConvert_FloatToInt16Dither(&rIn[count / 2], &dithered[count / 2], count - count / 2, state);
+
+  nuiAudioConvert_Int16ToFloat(&int16s[0], &floats[0], count);
+  nuiAudioConvert_Int24LEToFloat(&int24s[0], &floats[count], count);
+
+  const float* pIn[2] = { &rIn[0], &rIn[count / 2] };
+  nuiAudioConvert_Interleave(pIn, &interleaved[0], 2, count / 2);
+  float* pOut[2] = { &left[0], &right[0] };
+  nuiAudioConvert_Deinterleave(&rIn[0], pOut, 2, count / 2);
+
+  rOut.clear();
+  rOut.insert(rOut.end(), (uint8*)&int16s[0], (uint8*)&int16s[0] + count * sizeof(int16));
+  rOut.insert(rOut.end(), (uint8*)&dithered[0], (uint8*)&dithered[0] + count * sizeof(int16));
+  rOut.insert(rOut.end(), int24s.begin(), int24s.end());
+  rOut.insert(rOut.end(), (uint8*)&int32s[0], (uint8*)&int32s[0] + count * sizeof(int32));
+  rOut.insert(rOut.end(), (uint8*)&floats[0], (uint8*)&floats[0] + floats.size() * sizeof(float));
+  rOut.insert(rOut.end(), (uint8*)&interleaved[0], (uint8*)&interleaved[0] + (count / 2) * 2 * sizeof(float));
+  rOut.insert(rOut.end(), (uint8*)&left[0], (uint8*)&left[0] + left.size() * sizeof(float));
+  rOut.insert(rOut.end(), (uint8*)&right[0], (uint8*)&right[0] + right.size() * sizeof(float));
+  rOut.push_back((uint8)state);
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<float> in(TEST_SAMPLES);
+  FillInput(in);
+
+  const int64 counts[] = { 1, 7, 8, 9, 15, 16, 17, 33, 1000, TEST_SAMPLES };
+  const uint32 seeds[] = { 0, 1, 12345, 0xffffffff };
+  int32 fails = 0;
+
+  for (uint32 c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+  {
+    for (uint32 s = 0; s < sizeof(seeds) / sizeof(seeds[0]); s++)
+    {
+      std::vector<uint8> reference;
+      nuiAudioConvert_SetImplementation(eAudioConvertScalar);
+      Convert(in, counts[c], seeds[s], reference);
+
+      for (int32 impl = eAudioConvertScalar + 1; impl <= eAudioConvertAVX2; impl++)
+      {
+        if (!nuiAudioConvert_SetImplementation((nuiAudioConvertImplementation)impl))
+          continue;
+
+        std::vector<uint8> result;
+        Convert(in, counts[c], seeds[s], result);
+        if (result != reference)
+        {
+          printf("%s differs from scalar (%d samples, seed %u)\n", nuiAudioConvert_GetImplementationName((nuiAudioConvertImplementation)impl), (int32)counts[c], seeds[s]);
+          fails++;
+        }
+      }
+    }
+  }
+
+  nuiAudioConvert_ResetImplementation();
+  printf("%d failures\n", fails);
+  return fails;
+}
@@ -0,0 +1,137 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioEngine.h"
+#include "nui3/include/nuiSynthSound.h"
+#include "nui3/include/nuiSynthVoice.h"
+
+// Offline render of the audio engine: benchmark with 1..N render threads and optional stress test where
+// another thread keeps starting and stopping voices while the engine renders.
+
+#define RENDER_SAMPLERATE 48000
+#define RENDER_BUFFER 512
+
+class VoiceStress : public nglThread
+{
+public:
+  VoiceStress(nuiAudioEngine& rEngine, nuiSynthSound* pSound)
+  : mrEngine(rEngine), mpSound(pSound), mStop(false), mStarted(0)
+  {
+  }
+
+  void OnStart()
+  {
+    std::vector<nuiVoice*> voices;
+    uint32 seed = 1;
+    while (!mStop)
+    {
+      seed = seed * 1664525 + 1013904223;
+      if (voices.size() < 64 && (seed & 0x100))
+      {
+        nuiVoice* pVoice = mrEngine.PlaySound(mpSound);
+        if (pVoice)
+        {
+          pVoice->Acquire();
+          voices.push_back(pVoice);
+          mStarted++;
+        }
+      }
+      else if (!voices.empty())
+      {
+        nuiVoice* pVoice = voices[seed % voices.size()];
+        voices.erase(std::find(voices.begin(), voices.end(), pVoice));
+        mrEngine.StopSound(pVoice);
+        pVoice->Release();
+      }
+      nglThread::USleep(100);
+    }
+
+    for (size_t i = 0; i < voices.size(); i++)
+    {
+      mrEngine.StopSound(voices[i]);
+      voices[i]->Release();
+    }
+  }
+
+  nuiAudioEngine& mrEngine;
+  nuiSynthSound* mpSound;
+  volatile bool mStop;
+  uint32 mStarted;
+};
+
+void performTest(int32 voices, int32 seconds, uint32 threads, bool stress)
+{
+  nuiAudioEngine engine(RENDER_SAMPLERATE, RENDER_BUFFER, nuiAudioEngine::eNone, 1024, true);
+  engine.SetRenderThreads(threads);
+
+  nuiSynthSound* pSound = nuiSoundManager::Instance.GetSynthSound();
+  pSound->Acquire();
+  for (int32 v = 0; v < voices; v++)
+  {
+    nuiVoice* pVoice = engine.PlaySound(pSound);
+    if (!pVoice)
+      continue;
+    pVoice->SetPan((float)v / (float)voices * 2.0f - 1.0f);
+    pVoice->SetGain(0.05f);
+    pVoice->SetLoop(true);
+  }
+
+  VoiceStress stressThread(engine, pSound);
+  if (stress)
+    stressThread.Start();
+
+  std::vector<float> data(RENDER_BUFFER * 2);
+  std::vector<float*> buffers;
+  buffers.push_back(&data[0]);
+  buffers.push_back(&data[RENDER_BUFFER]);
+
+  const int32 count = seconds * RENDER_SAMPLERATE / RENDER_BUFFER;
+  double level = 0;
+  nglTime start;
+  for (int32 b = 0; b < count; b++)
+  {
+    engine.Render(buffers, RENDER_BUFFER);
+    level = MAX(level, engine.GetOutputPeak(0));
+  }
+  nglTime end;
+
+  if (stress)
+  {
+    stressThread.mStop = true;
+    stressThread.Join();
+    engine.Render(buffers, RENDER_BUFFER); // Let the engine process the last commands
+    engine.ReleaseStoppedVoices();
+  }
+  pSound->Release();
+
+  double elapsed = (double)end - (double)start;
+  printf("%4d voices %2d threads%s: %7.3f s for %d s of audio (%6.1fx real time), peak %f, dropped %d",
+         voices, engine.GetRenderThreads(), stress ? " +stress" : "", elapsed, seconds, (double)seconds / elapsed, level, engine.GetDroppedVoices());
+  if (stress)
+    printf(", %d voices started", stressThread.mStarted);
+  printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+  int32 seconds = 10;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    seconds = atoi(argv[1]);
+
+  nuiInit(NULL);
+  {
+    performTest(128, seconds, 1, false);
+    performTest(128, seconds, 0, false);
+    performTest(512, seconds, 1, false);
+    performTest(512, seconds, 0, false);
+    performTest(128, seconds, 1, true);
+    performTest(128, seconds, 0, true);
+
+    // Stems on disk:
+    nuiAudioEngine engine(RENDER_SAMPLERATE, RENDER_BUFFER, nuiAudioEngine::eNone, 1024, true);
+    engine.PlaySound(nuiSoundManager::Instance.GetSynthSound());
+    int64 frames = engine.RenderToFile(nglPath(_T("audioEngineRender.wav")), -1, 24);
+    printf("Rendered %lld frames to audioEngineRender.wav\n", frames);
+  }
+  nuiUninit();
+  return 0;
+}
+
@@ -0,0 +1,137 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioEngine.h"
+#include "nui3/include/nuiFileVoice.h"
+#include "nui3/include/nuiWaveReader.h"
+#include "nui3/include/nuiWaveWriter.h"
+
+// Bounce a file voice with an offline engine and compare the result sample by sample with the file decoded directly. The offline
+// render runs much faster than real time, so a voice that still went through the streaming loader would have dropouts. The source
+// is a float wave at the engine's rate and the voice plays at unity gain in the center: the mix must give back the exact samples.
+// Returns the number of failures.
+
+#define BOUNCE_SAMPLERATE 48000
+#define BOUNCE_BUFFER 512
+#define BOUNCE_SECONDS 20
+#define BOUNCE_ROUNDS 3
+
+static bool WriteSource(const nglPath& rPath, int32 frames)
+{
+  nglOFile file(rPath, eOFileCreate);
+  if (!file.IsOpen())
+    return false;
+
+  nuiSampleInfo info;
+  info.SetSampleRate(BOUNCE_SAMPLERATE);
+  info.SetChannels(2);
+  info.SetBitsPerSample(32);
+  info.SetSampleFrames(0);
+  info.SetFormatTag(eWaveFormatIEEEfloat);
+
+  nuiWaveWriter writer(file);
+  if (!writer.WriteInfo(info))
+    return false;
+
+  // Noise, so that any gap, repeat or shift shows:
+  uint32 seed = 1;
+  std::vector<float> data(2 * frames);
+  for (uint32 i = 0; i < data.size(); i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    data[i] = (float)((seed >> 8) % 20000) / 40000.0f - 0.25f;
+  }
+  if (writer.Write(&data[0], frames, eSampleFloat32) != frames)
+    return false;
+  return writer.Finalize();
+}
+
+// Interleaved float frames of a wave file:
+static bool Decode(const nglPath& rPath, std::vector<float>& rData)
+{
+  nglIStream* pStream = rPath.OpenRead();
+  if (!pStream)
+    return false;
+
+  nuiWaveReader reader(*pStream);
+  nuiSampleInfo info;
+  bool res = reader.GetInfo(info) && info.GetChannels() == 2;
+  if (res)
+  {
+    rData.resize(2 * info.GetSampleFrames());
+    res = reader.ReadIN(&rData[0], info.GetSampleFrames(), eSampleFloat32) == info.GetSampleFrames();
+  }
+  delete pStream;
+  return res;
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+  int32 fails = 0;
+  {
+    const nglPath source(_T("audioFileBounceSource.wav"));
+    const nglPath bounce(_T("audioFileBounce.wav"));
+    const int32 frames = BOUNCE_SECONDS * BOUNCE_SAMPLERATE;
+
+    std::vector<float> reference;
+    if (!WriteSource(source, frames) || !Decode(source, reference))
+    {
+      printf("Can't create %s\n", source.GetChars());
+      nuiUninit();
+      return 1;
+    }
+
+    // Streaming with a small prefetch, which the offline voices must not use:
+    nuiFileVoice::SetStreaming(true, 4096);
+
+    // Several rounds, each render must give the same samples:
+    for (int32 r = 0; r < BOUNCE_ROUNDS; r++)
+    {
+      nuiAudioEngine engine(BOUNCE_SAMPLERATE, BOUNCE_BUFFER, nuiAudioEngine::eNone, 16, true);
+      nuiFileVoice* pVoice = (nuiFileVoice*)engine.PlaySound(source, nuiSound::eStream);
+      if (!pVoice)
+      {
+        printf("Can't play %s\n", source.GetChars());
+        fails++;
+        break;
+      }
+      pVoice->Acquire();
+
+      const int64 rendered = engine.RenderToFile(bounce, frames, 32);
+      std::vector<float> result;
+      if (rendered != frames || !Decode(bounce, result) || result.size() != reference.size())
+      {
+        printf("round %d: the bounce failed (%lld frames)\n", r, rendered);
+        fails++;
+      }
+      else
+      {
+        int32 diffs = 0;
+        int32 first = -1;
+        for (uint32 i = 0; i < reference.size(); i++)
+        {
+          if (result[i] != reference[i])
+          {
+            if (first < 0)
+              first = i / 2;
+            diffs++;
+          }
+        }
+        printf("round %d: %d samples differ (first at frame %d), %d underruns, %s\n", r, diffs, first, pVoice->GetUnderruns(),
+               pVoice->IsStreamingVoice() ? "streaming" : "not streaming");
+        if (diffs || pVoice->GetUnderruns() || pVoice->IsStreamingVoice())
+          fails++;
+      }
+
+      engine.StopSound(pVoice);
+      pVoice->Release();
+    }
+
+    nuiFileVoice::SetStreaming(true);
+    source.Delete();
+    bounce.Delete();
+  }
+  nuiUninit();
+
+  printf("%d failures\n", fails);
+  return fails;
+}
@@ -0,0 +1,82 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioDSP.h"
+
+// Mix N mono voices to a stereo bus the way nuiVoice does (gain + pan, a fade on every other voice),
+// then apply the master gain and meter the result like nuiAudioEngine. Reports the cost relative to real time.
+
+#define BENCH_SAMPLERATE 48000
+#define BENCH_BUFFER 512
+
+void performTest(int32 voices, int32 seconds, bool simd)
+{
+  nuiAudioDSP_EnableSIMD(simd);
+
+  std::vector<std::vector<float> > sources(voices);
+  std::vector<float> gains(voices * 2);
+  for (int32 v = 0; v < voices; v++)
+  {
+    sources[v].resize(BENCH_SAMPLERATE); // one second of material per voice, looped
+    for (int32 i = 0; i < BENCH_SAMPLERATE; i++)
+      sources[v][i] = sinf((float)i * (0.01f + 0.001f * v));
+    nuiAudioDSP_PanGains((float)v / (float)voices * 2.0f - 1.0f, eAudioPanConstantPower, gains[v * 2], gains[v * 2 + 1]);
+  }
+
+  std::vector<float> bus(BENCH_BUFFER * 2);
+  std::vector<float> output(BENCH_BUFFER * 2);
+  float* pBusLeft = &bus[0];
+  float* pBusRight = &bus[BENCH_BUFFER];
+
+  const int32 buffers = seconds * BENCH_SAMPLERATE / BENCH_BUFFER;
+  double level = 0; // Keeps the metering from being optimized away
+
+  nglTime start;
+  for (int32 b = 0; b < buffers; b++)
+  {
+    const int32 position = (b * BENCH_BUFFER) % (BENCH_SAMPLERATE - BENCH_BUFFER);
+    nuiAudioDSP_Clear(&bus[0], BENCH_BUFFER * 2);
+
+    for (int32 v = 0; v < voices; v++)
+    {
+      const float* pSrc = &sources[v][position];
+      const float left = gains[v * 2] * 0.1f;
+      const float right = gains[v * 2 + 1] * 0.1f;
+      if (v & 1)
+      {
+        const float fade = (float)(b % 100) / 100.0f;
+        nuiAudioDSP_MixAddStereoRamp(pSrc, pBusLeft, pBusRight, BENCH_BUFFER, left * fade, left * (fade + 0.01f), right * fade, right * (fade + 0.01f));
+      }
+      else
+      {
+        nuiAudioDSP_MixAddStereo(pSrc, pBusLeft, pBusRight, BENCH_BUFFER, left, right);
+      }
+    }
+
+    nuiAudioDSP_Clear(&output[0], BENCH_BUFFER * 2);
+    nuiAudioDSP_MixAdd(pBusLeft, &output[0], BENCH_BUFFER, 0.8f);
+    nuiAudioDSP_MixAdd(pBusRight, &output[BENCH_BUFFER], BENCH_BUFFER, 0.8f);
+    level = MAX(level, nuiAudioDSP_Peak(&output[0], BENCH_BUFFER));
+    level = MAX(level, nuiAudioDSP_RMS(&output[BENCH_BUFFER], BENCH_BUFFER));
+  }
+  nglTime end;
+
+  double elapsed = (double)end - (double)start;
+  printf("%4d voices %6s: %7.3f s for %d s of audio, %6.2f%% of one core (level %f)\n", voices, simd ? "SIMD" : "scalar", elapsed, seconds, elapsed / (double)seconds * 100.0, level);
+}
+
+int main(int argc, char** argv)
+{
+  int32 seconds = 10;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    seconds = atoi(argv[1]);
+
+  printf("Mixing at %d Hz, %d frames per buffer.\n", BENCH_SAMPLERATE, BENCH_BUFFER);
+  const int32 counts[] = { 16, 64, 128, 256 };
+  for (int32 i = 0; i < 4; i++)
+  {
+    performTest(counts[i], seconds, false);
+    performTest(counts[i], seconds, true);
+  }
+  nuiAudioDSP_EnableSIMD(true);
+  return 0;
+}
+
@@ -0,0 +1,98 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiAudioDSP.h"
+#include "nui3/include/nuiPolyphaseResampler.h"
+
+// Convert a sine through nuiPolyphaseResampler in blocks the way nuiVoice does, for each preset with and without SIMD.
+// Reports the error against the ideal sine, the aliasing of a tone above the output Nyquist frequency and the cost.
+
+#define BENCH_BUFFER 512
+#define BENCH_CHANNELS 2
+
+// Returns the cost relative to real time. rError is the biggest difference with the ideal output, rLevel the RMS level of the output.
+double performTest(nuiPolyphaseResampler::Quality quality, double InputRate, double OutputRate, double Frequency, int32 seconds, bool simd, double& rError, double& rLevel)
+{
+  nuiAudioDSP_EnableSIMD(simd);
+  nuiPolyphaseResampler resampler(BENCH_CHANNELS, InputRate, OutputRate, quality);
+  resampler.Prepare(BENCH_BUFFER);
+
+  const int32 inputFrames = resampler.GetInputFramesNeeded(BENCH_BUFFER) + resampler.GetLatency() * 2 + 4;
+  std::vector<float> input(inputFrames * BENCH_CHANNELS);
+  std::vector<float> output(BENCH_BUFFER * BENCH_CHANNELS);
+  std::vector<const float*> inputs(BENCH_CHANNELS);
+  std::vector<float*> outputs(BENCH_CHANNELS);
+  for (int32 c = 0; c < BENCH_CHANNELS; c++)
+    outputs[c] = &output[c * BENCH_BUFFER];
+
+  const int32 buffers = (int32)(seconds * OutputRate / BENCH_BUFFER);
+  const double amplitude = 0.5;
+  int64 inputPosition = 0;
+  int64 outputPosition = 0;
+  double error = 0;
+  double sum = 0;
+  int64 count = 0;
+  double elapsed = 0;
+
+  for (int32 b = 0; b < buffers; b++)
+  {
+    const int32 needed = resampler.GetInputFramesNeeded(BENCH_BUFFER);
+    for (int32 c = 0; c < BENCH_CHANNELS; c++)
+    {
+      float* pInput = &input[c * inputFrames];
+      for (int32 i = 0; i < needed; i++)
+        pInput[i] = (float)(amplitude * sin(2.0 * M_PI * Frequency * (double)(inputPosition + i) / InputRate));
+      inputs[c] = pInput;
+    }
+    inputPosition += needed;
+
+    nglTime start;
+    resampler.Push(inputs, needed);
+    const int32 done = resampler.Pull(outputs, BENCH_BUFFER);
+    nglTime end;
+    elapsed += (double)end - (double)start;
+
+    for (int32 i = 0; i < done; i++)
+    {
+      const int64 position = outputPosition + i;
+      if (position < OutputRate / 10) // Skip the start of the stream, the input was silent before it
+        continue;
+      const double ideal = amplitude * sin(2.0 * M_PI * Frequency * (double)position / OutputRate);
+      error = MAX(error, fabs(ideal - output[i]));
+      sum += output[i] * output[i];
+      count++;
+    }
+    outputPosition += done;
+  }
+
+  rError = error;
+  rLevel = count ? sqrt(sum / (double)count) : 0;
+  return elapsed / (double)seconds;
+}
+
+int main(int argc, char** argv)
+{
+  int32 seconds = 10;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    seconds = atoi(argv[1]);
+
+  const double rms = 0.5 / sqrt(2.0);
+  printf("%d channels, %d frames per buffer.\n", BENCH_CHANNELS, BENCH_BUFFER);
+  for (int32 q = nuiPolyphaseResampler::eFast; q <= nuiPolyphaseResampler::eBest; q++)
+  {
+    const nuiPolyphaseResampler::Quality quality = (nuiPolyphaseResampler::Quality)q;
+    for (int32 simd = 0; simd < 2; simd++)
+    {
+      double error;
+      double level;
+      const double up = performTest(quality, 44100, 48000, 1000, seconds, simd != 0, error, level);
+      const double upError = 20.0 * log10(error / 0.5);
+      const double down = performTest(quality, 96000, 48000, 1000, seconds, simd != 0, error, level);
+      const double downError = 20.0 * log10(error / 0.5);
+      performTest(quality, 96000, 48000, 30000, 1, simd != 0, error, level);
+      const double alias = 20.0 * log10(MAX(level, 1e-12) / rms);
+      printf("%6s %6s: 44.1k->48k %6.2f%% of one core (error %6.1f dB), 96k->48k %6.2f%% (error %6.1f dB), 30 kHz alias %6.1f dB\n",
+             nuiPolyphaseResampler::GetQualityName(quality), simd ? "SIMD" : "scalar", up * 100.0, upError, down * 100.0, downError, alias);
+    }
+  }
+  nuiAudioDSP_EnableSIMD(true);
+  return 0;
+}
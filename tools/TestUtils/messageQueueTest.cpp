@@ -0,0 +1,113 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiMessageQueue.h"
+
+// Several threads read from the same queue while one thread posts messages slowly enough for the idle readers to park in Get
+// between them. Every message must reach exactly one reader, and quickly: a reader that misses its wake up only gets its message
+// when its Get times out. Returns the number of failures.
+
+#define TEST_READERS 4
+#define TEST_MESSAGES 2000
+#define TEST_TIMEOUT 5000 // ms, what a reader waits in Get
+#define TEST_MAX_LATENCY 1.0 // s, far below TEST_TIMEOUT
+
+class TestMessage : public nuiRefCount, public nuiQueueLink
+{
+public:
+  TestMessage(int32 Index)
+  : mIndex(Index)
+  {
+  }
+
+  int32 mIndex; ///< -1 asks the reader to stop
+  nglTime mPosted;
+};
+
+class Reader : public nglThread
+{
+public:
+  Reader(nuiProtectedQueue<TestMessage>& rQueue)
+  : mrQueue(rQueue), mMaxLatency(0)
+  {
+  }
+
+  void OnStart()
+  {
+    for (;;)
+    {
+      TestMessage* pMessage = mrQueue.Get(TEST_TIMEOUT);
+      if (!pMessage)
+        continue;
+
+      nglTime now;
+      mMaxLatency = MAX(mMaxLatency, (double)now - (double)pMessage->mPosted);
+      const int32 index = pMessage->mIndex;
+      pMessage->Release();
+      if (index < 0)
+        return;
+      mReceived.push_back(index);
+
+      // Work a bit so that the messages find some readers busy and some parked:
+      nglThread::USleep((index * 7919) % 1000);
+    }
+  }
+
+  nuiProtectedQueue<TestMessage>& mrQueue;
+  std::vector<int32> mReceived;
+  double mMaxLatency;
+};
+
+int main(int argc, char** argv)
+{
+  nuiProtectedQueue<TestMessage> queue("messageQueueTest");
+  std::vector<Reader*> readers;
+  for (int32 i = 0; i < TEST_READERS; i++)
+  {
+    readers.push_back(new Reader(queue));
+    readers.back()->Start();
+  }
+
+  uint32 seed = 1;
+  for (int32 i = 0; i < TEST_MESSAGES; i++)
+  {
+    TestMessage* pMessage = new TestMessage(i);
+    pMessage->mPosted = nglTime();
+    queue.Post(pMessage);
+
+    // Mostly let the readers park again, sometimes post bursts:
+    seed = seed * 1664525 + 1013904223;
+    if ((seed >> 8) % 4)
+      nglThread::USleep((seed >> 8) % 500);
+  }
+
+  for (int32 i = 0; i < TEST_READERS; i++)
+  {
+    TestMessage* pMessage = new TestMessage(-1);
+    pMessage->mPosted = nglTime();
+    queue.Post(pMessage);
+  }
+
+  int32 fails = 0;
+  std::vector<int32> counts(TEST_MESSAGES, 0);
+  for (int32 i = 0; i < TEST_READERS; i++)
+  {
+    readers[i]->Join();
+    printf("reader %d: %5d messages, max latency %.3f s\n", i, (int32)readers[i]->mReceived.size(), readers[i]->mMaxLatency);
+    if (readers[i]->mMaxLatency > TEST_MAX_LATENCY)
+      fails++;
+    for (uint32 m = 0; m < readers[i]->mReceived.size(); m++)
+      counts[readers[i]->mReceived[m]]++;
+    delete readers[i];
+  }
+
+  for (int32 i = 0; i < TEST_MESSAGES; i++)
+  {
+    if (counts[i] != 1)
+    {
+      printf("message %d received %d times\n", i, counts[i]);
+      fails++;
+    }
+  }
+
+  printf("%d failures\n", fails);
+  return fails;
+}
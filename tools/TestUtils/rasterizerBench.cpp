@@ -0,0 +1,156 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiFixedPoint.h"
+#include "nui3/include/nuiVertex.h"
+#include "nui3/include/nuiPixelBlender.h"
+#include "nui3/include/nuiRasterizer.h"
+#include "nui3/include/nuiSpanKernels.h"
+
+// Render a fixed scene with nuiRasterizer (the way nuiSoftwarePainter draws widgets: solid and gradient fills, transparent
+// overlays and textured quads from RGB and RGBA images) with each span kernel implementation and report the throughput.
+// The images must be identical for every implementation.
+
+#define BENCH_WIDTH 1024
+#define BENCH_HEIGHT 768
+#define BENCH_TEXTURE 128
+
+class BenchScene
+{
+public:
+  BenchScene()
+  {
+    mpRGB = MakeTexture(eImagePixelRGB, 3);
+    mpRGBA = MakeTexture(eImagePixelRGBA, 4);
+    mPixels = 0;
+  }
+
+  ~BenchScene()
+  {
+    mpRGB->Release();
+    mpRGBA->Release();
+  }
+
+  // Returns the number of pixels covered by the scene.
+  double Render(nuiRasterizer& rRasterizer)
+  {
+    mPixels = 0;
+    rRasterizer.SetClipRect(0, 0, BENCH_WIDTH, BENCH_HEIGHT);
+    rRasterizer.ClearColor(NUI_RGBA(40, 40, 40, 255));
+
+    uint32 seed = 1;
+    for (int32 i = 0; i < 200; i++)
+    {
+      const float x = (float)(Random(seed) % (BENCH_WIDTH - 200));
+      const float y = (float)(Random(seed) % (BENCH_HEIGHT - 150));
+      const float w = (float)(20 + Random(seed) % 180);
+      const float h = (float)(10 + Random(seed) % 140);
+      const nuiColor c0((int)(Random(seed) % 256), (int)(Random(seed) % 256), (int)(Random(seed) % 256), (int)(64 + Random(seed) % 192), false);
+      const nuiColor c1((int)(Random(seed) % 256), (int)(Random(seed) % 256), (int)(Random(seed) % 256), (int)(64 + Random(seed) % 192), false);
+      const float u = (float)(Random(seed) % BENCH_TEXTURE);
+
+      switch (i % 6)
+      {
+        case 0: // Opaque solid fill
+          rRasterizer.DrawRectangle<nuiPixelBlender_Copy>(nuiVertex_Solid(x, y, NUI_RGBA(c0) | 0xff000000), nuiVertex_Solid(x + w, y, NUI_RGBA(c0) | 0xff000000),
+                                                          nuiVertex_Solid(x, y + h, NUI_RGBA(c0) | 0xff000000), nuiVertex_Solid(x + w, y + h, NUI_RGBA(c0) | 0xff000000));
+          break;
+        case 1: // Transparent solid fill
+          rRasterizer.DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Solid(x, y, NUI_RGBA(c0)), nuiVertex_Solid(x + w, y, NUI_RGBA(c0)),
+                                                            nuiVertex_Solid(x, y + h, NUI_RGBA(c0)), nuiVertex_Solid(x + w, y + h, NUI_RGBA(c0)));
+          break;
+        case 2: // Transparent gradient
+          rRasterizer.DrawRectangle<nuiPixelBlender_Transp>(nuiVertex_Gouraud(x, y, nuiGouraudColor(c0)), nuiVertex_Gouraud(x + w, y, nuiGouraudColor(c1)),
+                                                            nuiVertex_Gouraud(x, y + h, nuiGouraudColor(c0)), nuiVertex_Gouraud(x + w, y + h, nuiGouraudColor(c1)));
+          break;
+        case 3: // Additive glow
+          rRasterizer.DrawTriangle<nuiPixelBlender_TranspAdd>(nuiVertex_Gouraud(x, y, nuiGouraudColor(c0)), nuiVertex_Gouraud(x + w, y + h / 2, nuiGouraudColor(c1)),
+                                                              nuiVertex_Gouraud(x, y + h, nuiGouraudColor(c1)));
+          mPixels -= w * h / 2; // Half of the bounding box below
+          break;
+        case 4: // RGB image, tinted
+          DrawImage<nuiTexelAccessor_RGB24>(rRasterizer, mpRGB, x, y, w, h, u, c0);
+          break;
+        case 5: // RGBA image (icons, text)
+          DrawImage<nuiTexelAccessor_RGBA32>(rRasterizer, mpRGBA, x, y, w, h, u, nuiColor(255, 255, 255, 255, false));
+          break;
+      }
+      mPixels += w * h;
+    }
+    return mPixels;
+  }
+
+private:
+  template <class TexelAccessor>
+  void DrawImage(nuiRasterizer& rRasterizer, nuiTexture* pTexture, float x, float y, float w, float h, float u, const nuiColor& rColor)
+  {
+    typedef nuiModulatedColor<nuiTexelColor<TexelAccessor>, nuiGouraudColor> Color;
+    typedef nuiVertex<Color> Vertex;
+    const float s = (float)BENCH_TEXTURE;
+    rRasterizer.DrawRectangle<nuiPixelBlender_Transp>(
+      Vertex(x, y, Color(nuiTexelColor<TexelAccessor>(pTexture, u, 0), nuiGouraudColor(rColor))),
+      Vertex(x + w, y, Color(nuiTexelColor<TexelAccessor>(pTexture, u + s, 0), nuiGouraudColor(rColor))),
+      Vertex(x, y + h, Color(nuiTexelColor<TexelAccessor>(pTexture, u, s), nuiGouraudColor(rColor))),
+      Vertex(x + w, y + h, Color(nuiTexelColor<TexelAccessor>(pTexture, u + s, s), nuiGouraudColor(rColor))));
+  }
+
+  static uint32 Random(uint32& rSeed)
+  {
+    rSeed = rSeed * 1664525 + 1013904223;
+    return rSeed >> 8;
+  }
+
+  static nuiTexture* MakeTexture(nglImagePixelFormat format, int32 bytes)
+  {
+    nglImageInfo info(false);
+    info.mBufferFormat = eImageFormatRaw;
+    info.mPixelFormat = format;
+    info.mWidth = BENCH_TEXTURE;
+    info.mHeight = BENCH_TEXTURE;
+    info.mBitDepth = 8 * bytes;
+    info.mBytesPerPixel = bytes;
+    info.mBytesPerLine = BENCH_TEXTURE * bytes;
+    std::vector<char> buffer(BENCH_TEXTURE * BENCH_TEXTURE * bytes);
+    for (uint32 i = 0; i < buffer.size(); i++)
+      buffer[i] = (char)((i * 7) ^ (i >> 5));
+    info.mpBuffer = &buffer[0];
+    return nuiTexture::GetTexture(info, true);
+  }
+
+  nuiTexture* mpRGB;
+  nuiTexture* mpRGBA;
+  double mPixels;
+};
+
+int main(int argc, char** argv)
+{
+  int32 frames = 100;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    frames = atoi(argv[1]);
+
+  BenchScene scene;
+  std::vector<uint32> reference;
+  printf("%d frames of %dx%d.\n", frames, BENCH_WIDTH, BENCH_HEIGHT);
+  for (int32 impl = eSpanScalar; impl <= eSpanAVX2; impl++)
+  {
+    const char* pName = nuiSpan_GetImplementationName((nuiSpanImplementation)impl);
+    if (!nuiSpan_SetImplementation((nuiSpanImplementation)impl))
+    {
+      printf("%6s: n/a\n", pName);
+      continue;
+    }
+
+    nuiRasterizer rasterizer(BENCH_WIDTH, BENCH_HEIGHT);
+    double pixels = 0;
+    nglTime start;
+    for (int32 f = 0; f < frames; f++)
+      pixels += scene.Render(rasterizer);
+    nglTime end;
+    const double seconds = (double)end - (double)start;
+
+    std::vector<uint32> image(rasterizer.GetBuffer(), rasterizer.GetBuffer() + BENCH_WIDTH * BENCH_HEIGHT);
+    if (reference.empty())
+      reference = image;
+    printf("%6s: %8.1f Mpixels/s, %6.2f ms per frame%s\n", pName, pixels / seconds / 1000000.0, seconds * 1000.0 / frames, image == reference ? "" : " (IMAGE DIFFERS FROM SCALAR)");
+  }
+  nuiSpan_ResetImplementation();
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiTextLayout.h"
+#include "nui3/include/nuiShapedRunCache.h"
+#include "nui3/include/nuiTaskPool.h"
+
+// Lay out big texts made of words that never repeat, with the shaped run cache disabled, so that every run is a miss that goes
+// through HarfBuzz. Each text is laid out on the calling thread alone and then with task pools of 1, 2, 4... workers: the misses
+// of the workers must run in parallel, so the layouts get faster with more threads, and the glyphs must be the same every time.
+// Usage: shapeBench [font file]. Returns the number of failures.
+
+#define BENCH_PARAGRAPHS 4000
+#define BENCH_WORDS 12
+#define BENCH_ROUNDS 4
+
+static uint32 Random(uint32& rSeed)
+{
+  rSeed = rSeed * 1664525 + 1013904223;
+  return rSeed >> 8;
+}
+
+static nglString MakeText(uint32 Seed)
+{
+  nglString text;
+  for (int32 p = 0; p < BENCH_PARAGRAPHS; p++)
+  {
+    for (int32 w = 0; w < BENCH_WORDS; w++)
+    {
+      const int32 len = 3 + Random(Seed) % 8;
+      for (int32 c = 0; c < len; c++)
+        text.Add((nglUChar)('a' + Random(Seed) % 26));
+      text.Add((nglUChar)' ');
+    }
+    text.Add((nglUChar)'\n');
+  }
+  return text;
+}
+
+static void GetGlyphs(const nuiTextLayout& rLayout, std::vector<float>& rGlyphs)
+{
+  rGlyphs.clear();
+  for (int32 i = 0; i < rLayout.GetGlyphCount(); i++)
+  {
+    const nuiTextGlyph* pGlyph = rLayout.GetGlyph(i);
+    rGlyphs.push_back((float)pGlyph->Index);
+    rGlyphs.push_back(pGlyph->mX);
+    rGlyphs.push_back(pGlyph->mY);
+  }
+}
+
+// Returns the time spent in Layout and sets rChars to the number of chars laid out.
+static double Run(nuiFontBase* pFont, nuiTaskPool* pPool, uint32 Seed, std::vector<float>& rGlyphs, double& rChars)
+{
+  double time = 0;
+  rChars = 0;
+  for (int32 r = 0; r < BENCH_ROUNDS; r++)
+  {
+    const nglString text(MakeText(Seed + r));
+    rChars += text.GetLength();
+    nuiTextLayout layout(pFont);
+    layout.SetTaskPool(pPool);
+
+    nglTime start;
+    layout.Layout(text);
+    nglTime end;
+    time += (double)end - (double)start;
+
+    if (r == BENCH_ROUNDS - 1)
+      GetGlyphs(layout, rGlyphs);
+  }
+  return time;
+}
+
+int main(int argc, char** argv)
+{
+  nuiInit(NULL);
+  int32 fails = 0;
+  {
+    nuiFont* pFont = (argc > 1) ? nuiFont::GetFont(nglPath(argv[1]), 14.0f) : nuiFont::GetFont(14.0f);
+    if (!pFont)
+    {
+      printf("Can't load the font\n");
+      nuiUninit();
+      return 1;
+    }
+
+    nuiShapedRunCache::Get().SetEnabled(false);
+
+    // Put the glyphs in the font textures first, the rest of the rounds only measure the layouts:
+    std::vector<float> reference;
+    double chars = 0;
+    Run(pFont, NULL, 0, reference, chars);
+
+    const double serial = Run(pFont, NULL, 1, reference, chars);
+    printf("calling thread: %9.0f chars/s\n", chars / serial);
+
+    const uint32 cpus = nglCPUInfo::GetCount();
+    for (uint32 threads = 1; threads <= MAX(cpus, 2); threads *= 2)
+    {
+      nuiTaskPool pool(threads, nglString("shapeBench"));
+      std::vector<float> glyphs;
+      const double time = Run(pFont, &pool, 1, glyphs, chars);
+
+      // The calling thread shapes its share too, so two workers and more must beat it clearly if the misses don't wait on each other:
+      const double speedup = serial / time;
+      const bool same = glyphs == reference;
+      const bool parallel = threads < 2 || cpus < 2 || speedup > 1.3;
+      printf("%2d workers     : %9.0f chars/s, x%.2f%s%s\n", threads, chars / time, speedup, same ? "" : " (GLYPHS DIFFER)", parallel ? "" : " (NOT PARALLEL)");
+      if (!same)
+        fails++;
+      if (!parallel)
+        fails++;
+    }
+
+    nuiShapedRunCache::Get().SetEnabled(true);
+    pFont->Release();
+  }
+  nuiUninit();
+
+  printf("%d failures\n", fails);
+  return fails;
+}
@@ -0,0 +1,98 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nglSPSCRing.h"
+
+#ifdef _LINUX_
+#include <sched.h>
+#endif
+
+// Pin the calling thread to the given core so that the two sides of the ring really run on different caches.
+void pinCurrentThread(int cpu)
+{
+#ifdef _LINUX_
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+class Producer : public nglThread
+{
+public:
+  Producer(nglSPSCRing<float>& rRing, uint64 count, uint32 chunk, int cpu)
+  : mrRing(rRing), mCount(count), mChunk(chunk), mCPU(cpu)
+  {
+  }
+
+  void OnStart()
+  {
+    pinCurrentThread(mCPU);
+    std::vector<float> buffer(mChunk, 1.0f);
+    uint64 done = 0;
+    while (done < mCount)
+    {
+      uint32 todo = (uint32)MIN((uint64)mChunk, mCount - done);
+      if (mChunk == 1)
+        done += mrRing.Push(buffer[0]) ? 1 : 0;
+      else
+        done += mrRing.Push(&buffer[0], todo);
+    }
+  }
+
+private:
+  nglSPSCRing<float>& mrRing;
+  uint64 mCount;
+  uint32 mChunk;
+  int mCPU;
+};
+
+void performTest(uint64 count, uint32 capacity, uint32 chunk)
+{
+  nglSPSCRing<float> ring(capacity);
+  Producer producer(ring, count, chunk, 1);
+
+  nglTime start;
+  producer.Start();
+
+  pinCurrentThread(0);
+  std::vector<float> buffer(chunk);
+  uint64 done = 0;
+  double sum = 0;
+  while (done < count)
+  {
+    if (chunk == 1)
+    {
+      if (ring.Pop(buffer[0]))
+      {
+        sum += buffer[0];
+        done++;
+      }
+    }
+    else
+    {
+      uint32 read = ring.Pop(&buffer[0], chunk);
+      for (uint32 i = 0; i < read; i++)
+        sum += buffer[i];
+      done += read;
+    }
+  }
+  producer.Join();
+  nglTime end;
+
+  double seconds = (double)end - (double)start;
+  printf("capacity %6d chunk %5d: %8.2f Mfloats/s (checksum %g)\n", ring.GetCapacity(), chunk, (double)count / seconds / 1000000.0, sum);
+}
+
+int main(int argc, char** argv)
+{
+  uint64 count = 100000000;
+  if (argc > 1 && strtoll(argv[1], NULL, 10) > 0)
+    count = strtoll(argv[1], NULL, 10);
+
+  printf("Transfering %lld floats between two pinned threads.\n", count);
+  performTest(count, 4096, 1);
+  performTest(count, 4096, 64);
+  performTest(count, 4096, 512);
+  performTest(count, 65536, 4096);
+  return 0;
+}
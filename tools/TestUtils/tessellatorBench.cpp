@@ -0,0 +1,201 @@
+#include "nui3/include/nui.h"
+#include "nui3/include/nuiTessellator.h"
+#include "nui3/include/nuiRectPath.h"
+#include "nui3/include/nuiArc.h"
+#include "nui3/include/nuiSpline.h"
+
+// Fill the same sets of rectangles, rounded rectangles, ellipses, spline blobs and self intersecting stars with nuiTessellator,
+// with and without its simple contour fast path, and report the throughput of each. The area covered by the triangles must be
+// the same both ways.
+
+#define BENCH_SHAPES 1000
+
+class BenchSet
+{
+public:
+  BenchSet(const char* pName)
+  : mpName(pName)
+  {
+  }
+
+  ~BenchSet()
+  {
+    for (uint32 i = 0; i < mpShapes.size(); i++)
+      delete mpShapes[i];
+    for (uint32 i = 0; i < mpPaths.size(); i++)
+      delete mpPaths[i];
+  }
+
+  void Add(nuiShape* pShape)
+  {
+    mpShapes.push_back(pShape);
+  }
+
+  void Add(nuiPathGenerator* pPath)
+  {
+    mpPaths.push_back(pPath);
+  }
+
+  // Returns the number of triangles and sets rArea to the area they cover.
+  uint32 Run(int32 Rounds, double& rArea)
+  {
+    uint32 triangles = 0;
+    rArea = 0;
+    for (int32 r = 0; r < Rounds; r++)
+    {
+      for (uint32 i = 0; i < mpShapes.size(); i++)
+      {
+        nuiTessellator tessellator(mpShapes[i]);
+        triangles += Measure(tessellator.Generate(), rArea);
+      }
+      for (uint32 i = 0; i < mpPaths.size(); i++)
+      {
+        nuiTessellator tessellator(mpPaths[i]);
+        triangles += Measure(tessellator.Generate(), rArea);
+      }
+    }
+    return triangles;
+  }
+
+  const char* GetName() const
+  {
+    return mpName;
+  }
+
+  uint32 GetCount() const
+  {
+    return mpShapes.size() + mpPaths.size();
+  }
+
+private:
+  static uint32 Measure(nuiRenderObject* pObject, double& rArea)
+  {
+    if (!pObject)
+      return 0;
+
+    uint32 triangles = 0;
+    nuiRenderArray::Vertex v[3];
+    for (uint32 i = 0; i < pObject->GetSize(); i++)
+    {
+      nuiRenderArray* pArray = pObject->GetArray(i);
+      if (pArray->GetMode() == GL_TRIANGLES)
+      {
+        for (uint32 j = 0; j + 2 < pArray->GetSize(); j += 3)
+        {
+          pArray->GetVertex(j, v[0]);
+          pArray->GetVertex(j + 1, v[1]);
+          pArray->GetVertex(j + 2, v[2]);
+          rArea += fabs((v[1].mX - v[0].mX) * (v[2].mY - v[0].mY) - (v[1].mY - v[0].mY) * (v[2].mX - v[0].mX)) * 0.5;
+          triangles++;
+        }
+      }
+      pArray->Release(); // The reference left for the painter
+    }
+    delete pObject;
+    return triangles;
+  }
+
+  const char* mpName;
+  std::vector<nuiShape*> mpShapes;
+  std::vector<nuiPathGenerator*> mpPaths;
+};
+
+static uint32 Random(uint32& rSeed)
+{
+  rSeed = rSeed * 1664525 + 1013904223;
+  return rSeed >> 8;
+}
+
+static float RandomFloat(uint32& rSeed, float Min, float Max)
+{
+  return Min + (Max - Min) * (float)(Random(rSeed) % 10000) / 10000.0f;
+}
+
+int main(int argc, char** argv)
+{
+  int32 rounds = 20;
+  if (argc > 1 && atoi(argv[1]) > 0)
+    rounds = atoi(argv[1]);
+
+  std::vector<BenchSet*> sets;
+  uint32 seed = 1;
+
+  BenchSet* pRects = new BenchSet("rect");
+  BenchSet* pRoundRects = new BenchSet("roundrect");
+  BenchSet* pEllipses = new BenchSet("arc");
+  BenchSet* pSplines = new BenchSet("spline");
+  BenchSet* pStars = new BenchSet("star");
+  sets.push_back(pRects);
+  sets.push_back(pRoundRects);
+  sets.push_back(pEllipses);
+  sets.push_back(pSplines);
+  sets.push_back(pStars);
+
+  for (int32 i = 0; i < BENCH_SHAPES; i++)
+  {
+    const float x = RandomFloat(seed, 0, 1000);
+    const float y = RandomFloat(seed, 0, 1000);
+    const float w = RandomFloat(seed, 10, 300);
+    const float h = RandomFloat(seed, 10, 300);
+
+    pRects->Add(new nuiRectPath(nuiRect(x, y, w, h)));
+
+    nuiShape* pRoundRect = new nuiShape();
+    pRoundRect->AddRoundRect(nuiRect(x, y, w, h), RandomFloat(seed, 2, MIN(w, h) / 2));
+    pRoundRects->Add(pRoundRect);
+
+    pEllipses->Add(new nuiArc(x, y, w / 2, h / 2, 270, 0, RandomFloat(seed, 0, 90))); // Three quarters of an ellipse, closed by a chord.
+
+    // A concave blob: the nodes alternate between two radii.
+    nuiSpline* pSpline = new nuiSpline();
+    pSpline->SetCatmullRomMode();
+    const int32 nodes = 6 + Random(seed) % 6;
+    for (int32 n = 0; n < nodes; n++)
+    {
+      const float angle = (float)(2 * M_PI * n / nodes);
+      const float radius = (n & 1) ? w / 2 : w / 4;
+      pSpline->AddNode(nuiSplineNode(x + radius * cosf(angle), y + radius * sinf(angle)));
+    }
+    pSpline->AddNode(*pSpline->GetNode(0));
+    pSplines->Add(pSpline);
+
+    // Self intersecting, always goes through libtess:
+    nuiPath star;
+    for (int32 n = 0; n < 5; n++)
+    {
+      const float angle = (float)(4 * M_PI * n / 5);
+      star.AddVertex(nuiPoint(x + w / 2 * cosf(angle), y + w / 2 * sinf(angle)));
+    }
+    star.AddVertex(star.Front());
+    nuiShape* pStar = new nuiShape();
+    pStar->AddPath(star);
+    pStar->SetWinding(nuiShape::eOdd);
+    pStars->Add(pStar);
+  }
+
+  printf("%d rounds of %d shapes per set.\n", rounds, BENCH_SHAPES);
+  for (uint32 i = 0; i < sets.size(); i++)
+  {
+    BenchSet* pSet = sets[i];
+    double results[2];
+    double areas[2];
+    uint32 triangles[2];
+    for (int32 fast = 0; fast < 2; fast++)
+    {
+      nuiTessellator::SetFastPath(fast != 0);
+      nglTime start;
+      triangles[fast] = pSet->Run(rounds, areas[fast]);
+      nglTime end;
+      results[fast] = (double)(rounds * pSet->GetCount()) / ((double)end - (double)start);
+    }
+
+    const bool same = fabs(areas[1] - areas[0]) <= 0.001 * areas[0];
+    printf("%10s: libtess %9.0f shapes/s (%7d triangles), fast path %9.0f shapes/s (%7d triangles), x%.2f%s\n", pSet->GetName(),
+           results[0], triangles[0] / rounds, results[1], triangles[1] / rounds, results[1] / results[0], same ? "" : " (AREA DIFFERS)");
+    delete pSet;
+  }
+
+  nuiTessellator::SetFastPath(true);
+  nuiTessellator::ReleaseTessellators();
+  return 0;
+}